@@ -2465,6 +2465,106 @@ static void test_symlinks(void)
     pRtlFreeUnicodeString( &target_str );
 }
 
+static void test_symlink_flush(void)
+{
+    static const WCHAR targetW[] = {'\\','S','o','f','t','w','a','r','e','\\','W','i','n','e',
+                                    '\\','T','e','s','t','\\','t','a','r','g','e','t',0};
+    BYTE buffer[1024];
+    UNICODE_STRING target_str;
+    WCHAR *target;
+    HKEY key, link;
+    NTSTATUS status;
+    DWORD target_len, type, len, dw, err;
+
+    if (!pRtlFormatCurrentUserKeyPath || !pNtDeleteKey)
+    {
+        win_skip( "Can't perform symlink tests\n" );
+        return;
+    }
+
+    pRtlFormatCurrentUserKeyPath( &target_str );
+
+    target_len = target_str.Length + sizeof(targetW);
+    target = HeapAlloc( GetProcessHeap(), 0, target_len );
+    memcpy( target, target_str.Buffer, target_str.Length );
+    memcpy( target + target_str.Length/sizeof(WCHAR), targetW, sizeof(targetW) );
+
+    err = RegCreateKeyExA( hkey_main, "target", 0, NULL, 0, KEY_ALL_ACCESS, NULL, &key, NULL );
+    ok( err == ERROR_SUCCESS, "RegCreateKeyEx failed error %u\n", err );
+    dw = 1;
+    err = RegSetValueExA( key, "value", 0, REG_DWORD, (BYTE *)&dw, sizeof(dw) );
+    ok( err == ERROR_SUCCESS, "RegSetValueEx failed error %u\n", err );
+    RegCloseKey( key );
+
+    /* changes are written out when flushing, and read back when the registry is loaded again */
+    err = RegCreateKeyExA( hkey_main, "link", 0, NULL, REG_OPTION_CREATE_LINK,
+                           KEY_ALL_ACCESS, NULL, &link, NULL );
+    ok( err == ERROR_SUCCESS, "RegCreateKeyEx failed: %u\n", err );
+    err = RegSetValueExA( link, "SymbolicLinkValue", 0, REG_LINK,
+                          (BYTE *)target, target_len - sizeof(WCHAR) );
+    ok( err == ERROR_SUCCESS, "RegSetValueEx failed error %u\n", err );
+    err = RegSetValueExA( link, "SymbolicLinkValue", 0, REG_LINK,
+                          (BYTE *)target, target_len - sizeof(WCHAR) );
+    ok( err == ERROR_SUCCESS, "RegSetValueEx failed error %u\n", err );
+    err = RegFlushKey( hkey_main );
+    ok( err == ERROR_SUCCESS, "RegFlushKey failed error %u\n", err );
+
+    err = RegOpenKeyA( hkey_main, "link", &key );
+    ok( err == ERROR_SUCCESS, "RegOpenKey failed error %u\n", err );
+    dw = 2;
+    err = RegSetValueExA( key, "value", 0, REG_DWORD, (BYTE *)&dw, sizeof(dw) );
+    ok( err == ERROR_SUCCESS, "RegSetValueEx failed error %u\n", err );
+    RegCloseKey( key );
+    err = RegFlushKey( hkey_main );
+    ok( err == ERROR_SUCCESS, "RegFlushKey failed error %u\n", err );
+
+    err = RegOpenKeyExA( hkey_main, "link", REG_OPTION_OPEN_LINK, KEY_ALL_ACCESS, &key );
+    ok( err == ERROR_SUCCESS, "RegOpenKeyEx failed error %u\n", err );
+    len = sizeof(buffer);
+    err = RegQueryValueExA( key, "SymbolicLinkValue", NULL, &type, buffer, &len );
+    ok( err == ERROR_SUCCESS, "RegQueryValueEx failed error %u\n", err );
+    ok( type == REG_LINK, "wrong type %u\n", type );
+    ok( len == target_len - sizeof(WCHAR), "wrong len %u\n", len );
+    len = sizeof(buffer);
+    err = RegQueryValueExA( key, "value", NULL, &type, buffer, &len );
+    ok( err == ERROR_FILE_NOT_FOUND, "RegQueryValueEx wrong error %u\n", err );
+    RegCloseKey( key );
+
+    err = RegOpenKeyA( hkey_main, "target", &key );
+    ok( err == ERROR_SUCCESS, "RegOpenKey failed error %u\n", err );
+    len = sizeof(dw);
+    err = RegQueryValueExA( key, "value", NULL, &type, (BYTE *)&dw, &len );
+    ok( err == ERROR_SUCCESS, "RegQueryValueEx failed error %u\n", err );
+    ok( dw == 2, "wrong value %u\n", dw );
+    len = sizeof(buffer);
+    err = RegQueryValueExA( key, "SymbolicLinkValue", NULL, &type, buffer, &len );
+    ok( err == ERROR_FILE_NOT_FOUND, "RegQueryValueEx wrong error %u\n", err );
+    RegCloseKey( key );
+
+    /* deleting the link leaves the target alone */
+    status = pNtDeleteKey( link );
+    ok( !status, "NtDeleteKey failed: 0x%08x\n", status );
+    RegCloseKey( link );
+    err = RegFlushKey( hkey_main );
+    ok( err == ERROR_SUCCESS, "RegFlushKey failed error %u\n", err );
+
+    err = RegOpenKeyExA( hkey_main, "link", REG_OPTION_OPEN_LINK, KEY_ALL_ACCESS, &key );
+    ok( err == ERROR_FILE_NOT_FOUND, "RegOpenKeyEx wrong error %u\n", err );
+    err = RegOpenKeyA( hkey_main, "target", &key );
+    ok( err == ERROR_SUCCESS, "RegOpenKey failed error %u\n", err );
+    len = sizeof(dw);
+    err = RegQueryValueExA( key, "value", NULL, &type, (BYTE *)&dw, &len );
+    ok( err == ERROR_SUCCESS, "RegQueryValueEx failed error %u\n", err );
+    ok( dw == 2, "wrong value %u\n", dw );
+    RegCloseKey( key );
+
+    err = RegDeleteKeyA( hkey_main, "target" );
+    ok( err == ERROR_SUCCESS, "RegDeleteKey failed error %u\n", err );
+
+    HeapFree( GetProcessHeap(), 0, target );
+    pRtlFreeUnicodeString( &target_str );
+}
+
 static DWORD get_key_value( HKEY root, const char *name, DWORD flags )
 {
     HKEY key;
@@ -2490,6 +2590,44 @@ static void _check_key_value( int line, HANDLE root, const char *name, DWORD fla
 }
 #define check_key_value(root,name,flags,expect) _check_key_value( __LINE__, root, name, flags, expect )
 
+/* Software has been there since the registry was loaded, its subkeys may not have been looked at yet */
+static void test_redirection_existing_key(void)
+{
+    char path32[MAX_PATH], path[MAX_PATH];
+    DWORD err, len;
+    HKEY software, key;
+
+    if (ptr_size != 64)
+    {
+        BOOL is_wow64;
+        if (!pIsWow64Process || !pIsWow64Process( GetCurrentProcess(), &is_wow64 ) || !is_wow64)
+        {
+            skip( "Not on Wow64, no redirection\n" );
+            return;
+        }
+    }
+
+    err = RegOpenKeyExA( HKEY_LOCAL_MACHINE, "Software\\Wow6432Node\\Microsoft\\Windows\\CurrentVersion", 0,
+                         KEY_WOW64_64KEY | KEY_QUERY_VALUE, &key );
+    ok( err == ERROR_SUCCESS, "RegOpenKeyExA failed: %u\n", err );
+    len = sizeof(path32);
+    err = RegQueryValueExA( key, "ProgramFilesDir", NULL, NULL, (BYTE *)path32, &len );
+    ok( err == ERROR_SUCCESS, "RegQueryValueExA failed: %u\n", err );
+    RegCloseKey( key );
+
+    err = RegOpenKeyExA( HKEY_LOCAL_MACHINE, "Software", 0, KEY_WOW64_64KEY | KEY_READ, &software );
+    ok( err == ERROR_SUCCESS, "RegOpenKeyExA failed: %u\n", err );
+    err = RegOpenKeyExA( software, "Microsoft\\Windows\\CurrentVersion", 0,
+                         KEY_WOW64_32KEY | KEY_QUERY_VALUE, &key );
+    ok( err == ERROR_SUCCESS, "RegOpenKeyExA failed: %u\n", err );
+    len = sizeof(path);
+    err = RegQueryValueExA( key, "ProgramFilesDir", NULL, NULL, (BYTE *)path, &len );
+    ok( err == ERROR_SUCCESS, "RegQueryValueExA failed: %u\n", err );
+    ok( !strcmp( path, path32 ), "got %s, expected %s\n", path, path32 );
+    RegCloseKey( key );
+    RegCloseKey( software );
+}
+
 static void test_redirection(void)
 {
     DWORD err, type, dw, len;
@@ -3542,6 +3680,7 @@ START_TEST(registry)
 
     setup_main_key();
     check_user_privs();
+    test_redirection_existing_key();
     test_set_value();
     create_test_entries();
     test_enum_value();
@@ -3555,6 +3694,7 @@ START_TEST(registry)
     test_reg_query_info();
     test_string_termination();
     test_symlinks();
+    test_symlink_flush();
     test_redirection();
     test_classesroot();
     test_classesroot_enum();
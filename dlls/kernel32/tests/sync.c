@@ -654,6 +654,99 @@ static void test_waitable_timer(void)
     CloseHandle( handle );
 }
 
+/* all the named events end up in the same server namespace, which has to grow */
+static void test_named_objects_stress(void)
+{
+    int i, count = 1000;
+    HANDLE *events, handle;
+    char name[64];
+
+    events = HeapAlloc( GetProcessHeap(), 0, count * sizeof(*events) );
+    for (i = 0; i < count; i++)
+    {
+        sprintf( name, "wine_test_named_object_%u_%d", GetCurrentProcessId(), i );
+        events[i] = CreateEventA( NULL, TRUE, FALSE, name );
+        ok( events[i] != NULL, "CreateEvent %s failed with error %u\n", name, GetLastError() );
+        ok( GetLastError() != ERROR_ALREADY_EXISTS, "%s already exists\n", name );
+        if (!events[i]) break;
+    }
+    count = i;
+
+    for (i = 0; i < count; i++)
+    {
+        sprintf( name, "wine_test_named_object_%u_%d", GetCurrentProcessId(), (int)((LONGLONG)i * 7919 % count) );
+        handle = OpenEventA( SYNCHRONIZE, FALSE, name );
+        ok( handle != NULL, "OpenEvent %s failed with error %u\n", name, GetLastError() );
+        CloseHandle( handle );
+    }
+
+    /* the names go away with the objects, also when the namespace is being resized */
+    for (i = 0; i < count; i += 2) CloseHandle( events[i] );
+    for (i = 0; i < count; i++)
+    {
+        sprintf( name, "wine_test_named_object_%u_%d", GetCurrentProcessId(), i );
+        handle = OpenEventA( SYNCHRONIZE, FALSE, name );
+        if (i % 2) ok( handle != NULL, "OpenEvent %s failed with error %u\n", name, GetLastError() );
+        else ok( !handle && GetLastError() == ERROR_FILE_NOT_FOUND, "OpenEvent %s returned %p, error %u\n",
+                 name, handle, GetLastError() );
+        if (handle) CloseHandle( handle );
+    }
+
+    for (i = 1; i < count; i += 2) CloseHandle( events[i] );
+    HeapFree( GetProcessHeap(), 0, events );
+}
+
+/* each pending timer is a timeout in the server, arm, cancel and expire many of them at once */
+static void test_waitable_timer_stress(void)
+{
+    LARGE_INTEGER due;
+    int i, count = 1000;
+    HANDLE *timers;
+    DWORD ret;
+    BOOL res;
+
+    if (!pCreateWaitableTimerA)
+    {
+        win_skip("CreateWaitableTimerA() is not available\n");
+        return;
+    }
+
+    timers = HeapAlloc( GetProcessHeap(), 0, count * sizeof(*timers) );
+    for (i = 0; i < count; i++)
+    {
+        timers[i] = pCreateWaitableTimerA( NULL, TRUE, NULL );
+        ok( timers[i] != NULL, "CreateWaitableTimer failed with error %u\n", GetLastError() );
+        if (!timers[i]) break;
+    }
+    count = i;
+
+    /* spread the due times over 100-600ms in an order unrelated to the creation order */
+    for (i = 0; i < count; i++)
+    {
+        due.QuadPart = -(100 + (LONGLONG)i * 7919 % 500) * 10000;
+        res = SetWaitableTimer( timers[i], &due, 0, NULL, NULL, FALSE );
+        ok( res, "SetWaitableTimer failed with error %u\n", GetLastError() );
+    }
+    for (i = 0; i < count; i += 2)
+    {
+        res = CancelWaitableTimer( timers[i] );
+        ok( res, "CancelWaitableTimer failed with error %u\n", GetLastError() );
+    }
+    for (i = 1; i < count; i += 2)
+    {
+        ret = WaitForSingleObject( timers[i], 10000 );
+        ok( ret == WAIT_OBJECT_0, "timer %d not signaled, ret %u\n", i, ret );
+    }
+    for (i = 0; i < count; i += 2)
+    {
+        ret = WaitForSingleObject( timers[i], 0 );
+        ok( ret == WAIT_TIMEOUT, "cancelled timer %d signaled, ret %u\n", i, ret );
+    }
+
+    for (i = 0; i < count; i++) CloseHandle( timers[i] );
+    HeapFree( GetProcessHeap(), 0, timers );
+}
+
 static HANDLE sem = 0;
 
 static void CALLBACK iocp_callback(DWORD dwErrorCode, DWORD dwNumberOfBytesTransferred, LPOVERLAPPED lpOverlapped)
@@ -2467,6 +2560,111 @@ static void test_srwlock_example(void)
     trace("number of total exclusive accesses is %d\n", srwlock_protected_value);
 }
 
+struct contention_params
+{
+    SRWLOCK *lock;
+    CONDITION_VARIABLE *cv;
+    LONG *value;
+    LONG *turn;
+    unsigned int index;
+    unsigned int threads;
+    unsigned int loops;
+};
+
+static DWORD WINAPI srwlock_contention_thread(void *arg)
+{
+    struct contention_params *params = arg;
+    unsigned int i;
+
+    for (i = 0; i < params->loops; i++)
+    {
+        if (i % 4)
+        {
+            pAcquireSRWLockShared(params->lock);
+            if (*params->value < 0) InterlockedIncrement(&srwlock_example_errors);
+            pReleaseSRWLockShared(params->lock);
+        }
+        else
+        {
+            pAcquireSRWLockExclusive(params->lock);
+            *params->value = *params->value + 1;
+            pReleaseSRWLockExclusive(params->lock);
+        }
+    }
+    return 0;
+}
+
+/* the threads take turns, each one has to be woken by the previous one */
+static DWORD WINAPI condvar_contention_thread(void *arg)
+{
+    struct contention_params *params = arg;
+    unsigned int i;
+
+    pAcquireSRWLockExclusive(params->lock);
+    for (i = 0; i < params->loops; i++)
+    {
+        while (*params->turn % params->threads != params->index)
+            pSleepConditionVariableSRW(params->cv, params->lock, INFINITE, 0);
+        (*params->turn)++;
+        pWakeAllConditionVariable(params->cv);
+    }
+    pReleaseSRWLockExclusive(params->lock);
+    return 0;
+}
+
+static LONG run_contention(LPTHREAD_START_ROUTINE func, unsigned int count, unsigned int loops)
+{
+    struct contention_params params[64];
+    HANDLE threads[64];
+    CONDITION_VARIABLE cv;
+    SRWLOCK lock;
+    LONG value = 0, turn = 0;
+    unsigned int i;
+
+    pInitializeSRWLock(&lock);
+    pInitializeConditionVariable(&cv);
+    for (i = 0; i < count; i++)
+    {
+        params[i].lock = &lock;
+        params[i].cv = &cv;
+        params[i].value = &value;
+        params[i].turn = &turn;
+        params[i].index = i;
+        params[i].threads = count;
+        params[i].loops = loops;
+        threads[i] = CreateThread(NULL, 0, func, &params[i], 0, NULL);
+        ok(threads[i] != NULL, "CreateThread failed with error %u\n", GetLastError());
+    }
+    WaitForMultipleObjects(count, threads, TRUE, INFINITE);
+    for (i = 0; i < count; i++) CloseHandle(threads[i]);
+
+    return func == condvar_contention_thread ? turn : value;
+}
+
+/* SRW locks and condition variables with a growing number of threads fighting over them */
+static void test_srwlock_contention(void)
+{
+    unsigned int count, loops = 1000;
+    LONG result;
+
+    if (!pInitializeSRWLock || !pInitializeConditionVariable)
+    {
+        win_skip("no srw lock or condition variable support.\n");
+        return;
+    }
+
+    srwlock_example_errors = 0;
+    for (count = 2; count <= 64; count *= 2)
+    {
+        result = run_contention(srwlock_contention_thread, count, loops);
+        ok(result == count * ((loops + 3) / 4), "%u threads: got %d exclusive accesses\n", count, result);
+
+        result = run_contention(condvar_contention_thread, count, loops / 100);
+        ok(result == count * (loops / 100), "%u threads: got %d turns\n", count, result);
+    }
+    ok(!srwlock_example_errors, "%d errors\n", srwlock_example_errors);
+}
+
 static DWORD WINAPI alertable_wait_thread(void *param)
 {
     HANDLE *semaphores = param;
@@ -2648,6 +2846,254 @@ static void test_apc_deadlock(void)
     CloseHandle(pi.hProcess);
 }
 
+static void shared_state_child(void)
+{
+    HANDLE manual, autoreset, sem, mutex;
+    LONG prev;
+    DWORD ret;
+
+    manual = OpenEventA(EVENT_ALL_ACCESS, FALSE, "test_shared_state_manual");
+    ok(manual != NULL, "OpenEvent failed with %u\n", GetLastError());
+    autoreset = OpenEventA(EVENT_MODIFY_STATE, FALSE, "test_shared_state_auto");
+    ok(autoreset != NULL, "OpenEvent failed with %u\n", GetLastError());
+    sem = OpenSemaphoreA(SEMAPHORE_ALL_ACCESS, FALSE, "test_shared_state_sem");
+    ok(sem != NULL, "OpenSemaphore failed with %u\n", GetLastError());
+    mutex = OpenMutexA(MUTEX_ALL_ACCESS, FALSE, "test_shared_state_mutex");
+    ok(mutex != NULL, "OpenMutex failed with %u\n", GetLastError());
+
+    /* the parent left the manual event set */
+    ret = WaitForSingleObject(manual, 0);
+    ok(ret == WAIT_OBJECT_0, "expected WAIT_OBJECT_0, got %u\n", ret);
+    ret = ResetEvent(manual);
+    ok(ret, "ResetEvent failed with %u\n", GetLastError());
+
+    ret = SetEvent(autoreset);
+    ok(ret, "SetEvent failed with %u\n", GetLastError());
+    SetLastError(0xdeadbeef);
+    ret = WaitForSingleObject(autoreset, 0);
+    ok(ret == WAIT_FAILED, "expected WAIT_FAILED, got %u\n", ret);
+    ok(GetLastError() == ERROR_ACCESS_DENIED, "expected ERROR_ACCESS_DENIED, got %u\n", GetLastError());
+
+    /* the parent consumed one of its two counts */
+    prev = 0xdeadbeef;
+    ret = ReleaseSemaphore(sem, 2, &prev);
+    ok(ret, "ReleaseSemaphore failed with %u\n", GetLastError());
+    ok(prev == 1, "expected 1, got %d\n", prev);
+    SetLastError(0xdeadbeef);
+    ret = ReleaseSemaphore(sem, 1, NULL);
+    ok(!ret, "ReleaseSemaphore succeeded\n");
+    ok(GetLastError() == ERROR_TOO_MANY_POSTS, "expected ERROR_TOO_MANY_POSTS, got %u\n", GetLastError());
+
+    /* exit while owning the mutex */
+    ret = WaitForSingleObject(mutex, 0);
+    ok(ret == WAIT_OBJECT_0, "expected WAIT_OBJECT_0, got %u\n", ret);
+
+    CloseHandle(manual);
+    CloseHandle(autoreset);
+    CloseHandle(sem);
+}
+
+static DWORD WINAPI server_wait_thread(void *arg)
+{
+    return WaitForSingleObjectEx(arg, INFINITE, TRUE);
+}
+
+static DWORD WINAPI timeout_wait_thread(void *arg)
+{
+    return WaitForSingleObject(arg, 200);
+}
+
+static DWORD WINAPI fast_wait_thread(void *arg)
+{
+    return WaitForSingleObject(arg, 1000);
+}
+
+static void test_shared_state(void)
+{
+    HANDLE manual, autoreset, sem, mutex, dup, thread, handles[2];
+    PROCESS_INFORMATION pi;
+    STARTUPINFOA si = { sizeof(si) };
+    char cmdline[MAX_PATH];
+    char **argv;
+    LONG prev;
+    DWORD ret;
+
+    manual = CreateEventA(NULL, TRUE, TRUE, "test_shared_state_manual");
+    ok(manual != NULL, "CreateEvent failed with %u\n", GetLastError());
+    autoreset = CreateEventA(NULL, FALSE, FALSE, "test_shared_state_auto");
+    ok(autoreset != NULL, "CreateEvent failed with %u\n", GetLastError());
+    sem = CreateSemaphoreA(NULL, 2, 3, "test_shared_state_sem");
+    ok(sem != NULL, "CreateSemaphore failed with %u\n", GetLastError());
+    mutex = CreateMutexA(NULL, FALSE, "test_shared_state_mutex");
+    ok(mutex != NULL, "CreateMutex failed with %u\n", GetLastError());
+
+    ret = WaitForSingleObject(sem, 0);
+    ok(ret == WAIT_OBJECT_0, "expected WAIT_OBJECT_0, got %u\n", ret);
+
+    /* state changes made by another process */
+    winetest_get_mainargs(&argv);
+    sprintf(cmdline, "\"%s\" sync shared_state", argv[0]);
+    ret = CreateProcessA(argv[0], cmdline, NULL, NULL, FALSE, 0, NULL, NULL, &si, &pi);
+    ok(ret, "CreateProcess failed with %u\n", GetLastError());
+    winetest_wait_child_process(pi.hProcess);
+    CloseHandle(pi.hThread);
+    CloseHandle(pi.hProcess);
+
+    ret = WaitForSingleObject(manual, 0);
+    ok(ret == WAIT_TIMEOUT, "expected WAIT_TIMEOUT, got %u\n", ret);
+    ret = WaitForSingleObject(autoreset, 0);
+    ok(ret == WAIT_OBJECT_0, "expected WAIT_OBJECT_0, got %u\n", ret);
+    ret = WaitForSingleObject(autoreset, 0);
+    ok(ret == WAIT_TIMEOUT, "expected WAIT_TIMEOUT, got %u\n", ret);
+    ret = WaitForSingleObject(mutex, 0);
+    ok(ret == WAIT_ABANDONED, "expected WAIT_ABANDONED, got %u\n", ret);
+    ret = ReleaseMutex(mutex);
+    ok(ret, "ReleaseMutex failed with %u\n", GetLastError());
+
+    /* state changes made through other handles */
+    dup = OpenEventA(EVENT_MODIFY_STATE, FALSE, "test_shared_state_manual");
+    ok(dup != NULL, "OpenEvent failed with %u\n", GetLastError());
+    ret = SetEvent(dup);
+    ok(ret, "SetEvent failed with %u\n", GetLastError());
+    ret = WaitForSingleObject(manual, 0);
+    ok(ret == WAIT_OBJECT_0, "expected WAIT_OBJECT_0, got %u\n", ret);
+    CloseHandle(dup);
+
+    ret = DuplicateHandle(GetCurrentProcess(), manual, GetCurrentProcess(), &dup, SYNCHRONIZE, FALSE, 0);
+    ok(ret, "DuplicateHandle failed with %u\n", GetLastError());
+    SetLastError(0xdeadbeef);
+    ret = ResetEvent(dup);
+    ok(!ret, "ResetEvent succeeded\n");
+    ok(GetLastError() == ERROR_ACCESS_DENIED, "expected ERROR_ACCESS_DENIED, got %u\n", GetLastError());
+    ret = WaitForSingleObject(dup, 0);
+    ok(ret == WAIT_OBJECT_0, "expected WAIT_OBJECT_0, got %u\n", ret);
+    ret = ResetEvent(manual);
+    ok(ret, "ResetEvent failed with %u\n", GetLastError());
+    ret = WaitForSingleObject(dup, 0);
+    ok(ret == WAIT_TIMEOUT, "expected WAIT_TIMEOUT, got %u\n", ret);
+    CloseHandle(dup);
+
+    ret = DuplicateHandle(GetCurrentProcess(), sem, GetCurrentProcess(), &dup, 0, FALSE, DUPLICATE_SAME_ACCESS);
+    ok(ret, "DuplicateHandle failed with %u\n", GetLastError());
+    ret = WaitForSingleObject(dup, 0);
+    ok(ret == WAIT_OBJECT_0, "expected WAIT_OBJECT_0, got %u\n", ret);
+    ret = WaitForSingleObject(sem, 0);
+    ok(ret == WAIT_OBJECT_0, "expected WAIT_OBJECT_0, got %u\n", ret);
+    ret = WaitForSingleObject(dup, 0);
+    ok(ret == WAIT_OBJECT_0, "expected WAIT_OBJECT_0, got %u\n", ret);
+    ret = WaitForSingleObject(sem, 0);
+    ok(ret == WAIT_TIMEOUT, "expected WAIT_TIMEOUT, got %u\n", ret);
+    CloseHandle(dup);
+
+    /* a thread waiting in the server has to be woken up by the other waits and wakes */
+    thread = CreateThread(NULL, 0, server_wait_thread, autoreset, 0, NULL);
+    ok(thread != NULL, "CreateThread failed with %u\n", GetLastError());
+    Sleep(100);
+    ret = WaitForSingleObject(autoreset, 10);
+    ok(ret == WAIT_TIMEOUT, "expected WAIT_TIMEOUT, got %u\n", ret);
+    ret = SetEvent(autoreset);
+    ok(ret, "SetEvent failed with %u\n", GetLastError());
+    ret = WaitForSingleObject(thread, 1000);
+    ok(ret == WAIT_OBJECT_0, "expected WAIT_OBJECT_0, got %u\n", ret);
+    GetExitCodeThread(thread, &ret);
+    ok(ret == WAIT_OBJECT_0, "expected WAIT_OBJECT_0, got %u\n", ret);
+    CloseHandle(thread);
+    ret = WaitForSingleObject(autoreset, 0);
+    ok(ret == WAIT_TIMEOUT, "expected WAIT_TIMEOUT, got %u\n", ret);
+
+    /* a wait that has to move to the server keeps its timeout */
+    handles[0] = CreateThread(NULL, 0, timeout_wait_thread, autoreset, 0, NULL);
+    ok(handles[0] != NULL, "CreateThread failed with %u\n", GetLastError());
+    Sleep(50);
+    handles[1] = CreateThread(NULL, 0, server_wait_thread, autoreset, 0, NULL);
+    ok(handles[1] != NULL, "CreateThread failed with %u\n", GetLastError());
+    ret = WaitForSingleObject(handles[0], 1000);
+    ok(ret == WAIT_OBJECT_0, "expected WAIT_OBJECT_0, got %u\n", ret);
+    GetExitCodeThread(handles[0], &ret);
+    ok(ret == WAIT_TIMEOUT, "expected WAIT_TIMEOUT, got %u\n", ret);
+    ret = SetEvent(autoreset);
+    ok(ret, "SetEvent failed with %u\n", GetLastError());
+    ret = WaitForSingleObject(handles[1], 1000);
+    ok(ret == WAIT_OBJECT_0, "expected WAIT_OBJECT_0, got %u\n", ret);
+    CloseHandle(handles[0]);
+    CloseHandle(handles[1]);
+
+    /* pulses release the threads already blocked in a wait */
+    thread = CreateThread(NULL, 0, fast_wait_thread, manual, 0, NULL);
+    ok(thread != NULL, "CreateThread failed with %u\n", GetLastError());
+    Sleep(100);
+    ret = PulseEvent(manual);
+    ok(ret, "PulseEvent failed with %u\n", GetLastError());
+    ret = WaitForSingleObject(thread, 1000);
+    ok(ret == WAIT_OBJECT_0, "expected WAIT_OBJECT_0, got %u\n", ret);
+    GetExitCodeThread(thread, &ret);
+    ok(ret == WAIT_OBJECT_0, "expected WAIT_OBJECT_0, got %u\n", ret);
+    CloseHandle(thread);
+    ret = WaitForSingleObject(manual, 0);
+    ok(ret == WAIT_TIMEOUT, "expected WAIT_TIMEOUT, got %u\n", ret);
+
+    handles[0] = CreateThread(NULL, 0, fast_wait_thread, autoreset, 0, NULL);
+    ok(handles[0] != NULL, "CreateThread failed with %u\n", GetLastError());
+    handles[1] = CreateThread(NULL, 0, fast_wait_thread, autoreset, 0, NULL);
+    ok(handles[1] != NULL, "CreateThread failed with %u\n", GetLastError());
+    Sleep(100);
+    ret = PulseEvent(autoreset);
+    ok(ret, "PulseEvent failed with %u\n", GetLastError());
+    ret = WaitForMultipleObjects(2, handles, FALSE, 500);
+    ok(ret == WAIT_OBJECT_0 || ret == WAIT_OBJECT_0 + 1, "expected WAIT_OBJECT_0, got %u\n", ret);
+    if (ret <= WAIT_OBJECT_0 + 1)
+    {
+        DWORD code;
+
+        GetExitCodeThread(handles[ret], &code);
+        ok(code == WAIT_OBJECT_0, "expected WAIT_OBJECT_0, got %u\n", code);
+        ret = WaitForSingleObject(handles[!ret], 100);
+        ok(ret == WAIT_TIMEOUT, "expected WAIT_TIMEOUT, got %u\n", ret);
+    }
+    ret = SetEvent(autoreset);
+    ok(ret, "SetEvent failed with %u\n", GetLastError());
+    ret = WaitForMultipleObjects(2, handles, TRUE, 1000);
+    ok(ret == WAIT_OBJECT_0, "expected WAIT_OBJECT_0, got %u\n", ret);
+    CloseHandle(handles[0]);
+    CloseHandle(handles[1]);
+
+    /* nothing is left pending by a pulse without waiters */
+    ret = PulseEvent(autoreset);
+    ok(ret, "PulseEvent failed with %u\n", GetLastError());
+    ret = WaitForSingleObject(autoreset, 0);
+    ok(ret == WAIT_TIMEOUT, "expected WAIT_TIMEOUT, got %u\n", ret);
+
+    thread = CreateThread(NULL, 0, server_wait_thread, sem, 0, NULL);
+    ok(thread != NULL, "CreateThread failed with %u\n", GetLastError());
+    Sleep(100);
+    prev = 0xdeadbeef;
+    ret = ReleaseSemaphore(sem, 2, &prev);
+    ok(ret, "ReleaseSemaphore failed with %u\n", GetLastError());
+    ok(prev == 0, "expected 0, got %d\n", prev);
+    ret = WaitForSingleObject(thread, 1000);
+    ok(ret == WAIT_OBJECT_0, "expected WAIT_OBJECT_0, got %u\n", ret);
+    CloseHandle(thread);
+
+    /* waiting for all of them is done in the server */
+    ret = SetEvent(autoreset);
+    ok(ret, "SetEvent failed with %u\n", GetLastError());
+    handles[0] = autoreset;
+    handles[1] = sem;
+    ret = WaitForMultipleObjects(2, handles, TRUE, 0);
+    ok(ret == WAIT_OBJECT_0, "expected WAIT_OBJECT_0, got %u\n", ret);
+    ret = WaitForSingleObject(autoreset, 0);
+    ok(ret == WAIT_TIMEOUT, "expected WAIT_TIMEOUT, got %u\n", ret);
+    ret = WaitForSingleObject(sem, 0);
+    ok(ret == WAIT_TIMEOUT, "expected WAIT_TIMEOUT, got %u\n", ret);
+    ret = WaitForMultipleObjects(2, handles, FALSE, 0);
+    ok(ret == WAIT_TIMEOUT, "expected WAIT_TIMEOUT, got %u\n", ret);
+
+    CloseHandle(manual);
+    CloseHandle(autoreset);
+    CloseHandle(sem);
+    CloseHandle(mutex);
+}
+
 START_TEST(sync)
 {
     char **argv;
@@ -2694,6 +3140,8 @@ START_TEST(sync)
         {
             for (;;) SleepEx(INFINITE, TRUE);
         }
+        if (!strcmp(argv[2], "shared_state"))
+            shared_state_child();
         return;
     }
 
@@ -2703,7 +3151,10 @@ START_TEST(sync)
     test_slist();
     test_event();
     test_semaphore();
+    test_shared_state();
     test_waitable_timer();
+    test_waitable_timer_stress();
+    test_named_objects_stress();
     test_iocp_callback();
     test_timer_queue();
     test_WaitForSingleObject();
@@ -2713,6 +3164,7 @@ START_TEST(sync)
     test_condvars_consumer_producer();
     test_srwlock_base();
     test_srwlock_example();
+    test_srwlock_contention();
     test_alertable_wait();
     test_apc_deadlock();
 }
@@ -4333,6 +4333,72 @@ static void test_shared_memory_ro(BOOL is_child, DWORD child_access)
     CloseHandle(mapping);
 }
 
+struct virtual_stress_args
+{
+    unsigned int loops;
+    unsigned int seed;
+};
+
+static DWORD WINAPI virtual_stress_thread( void *arg )
+{
+    struct virtual_stress_args *args = arg;
+    MEMORY_BASIC_INFORMATION info;
+    void *blocks[32] = { NULL };
+    SIZE_T sizes[32];
+    unsigned int i, j, rand = args->seed;
+    SIZE_T size;
+    BOOL ret;
+
+    for (i = 0; i < args->loops; i++)
+    {
+        rand = rand * 1103515245 + 12345;
+        j = (rand >> 16) % (sizeof(blocks)/sizeof(blocks[0]));
+        if (blocks[j])
+        {
+            size = VirtualQuery( blocks[j], &info, sizeof(info) );
+            ok( size == sizeof(info), "VirtualQuery failed %u\n", GetLastError() );
+            ok( info.AllocationBase == blocks[j], "wrong base %p/%p\n", info.AllocationBase, blocks[j] );
+            ok( info.State == MEM_COMMIT, "wrong state %x\n", info.State );
+            ok( info.RegionSize == sizes[j], "wrong size %lx/%lx\n", info.RegionSize, sizes[j] );
+            ret = VirtualFree( blocks[j], 0, MEM_RELEASE );
+            ok( ret, "VirtualFree failed %u\n", GetLastError() );
+            blocks[j] = NULL;
+        }
+        else
+        {
+            sizes[j] = (((rand >> 8) % 64) + 1) * 0x1000;
+            blocks[j] = VirtualAlloc( NULL, sizes[j], MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE );
+            ok( blocks[j] != NULL, "VirtualAlloc failed %u\n", GetLastError() );
+            if (!blocks[j]) break;
+            *(DWORD *)blocks[j] = i;
+        }
+    }
+    for (j = 0; j < sizeof(blocks)/sizeof(blocks[0]); j++)
+        if (blocks[j]) VirtualFree( blocks[j], 0, MEM_RELEASE );
+    return 0;
+}
+
+/* allocate and free from several threads at once */
+static void test_VirtualAlloc_stress(void)
+{
+    struct virtual_stress_args args[4];
+    HANDLE threads[4];
+    unsigned int i;
+
+    for (i = 0; i < sizeof(args)/sizeof(args[0]); i++)
+    {
+        args[i].loops = 5000;
+        args[i].seed = i + 1;
+        threads[i] = CreateThread( NULL, 0, virtual_stress_thread, &args[i], 0, NULL );
+        ok( threads[i] != NULL, "CreateThread failed %u\n", GetLastError() );
+    }
+    for (i = 0; i < sizeof(args)/sizeof(args[0]); i++)
+    {
+        WaitForSingleObject( threads[i], INFINITE );
+        CloseHandle( threads[i] );
+    }
+}
+
 START_TEST(virtual)
 {
     int argc;
@@ -4404,6 +4470,7 @@ START_TEST(virtual)
     test_VirtualProtect();
     test_VirtualAllocEx();
     test_VirtualAlloc();
+    test_VirtualAlloc_stress();
     test_MapViewOfFile();
     test_NtMapViewOfSection();
     test_NtAreMappedFilesTheSame();
@@ -42,9 +42,11 @@
 #include "ntdll_misc.h"
 #include "wine/list.h"
 #include "wine/debug.h"
+#include "wine/heapstats.h"
 #include "wine/server.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(heap);
+WINE_DECLARE_DEBUG_CHANNEL(heapstats);
 
 /* Note: the heap data structures are loosely based on what Pietrek describes in his
  * book 'Windows 95 System Programming Secrets', with some adaptations for
@@ -83,6 +85,7 @@ typedef struct
 /* Value for arena 'magic' field */
 #define ARENA_INUSE_MAGIC      0x455355
 #define ARENA_PENDING_MAGIC    0xbedead
+#define ARENA_CACHED_MAGIC     0x48464c    /* block cached by the low fragmentation front end */
 #define ARENA_FREE_MAGIC       0x45455246
 #define ARENA_LARGE_MAGIC      0x6752614c
 
@@ -144,10 +147,57 @@ typedef struct tagSUBHEAP
     struct tagHEAP     *heap;       /* Main heap structure */
     DWORD               headerSize; /* Size of the heap header */
     DWORD               magic;      /* Magic number */
+    struct tagSUBHEAP  *retired;    /* Next sub-heap waiting to be released */
 } SUBHEAP;
 
 #define SUBHEAP_MAGIC    ((DWORD)('S' | ('U'<<8) | ('B'<<16) | ('H'<<24)))
 
+/* Low fragmentation front end: freed small blocks are kept in per size class
+ * magazines and handed out again without taking the heap lock. Each size class
+ * has a few magazines selected by thread id, so that threads mostly don't
+ * contend with each other. Cached blocks remain in-use arenas for the back end,
+ * they are only marked with ARENA_CACHED_MAGIC. Magazines are refilled and
+ * flushed in batches under the heap lock, taken after the magazine lock. Since
+ * applications can hold the heap lock through RtlLockHeap, the magazine locks
+ * are never waited for: a busy magazine makes the request go to the back end.
+ *
+ * The free path looks up sub-heaps without the heap lock. Empty sub-heaps are
+ * unlinked as usual, but only released once no such lookup is in progress. */
+#define LFH_MAX_BLOCK_SIZE   0x400  /* largest arena size handled by the front end */
+#define LFH_NB_CLASSES       (LFH_MAX_BLOCK_SIZE / ALIGNMENT + 1)
+#define LFH_NB_MAGAZINES     4
+#define LFH_MAGAZINE_SIZE    16
+
+struct lfh_magazine
+{
+    int                   lock;       /* spin lock */
+    unsigned int          count;      /* number of cached blocks */
+    LONG                  contention; /* number of times the lock was busy */
+    ULONG64               allocs;     /* statistics, updated under the lock */
+    ULONG64               frees;
+    ARENA_INUSE          *blocks[LFH_MAGAZINE_SIZE];
+};
+
+struct lfh
+{
+    struct lfh_magazine   magazines[LFH_NB_CLASSES][LFH_NB_MAGAZINES];
+    LONG                  readers;  /* number of unlocked sub-heap lookups in progress */
+    SUBHEAP              *retired;  /* unlinked sub-heaps waiting for the lookups to finish */
+};
+
+/* Allocation statistics, updated under the heap lock. Blocks handled by the
+ * front end are counted in their magazine instead. The rest of the statistics
+ * is computed by walking the heap when they are queried. */
+#define HEAP_STATS_DUMP_INTERVAL  10000  /* ms between dumps on the heapstats channel */
+
+struct heap_stats
+{
+    ULONG64          allocs[HEAP_STATISTICS_CLASSES];
+    ULONG64          frees[HEAP_STATISTICS_CLASSES];
+    ULONG64          reallocs;
+    int              last_dump;     /* tick count of the last dump */
+};
+
 typedef struct tagHEAP
 {
     DWORD_PTR        unknown1[2];
@@ -164,6 +214,8 @@ typedef struct tagHEAP
     ARENA_INUSE    **pending_free;  /* Ring buffer for pending free requests */
     RTL_CRITICAL_SECTION critSection; /* Critical section for serialization */
     FREE_LIST_ENTRY *freeList;      /* Free lists */
+    struct lfh      *lfh;           /* Low fragmentation front end, if enabled */
+    struct heap_stats stats;        /* Statistics counters */
 } HEAP;
 
 #define HEAP_MAGIC       ((DWORD)('H' | ('E'<<8) | ('A'<<16) | ('P'<<24)))
@@ -296,7 +348,8 @@ static void subheap_notify_free_all(SUBHEAP const *subheap)
         {
             ARENA_INUSE const *pArena = (ARENA_INUSE const *)ptr;
             if (pArena->magic == ARENA_INUSE_MAGIC) notify_free(pArena + 1);
-            else if (pArena->magic != ARENA_PENDING_MAGIC) ERR("bad inuse_magic @%p\n", pArena);
+            else if (pArena->magic != ARENA_PENDING_MAGIC && pArena->magic != ARENA_CACHED_MAGIC)
+                ERR("bad inuse_magic @%p\n", pArena);
             ptr += sizeof(*pArena) + (pArena->size & ARENA_SIZE_MASK);
         }
     }
@@ -317,6 +370,15 @@ static inline unsigned int get_freelist_index( SIZE_T size )
     return i;
 }
 
+/* get the statistics class of a block size */
+static inline unsigned int get_stats_class( SIZE_T size )
+{
+    unsigned int ret = 0;
+
+    for (size = (size - 1) / 16; size && ret < HEAP_STATISTICS_CLASSES - 1; size >>= 1) ret++;
+    return ret;
+}
+
 /* get the memory protection type to use for a given heap */
 static inline ULONG get_protection_type( DWORD flags )
 {
@@ -625,6 +687,30 @@ static void HEAP_CreateFreeBlock( SUBHEAP *subheap, void *ptr, SIZE_T size )
 }
 
 
+/***********************************************************************
+ *           lfh_release_retired
+ *
+ * Release the retired sub-heaps if no unlocked lookup is in progress.
+ * The heap lock must be held.
+ */
+static void lfh_release_retired( struct lfh *lfh )
+{
+    SUBHEAP *subheap;
+    SIZE_T size;
+    void *addr;
+
+    if (!lfh->retired || interlocked_cmpxchg( &lfh->readers, 0, 0 )) return;
+    while ((subheap = lfh->retired))
+    {
+        lfh->retired = subheap->retired;
+        subheap->magic = 0;
+        size = 0;
+        addr = subheap->base;
+        NtFreeVirtualMemory( NtCurrentProcess(), &addr, &size, MEM_RELEASE );
+    }
+}
+
+
 /***********************************************************************
  *           HEAP_MakeInUseBlockFree
  *
@@ -680,6 +766,14 @@ static void HEAP_MakeInUseBlockFree( SUBHEAP *subheap, ARENA_INUSE *pArena )
         list_remove( &pFree->entry );
         /* Remove the subheap from the list */
         list_remove( &subheap->entry );
+        if (heap->lfh)
+        {
+            /* the front end may be looking at it, its list entry is left intact for that */
+            subheap->retired = heap->lfh->retired;
+            heap->lfh->retired = subheap;
+            lfh_release_retired( heap->lfh );
+            return;
+        }
         /* Free the memory */
         subheap->magic = 0;
         NtFreeVirtualMemory( NtCurrentProcess(), &addr, &size, MEM_RELEASE );
@@ -915,7 +1009,11 @@ static SUBHEAP *HEAP_CreateSubHeap( HEAP *heap, LPVOID address, DWORD flags,
         subheap->commitSize = commitSize;
         subheap->magic      = SUBHEAP_MAGIC;
         subheap->headerSize = ROUND_SIZE( sizeof(SUBHEAP) );
-        list_add_head( &heap->subheap_list, &subheap->entry );
+        /* publish the entry last, the front end walks the list without the heap lock */
+        subheap->entry.next = heap->subheap_list.next;
+        subheap->entry.prev = &heap->subheap_list;
+        subheap->entry.next->prev = &subheap->entry;
+        interlocked_xchg_ptr( (void **)&heap->subheap_list.next, &subheap->entry );
     }
     else
     {
@@ -1214,7 +1312,8 @@ static BOOL HEAP_ValidateInUseArena( const SUBHEAP *subheap, const ARENA_INUSE *
     }
 
     /* Check magic number */
-    if (pArena->magic != ARENA_INUSE_MAGIC && pArena->magic != ARENA_PENDING_MAGIC)
+    if (pArena->magic != ARENA_INUSE_MAGIC && pArena->magic != ARENA_PENDING_MAGIC &&
+        pArena->magic != ARENA_CACHED_MAGIC)
     {
         if (quiet == NOISY) {
             ERR("Heap %p: invalid in-use arena magic %08x for %p\n", subheap->heap, pArena->magic, pArena );
@@ -1429,7 +1528,7 @@ static BOOL validate_block_pointer( HEAP *heap, SUBHEAP **ret_subheap, const ARE
         ret = HEAP_ValidateInUseArena( subheap, arena, QUIET );
     else if ((ULONG_PTR)arena % ALIGNMENT != ARENA_OFFSET)
         WARN( "Heap %p: unaligned arena pointer %p\n", subheap->heap, arena );
-    else if (arena->magic == ARENA_PENDING_MAGIC)
+    else if (arena->magic == ARENA_PENDING_MAGIC || arena->magic == ARENA_CACHED_MAGIC)
         WARN( "Heap %p: block %p used after free\n", subheap->heap, arena + 1 );
     else if (arena->magic != ARENA_INUSE_MAGIC)
         WARN( "Heap %p: invalid in-use arena magic %08x for %p\n", subheap->heap, arena->magic, arena );
@@ -1447,6 +1546,351 @@ static BOOL validate_block_pointer( HEAP *heap, SUBHEAP **ret_subheap, const ARE
 }
 
 
+/***********************************************************************
+ *           allocate_block
+ *
+ * Allocate an in-use block of the given rounded size. The heap must be locked.
+ */
+static ARENA_INUSE *allocate_block( HEAP *heap, SIZE_T rounded_size )
+{
+    ARENA_FREE *pArena;
+    ARENA_INUSE *pInUse;
+    SUBHEAP *subheap;
+
+    /* Locate a suitable free block */
+
+    if (!(pArena = HEAP_FindFreeBlock( heap, rounded_size, &subheap ))) return NULL;
+
+    /* Remove the arena from the free list */
+
+    list_remove( &pArena->entry );
+
+    /* Build the in-use arena */
+
+    pInUse = (ARENA_INUSE *)pArena;
+
+    /* in-use arena is smaller than free arena,
+     * so we have to add the difference to the size */
+    pInUse->size  = (pInUse->size & ~ARENA_FLAG_FREE) + sizeof(ARENA_FREE) - sizeof(ARENA_INUSE);
+    pInUse->magic = ARENA_INUSE_MAGIC;
+
+    /* Shrink the block */
+
+    HEAP_ShrinkBlock( subheap, pInUse, rounded_size );
+    return pInUse;
+}
+
+
+/***********************************************************************
+ *           lfh_get_magazine
+ *
+ * Get the magazine of the current thread for a given arena size.
+ */
+static inline struct lfh_magazine *lfh_get_magazine( struct lfh *lfh, SIZE_T size )
+{
+    ULONG tid = HandleToULong( NtCurrentTeb()->ClientId.UniqueThread );
+    return &lfh->magazines[size / ALIGNMENT][(tid >> 2) % LFH_NB_MAGAZINES];
+}
+
+/* the lock isn't waited for, the caller falls back to the back end if it is busy */
+static inline BOOL lfh_trylock( struct lfh_magazine *mag )
+{
+    if (!interlocked_cmpxchg( &mag->lock, 1, 0 )) return TRUE;
+    interlocked_xchg_add( &mag->contention, 1 );
+    return FALSE;
+}
+
+static inline void lfh_unlock( struct lfh_magazine *mag )
+{
+    interlocked_xchg( &mag->lock, 0 );
+}
+
+
+/***********************************************************************
+ *           lfh_flush
+ *
+ * Return the oldest blocks of a magazine to the back end, keeping 'keep' of them.
+ * The magazine must be locked.
+ */
+static void lfh_flush( HEAP *heap, struct lfh_magazine *mag, unsigned int keep )
+{
+    unsigned int i, count = mag->count - keep;
+
+    RtlEnterCriticalSection( &heap->critSection );
+    for (i = 0; i < count; i++)
+    {
+        ARENA_INUSE *arena = mag->blocks[i];
+        arena->magic = ARENA_INUSE_MAGIC;
+        HEAP_MakeInUseBlockFree( HEAP_FindSubHeap( heap, arena ), arena );
+    }
+    lfh_release_retired( heap->lfh );
+    RtlLeaveCriticalSection( &heap->critSection );
+
+    memmove( mag->blocks, mag->blocks + count, keep * sizeof(mag->blocks[0]) );
+    mag->count = keep;
+}
+
+
+/***********************************************************************
+ *           lfh_alloc
+ *
+ * Allocate a block of the given rounded size from the front end. The
+ * magazine is refilled with a batch of blocks from the back end when empty.
+ * Returns NULL if the magazine is busy, the back end is used then.
+ */
+static ARENA_INUSE *lfh_alloc( HEAP *heap, SIZE_T rounded_size )
+{
+    struct lfh_magazine *mag = lfh_get_magazine( heap->lfh, rounded_size );
+    ARENA_INUSE *arena;
+
+    if (!lfh_trylock( mag )) return NULL;
+    if (!mag->count)
+    {
+        RtlEnterCriticalSection( &heap->critSection );
+        while (mag->count < LFH_MAGAZINE_SIZE / 2 && (arena = allocate_block( heap, rounded_size )))
+        {
+            arena->magic = ARENA_CACHED_MAGIC;
+            mag->blocks[mag->count++] = arena;
+        }
+        lfh_release_retired( heap->lfh );
+        RtlLeaveCriticalSection( &heap->critSection );
+    }
+    if ((arena = mag->count ? mag->blocks[--mag->count] : NULL))
+    {
+        arena->magic = ARENA_INUSE_MAGIC;
+        mag->allocs++;
+    }
+    lfh_unlock( mag );
+    return arena;
+}
+
+
+/***********************************************************************
+ *           lfh_check_block
+ *
+ * Check that a block is a plausible small in-use block. The sub-heap is
+ * looked up without the heap lock, so it can be unlinked meanwhile but not
+ * released. An in-use block keeps its sub-heap from being retired.
+ */
+static BOOL lfh_check_block( HEAP *heap, const ARENA_INUSE *arena, SIZE_T *size )
+{
+    SUBHEAP *subheap;
+    BOOL ret = FALSE;
+
+    interlocked_xchg_add( &heap->lfh->readers, 1 );
+    if (!(subheap = HEAP_FindSubHeap( heap, arena ))) goto done;
+    if ((const char *)arena < (char *)subheap->base + subheap->headerSize) goto done;
+    if ((ULONG_PTR)arena % ALIGNMENT != ARENA_OFFSET) goto done;
+    if (arena->magic != ARENA_INUSE_MAGIC || (arena->size & ARENA_FLAG_FREE)) goto done;
+    *size = arena->size & ARENA_SIZE_MASK;
+    if (*size / ALIGNMENT >= LFH_NB_CLASSES) goto done;
+    ret = (const char *)(arena + 1) + *size <= (const char *)subheap->base + subheap->size;
+done:
+    interlocked_xchg_add( &heap->lfh->readers, -1 );
+    return ret;
+}
+
+
+/***********************************************************************
+ *           lfh_free
+ *
+ * Cache a freed block in the front end. Returns FALSE if the block isn't a
+ * plausible small in-use block, leaving it to the validation of the back end,
+ * or if the magazine is busy.
+ */
+static BOOL lfh_free( HEAP *heap, ARENA_INUSE *arena )
+{
+    struct lfh_magazine *mag;
+    SIZE_T size;
+
+    if (!lfh_check_block( heap, arena, &size )) return FALSE;
+
+    mag = lfh_get_magazine( heap->lfh, size );
+    if (!lfh_trylock( mag )) return FALSE;
+    if (mag->count == LFH_MAGAZINE_SIZE) lfh_flush( heap, mag, LFH_MAGAZINE_SIZE / 2 );
+    arena->magic = ARENA_CACHED_MAGIC;
+    mag->blocks[mag->count++] = arena;
+    mag->frees++;
+    lfh_unlock( mag );
+    return TRUE;
+}
+
+
+/***********************************************************************
+ *           lfh_enable
+ */
+static NTSTATUS lfh_enable( HEAP *heap )
+{
+    void *ptr = NULL;
+    SIZE_T size = sizeof(struct lfh);
+
+    if (heap->lfh) return STATUS_SUCCESS;
+    if (heap->flags & (HEAP_NO_SERIALIZE | HEAP_SHARED | HEAP_VALIDATE |
+                       HEAP_TAIL_CHECKING_ENABLED | HEAP_FREE_CHECKING_ENABLED |
+                       HEAP_DISABLE_COALESCE_ON_FREE | HEAP_PAGE_ALLOCS))
+        return STATUS_UNSUCCESSFUL;
+    if (RUNNING_ON_VALGRIND) return STATUS_UNSUCCESSFUL;
+
+    if (NtAllocateVirtualMemory( NtCurrentProcess(), &ptr, 0, &size, MEM_COMMIT, PAGE_READWRITE ))
+        return STATUS_NO_MEMORY;
+    if (interlocked_cmpxchg_ptr( (void **)&heap->lfh, ptr, NULL ))
+    {
+        size = 0;
+        NtFreeVirtualMemory( NtCurrentProcess(), &ptr, &size, MEM_RELEASE );
+    }
+    return STATUS_SUCCESS;
+}
+
+
+/***********************************************************************
+ *           lfh_disable
+ *
+ * Return all the cached blocks to the back end. Only used while the heap
+ * isn't shared between threads yet, when debug flags are set on it.
+ */
+static void lfh_disable( HEAP *heap )
+{
+    struct lfh *lfh = heap->lfh;
+    unsigned int i, j;
+    SIZE_T size = 0;
+
+    for (i = 0; i < LFH_NB_CLASSES; i++)
+        for (j = 0; j < LFH_NB_MAGAZINES; j++)
+            if (lfh->magazines[i][j].count) lfh_flush( heap, &lfh->magazines[i][j], 0 );
+    lfh_release_retired( lfh );
+    heap->lfh = NULL;
+    NtFreeVirtualMemory( NtCurrentProcess(), (void **)&lfh, &size, MEM_RELEASE );
+}
+
+
+/***********************************************************************
+ *           heap_get_stats
+ *
+ * Compute the statistics of a heap. They are only a snapshot, blocks of
+ * the front end may be allocated and freed concurrently.
+ */
+static void heap_get_stats( HEAP *heap, HEAP_WINE_STATISTICS *stats )
+{
+    SUBHEAP *subheap;
+    ARENA_LARGE *large;
+    unsigned int i, j;
+
+    memset( stats, 0, sizeof(*stats) );
+
+    if (!(heap->flags & HEAP_NO_SERIALIZE)) RtlEnterCriticalSection( &heap->critSection );
+
+    LIST_FOR_EACH_ENTRY( subheap, &heap->subheap_list, SUBHEAP, entry )
+    {
+        char *ptr = (char *)subheap->base + subheap->headerSize;
+        char *end = (char *)subheap->base + subheap->size;
+
+        stats->ReservedSize += subheap->size;
+        stats->CommittedSize += subheap->commitSize;
+        while (ptr < end)
+        {
+            ARENA_INUSE *arena = (ARENA_INUSE *)ptr;
+            SIZE_T size = arena->size & ARENA_SIZE_MASK;
+
+            if (arena->size & ARENA_FLAG_FREE)
+            {
+                stats->FreeSize += size;
+                stats->FreeBlocks++;
+                ptr += sizeof(ARENA_FREE) + size;
+                continue;
+            }
+            if (arena->magic == ARENA_CACHED_MAGIC) stats->CachedSize += size;
+            else if (arena->magic == ARENA_PENDING_MAGIC) stats->FreeSize += size;
+            else
+            {
+                stats->UsedSize += size;
+                stats->UsedBlocks++;
+            }
+            ptr += sizeof(ARENA_INUSE) + size;
+        }
+    }
+
+    LIST_FOR_EACH_ENTRY( large, &heap->large_list, ARENA_LARGE, entry )
+    {
+        stats->ReservedSize += large->block_size;
+        stats->CommittedSize += large->block_size;
+        stats->LargeSize += large->data_size;
+        stats->LargeBlocks++;
+    }
+    stats->UsedSize += stats->LargeSize;
+    stats->UsedBlocks += stats->LargeBlocks;
+
+    for (i = 0; i < HEAP_STATISTICS_CLASSES; i++)
+    {
+        stats->Allocations[i] = heap->stats.allocs[i];
+        stats->Frees[i] = heap->stats.frees[i];
+    }
+    stats->Reallocations = heap->stats.reallocs;
+    if (heap->critSection.DebugInfo) stats->LockContention = heap->critSection.DebugInfo->ContentionCount;
+
+    if (!(heap->flags & HEAP_NO_SERIALIZE)) RtlLeaveCriticalSection( &heap->critSection );
+
+    /* the magazine counters are read without their locks, they are only statistics */
+    if (heap->lfh)
+    {
+        for (i = 0; i < LFH_NB_CLASSES; i++)
+        {
+            for (j = 0; j < LFH_NB_MAGAZINES; j++)
+            {
+                struct lfh_magazine *mag = &heap->lfh->magazines[i][j];
+
+                stats->Allocations[get_stats_class( i * ALIGNMENT )] += mag->allocs;
+                stats->Frees[get_stats_class( i * ALIGNMENT )] += mag->frees;
+                stats->FrontEndContention += mag->contention;
+            }
+        }
+    }
+}
+
+
+/***********************************************************************
+ *           heap_dump_stats
+ *
+ * Dump the statistics of a heap on the heapstats channel.
+ */
+static void heap_dump_stats( HEAP *heap )
+{
+    HEAP_WINE_STATISTICS stats;
+    unsigned int i;
+
+    heap_get_stats( heap, &stats );
+
+    TRACE_(heapstats)( "heap %p: reserved %lu committed %lu used %lu (%u blocks) cached %lu free %lu (%u blocks)\n",
+                       heap, stats.ReservedSize, stats.CommittedSize, stats.UsedSize, stats.UsedBlocks,
+                       stats.CachedSize, stats.FreeSize, stats.FreeBlocks );
+    TRACE_(heapstats)( "heap %p: large %lu (%u blocks) reallocs %s contention %u front end %u\n",
+                       heap, stats.LargeSize, stats.LargeBlocks, wine_dbgstr_longlong( stats.Reallocations ),
+                       stats.LockContention, stats.FrontEndContention );
+    for (i = 0; i < HEAP_STATISTICS_CLASSES; i++)
+    {
+        if (!stats.Allocations[i] && !stats.Frees[i]) continue;
+        TRACE_(heapstats)( "heap %p: %s%lu bytes: allocs %s frees %s\n", heap,
+                           i < HEAP_STATISTICS_CLASSES - 1 ? "<= " : "> ",
+                           (SIZE_T)16 << (i < HEAP_STATISTICS_CLASSES - 1 ? i : i - 1),
+                           wine_dbgstr_longlong( stats.Allocations[i] ),
+                           wine_dbgstr_longlong( stats.Frees[i] ));
+    }
+}
+
+
+/***********************************************************************
+ *           heap_dump_stats_periodic
+ */
+static void heap_dump_stats_periodic( HEAP *heap )
+{
+    int now = NtGetTickCount(), last = heap->stats.last_dump;
+
+    if (now - last < HEAP_STATS_DUMP_INTERVAL) return;
+    /* only one of the threads noticing it gets to dump */
+    if (interlocked_cmpxchg( &heap->stats.last_dump, now, last ) != last) return;
+    heap_dump_stats( heap );
+}
+
+
 /***********************************************************************
  *           heap_set_debug_flags
  */
@@ -1473,6 +1917,8 @@ void heap_set_debug_flags( HANDLE handle )
 
     if (RUNNING_ON_VALGRIND) flags = 0; /* no sense in validating since Valgrind catches accesses */
 
+    if (heap->lfh && flags) lfh_disable( heap );
+
     heap->flags |= flags;
     heap->force_flags |= flags & ~(HEAP_VALIDATE | HEAP_DISABLE_COALESCE_ON_FREE);
 
@@ -1564,6 +2010,9 @@ HANDLE WINAPI RtlCreateHeap( ULONG flags, PVOID addr, SIZE_T totalSize, SIZE_T c
 
     heap_set_debug_flags( subheap->heap );
 
+    /* the process heap always uses the low fragmentation front end */
+    if (!processHeap && !addr) lfh_enable( subheap->heap );
+
     /* link it into the per-process heap list */
     if (processHeap)
     {
@@ -1607,6 +2056,8 @@ HANDLE WINAPI RtlDestroyHeap( HANDLE heap )
 
     if (heap == processHeap) return heap; /* cannot delete the main process heap */
 
+    if (TRACE_ON(heapstats)) heap_dump_stats( heapPtr );
+
     /* remove it from the per-process list */
     RtlEnterCriticalSection( &processHeap->critSection );
     list_remove( &heapPtr->entry );
@@ -1638,6 +2089,13 @@ HANDLE WINAPI RtlDestroyHeap( HANDLE heap )
         addr = heapPtr->pending_free;
         NtFreeVirtualMemory( NtCurrentProcess(), &addr, &size, MEM_RELEASE );
     }
+    if (heapPtr->lfh)
+    {
+        lfh_release_retired( heapPtr->lfh );
+        size = 0;
+        addr = heapPtr->lfh;
+        NtFreeVirtualMemory( NtCurrentProcess(), &addr, &size, MEM_RELEASE );
+    }
     size = 0;
     addr = heapPtr->subheap.base;
     NtFreeVirtualMemory( NtCurrentProcess(), &addr, &size, MEM_RELEASE );
@@ -1664,9 +2122,7 @@ HANDLE WINAPI RtlDestroyHeap( HANDLE heap )
  */
 PVOID WINAPI RtlAllocateHeap( HANDLE heap, ULONG flags, SIZE_T size )
 {
-    ARENA_FREE *pArena;
     ARENA_INUSE *pInUse;
-    SUBHEAP *subheap;
     HEAP *heapPtr = HEAP_GetPtr( heap );
     SIZE_T rounded_size;
 
@@ -1683,20 +2139,29 @@ PVOID WINAPI RtlAllocateHeap( HANDLE heap, ULONG flags, SIZE_T size )
     }
     if (rounded_size < HEAP_MIN_DATA_SIZE) rounded_size = HEAP_MIN_DATA_SIZE;
 
+    if (heapPtr->lfh && rounded_size / ALIGNMENT < LFH_NB_CLASSES &&
+        (pInUse = lfh_alloc( heapPtr, rounded_size )))
+    {
+        pInUse->unused_bytes = (pInUse->size & ARENA_SIZE_MASK) - size;
+        notify_alloc( pInUse + 1, size, flags & HEAP_ZERO_MEMORY );
+        initialize_block( pInUse + 1, size, pInUse->unused_bytes, flags );
+        TRACE("(%p,%08x,%08lx): returning %p\n", heap, flags, size, pInUse + 1 );
+        return pInUse + 1;
+    }
+
     if (!(flags & HEAP_NO_SERIALIZE)) RtlEnterCriticalSection( &heapPtr->critSection );
 
     if (rounded_size >= HEAP_MIN_LARGE_BLOCK_SIZE && (flags & HEAP_GROWABLE))
     {
         void *ret = allocate_large_block( heap, flags, size );
+        if (ret) heapPtr->stats.allocs[get_stats_class( size )]++;
         if (!(flags & HEAP_NO_SERIALIZE)) RtlLeaveCriticalSection( &heapPtr->critSection );
         if (!ret && (flags & HEAP_GENERATE_EXCEPTIONS)) RtlRaiseStatus( STATUS_NO_MEMORY );
         TRACE("(%p,%08x,%08lx): returning %p\n", heap, flags, size, ret );
         return ret;
     }
 
-    /* Locate a suitable free block */
-
-    if (!(pArena = HEAP_FindFreeBlock( heapPtr, rounded_size, &subheap )))
+    if (!(pInUse = allocate_block( heapPtr, rounded_size )))
     {
         TRACE("(%p,%08x,%08lx): returning NULL\n",
                   heap, flags, size  );
@@ -1705,29 +2170,16 @@ PVOID WINAPI RtlAllocateHeap( HANDLE heap, ULONG flags, SIZE_T size )
         return NULL;
     }
 
-    /* Remove the arena from the free list */
-
-    list_remove( &pArena->entry );
-
-    /* Build the in-use arena */
-
-    pInUse = (ARENA_INUSE *)pArena;
-
-    /* in-use arena is smaller than free arena,
-     * so we have to add the difference to the size */
-    pInUse->size  = (pInUse->size & ~ARENA_FLAG_FREE) + sizeof(ARENA_FREE) - sizeof(ARENA_INUSE);
-    pInUse->magic = ARENA_INUSE_MAGIC;
-
-    /* Shrink the block */
-
-    HEAP_ShrinkBlock( subheap, pInUse, rounded_size );
     pInUse->unused_bytes = (pInUse->size & ARENA_SIZE_MASK) - size;
+    heapPtr->stats.allocs[get_stats_class( pInUse->size & ARENA_SIZE_MASK )]++;
 
     notify_alloc( pInUse + 1, size, flags & HEAP_ZERO_MEMORY );
     initialize_block( pInUse + 1, size, pInUse->unused_bytes, flags );
 
     if (!(flags & HEAP_NO_SERIALIZE)) RtlLeaveCriticalSection( &heapPtr->critSection );
 
+    if (TRACE_ON(heapstats)) heap_dump_stats_periodic( heapPtr );
+
     TRACE("(%p,%08x,%08lx): returning %p\n", heap, flags, size, pInUse + 1 );
     return pInUse + 1;
 }
@@ -1766,19 +2218,32 @@ BOOLEAN WINAPI RtlFreeHeap( HANDLE heap, ULONG flags, PVOID ptr )
 
     flags &= HEAP_NO_SERIALIZE;
     flags |= heapPtr->flags;
+    pInUse  = (ARENA_INUSE *)ptr - 1;
+
+    if (heapPtr->lfh && lfh_free( heapPtr, pInUse ))
+    {
+        TRACE("(%p,%08x,%p): returning TRUE\n", heap, flags, ptr );
+        return TRUE;
+    }
+
     if (!(flags & HEAP_NO_SERIALIZE)) RtlEnterCriticalSection( &heapPtr->critSection );
 
     /* Inform valgrind we are trying to free memory, so it can throw up an error message */
     notify_free( ptr );
 
     /* Some sanity checks */
-    pInUse  = (ARENA_INUSE *)ptr - 1;
     if (!validate_block_pointer( heapPtr, &subheap, pInUse )) goto error;
 
     if (!subheap)
+    {
+        heapPtr->stats.frees[get_stats_class( ((ARENA_LARGE *)ptr - 1)->data_size )]++;
         free_large_block( heapPtr, flags, ptr );
+    }
     else
+    {
+        heapPtr->stats.frees[get_stats_class( pInUse->size & ARENA_SIZE_MASK )]++;
         HEAP_MakeInUseBlockFree( subheap, pInUse );
+    }
 
     if (!(flags & HEAP_NO_SERIALIZE)) RtlLeaveCriticalSection( &heapPtr->critSection );
     TRACE("(%p,%08x,%p): returning TRUE\n", heap, flags, ptr );
@@ -1835,6 +2300,7 @@ PVOID WINAPI RtlReAllocateHeap( HANDLE heap, ULONG flags, PVOID ptr, SIZE_T size
 
     pArena = (ARENA_INUSE *)ptr - 1;
     if (!validate_block_pointer( heapPtr, &subheap, pArena )) goto error;
+    heapPtr->stats.reallocs++;
     if (!subheap)
     {
         if (!(ret = realloc_large_block( heapPtr, flags, ptr, size ))) goto oom;
@@ -2133,7 +2599,8 @@ NTSTATUS WINAPI RtlWalkHeap( HANDLE heap, PVOID entry_ptr )
         }
 
         if (((ARENA_INUSE *)ptr - 1)->magic == ARENA_INUSE_MAGIC ||
-            ((ARENA_INUSE *)ptr - 1)->magic == ARENA_PENDING_MAGIC)
+            ((ARENA_INUSE *)ptr - 1)->magic == ARENA_PENDING_MAGIC ||
+            ((ARENA_INUSE *)ptr - 1)->magic == ARENA_CACHED_MAGIC)
         {
             ARENA_INUSE *pArena = (ARENA_INUSE *)ptr - 1;
             ptr += pArena->size & ARENA_SIZE_MASK;
@@ -2181,7 +2648,7 @@ NTSTATUS WINAPI RtlWalkHeap( HANDLE heap, PVOID entry_ptr )
         entry->lpData = pArena + 1;
         entry->cbData = pArena->size & ARENA_SIZE_MASK;
         entry->cbOverhead = sizeof(ARENA_INUSE);
-        entry->wFlags = (pArena->magic == ARENA_PENDING_MAGIC) ?
+        entry->wFlags = (pArena->magic == ARENA_PENDING_MAGIC || pArena->magic == ARENA_CACHED_MAGIC) ?
                         PROCESS_HEAP_UNCOMMITTED_RANGE : PROCESS_HEAP_ENTRY_BUSY;
         /* FIXME: can't handle PROCESS_HEAP_ENTRY_MOVEABLE
         and PROCESS_HEAP_ENTRY_DDESHARE yet */
@@ -2246,7 +2713,9 @@ ULONG WINAPI RtlGetProcessHeaps( ULONG count, HANDLE *heaps )
 NTSTATUS WINAPI RtlQueryHeapInformation( HANDLE heap, HEAP_INFORMATION_CLASS info_class,
                                          PVOID info, SIZE_T size_in, PSIZE_T size_out)
 {
-    switch (info_class)
+    HEAP *heap_ptr;
+
+    switch ((ULONG)info_class)  /* HeapWineStatistics isn't part of the enum */
     {
     case HeapCompatibilityInformation:
         if (size_out) *size_out = sizeof(ULONG);
@@ -2254,7 +2723,20 @@ NTSTATUS WINAPI RtlQueryHeapInformation( HANDLE heap, HEAP_INFORMATION_CLASS inf
         if (size_in < sizeof(ULONG))
             return STATUS_BUFFER_TOO_SMALL;
 
-        *(ULONG *)info = 0; /* standard heap */
+        if (!(heap_ptr = HEAP_GetPtr( heap ))) return STATUS_INVALID_HANDLE;
+
+        *(ULONG *)info = heap_ptr->lfh ? 2 /* low fragmentation heap */ : 0 /* standard heap */;
+        return STATUS_SUCCESS;
+
+    case HeapWineStatistics:
+        if (size_out) *size_out = sizeof(HEAP_WINE_STATISTICS);
+
+        if (size_in < sizeof(HEAP_WINE_STATISTICS))
+            return STATUS_BUFFER_TOO_SMALL;
+
+        if (!(heap_ptr = HEAP_GetPtr( heap ))) return STATUS_INVALID_HANDLE;
+
+        heap_get_stats( heap_ptr, info );
         return STATUS_SUCCESS;
 
     default:
@@ -2268,6 +2750,27 @@ NTSTATUS WINAPI RtlQueryHeapInformation( HANDLE heap, HEAP_INFORMATION_CLASS inf
  */
 NTSTATUS WINAPI RtlSetHeapInformation( HANDLE heap, HEAP_INFORMATION_CLASS info_class, PVOID info, SIZE_T size)
 {
-    FIXME("%p %d %p %ld stub\n", heap, info_class, info, size);
-    return STATUS_SUCCESS;
+    HEAP *heap_ptr;
+
+    switch (info_class)
+    {
+    case HeapCompatibilityInformation:
+        if (size < sizeof(ULONG)) return STATUS_BUFFER_TOO_SMALL;
+        if (!(heap_ptr = HEAP_GetPtr( heap ))) return STATUS_INVALID_HANDLE;
+
+        switch (*(ULONG *)info)
+        {
+        case 0:  /* standard heap */
+            return heap_ptr->lfh ? STATUS_UNSUCCESSFUL : STATUS_SUCCESS;
+        case 2:  /* low fragmentation heap */
+            return lfh_enable( heap_ptr );
+        default:
+            FIXME("%p: unsupported compatibility mode %u\n", heap, *(ULONG *)info);
+            return STATUS_UNSUCCESSFUL;
+        }
+
+    default:
+        FIXME("%p %d %p %ld stub\n", heap, info_class, info, size);
+        return STATUS_SUCCESS;
+    }
 }
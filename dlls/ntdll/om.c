@@ -370,6 +370,8 @@ NTSTATUS WINAPI NtDuplicateObject( HANDLE source_process, HANDLE source,
             {
                 int fd = server_remove_fd_from_cache( source );
                 if (fd != -1) close( fd );
+                fast_sync_remove_from_cache( source );
+                reg_cache_remove_handle( source );
             }
         }
     }
@@ -383,6 +385,8 @@ NTSTATUS close_handle( HANDLE handle )
     NTSTATUS ret;
     int fd = server_remove_fd_from_cache( handle );
 
+    fast_sync_remove_from_cache( handle );
+    reg_cache_remove_handle( handle );
     SERVER_START_REQ( close_handle )
     {
         req->handle = wine_server_obj_handle( handle );
@@ -31,13 +31,22 @@
 
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#ifdef HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+#endif
+#ifdef HAVE_UNISTD_H
+# include <unistd.h>
+#endif
 
 #include "ntstatus.h"
 #define WIN32_NO_STATUS
 #include "wine/library.h"
 #include "ntdll_misc.h"
 #include "wine/debug.h"
+#include "wine/exception.h"
+#include "wine/list.h"
 #include "wine/unicode.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(reg);
@@ -523,6 +532,185 @@ NTSTATUS WINAPI NtEnumerateValueKey( HANDLE handle, ULONG index,
 }
 
 
+/* Cache of the values read through NtQueryValueKey, by key handle and value name.
+ * The server publishes a change sequence number for each key in shared memory,
+ * an entry is only used as long as the sequence number of its key didn't change. */
+
+#define REG_CACHE_BUCKETS     256
+#define REG_CACHE_MAX_ENTRIES 4096
+#define REG_CACHE_MAX_DATA    4096
+
+struct reg_cache_entry
+{
+    struct list   entry;      /* entry in the hash bucket */
+    struct list   lru_entry;  /* entry in the LRU list, most recently used first */
+    HANDLE        handle;     /* key handle */
+    int           seq_index;  /* index of the key sequence number */
+    unsigned int  seq;        /* key sequence number at the time the value was read */
+    NTSTATUS      status;     /* STATUS_SUCCESS or STATUS_OBJECT_NAME_NOT_FOUND */
+    ULONG         type;       /* value type */
+    DWORD         total;      /* data length */
+    USHORT        namelen;    /* value name length in bytes */
+    WCHAR         name[1];    /* value name, followed by the data */
+};
+
+static struct list reg_cache[REG_CACHE_BUCKETS];
+static struct list reg_cache_lru = LIST_INIT( reg_cache_lru );
+static unsigned int reg_cache_count;
+static const unsigned int *key_seq_region;
+static int reg_cache_state;  /* 0: not initialized, 1: enabled, -1: disabled */
+
+static RTL_CRITICAL_SECTION reg_cache_section;
+static RTL_CRITICAL_SECTION_DEBUG reg_cache_section_debug =
+{
+    0, 0, &reg_cache_section,
+    { &reg_cache_section_debug.ProcessLocksList, &reg_cache_section_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": reg_cache_section") }
+};
+static RTL_CRITICAL_SECTION reg_cache_section = { &reg_cache_section_debug, -1, 0, 0, 0, 0 };
+
+/* caller must hold reg_cache_section */
+static BOOL init_reg_cache(void)
+{
+    unsigned int i, size;
+    const char *env;
+    void *ptr;
+    int fd;
+
+    if (reg_cache_state) return reg_cache_state > 0;
+    reg_cache_state = -1;
+
+    if ((env = getenv( "WINEREGCACHE" )) && !atoi( env )) return FALSE;
+    if ((fd = server_get_key_seq_fd( &size )) == -1) return FALSE;
+    ptr = mmap( NULL, size, PROT_READ, MAP_SHARED, fd, 0 );
+    close( fd );
+    if (ptr == MAP_FAILED) return FALSE;
+
+    key_seq_region = ptr;
+    for (i = 0; i < REG_CACHE_BUCKETS; i++) list_init( &reg_cache[i] );
+    reg_cache_state = 1;
+    return TRUE;
+}
+
+static inline struct list *get_reg_cache_bucket( HANDLE handle )
+{
+    return &reg_cache[((ULONG_PTR)handle >> 2) % REG_CACHE_BUCKETS];
+}
+
+static void free_reg_cache_entry( struct reg_cache_entry *entry )
+{
+    list_remove( &entry->entry );
+    list_remove( &entry->lru_entry );
+    reg_cache_count--;
+    RtlFreeHeap( GetProcessHeap(), 0, entry );
+}
+
+/* caller must hold reg_cache_section */
+static struct reg_cache_entry *find_reg_cache_entry( HANDLE handle, const UNICODE_STRING *name )
+{
+    struct reg_cache_entry *entry;
+
+    LIST_FOR_EACH_ENTRY( entry, get_reg_cache_bucket( handle ), struct reg_cache_entry, entry )
+    {
+        if (entry->handle != handle || entry->namelen != name->Length) continue;
+        if (memicmpW( entry->name, name->Buffer, name->Length / sizeof(WCHAR) )) continue;
+        if (*(volatile const unsigned int *)&key_seq_region[entry->seq_index] != entry->seq)
+        {
+            free_reg_cache_entry( entry );
+            return NULL;
+        }
+        return entry;
+    }
+    return NULL;
+}
+
+/* look up a value in the cache, copying as much data as fits in the buffer */
+static BOOL get_cached_value( HANDLE handle, const UNICODE_STRING *name, void *data, DWORD len,
+                              ULONG *type, DWORD *total, NTSTATUS *status )
+{
+    struct reg_cache_entry *entry;
+    BOOL ret = FALSE;
+
+    if (reg_cache_state < 0) return FALSE;
+
+    RtlEnterCriticalSection( &reg_cache_section );
+    if (init_reg_cache() && (entry = find_reg_cache_entry( handle, name )))
+    {
+        list_remove( &entry->lru_entry );
+        list_add_head( &reg_cache_lru, &entry->lru_entry );
+        *type   = entry->type;
+        *total  = entry->total;
+        *status = entry->status;
+        if (data && len)
+        {
+            __TRY
+            {
+                memcpy( data, (char *)entry->name + entry->namelen, min( len, entry->total ));
+            }
+            __EXCEPT_PAGE_FAULT
+            {
+                *status = STATUS_ACCESS_VIOLATION;
+            }
+            __ENDTRY
+        }
+        ret = TRUE;
+    }
+    RtlLeaveCriticalSection( &reg_cache_section );
+    return ret;
+}
+
+/* add a value that was just read from the server to the cache */
+static void cache_value( HANDLE handle, const UNICODE_STRING *name, int seq_index, unsigned int seq,
+                         NTSTATUS status, ULONG type, const void *data, DWORD total )
+{
+    struct reg_cache_entry *entry;
+
+    if (reg_cache_state < 0 || seq_index == -1 || total > REG_CACHE_MAX_DATA) return;
+
+    RtlEnterCriticalSection( &reg_cache_section );
+    if (!init_reg_cache()) goto done;
+
+    if ((entry = find_reg_cache_entry( handle, name ))) free_reg_cache_entry( entry );
+    if (reg_cache_count >= REG_CACHE_MAX_ENTRIES)
+        free_reg_cache_entry( LIST_ENTRY( list_tail( &reg_cache_lru ), struct reg_cache_entry, lru_entry ));
+
+    if (!(entry = RtlAllocateHeap( GetProcessHeap(), 0,
+                                   FIELD_OFFSET( struct reg_cache_entry, name ) + name->Length + total )))
+        goto done;
+    entry->handle    = handle;
+    entry->seq_index = seq_index;
+    entry->seq       = seq;
+    entry->status    = status;
+    entry->type      = type;
+    entry->total     = total;
+    entry->namelen   = name->Length;
+    memcpy( entry->name, name->Buffer, name->Length );
+    if (total) memcpy( (char *)entry->name + name->Length, data, total );
+    list_add_head( get_reg_cache_bucket( handle ), &entry->entry );
+    list_add_head( &reg_cache_lru, &entry->lru_entry );
+    reg_cache_count++;
+
+done:
+    RtlLeaveCriticalSection( &reg_cache_section );
+}
+
+/***********************************************************************
+ *           reg_cache_remove_handle
+ *
+ * Drop the cached values of a key handle that is being closed.
+ */
+void reg_cache_remove_handle( HANDLE handle )
+{
+    struct reg_cache_entry *entry, *next;
+
+    if (reg_cache_state <= 0) return;
+
+    RtlEnterCriticalSection( &reg_cache_section );
+    LIST_FOR_EACH_ENTRY_SAFE( entry, next, get_reg_cache_bucket( handle ), struct reg_cache_entry, entry )
+        if (entry->handle == handle) free_reg_cache_entry( entry );
+    RtlLeaveCriticalSection( &reg_cache_section );
+}
+
 /******************************************************************************
  * NtQueryValueKey [NTDLL.@]
  * ZwQueryValueKey [NTDLL.@]
@@ -537,6 +725,8 @@ NTSTATUS WINAPI NtQueryValueKey( HANDLE handle, const UNICODE_STRING *name,
     NTSTATUS ret;
     UCHAR *data_ptr;
     unsigned int fixed_size, min_size;
+    ULONG type;
+    DWORD total;
 
     TRACE( "(%p,%s,%d,%p,%d)\n", handle, debugstr_us(name), info_class, info, length );
 
@@ -574,6 +764,19 @@ NTSTATUS WINAPI NtQueryValueKey( HANDLE handle, const UNICODE_STRING *name,
         return STATUS_INVALID_PARAMETER;
     }
 
+    if (get_cached_value( handle, name, data_ptr, length > fixed_size ? length - fixed_size : 0,
+                          &type, &total, &ret ))
+    {
+        if (!ret)
+        {
+            copy_key_value_info( info_class, info, length, type, name->Length, total );
+            *result_len = fixed_size + (info_class == KeyValueBasicInformation ? 0 : total);
+            if (length < min_size) ret = STATUS_BUFFER_TOO_SMALL;
+            else if (length < *result_len) ret = STATUS_BUFFER_OVERFLOW;
+        }
+        return ret;
+    }
+
     SERVER_START_REQ( get_key_value )
     {
         req->hkey = wine_server_obj_handle( handle );
@@ -581,12 +784,18 @@ NTSTATUS WINAPI NtQueryValueKey( HANDLE handle, const UNICODE_STRING *name,
         if (length > fixed_size && data_ptr) wine_server_set_reply( req, data_ptr, length - fixed_size );
         if (!(ret = wine_server_call( req )))
         {
+            /* only cache values that we got completely */
+            if (data_ptr && wine_server_reply_size( reply ) == reply->total)
+                cache_value( handle, name, reply->seq_index, reply->seq, ret,
+                             reply->type, data_ptr, reply->total );
             copy_key_value_info( info_class, info, length, reply->type,
                                  name->Length, reply->total );
             *result_len = fixed_size + (info_class == KeyValueBasicInformation ? 0 : reply->total);
             if (length < min_size) ret = STATUS_BUFFER_TOO_SMALL;
             else if (length < *result_len) ret = STATUS_BUFFER_OVERFLOW;
         }
+        else if (ret == STATUS_OBJECT_NAME_NOT_FOUND)
+            cache_value( handle, name, reply->seq_index, reply->seq, ret, 0, NULL, 0 );
     }
     SERVER_END_REQ;
     return ret;
@@ -920,6 +920,58 @@ int server_remove_fd_from_cache( HANDLE handle )
 }
 
 
+/***********************************************************************
+ *           server_get_fast_sync_fd
+ *
+ * Get the fd of the shared region of fast synchronization objects, to be closed by the caller.
+ */
+int server_get_fast_sync_fd( unsigned int *size )
+{
+    sigset_t sigset;
+    obj_handle_t handle;
+    int fd = -1;
+
+    server_enter_uninterrupted_section( &fd_cache_section, &sigset );
+    SERVER_START_REQ( get_fast_sync_region )
+    {
+        if (!wine_server_call( req ))
+        {
+            *size = reply->size;
+            fd = receive_fd( &handle );
+        }
+    }
+    SERVER_END_REQ;
+    server_leave_uninterrupted_section( &fd_cache_section, &sigset );
+    return fd;
+}
+
+
+/***********************************************************************
+ *           server_get_key_seq_fd
+ *
+ * Get the fd of the shared region of registry key sequence numbers, to be closed by the caller.
+ */
+int server_get_key_seq_fd( unsigned int *size )
+{
+    sigset_t sigset;
+    obj_handle_t handle;
+    int fd = -1;
+
+    server_enter_uninterrupted_section( &fd_cache_section, &sigset );
+    SERVER_START_REQ( get_key_seq_region )
+    {
+        if (!wine_server_call( req ))
+        {
+            *size = reply->size;
+            fd = receive_fd( &handle );
+        }
+    }
+    SERVER_END_REQ;
+    server_leave_uninterrupted_section( &fd_cache_section, &sigset );
+    return fd;
+}
+
+
 /***********************************************************************
  *           server_get_unix_fd
  *
@@ -42,6 +42,13 @@
 #ifdef HAVE_SCHED_H
 # include <sched.h>
 #endif
+#ifdef HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+#endif
+#ifdef HAVE_SYS_SYSCALL_H
+# include <sys/syscall.h>
+#endif
+#include <limits.h>
 #include <string.h>
 #include <stdarg.h>
 #include <stdio.h>
@@ -55,6 +62,8 @@
 #include "winternl.h"
 #include "wine/server.h"
 #include "wine/debug.h"
+#include "wine/library.h"
+#include "wine/list.h"
 #include "ntdll_misc.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(ntdll);
@@ -166,6 +175,438 @@ NTSTATUS validate_open_object_attributes( const OBJECT_ATTRIBUTES *attr )
     return STATUS_SUCCESS;
 }
 
+/*
+ *	Fast synchronization objects
+ *
+ * With WINEFASTSYNC set, the server keeps the state of events and semaphores
+ * in a shared region of futex words. Unless the FAST_SYNC_SERVER bit is set,
+ * which means that threads are waiting on the object in the server, we can
+ * update and wait on these words directly without a server round trip.
+ * Everything else (pulsing, wait-all, alertable waits, mutexes) still goes
+ * through the server.
+ */
+
+#if defined(__linux__) && defined(HAVE_SYS_MMAN_H) && defined(__NR_futex)
+#define USE_FAST_SYNC
+
+#ifndef __NR_futex_waitv
+#define __NR_futex_waitv 449
+#endif
+
+#define FAST_SYNC_ACCESS_QUERY   1
+#define FAST_SYNC_ACCESS_MODIFY  2
+#define FAST_SYNC_ACCESS_WAIT    4
+
+union fast_sync_cache_entry
+{
+    LONG64 data;
+    struct
+    {
+        unsigned int index : 24;  /* index of the word in the shared region */
+        unsigned int type : 3;    /* enum fast_sync_type + 1, 0 if not cached */
+        unsigned int access : 3;  /* FAST_SYNC_ACCESS_* flags */
+        unsigned int max;         /* maximum count for semaphores */
+    } s;
+};
+
+C_ASSERT( sizeof(union fast_sync_cache_entry) == sizeof(LONG64) );
+
+#define FAST_SYNC_CACHE_BLOCK_SIZE  (65536 / sizeof(union fast_sync_cache_entry))
+#define FAST_SYNC_CACHE_ENTRIES     128
+
+static union fast_sync_cache_entry *fast_sync_cache[FAST_SYNC_CACHE_ENTRIES];
+static int *fast_sync_region;
+static int fast_sync_enabled = -1;
+static int futex_waitv_supported = 1;
+
+struct futex_waitv
+{
+    ULONG64      val;
+    ULONG64      uaddr;
+    unsigned int flags;
+    unsigned int __reserved;
+};
+
+/* futex_waitv always takes a 64-bit timespec */
+struct futex_timespec64
+{
+    LONGLONG tv_sec;
+    LONGLONG tv_nsec;
+};
+
+static inline int shared_futex_waitv( struct futex_waitv *waiters, unsigned int count,
+                                      const struct futex_timespec64 *end )
+{
+    return syscall( __NR_futex_waitv, waiters, count, 0, end, CLOCK_MONOTONIC );
+}
+
+static BOOL init_fast_sync(void)
+{
+    const char *env;
+    unsigned int size;
+    void *ptr;
+    int fd;
+
+    if (fast_sync_enabled != -1) return fast_sync_enabled;
+
+    /* no locking here, a critical section could end up waiting on a semaphore itself */
+    if (!(env = getenv( "WINEFASTSYNC" )) || !atoi( env ) ||
+        (fd = server_get_fast_sync_fd( &size )) == -1)
+    {
+        fast_sync_enabled = 0;
+        return FALSE;
+    }
+    ptr = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+    close( fd );
+    if (ptr == MAP_FAILED)
+    {
+        fast_sync_enabled = 0;
+        return FALSE;
+    }
+    if (interlocked_cmpxchg_ptr( (void **)&fast_sync_region, ptr, NULL )) munmap( ptr, size );
+    else TRACE( "using fast synchronization objects\n" );
+    fast_sync_enabled = 1;
+    return TRUE;
+}
+
+static inline unsigned int fast_sync_handle_to_index( HANDLE handle, unsigned int *entry )
+{
+    unsigned int idx = (wine_server_obj_handle(handle) >> 2) - 1;
+    *entry = idx / FAST_SYNC_CACHE_BLOCK_SIZE;
+    return idx % FAST_SYNC_CACHE_BLOCK_SIZE;
+}
+
+static inline unsigned int fast_sync_map_access( enum fast_sync_type type, unsigned int access )
+{
+    unsigned int ret = 0;
+
+    if (type == FAST_SYNC_SEMAPHORE)
+    {
+        if (access & SEMAPHORE_QUERY_STATE) ret |= FAST_SYNC_ACCESS_QUERY;
+        if (access & SEMAPHORE_MODIFY_STATE) ret |= FAST_SYNC_ACCESS_MODIFY;
+    }
+    else
+    {
+        if (access & EVENT_QUERY_STATE) ret |= FAST_SYNC_ACCESS_QUERY;
+        if (access & EVENT_MODIFY_STATE) ret |= FAST_SYNC_ACCESS_MODIFY;
+    }
+    if (access & SYNCHRONIZE) ret |= FAST_SYNC_ACCESS_WAIT;
+    return ret;
+}
+
+/* get the cache entry of a handle, allocating its cache block if needed */
+static union fast_sync_cache_entry *get_fast_sync_cache_entry( HANDLE handle )
+{
+    unsigned int entry, idx = fast_sync_handle_to_index( handle, &entry );
+
+    if (entry >= FAST_SYNC_CACHE_ENTRIES) return NULL;
+
+    if (!fast_sync_cache[entry])
+    {
+        void *ptr = wine_anon_mmap( NULL, FAST_SYNC_CACHE_BLOCK_SIZE * sizeof(union fast_sync_cache_entry),
+                                    PROT_READ | PROT_WRITE, 0 );
+        if (ptr == MAP_FAILED) return NULL;
+        if (interlocked_cmpxchg_ptr( (void **)&fast_sync_cache[entry], ptr, NULL ))
+            munmap( ptr, FAST_SYNC_CACHE_BLOCK_SIZE * sizeof(union fast_sync_cache_entry) );
+    }
+    return &fast_sync_cache[entry][idx];
+}
+
+/***********************************************************************
+ *           fast_sync_add_to_cache
+ *
+ * Cache the state returned by the server along with a new handle.
+ */
+static void fast_sync_add_to_cache( HANDLE handle, enum fast_sync_type type, unsigned int index,
+                                    unsigned int max, unsigned int access )
+{
+    union fast_sync_cache_entry *entry, cache;
+
+    if (!init_fast_sync() || !(entry = get_fast_sync_cache_entry( handle ))) return;
+
+    cache.data     = 0;
+    cache.s.index  = index;
+    cache.s.type   = type + 1;
+    cache.s.access = fast_sync_map_access( type, access );
+    cache.s.max    = max;
+    interlocked_cmpxchg64( &entry->data, cache.data, 0 );
+}
+
+/* get the shared state of an object, with the handle access that allows to use it */
+static int *get_fast_sync( HANDLE handle, unsigned int access, union fast_sync_cache_entry *cache )
+{
+    union fast_sync_cache_entry *entry;
+    NTSTATUS ret;
+
+    if (!init_fast_sync() || !(entry = get_fast_sync_cache_entry( handle ))) return NULL;
+
+    if (!(cache->data = interlocked_cmpxchg64( &entry->data, 0, 0 )))
+    {
+        SERVER_START_REQ( get_fast_sync )
+        {
+            req->handle = wine_server_obj_handle( handle );
+            if (!(ret = wine_server_call( req )))
+            {
+                cache->s.index  = reply->index;
+                cache->s.type   = reply->type + 1;
+                cache->s.access = fast_sync_map_access( reply->type, reply->access );
+                cache->s.max    = reply->max;
+            }
+        }
+        SERVER_END_REQ;
+        if (ret) return NULL;  /* let the server report the error */
+        interlocked_cmpxchg64( &entry->data, cache->data, 0 );
+    }
+
+    if (cache->s.type == FAST_SYNC_NONE + 1) return NULL;
+    if ((cache->s.access & access) != access) return NULL;
+    return &fast_sync_region[cache->s.index];
+}
+
+/***********************************************************************
+ *           fast_sync_remove_from_cache
+ */
+void fast_sync_remove_from_cache( HANDLE handle )
+{
+    unsigned int entry, idx = fast_sync_handle_to_index( handle, &entry );
+
+    union fast_sync_cache_entry cache;
+
+    if (entry >= FAST_SYNC_CACHE_ENTRIES || !fast_sync_cache[entry]) return;
+    do cache.data = fast_sync_cache[entry][idx].data;
+    while (interlocked_cmpxchg64( &fast_sync_cache[entry][idx].data, 0, cache.data ) != cache.data);
+}
+
+/* try to acquire the object, returns -1 if the server owns it */
+/* 'val' holds the state seen last, events pulsed since then count as signaled */
+static inline int fast_sync_try_acquire( int *word, enum fast_sync_type type, int *val )
+{
+    int cur, new;
+
+    for (;;)
+    {
+        cur = *(volatile int *)word;
+        if (cur & FAST_SYNC_SERVER) return -1;
+        if (type == FAST_SYNC_SEMAPHORE)
+        {
+            *val = cur;
+            if (!cur) return 0;
+            new = cur - 1;
+        }
+        else if (cur & FAST_SYNC_EVENT_SIGNALED)
+        {
+            if (type == FAST_SYNC_MANUAL_EVENT) return 1;
+            new = cur & ~FAST_SYNC_EVENT_SIGNALED;
+        }
+        else if ((cur & FAST_SYNC_EVENT_PULSES) != (*val & FAST_SYNC_EVENT_PULSES))
+        {
+            /* a pulse releases all waiters of manual-reset events, but only one of auto-reset ones */
+            if (type == FAST_SYNC_MANUAL_EVENT) return 1;
+            if (cur & FAST_SYNC_EVENT_CLAIMED)
+            {
+                *val = cur;
+                return 0;
+            }
+            new = cur | FAST_SYNC_EVENT_CLAIMED;
+        }
+        else
+        {
+            *val = cur;
+            return 0;
+        }
+        if (interlocked_cmpxchg( word, new, cur ) == cur) return 1;
+    }
+}
+
+static NTSTATUS fast_set_event( HANDLE handle, int state, LONG *prev )
+{
+    union fast_sync_cache_entry cache;
+    int *word, cur;
+
+    if (!(word = get_fast_sync( handle, FAST_SYNC_ACCESS_MODIFY, &cache ))) return STATUS_NOT_IMPLEMENTED;
+    if (cache.s.type == FAST_SYNC_SEMAPHORE + 1) return STATUS_NOT_IMPLEMENTED;
+
+    /* the other bits count pulses, which are done by the server */
+    do
+    {
+        cur = *(volatile int *)word;
+        if (cur & FAST_SYNC_SERVER) return STATUS_NOT_IMPLEMENTED;
+    } while (interlocked_cmpxchg( word, state ? cur | FAST_SYNC_EVENT_SIGNALED : cur & ~FAST_SYNC_EVENT_SIGNALED,
+                                  cur ) != cur);
+
+    cur &= FAST_SYNC_EVENT_SIGNALED;
+    if (state && !cur)
+        shared_futex_wake( word, cache.s.type == FAST_SYNC_MANUAL_EVENT + 1 ? INT_MAX : 1 );
+    if (prev) *prev = cur;
+    return STATUS_SUCCESS;
+}
+
+static NTSTATUS fast_release_semaphore( HANDLE handle, ULONG count, ULONG *prev )
+{
+    union fast_sync_cache_entry cache;
+    unsigned int cur;
+    int *word;
+
+    if (!(word = get_fast_sync( handle, FAST_SYNC_ACCESS_MODIFY, &cache ))) return STATUS_NOT_IMPLEMENTED;
+    if (cache.s.type != FAST_SYNC_SEMAPHORE + 1) return STATUS_NOT_IMPLEMENTED;
+
+    do
+    {
+        cur = *(volatile int *)word;
+        if (cur & FAST_SYNC_SERVER) return STATUS_NOT_IMPLEMENTED;
+        if (cur + count < cur || cur + count > cache.s.max) return STATUS_SEMAPHORE_LIMIT_EXCEEDED;
+    } while (interlocked_cmpxchg( word, cur + count, cur ) != cur);
+
+    if (!cur) shared_futex_wake( word, count );
+    if (prev) *prev = cur;
+    return STATUS_SUCCESS;
+}
+
+static NTSTATUS fast_query( HANDLE handle, enum fast_sync_type *type, unsigned int *state,
+                            unsigned int *max )
+{
+    union fast_sync_cache_entry cache;
+    int *word;
+
+    if (!(word = get_fast_sync( handle, FAST_SYNC_ACCESS_QUERY, &cache ))) return STATUS_NOT_IMPLEMENTED;
+    *type = cache.s.type - 1;
+    *state = *(volatile int *)word & FAST_SYNC_STATE_MASK;
+    if (*type != FAST_SYNC_SEMAPHORE) *state &= FAST_SYNC_EVENT_SIGNALED;
+    *max = cache.s.max;
+    return STATUS_SUCCESS;
+}
+
+static NTSTATUS fast_wait( DWORD count, const HANDLE *handles, BOOLEAN wait_any, BOOLEAN alertable,
+                           const LARGE_INTEGER *timeout, LARGE_INTEGER *deadline )
+{
+    union fast_sync_cache_entry cache[MAXIMUM_WAIT_OBJECTS];
+    struct futex_waitv waiters[MAXIMUM_WAIT_OBJECTS];
+    int *words[MAXIMUM_WAIT_OBJECTS];
+    struct futex_timespec64 end;
+    struct timespec now, rel;
+    ULONGLONG diff = 0;
+    int vals[MAXIMUM_WAIT_OBJECTS];
+    DWORD i;
+
+    /* waiting for all of them would need to acquire them atomically */
+    if (alertable || (!wait_any && count > 1)) return STATUS_NOT_IMPLEMENTED;
+    if (count > 1 && !futex_waitv_supported) return STATUS_NOT_IMPLEMENTED;
+
+    for (i = 0; i < count; i++)
+    {
+        if (!(words[i] = get_fast_sync( handles[i], FAST_SYNC_ACCESS_WAIT, &cache[i] )))
+            return STATUS_NOT_IMPLEMENTED;
+        /* pulses from here on satisfy the wait */
+        vals[i] = *(volatile int *)words[i];
+    }
+
+    if (timeout)
+    {
+        LARGE_INTEGER time;
+
+        NtQuerySystemTime( &time );
+        if (timeout->QuadPart > 0)
+        {
+            if (timeout->QuadPart > time.QuadPart) diff = timeout->QuadPart - time.QuadPart;
+        }
+        else
+        {
+            diff = -timeout->QuadPart;
+            /* the server must not restart a relative timeout if we give up on the way */
+            deadline->QuadPart = time.QuadPart + diff;
+        }
+        clock_gettime( CLOCK_MONOTONIC, &now );
+        end.tv_sec  = now.tv_sec + diff / 10000000;
+        end.tv_nsec = now.tv_nsec + (diff % 10000000) * 100;
+        if (end.tv_nsec >= 1000000000)
+        {
+            end.tv_sec++;
+            end.tv_nsec -= 1000000000;
+        }
+    }
+
+    for (;;)
+    {
+        for (i = 0; i < count; i++)
+        {
+            switch (fast_sync_try_acquire( words[i], cache[i].s.type - 1, &vals[i] ))
+            {
+            case 1: return STATUS_WAIT_0 + i;
+            case -1: return STATUS_NOT_IMPLEMENTED;
+            }
+            waiters[i].val = vals[i];
+            waiters[i].uaddr = (ULONG_PTR)words[i];
+            waiters[i].flags = 2; /* FUTEX2_SIZE_U32 */
+            waiters[i].__reserved = 0;
+        }
+
+        if (timeout)
+        {
+            clock_gettime( CLOCK_MONOTONIC, &now );
+            if (now.tv_sec > end.tv_sec || (now.tv_sec == end.tv_sec && now.tv_nsec >= end.tv_nsec))
+                return STATUS_TIMEOUT;
+            rel.tv_sec  = end.tv_sec - now.tv_sec;
+            rel.tv_nsec = end.tv_nsec - now.tv_nsec;
+            if (rel.tv_nsec < 0)
+            {
+                rel.tv_sec--;
+                rel.tv_nsec += 1000000000;
+            }
+        }
+
+        if (count == 1)
+        {
+            if (shared_futex_wait( words[0], waiters[0].val, timeout ? &rel : NULL ) == -1 &&
+                errno == ETIMEDOUT)
+                return STATUS_TIMEOUT;
+        }
+        else if (shared_futex_waitv( waiters, count, timeout ? &end : NULL ) == -1)
+        {
+            if (errno == ETIMEDOUT) return STATUS_TIMEOUT;
+            if (errno == ENOSYS)
+            {
+                futex_waitv_supported = 0;
+                return STATUS_NOT_IMPLEMENTED;
+            }
+        }
+    }
+}
+
+#else  /* USE_FAST_SYNC */
+
+void fast_sync_remove_from_cache( HANDLE handle )
+{
+}
+
+static void fast_sync_add_to_cache( HANDLE handle, enum fast_sync_type type, unsigned int index,
+                                    unsigned int max, unsigned int access )
+{
+}
+
+static NTSTATUS fast_set_event( HANDLE handle, int state, LONG *prev )
+{
+    return STATUS_NOT_IMPLEMENTED;
+}
+
+static NTSTATUS fast_release_semaphore( HANDLE handle, ULONG count, ULONG *prev )
+{
+    return STATUS_NOT_IMPLEMENTED;
+}
+
+static NTSTATUS fast_query( HANDLE handle, enum fast_sync_type *type, unsigned int *state,
+                            unsigned int *max )
+{
+    return STATUS_NOT_IMPLEMENTED;
+}
+
+static NTSTATUS fast_wait( DWORD count, const HANDLE *handles, BOOLEAN wait_any, BOOLEAN alertable,
+                           const LARGE_INTEGER *timeout, LARGE_INTEGER *deadline )
+{
+    return STATUS_NOT_IMPLEMENTED;
+}
+
+#endif  /* USE_FAST_SYNC */
+
 /*
  *	Semaphores
  */
@@ -196,6 +637,9 @@ NTSTATUS WINAPI NtCreateSemaphore( OUT PHANDLE SemaphoreHandle,
         wine_server_add_data( req, objattr, len );
         ret = wine_server_call( req );
         *SemaphoreHandle = wine_server_ptr_handle( reply->handle );
+        if (reply->handle)
+            fast_sync_add_to_cache( *SemaphoreHandle, reply->fast_type, reply->fast_index,
+                                    reply->fast_max, reply->fast_access );
     }
     SERVER_END_REQ;
 
@@ -221,6 +665,9 @@ NTSTATUS WINAPI NtOpenSemaphore( HANDLE *handle, ACCESS_MASK access, const OBJEC
             wine_server_add_data( req, attr->ObjectName->Buffer, attr->ObjectName->Length );
         ret = wine_server_call( req );
         *handle = wine_server_ptr_handle( reply->handle );
+        if (reply->handle)
+            fast_sync_add_to_cache( *handle, reply->fast_type, reply->fast_index,
+                                    reply->fast_max, reply->fast_access );
     }
     SERVER_END_REQ;
     return ret;
@@ -234,6 +681,8 @@ NTSTATUS WINAPI NtQuerySemaphore( HANDLE handle, SEMAPHORE_INFORMATION_CLASS cla
 {
     NTSTATUS ret;
     SEMAPHORE_BASIC_INFORMATION *out = info;
+    enum fast_sync_type type;
+    unsigned int current, max;
 
     TRACE("(%p, %u, %p, %u, %p)\n", handle, class, info, len, ret_len);
 
@@ -245,6 +694,14 @@ NTSTATUS WINAPI NtQuerySemaphore( HANDLE handle, SEMAPHORE_INFORMATION_CLASS cla
 
     if (len != sizeof(SEMAPHORE_BASIC_INFORMATION)) return STATUS_INFO_LENGTH_MISMATCH;
 
+    if (!fast_query( handle, &type, &current, &max ) && type == FAST_SYNC_SEMAPHORE)
+    {
+        out->CurrentCount = current;
+        out->MaximumCount = max;
+        if (ret_len) *ret_len = sizeof(SEMAPHORE_BASIC_INFORMATION);
+        return STATUS_SUCCESS;
+    }
+
     SERVER_START_REQ( query_semaphore )
     {
         req->handle = wine_server_obj_handle( handle );
@@ -266,6 +723,10 @@ NTSTATUS WINAPI NtQuerySemaphore( HANDLE handle, SEMAPHORE_INFORMATION_CLASS cla
 NTSTATUS WINAPI NtReleaseSemaphore( HANDLE handle, ULONG count, PULONG previous )
 {
     NTSTATUS ret;
+
+    if ((ret = fast_release_semaphore( handle, count, previous )) != STATUS_NOT_IMPLEMENTED)
+        return ret;
+
     SERVER_START_REQ( release_semaphore )
     {
         req->handle = wine_server_obj_handle( handle );
@@ -304,6 +765,9 @@ NTSTATUS WINAPI NtCreateEvent( PHANDLE EventHandle, ACCESS_MASK DesiredAccess,
         wine_server_add_data( req, objattr, len );
         ret = wine_server_call( req );
         *EventHandle = wine_server_ptr_handle( reply->handle );
+        if (reply->handle)
+            fast_sync_add_to_cache( *EventHandle, reply->fast_type, reply->fast_index,
+                                    0, reply->fast_access );
     }
     SERVER_END_REQ;
 
@@ -330,6 +794,9 @@ NTSTATUS WINAPI NtOpenEvent( HANDLE *handle, ACCESS_MASK access, const OBJECT_AT
             wine_server_add_data( req, attr->ObjectName->Buffer, attr->ObjectName->Length );
         ret = wine_server_call( req );
         *handle = wine_server_ptr_handle( reply->handle );
+        if (reply->handle)
+            fast_sync_add_to_cache( *handle, reply->fast_type, reply->fast_index,
+                                    0, reply->fast_access );
     }
     SERVER_END_REQ;
     return ret;
@@ -346,6 +813,8 @@ NTSTATUS WINAPI NtSetEvent( HANDLE handle, PULONG NumberOfThreadsReleased )
 
     /* FIXME: set NumberOfThreadsReleased */
 
+    if ((ret = fast_set_event( handle, 1, NULL )) != STATUS_NOT_IMPLEMENTED) return ret;
+
     SERVER_START_REQ( event_op )
     {
         req->handle = wine_server_obj_handle( handle );
@@ -366,6 +835,8 @@ NTSTATUS WINAPI NtResetEvent( HANDLE handle, PULONG NumberOfThreadsReleased )
     /* resetting an event can't release any thread... */
     if (NumberOfThreadsReleased) *NumberOfThreadsReleased = 0;
 
+    if ((ret = fast_set_event( handle, 0, NULL )) != STATUS_NOT_IMPLEMENTED) return ret;
+
     SERVER_START_REQ( event_op )
     {
         req->handle = wine_server_obj_handle( handle );
@@ -418,6 +889,8 @@ NTSTATUS WINAPI NtQueryEvent( HANDLE handle, EVENT_INFORMATION_CLASS class,
 {
     NTSTATUS ret;
     EVENT_BASIC_INFORMATION *out = info;
+    enum fast_sync_type type;
+    unsigned int state, max;
 
     TRACE("(%p, %u, %p, %u, %p)\n", handle, class, info, len, ret_len);
 
@@ -430,6 +903,14 @@ NTSTATUS WINAPI NtQueryEvent( HANDLE handle, EVENT_INFORMATION_CLASS class,
 
     if (len != sizeof(EVENT_BASIC_INFORMATION)) return STATUS_INFO_LENGTH_MISMATCH;
 
+    if (!fast_query( handle, &type, &state, &max ) && type != FAST_SYNC_SEMAPHORE)
+    {
+        out->EventType  = type == FAST_SYNC_MANUAL_EVENT ? NotificationEvent : SynchronizationEvent;
+        out->EventState = state;
+        if (ret_len) *ret_len = sizeof(EVENT_BASIC_INFORMATION);
+        return STATUS_SUCCESS;
+    }
+
     SERVER_START_REQ( query_event )
     {
         req->handle = wine_server_obj_handle( handle );
@@ -1022,9 +1503,16 @@ static NTSTATUS wait_objects( DWORD count, const HANDLE *handles,
 {
     select_op_t select_op;
     UINT i, flags = SELECT_INTERRUPTIBLE;
+    LARGE_INTEGER deadline;
+    NTSTATUS ret;
 
     if (!count || count > MAXIMUM_WAIT_OBJECTS) return STATUS_INVALID_PARAMETER_1;
 
+    deadline.QuadPart = 0;
+    if ((ret = fast_wait( count, handles, wait_any, alertable, timeout, &deadline )) != STATUS_NOT_IMPLEMENTED)
+        return ret;
+    if (deadline.QuadPart) timeout = &deadline;
+
     if (alertable) flags |= SELECT_ALERTABLE;
     select_op.wait.op = wait_any ? SELECT_WAIT : SELECT_WAIT_ALL;
     for (i = 0; i < count; i++) select_op.wait.handles[i] = wine_server_obj_handle( handles[i] );
@@ -1432,6 +1920,386 @@ NTSTATUS NTDLL_AddCompletion( HANDLE hFile, ULONG_PTR CompletionValue,
     return status;
 }
 
+/*
+ *	Futex-based implementation of SRW locks, condition variables and run-once
+ *
+ * These are all process-private, so on Linux we can wait directly on the
+ * memory of the object instead of going through the global keyed event,
+ * which costs a server round trip for each wait and each wake. The keyed
+ * event implementation below remains as fallback. Since use_futexes()
+ * doesn't change during the lifetime of the process, both never get mixed
+ * on the same object.
+ */
+
+static inline BOOL compare_addr( const void *addr, const void *cmp, SIZE_T size )
+{
+    switch (size)
+    {
+    case 1: return *(const volatile UCHAR *)addr == *(const UCHAR *)cmp;
+    case 2: return *(const volatile USHORT *)addr == *(const USHORT *)cmp;
+    case 4: return *(const volatile ULONG *)addr == *(const ULONG *)cmp;
+    case 8: return *(const volatile ULONG64 *)addr == *(const ULONG64 *)cmp;
+    }
+    return FALSE;
+}
+
+#if defined(__linux__) && defined(__NR_futex)
+
+int futex_private = 128;  /* FUTEX_PRIVATE_FLAG */
+
+int use_futexes(void)
+{
+    static int supported = -1;
+
+    if (supported == -1)
+    {
+        futex_wait( &supported, 10, NULL );
+        if (errno == ENOSYS)
+        {
+            futex_private = 0;
+            futex_wait( &supported, 10, NULL );
+        }
+        supported = (errno != ENOSYS);
+    }
+    return supported;
+}
+
+/* futexes need an aligned 32-bit word, which the objects normally provide */
+static inline int *get_futex( void **ptr )
+{
+    if ((ULONG_PTR)ptr & 3) return NULL;
+#ifdef WORDS_BIGENDIAN
+    return (int *)ptr + sizeof(void *) / sizeof(int) - 1;  /* the low half holds the state bits */
+#else
+    return (int *)ptr;
+#endif
+}
+
+/* convert a NT timeout to a relative timespec, returns NULL for infinite timeouts */
+static struct timespec *get_futex_timeout( struct timespec *timespec, const LARGE_INTEGER *timeout )
+{
+    LARGE_INTEGER now;
+    timeout_t diff;
+
+    if (!timeout || timeout->QuadPart == TIMEOUT_INFINITE) return NULL;
+    if (timeout->QuadPart > 0)
+    {
+        NtQuerySystemTime( &now );
+        diff = max( timeout->QuadPart - now.QuadPart, 0 );
+    }
+    else diff = -timeout->QuadPart;
+
+    timespec->tv_sec  = diff / 10000000;
+    timespec->tv_nsec = (diff % 10000000) * 100;
+    return timespec;
+}
+
+static NTSTATUS fast_wait_once( RTL_RUN_ONCE *once, ULONG_PTR val )
+{
+    int *futex;
+
+    if (!use_futexes() || !(futex = get_futex( &once->Ptr ))) return STATUS_NOT_IMPLEMENTED;
+    futex_wait( futex, (int)val, NULL );
+    return STATUS_SUCCESS;
+}
+
+static NTSTATUS fast_wake_once( RTL_RUN_ONCE *once )
+{
+    int *futex;
+
+    if (!use_futexes() || !(futex = get_futex( &once->Ptr ))) return STATUS_NOT_IMPLEMENTED;
+    futex_wake( futex, INT_MAX );
+    return STATUS_SUCCESS;
+}
+
+/* The futex SRW lock doesn't need to count waiters that it will have to wake
+ * one by one, so the layout is simpler than the keyed event one:
+ *
+ *    31 - exclusive lock bit, set if the lock is owned exclusively
+ * 30-16 - number of threads waiting for exclusive access
+ *    15 - set if threads are waiting for shared access
+ *  14-0 - number of shared owners
+ *
+ * Threads waiting for shared access don't get the lock while exclusive
+ * waiters are queued, as with the keyed event implementation. The two kinds
+ * of waiters are told apart through the futex bitsets.
+ */
+
+#define SRWLOCK_FUTEX_EXCLUSIVE_LOCK_BIT      0x80000000
+#define SRWLOCK_FUTEX_EXCLUSIVE_WAITERS_MASK  0x7fff0000
+#define SRWLOCK_FUTEX_EXCLUSIVE_WAITERS_INC   0x00010000
+#define SRWLOCK_FUTEX_SHARED_WAITERS_BIT      0x00008000
+#define SRWLOCK_FUTEX_SHARED_OWNERS_MASK      0x00007fff
+#define SRWLOCK_FUTEX_SHARED_OWNERS_INC       0x00000001
+
+#define SRWLOCK_FUTEX_BITSET_EXCLUSIVE  1
+#define SRWLOCK_FUTEX_BITSET_SHARED     2
+
+static NTSTATUS fast_try_acquire_srw_exclusive( RTL_SRWLOCK *lock )
+{
+    int old, *futex;
+
+    if (!use_futexes() || !(futex = get_futex( &lock->Ptr ))) return STATUS_NOT_IMPLEMENTED;
+
+    for (;;)
+    {
+        old = *futex;
+        if (old & (SRWLOCK_FUTEX_EXCLUSIVE_LOCK_BIT | SRWLOCK_FUTEX_SHARED_OWNERS_MASK))
+            return STATUS_TIMEOUT;
+        if (interlocked_cmpxchg( futex, old | SRWLOCK_FUTEX_EXCLUSIVE_LOCK_BIT, old ) == old)
+            return STATUS_SUCCESS;
+    }
+}
+
+static NTSTATUS fast_acquire_srw_exclusive( RTL_SRWLOCK *lock )
+{
+    int old, new, *futex;
+
+    if (!use_futexes() || !(futex = get_futex( &lock->Ptr ))) return STATUS_NOT_IMPLEMENTED;
+
+    /* uncontended case */
+    if (!interlocked_cmpxchg( futex, SRWLOCK_FUTEX_EXCLUSIVE_LOCK_BIT, 0 )) return STATUS_SUCCESS;
+
+    do
+    {
+        old = *futex;
+        if ((old & SRWLOCK_FUTEX_EXCLUSIVE_WAITERS_MASK) == SRWLOCK_FUTEX_EXCLUSIVE_WAITERS_MASK)
+            RtlRaiseStatus( STATUS_RESOURCE_NOT_OWNED );
+        new = old + SRWLOCK_FUTEX_EXCLUSIVE_WAITERS_INC;
+    } while (interlocked_cmpxchg( futex, new, old ) != old);
+
+    for (;;)
+    {
+        old = *futex;
+        if (!(old & (SRWLOCK_FUTEX_EXCLUSIVE_LOCK_BIT | SRWLOCK_FUTEX_SHARED_OWNERS_MASK)))
+        {
+            new = (old | SRWLOCK_FUTEX_EXCLUSIVE_LOCK_BIT) - SRWLOCK_FUTEX_EXCLUSIVE_WAITERS_INC;
+            if (interlocked_cmpxchg( futex, new, old ) == old) return STATUS_SUCCESS;
+        }
+        else futex_wait_bitset( futex, old, SRWLOCK_FUTEX_BITSET_EXCLUSIVE );
+    }
+}
+
+static NTSTATUS fast_try_acquire_srw_shared( RTL_SRWLOCK *lock )
+{
+    int old, *futex;
+
+    if (!use_futexes() || !(futex = get_futex( &lock->Ptr ))) return STATUS_NOT_IMPLEMENTED;
+
+    for (;;)
+    {
+        old = *futex;
+        if (old & (SRWLOCK_FUTEX_EXCLUSIVE_LOCK_BIT | SRWLOCK_FUTEX_EXCLUSIVE_WAITERS_MASK))
+            return STATUS_TIMEOUT;
+        if ((old & SRWLOCK_FUTEX_SHARED_OWNERS_MASK) == SRWLOCK_FUTEX_SHARED_OWNERS_MASK)
+            RtlRaiseStatus( STATUS_RESOURCE_NOT_OWNED );
+        if (interlocked_cmpxchg( futex, old + SRWLOCK_FUTEX_SHARED_OWNERS_INC, old ) == old)
+            return STATUS_SUCCESS;
+    }
+}
+
+static NTSTATUS fast_acquire_srw_shared( RTL_SRWLOCK *lock )
+{
+    int old, new, *futex;
+
+    if (!use_futexes() || !(futex = get_futex( &lock->Ptr ))) return STATUS_NOT_IMPLEMENTED;
+
+    for (;;)
+    {
+        old = *futex;
+        if (!(old & (SRWLOCK_FUTEX_EXCLUSIVE_LOCK_BIT | SRWLOCK_FUTEX_EXCLUSIVE_WAITERS_MASK)))
+        {
+            if ((old & SRWLOCK_FUTEX_SHARED_OWNERS_MASK) == SRWLOCK_FUTEX_SHARED_OWNERS_MASK)
+                RtlRaiseStatus( STATUS_RESOURCE_NOT_OWNED );
+            if (interlocked_cmpxchg( futex, old + SRWLOCK_FUTEX_SHARED_OWNERS_INC, old ) == old)
+                return STATUS_SUCCESS;
+        }
+        else
+        {
+            new = old | SRWLOCK_FUTEX_SHARED_WAITERS_BIT;
+            if (new == old || interlocked_cmpxchg( futex, new, old ) == old)
+                futex_wait_bitset( futex, new, SRWLOCK_FUTEX_BITSET_SHARED );
+        }
+    }
+}
+
+static NTSTATUS fast_release_srw_exclusive( RTL_SRWLOCK *lock )
+{
+    int old, new, *futex;
+
+    if (!use_futexes() || !(futex = get_futex( &lock->Ptr ))) return STATUS_NOT_IMPLEMENTED;
+
+    do
+    {
+        old = *futex;
+        if (!(old & SRWLOCK_FUTEX_EXCLUSIVE_LOCK_BIT))
+        {
+            ERR( "lock %p is not owned exclusive (%#x)\n", lock, old );
+            return STATUS_RESOURCE_NOT_OWNED;
+        }
+        new = old & ~SRWLOCK_FUTEX_EXCLUSIVE_LOCK_BIT;
+        if (!(new & SRWLOCK_FUTEX_EXCLUSIVE_WAITERS_MASK)) new &= ~SRWLOCK_FUTEX_SHARED_WAITERS_BIT;
+    } while (interlocked_cmpxchg( futex, new, old ) != old);
+
+    /* exclusive waiters go first, the shared ones once there are none left */
+    if (new & SRWLOCK_FUTEX_EXCLUSIVE_WAITERS_MASK)
+        futex_wake_bitset( futex, 1, SRWLOCK_FUTEX_BITSET_EXCLUSIVE );
+    else if (old & SRWLOCK_FUTEX_SHARED_WAITERS_BIT)
+        futex_wake_bitset( futex, INT_MAX, SRWLOCK_FUTEX_BITSET_SHARED );
+    return STATUS_SUCCESS;
+}
+
+static NTSTATUS fast_release_srw_shared( RTL_SRWLOCK *lock )
+{
+    int old, new, *futex;
+
+    if (!use_futexes() || !(futex = get_futex( &lock->Ptr ))) return STATUS_NOT_IMPLEMENTED;
+
+    do
+    {
+        old = *futex;
+        if ((old & SRWLOCK_FUTEX_EXCLUSIVE_LOCK_BIT) || !(old & SRWLOCK_FUTEX_SHARED_OWNERS_MASK))
+        {
+            ERR( "lock %p is not owned shared (%#x)\n", lock, old );
+            return STATUS_RESOURCE_NOT_OWNED;
+        }
+        new = old - SRWLOCK_FUTEX_SHARED_OWNERS_INC;
+    } while (interlocked_cmpxchg( futex, new, old ) != old);
+
+    if (!(new & SRWLOCK_FUTEX_SHARED_OWNERS_MASK) && (new & SRWLOCK_FUTEX_EXCLUSIVE_WAITERS_MASK))
+        futex_wake_bitset( futex, 1, SRWLOCK_FUTEX_BITSET_EXCLUSIVE );
+    return STATUS_SUCCESS;
+}
+
+/* With futexes the condition variable is a sequence counter bumped by each
+ * wake, sleepers wait for it to change. Spurious wakeups are allowed. The
+ * variable has no room for a waiter count, so sleepers are counted in a table
+ * hashed by address, and wakes of variables without waiters skip the system
+ * call. A collision only costs an unneeded wake. */
+#define CV_WAIT_HASH_SIZE  256
+
+static int DECLSPEC_ALIGN(64) cv_waiters[CV_WAIT_HASH_SIZE];
+
+static inline int *get_cv_waiters( const RTL_CONDITION_VARIABLE *variable )
+{
+    ULONG_PTR val = (ULONG_PTR)variable;
+    return &cv_waiters[((val >> 3) ^ (val >> 11)) % CV_WAIT_HASH_SIZE];
+}
+
+/* register as waiter and sample the sequence, before the lock is released */
+static NTSTATUS fast_get_cv_sequence( RTL_CONDITION_VARIABLE *variable, int *val )
+{
+    int *futex;
+
+    if (!use_futexes() || !(futex = get_futex( &variable->Ptr ))) return STATUS_NOT_IMPLEMENTED;
+    interlocked_xchg_add( get_cv_waiters( variable ), 1 );
+    *val = interlocked_cmpxchg( futex, 0, 0 );
+    return STATUS_SUCCESS;
+}
+
+static NTSTATUS fast_wait_cv( RTL_CONDITION_VARIABLE *variable, int val, const LARGE_INTEGER *timeout )
+{
+    struct timespec timespec;
+    NTSTATUS ret = STATUS_SUCCESS;
+
+    if (futex_wait( get_futex( &variable->Ptr ), val, get_futex_timeout( &timespec, timeout )) == -1 &&
+        errno == ETIMEDOUT)
+        ret = STATUS_TIMEOUT;
+    interlocked_xchg_add( get_cv_waiters( variable ), -1 );
+    return ret;
+}
+
+static NTSTATUS fast_wake_cv( RTL_CONDITION_VARIABLE *variable, int count )
+{
+    int *futex;
+
+    if (!use_futexes() || !(futex = get_futex( &variable->Ptr ))) return STATUS_NOT_IMPLEMENTED;
+
+    /* the sequence is bumped before reading the count, so a concurrent
+     * waiter either is counted or samples the new sequence */
+    interlocked_xchg_add( futex, 1 );
+    if (*(volatile int *)get_cv_waiters( variable )) futex_wake( futex, count );
+    return STATUS_SUCCESS;
+}
+
+/* Address waits go through a table of futexes hashed by address, each one a
+ * sequence counter bumped by the wakes of any of its addresses. Waiters are
+ * counted so that wakes nobody waits for don't need a system call. */
+#define ADDR_WAIT_HASH_SIZE  256
+
+struct addr_wait_bucket
+{
+    int seq;       /* futex word, incremented on each wake */
+    int waiters;   /* number of threads waiting on the futex */
+    int pad[14];   /* keep buckets on separate cache lines */
+};
+
+static struct addr_wait_bucket DECLSPEC_ALIGN(64) addr_wait_table[ADDR_WAIT_HASH_SIZE];
+
+static inline struct addr_wait_bucket *get_addr_wait_bucket( const void *addr )
+{
+    ULONG_PTR val = (ULONG_PTR)addr;
+    return &addr_wait_table[((val >> 3) ^ (val >> 11)) % ADDR_WAIT_HASH_SIZE];
+}
+
+static NTSTATUS fast_wait_addr( const void *addr, const void *cmp, SIZE_T size, const LARGE_INTEGER *timeout )
+{
+    struct addr_wait_bucket *bucket = get_addr_wait_bucket( addr );
+    struct timespec timespec;
+    NTSTATUS ret = STATUS_SUCCESS;
+    int val;
+
+    if (!use_futexes()) return STATUS_NOT_IMPLEMENTED;
+
+    /* register before sampling the sequence and the address, so that a
+     * concurrent wake either sees the waiter or changes the sequence */
+    interlocked_xchg_add( &bucket->waiters, 1 );
+    val = interlocked_cmpxchg( &bucket->seq, 0, 0 );
+    if (compare_addr( addr, cmp, size ) &&
+        futex_wait( &bucket->seq, val, get_futex_timeout( &timespec, timeout )) == -1 && errno == ETIMEDOUT)
+        ret = STATUS_TIMEOUT;
+    interlocked_xchg_add( &bucket->waiters, -1 );
+    return ret;
+}
+
+static NTSTATUS fast_wake_addr( const void *addr )
+{
+    struct addr_wait_bucket *bucket = get_addr_wait_bucket( addr );
+
+    if (!use_futexes()) return STATUS_NOT_IMPLEMENTED;
+
+    /* this wakes the waiters of all the addresses of the bucket, they have
+     * to cope with spurious wakeups anyway, but a single one could be the
+     * wrong one */
+    interlocked_xchg_add( &bucket->seq, 1 );
+    if (*(volatile int *)&bucket->waiters) futex_wake( &bucket->seq, INT_MAX );
+    return STATUS_SUCCESS;
+}
+
+#else  /* __linux__ && __NR_futex */
+
+static NTSTATUS fast_wait_once( RTL_RUN_ONCE *once, ULONG_PTR val ) { return STATUS_NOT_IMPLEMENTED; }
+static NTSTATUS fast_wake_once( RTL_RUN_ONCE *once ) { return STATUS_NOT_IMPLEMENTED; }
+static NTSTATUS fast_try_acquire_srw_exclusive( RTL_SRWLOCK *lock ) { return STATUS_NOT_IMPLEMENTED; }
+static NTSTATUS fast_acquire_srw_exclusive( RTL_SRWLOCK *lock ) { return STATUS_NOT_IMPLEMENTED; }
+static NTSTATUS fast_try_acquire_srw_shared( RTL_SRWLOCK *lock ) { return STATUS_NOT_IMPLEMENTED; }
+static NTSTATUS fast_acquire_srw_shared( RTL_SRWLOCK *lock ) { return STATUS_NOT_IMPLEMENTED; }
+static NTSTATUS fast_release_srw_exclusive( RTL_SRWLOCK *lock ) { return STATUS_NOT_IMPLEMENTED; }
+static NTSTATUS fast_release_srw_shared( RTL_SRWLOCK *lock ) { return STATUS_NOT_IMPLEMENTED; }
+static NTSTATUS fast_get_cv_sequence( RTL_CONDITION_VARIABLE *variable, int *val ) { return STATUS_NOT_IMPLEMENTED; }
+static NTSTATUS fast_wait_cv( RTL_CONDITION_VARIABLE *variable, int val, const LARGE_INTEGER *timeout )
+{
+    return STATUS_NOT_IMPLEMENTED;
+}
+static NTSTATUS fast_wake_cv( RTL_CONDITION_VARIABLE *variable, int count ) { return STATUS_NOT_IMPLEMENTED; }
+static NTSTATUS fast_wait_addr( const void *addr, const void *cmp, SIZE_T size, const LARGE_INTEGER *timeout )
+{
+    return STATUS_NOT_IMPLEMENTED;
+}
+static NTSTATUS fast_wake_addr( const void *addr ) { return STATUS_NOT_IMPLEMENTED; }
+
+#endif  /* __linux__ && __NR_futex */
+
 /******************************************************************
  *              RtlRunOnceInitialize (NTDLL.@)
  */
@@ -1469,6 +2337,7 @@ DWORD WINAPI RtlRunOnceBeginInitialize( RTL_RUN_ONCE *once, ULONG flags, void **
 
         case 1:  /* in progress, wait */
             if (flags & RTL_RUN_ONCE_ASYNC) return STATUS_INVALID_PARAMETER;
+            if (fast_wait_once( once, val ) != STATUS_NOT_IMPLEMENTED) break;
             next = val & ~3;
             if (interlocked_cmpxchg_ptr( &once->Ptr, (void *)((ULONG_PTR)&next | 1),
                                          (void *)val ) == (void *)val)
@@ -1508,6 +2377,7 @@ DWORD WINAPI RtlRunOnceComplete( RTL_RUN_ONCE *once, ULONG flags, void *context
         {
         case 1:  /* in progress */
             if (interlocked_cmpxchg_ptr( &once->Ptr, context, (void *)val ) != (void *)val) break;
+            if (fast_wake_once( once ) != STATUS_NOT_IMPLEMENTED) return STATUS_SUCCESS;
             val &= ~3;
             while (val)
             {
@@ -1677,7 +2547,8 @@ static inline void srwlock_leave_shared( RTL_SRWLOCK *lock, unsigned int val )
  *  It doesn't make any difference which thread for example unlocks an
  *  SRWLock (see corresponding tests). This implementation uses two
  *  keyed events (one for the exclusive waiters and one for the shared
- *  waiters) and is limited to 2^15-1 waiting threads.
+ *  waiters) and is limited to 2^15-1 waiting threads. Where futexes are
+ *  available the lock waits on them directly instead.
  */
 void WINAPI RtlInitializeSRWLock( RTL_SRWLOCK *lock )
 {
@@ -1694,6 +2565,9 @@ void WINAPI RtlInitializeSRWLock( RTL_SRWLOCK *lock )
  */
 void WINAPI RtlAcquireSRWLockExclusive( RTL_SRWLOCK *lock )
 {
+    if (fast_acquire_srw_exclusive( lock ) != STATUS_NOT_IMPLEMENTED)
+        return;
+
     if (srwlock_lock_exclusive( (unsigned int *)&lock->Ptr, SRWLOCK_RES_EXCLUSIVE ))
         NtWaitForKeyedEvent( keyed_event, srwlock_key_exclusive(lock), FALSE, NULL );
 }
@@ -1708,6 +2582,10 @@ void WINAPI RtlAcquireSRWLockExclusive( RTL_SRWLOCK *lock )
 void WINAPI RtlAcquireSRWLockShared( RTL_SRWLOCK *lock )
 {
     unsigned int val, tmp;
+
+    if (fast_acquire_srw_shared( lock ) != STATUS_NOT_IMPLEMENTED)
+        return;
+
     /* Acquires a shared lock. If it's currently not possible to add elements to
      * the shared queue, then request exclusive access instead. */
     for (val = *(unsigned int *)&lock->Ptr;; val = tmp)
@@ -1738,6 +2616,9 @@ void WINAPI RtlAcquireSRWLockShared( RTL_SRWLOCK *lock )
  */
 void WINAPI RtlReleaseSRWLockExclusive( RTL_SRWLOCK *lock )
 {
+    if (fast_release_srw_exclusive( lock ) != STATUS_NOT_IMPLEMENTED)
+        return;
+
     srwlock_leave_exclusive( lock, srwlock_unlock_exclusive( (unsigned int *)&lock->Ptr,
                              - SRWLOCK_RES_EXCLUSIVE ) - SRWLOCK_RES_EXCLUSIVE );
 }
@@ -1747,6 +2628,9 @@ void WINAPI RtlReleaseSRWLockExclusive( RTL_SRWLOCK *lock )
  */
 void WINAPI RtlReleaseSRWLockShared( RTL_SRWLOCK *lock )
 {
+    if (fast_release_srw_shared( lock ) != STATUS_NOT_IMPLEMENTED)
+        return;
+
     srwlock_leave_shared( lock, srwlock_lock_exclusive( (unsigned int *)&lock->Ptr,
                           - SRWLOCK_RES_SHARED ) - SRWLOCK_RES_SHARED );
 }
@@ -1760,6 +2644,11 @@ void WINAPI RtlReleaseSRWLockShared( RTL_SRWLOCK *lock )
  */
 BOOLEAN WINAPI RtlTryAcquireSRWLockExclusive( RTL_SRWLOCK *lock )
 {
+    NTSTATUS ret;
+
+    if ((ret = fast_try_acquire_srw_exclusive( lock )) != STATUS_NOT_IMPLEMENTED)
+        return ret == STATUS_SUCCESS;
+
     return interlocked_cmpxchg( (int *)&lock->Ptr, SRWLOCK_MASK_IN_EXCLUSIVE |
                                 SRWLOCK_RES_EXCLUSIVE, 0 ) == 0;
 }
@@ -1770,6 +2659,11 @@ BOOLEAN WINAPI RtlTryAcquireSRWLockExclusive( RTL_SRWLOCK *lock )
 BOOLEAN WINAPI RtlTryAcquireSRWLockShared( RTL_SRWLOCK *lock )
 {
     unsigned int val, tmp;
+    NTSTATUS ret;
+
+    if ((ret = fast_try_acquire_srw_shared( lock )) != STATUS_NOT_IMPLEMENTED)
+        return ret == STATUS_SUCCESS;
+
     for (val = *(unsigned int *)&lock->Ptr;; val = tmp)
     {
         if (val & SRWLOCK_MASK_EXCLUSIVE_QUEUE)
@@ -1813,6 +2707,9 @@ void WINAPI RtlInitializeConditionVariable( RTL_CONDITION_VARIABLE *variable )
  */
 void WINAPI RtlWakeConditionVariable( RTL_CONDITION_VARIABLE *variable )
 {
+    if (fast_wake_cv( variable, 1 ) != STATUS_NOT_IMPLEMENTED)
+        return;
+
     if (interlocked_dec_if_nonzero( (int *)&variable->Ptr ))
         NtReleaseKeyedEvent( keyed_event, &variable->Ptr, FALSE, NULL );
 }
@@ -1824,7 +2721,12 @@ void WINAPI RtlWakeConditionVariable( RTL_CONDITION_VARIABLE *variable )
  */
 void WINAPI RtlWakeAllConditionVariable( RTL_CONDITION_VARIABLE *variable )
 {
-    int val = interlocked_xchg( (int *)&variable->Ptr, 0 );
+    int val;
+
+    if (fast_wake_cv( variable, INT_MAX ) != STATUS_NOT_IMPLEMENTED)
+        return;
+
+    val = interlocked_xchg( (int *)&variable->Ptr, 0 );
     while (val-- > 0)
         NtReleaseKeyedEvent( keyed_event, &variable->Ptr, FALSE, NULL );
 }
@@ -1848,6 +2750,16 @@ NTSTATUS WINAPI RtlSleepConditionVariableCS( RTL_CONDITION_VARIABLE *variable, R
                                              const LARGE_INTEGER *timeout )
 {
     NTSTATUS status;
+    int val;
+
+    if (fast_get_cv_sequence( variable, &val ) != STATUS_NOT_IMPLEMENTED)
+    {
+        RtlLeaveCriticalSection( crit );
+        status = fast_wait_cv( variable, val, timeout );
+        RtlEnterCriticalSection( crit );
+        return status;
+    }
+
     interlocked_xchg_add( (int *)&variable->Ptr, 1 );
     RtlLeaveCriticalSection( crit );
 
@@ -1885,18 +2797,27 @@ NTSTATUS WINAPI RtlSleepConditionVariableSRW( RTL_CONDITION_VARIABLE *variable,
                                               const LARGE_INTEGER *timeout, ULONG flags )
 {
     NTSTATUS status;
-    interlocked_xchg_add( (int *)&variable->Ptr, 1 );
+    BOOL fast;
+    int val;
+
+    if (!(fast = fast_get_cv_sequence( variable, &val ) != STATUS_NOT_IMPLEMENTED))
+        interlocked_xchg_add( (int *)&variable->Ptr, 1 );
 
     if (flags & RTL_CONDITION_VARIABLE_LOCKMODE_SHARED)
         RtlReleaseSRWLockShared( lock );
     else
         RtlReleaseSRWLockExclusive( lock );
 
-    status = NtWaitForKeyedEvent( keyed_event, &variable->Ptr, FALSE, timeout );
-    if (status != STATUS_SUCCESS)
+    if (fast)
+        status = fast_wait_cv( variable, val, timeout );
+    else
     {
-        if (!interlocked_dec_if_nonzero( (int *)&variable->Ptr ))
-            status = NtWaitForKeyedEvent( keyed_event, &variable->Ptr, FALSE, NULL );
+        status = NtWaitForKeyedEvent( keyed_event, &variable->Ptr, FALSE, timeout );
+        if (status != STATUS_SUCCESS)
+        {
+            if (!interlocked_dec_if_nonzero( (int *)&variable->Ptr ))
+                status = NtWaitForKeyedEvent( keyed_event, &variable->Ptr, FALSE, NULL );
+        }
     }
 
     if (flags & RTL_CONDITION_VARIABLE_LOCKMODE_SHARED)
@@ -1905,3 +2826,119 @@ NTSTATUS WINAPI RtlSleepConditionVariableSRW( RTL_CONDITION_VARIABLE *variable,
         RtlAcquireSRWLockExclusive( lock );
     return status;
 }
+
+/* Without futexes, address waiters queue up in a list and sleep on the keyed event */
+struct addr_waiter
+{
+    struct list  entry;
+    const void  *addr;   /* NULL once woken */
+};
+
+static struct list addr_waiters = LIST_INIT( addr_waiters );
+
+static RTL_CRITICAL_SECTION addr_section;
+static RTL_CRITICAL_SECTION_DEBUG addr_section_debug =
+{
+    0, 0, &addr_section,
+    { &addr_section_debug.ProcessLocksList, &addr_section_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": addr_section") }
+};
+static RTL_CRITICAL_SECTION addr_section = { &addr_section_debug, -1, 0, 0, 0, 0 };
+
+static void wake_addr_waiters( const void *addr, BOOL all )
+{
+    struct addr_waiter *waiter, *next;
+    struct list woken = LIST_INIT( woken );
+    struct list *ptr;
+
+    RtlEnterCriticalSection( &addr_section );
+    LIST_FOR_EACH_ENTRY_SAFE( waiter, next, &addr_waiters, struct addr_waiter, entry )
+    {
+        if (waiter->addr != addr) continue;
+        list_remove( &waiter->entry );
+        list_add_tail( &woken, &waiter->entry );
+        waiter->addr = NULL;
+        if (!all) break;
+    }
+    RtlLeaveCriticalSection( &addr_section );
+
+    /* the waiters can't go away before they get released */
+    while ((ptr = list_head( &woken )))
+    {
+        list_remove( ptr );
+        NtReleaseKeyedEvent( keyed_event, LIST_ENTRY( ptr, struct addr_waiter, entry ), FALSE, NULL );
+    }
+}
+
+/***********************************************************************
+ *           RtlWaitOnAddress   (NTDLL.@)
+ *
+ * Waits until the value at an address differs from the given one, or
+ * until a wake for the address.
+ *
+ * PARAMS
+ *  addr    [I] address to wait on
+ *  cmp     [I] value to compare with
+ *  size    [I] size of the value, 1, 2, 4 or 8 bytes
+ *  timeout [I] timeout
+ *
+ * RETURNS
+ *  STATUS_SUCCESS, or STATUS_TIMEOUT if the timeout expired.
+ *
+ * NOTES
+ *  Like with condition variables, the wait may end spuriously.
+ */
+NTSTATUS WINAPI RtlWaitOnAddress( const void *addr, const void *cmp, SIZE_T size,
+                                  const LARGE_INTEGER *timeout )
+{
+    struct addr_waiter waiter;
+    NTSTATUS status;
+
+    if (size != 1 && size != 2 && size != 4 && size != 8) return STATUS_INVALID_PARAMETER;
+
+    if ((status = fast_wait_addr( addr, cmp, size, timeout )) != STATUS_NOT_IMPLEMENTED)
+        return status;
+
+    RtlEnterCriticalSection( &addr_section );
+    if (!compare_addr( addr, cmp, size ))
+    {
+        RtlLeaveCriticalSection( &addr_section );
+        return STATUS_SUCCESS;
+    }
+    waiter.addr = addr;
+    list_add_tail( &addr_waiters, &waiter.entry );
+    RtlLeaveCriticalSection( &addr_section );
+
+    status = NtWaitForKeyedEvent( keyed_event, &waiter, FALSE, timeout );
+    if (status != STATUS_SUCCESS)
+    {
+        RtlEnterCriticalSection( &addr_section );
+        if (waiter.addr) list_remove( &waiter.entry );
+        RtlLeaveCriticalSection( &addr_section );
+        /* a wake got to us in the meantime and will release the keyed event */
+        if (!waiter.addr) status = NtWaitForKeyedEvent( keyed_event, &waiter, FALSE, NULL );
+    }
+    return status;
+}
+
+/***********************************************************************
+ *           RtlWakeAddressAll   (NTDLL.@)
+ *
+ * Wakes up all the threads waiting on an address.
+ */
+void WINAPI RtlWakeAddressAll( const void *addr )
+{
+    if (fast_wake_addr( addr ) != STATUS_NOT_IMPLEMENTED) return;
+    wake_addr_waiters( addr, TRUE );
+}
+
+/***********************************************************************
+ *           RtlWakeAddressSingle   (NTDLL.@)
+ *
+ * Wakes up one of the threads waiting on an address.
+ */
+void WINAPI RtlWakeAddressSingle( const void *addr )
+{
+    if (fast_wake_addr( addr ) != STATUS_NOT_IMPLEMENTED) return;
+    wake_addr_waiters( addr, FALSE );
+}
@@ -0,0 +1,396 @@
+/*
+ * Unit test suite for heap functions
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include "ntdll_test.h"
+#include "wine/heapstats.h"
+
+static HANDLE   (WINAPI *pRtlCreateHeap)(ULONG,PVOID,SIZE_T,SIZE_T,PVOID,PRTL_HEAP_DEFINITION);
+static HANDLE   (WINAPI *pRtlDestroyHeap)(HANDLE);
+static PVOID    (WINAPI *pRtlAllocateHeap)(HANDLE,ULONG,SIZE_T);
+static BOOLEAN  (WINAPI *pRtlFreeHeap)(HANDLE,ULONG,PVOID);
+static SIZE_T   (WINAPI *pRtlSizeHeap)(HANDLE,ULONG,const void *);
+static BOOLEAN  (WINAPI *pRtlValidateHeap)(HANDLE,ULONG,LPCVOID);
+static NTSTATUS (WINAPI *pRtlWalkHeap)(HANDLE,PVOID);
+static NTSTATUS (WINAPI *pRtlQueryHeapInformation)(HANDLE,HEAP_INFORMATION_CLASS,PVOID,SIZE_T,PSIZE_T);
+static NTSTATUS (WINAPI *pRtlSetHeapInformation)(HANDLE,HEAP_INFORMATION_CLASS,PVOID,SIZE_T);
+static BOOLEAN  (WINAPI *pRtlLockHeap)(HANDLE);
+static BOOLEAN  (WINAPI *pRtlUnlockHeap)(HANDLE);
+
+static void init_function_pointers(void)
+{
+    HMODULE hntdll = GetModuleHandleA( "ntdll.dll" );
+
+#define GET_FUNC(name) p##name = (void *)GetProcAddress( hntdll, #name )
+    GET_FUNC( RtlCreateHeap );
+    GET_FUNC( RtlDestroyHeap );
+    GET_FUNC( RtlAllocateHeap );
+    GET_FUNC( RtlFreeHeap );
+    GET_FUNC( RtlSizeHeap );
+    GET_FUNC( RtlValidateHeap );
+    GET_FUNC( RtlWalkHeap );
+    GET_FUNC( RtlQueryHeapInformation );
+    GET_FUNC( RtlSetHeapInformation );
+    GET_FUNC( RtlLockHeap );
+    GET_FUNC( RtlUnlockHeap );
+#undef GET_FUNC
+}
+
+static ULONG get_heap_compatibility( HANDLE heap )
+{
+    NTSTATUS status;
+    ULONG info = 0xdeadbeef;
+    SIZE_T size = 0;
+
+    status = pRtlQueryHeapInformation( heap, HeapCompatibilityInformation, &info, sizeof(info), &size );
+    ok( !status, "RtlQueryHeapInformation failed %08x\n", status );
+    ok( size == sizeof(info), "got size %lu\n", size );
+    return info;
+}
+
+static void test_heap_compatibility(void)
+{
+    NTSTATUS status;
+    HANDLE heap;
+    ULONG info;
+    void *ptr;
+
+    if (!pRtlQueryHeapInformation || !pRtlSetHeapInformation)
+    {
+        win_skip( "RtlQueryHeapInformation or RtlSetHeapInformation not available\n" );
+        return;
+    }
+
+    heap = pRtlCreateHeap( HEAP_GROWABLE, NULL, 0, 0, NULL, NULL );
+    ok( heap != NULL, "RtlCreateHeap failed\n" );
+    info = get_heap_compatibility( heap );
+    ok( info == 0, "got %u\n", info );
+
+    info = 2;
+    status = pRtlSetHeapInformation( heap, HeapCompatibilityInformation, &info, sizeof(info) - 1 );
+    ok( status, "RtlSetHeapInformation succeeded\n" );
+    status = pRtlSetHeapInformation( heap, HeapCompatibilityInformation, &info, sizeof(info) );
+    ok( !status, "RtlSetHeapInformation failed %08x\n", status );
+    info = get_heap_compatibility( heap );
+    ok( info == 2, "got %u\n", info );
+
+    /* blocks of the front end are still regular heap blocks */
+    ptr = pRtlAllocateHeap( heap, 0, 24 );
+    ok( ptr != NULL, "RtlAllocateHeap failed\n" );
+    ok( pRtlSizeHeap( heap, 0, ptr ) == 24, "got size %lu\n", pRtlSizeHeap( heap, 0, ptr ) );
+    ok( pRtlValidateHeap( heap, 0, ptr ), "RtlValidateHeap failed\n" );
+    ok( pRtlFreeHeap( heap, 0, ptr ), "RtlFreeHeap failed\n" );
+    ok( pRtlValidateHeap( heap, 0, NULL ), "RtlValidateHeap failed\n" );
+
+    info = 0;
+    status = pRtlSetHeapInformation( heap, HeapCompatibilityInformation, &info, sizeof(info) );
+    ok( status, "RtlSetHeapInformation succeeded\n" );
+    pRtlDestroyHeap( heap );
+
+    /* not available on heaps without serialization */
+    heap = pRtlCreateHeap( HEAP_GROWABLE | HEAP_NO_SERIALIZE, NULL, 0, 0, NULL, NULL );
+    ok( heap != NULL, "RtlCreateHeap failed\n" );
+    info = 2;
+    status = pRtlSetHeapInformation( heap, HeapCompatibilityInformation, &info, sizeof(info) );
+    ok( status, "RtlSetHeapInformation succeeded\n" );
+    info = get_heap_compatibility( heap );
+    ok( info == 0, "got %u\n", info );
+    pRtlDestroyHeap( heap );
+}
+
+static void test_heap_statistics(void)
+{
+    HEAP_WINE_STATISTICS stats;
+    NTSTATUS status;
+    SIZE_T size;
+    HANDLE heap;
+    void *small[8], *large;
+    unsigned int i;
+
+    heap = pRtlCreateHeap( HEAP_GROWABLE, NULL, 0, 0, NULL, NULL );
+    ok( heap != NULL, "RtlCreateHeap failed\n" );
+
+    size = 0;
+    status = pRtlQueryHeapInformation( heap, HeapWineStatistics, &stats, sizeof(stats) - 1, &size );
+    if (status == STATUS_INVALID_INFO_CLASS)
+    {
+        win_skip( "heap statistics not supported\n" );
+        pRtlDestroyHeap( heap );
+        return;
+    }
+    ok( status == STATUS_BUFFER_TOO_SMALL, "RtlQueryHeapInformation returned %08x\n", status );
+    ok( size == sizeof(stats), "got size %lu\n", size );
+
+    status = pRtlQueryHeapInformation( heap, HeapWineStatistics, &stats, sizeof(stats), &size );
+    ok( !status, "RtlQueryHeapInformation failed %08x\n", status );
+    ok( !stats.UsedBlocks, "got %u used blocks\n", stats.UsedBlocks );
+    ok( !stats.LargeBlocks, "got %u large blocks\n", stats.LargeBlocks );
+    ok( stats.CommittedSize && stats.CommittedSize <= stats.ReservedSize,
+        "got committed %lu reserved %lu\n", stats.CommittedSize, stats.ReservedSize );
+    for (i = 0; i < HEAP_STATISTICS_CLASSES; i++)
+        ok( !stats.Allocations[i] && !stats.Frees[i], "class %u: got %s allocs %s frees\n", i,
+            wine_dbgstr_longlong( stats.Allocations[i] ), wine_dbgstr_longlong( stats.Frees[i] ));
+
+    for (i = 0; i < 8; i++)
+    {
+        small[i] = pRtlAllocateHeap( heap, 0, 100 );
+        ok( small[i] != NULL, "RtlAllocateHeap failed\n" );
+    }
+    large = pRtlAllocateHeap( heap, 0, 0x100000 );
+    ok( large != NULL, "RtlAllocateHeap failed\n" );
+
+    status = pRtlQueryHeapInformation( heap, HeapWineStatistics, &stats, sizeof(stats), NULL );
+    ok( !status, "RtlQueryHeapInformation failed %08x\n", status );
+    ok( stats.UsedBlocks == 9, "got %u used blocks\n", stats.UsedBlocks );
+    ok( stats.LargeBlocks == 1, "got %u large blocks\n", stats.LargeBlocks );
+    ok( stats.LargeSize == 0x100000, "got large size %lu\n", stats.LargeSize );
+    ok( stats.UsedSize >= 0x100000 + 8 * 100, "got used size %lu\n", stats.UsedSize );
+    ok( stats.CommittedSize >= stats.UsedSize, "got committed %lu used %lu\n",
+        stats.CommittedSize, stats.UsedSize );
+    ok( stats.Allocations[3] == 8, "got %s allocs of 100 bytes\n", wine_dbgstr_longlong( stats.Allocations[3] ));
+    ok( stats.Allocations[HEAP_STATISTICS_CLASSES - 1] == 1, "got %s large allocs\n",
+        wine_dbgstr_longlong( stats.Allocations[HEAP_STATISTICS_CLASSES - 1] ));
+
+    for (i = 0; i < 8; i++) pRtlFreeHeap( heap, 0, small[i] );
+    pRtlFreeHeap( heap, 0, large );
+
+    status = pRtlQueryHeapInformation( heap, HeapWineStatistics, &stats, sizeof(stats), NULL );
+    ok( !status, "RtlQueryHeapInformation failed %08x\n", status );
+    ok( !stats.UsedBlocks, "got %u used blocks\n", stats.UsedBlocks );
+    ok( !stats.LargeBlocks, "got %u large blocks\n", stats.LargeBlocks );
+    ok( stats.Frees[3] == 8, "got %s frees of 100 bytes\n", wine_dbgstr_longlong( stats.Frees[3] ));
+    ok( stats.Frees[HEAP_STATISTICS_CLASSES - 1] == 1, "got %s large frees\n",
+        wine_dbgstr_longlong( stats.Frees[HEAP_STATISTICS_CLASSES - 1] ));
+    pRtlDestroyHeap( heap );
+}
+
+#define STRESS_THREADS 4
+#define STRESS_BLOCKS  64
+
+struct stress_params
+{
+    HANDLE       heap;
+    unsigned int loops;
+    unsigned int seed;
+    LONG         errors;
+};
+
+static DWORD WINAPI stress_thread( void *arg )
+{
+    struct stress_params *params = arg;
+    unsigned char *blocks[STRESS_BLOCKS] = { NULL };
+    SIZE_T sizes[STRESS_BLOCKS];
+    unsigned int i, j, seed = params->seed;
+
+    for (i = 0; i < params->loops; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        j = (seed >> 16) % STRESS_BLOCKS;
+        if (blocks[j])
+        {
+            if (blocks[j][0] != (unsigned char)j || blocks[j][sizes[j] - 1] != (unsigned char)j ||
+                pRtlSizeHeap( params->heap, 0, blocks[j] ) != sizes[j])
+                InterlockedIncrement( &params->errors );
+            if (!pRtlFreeHeap( params->heap, 0, blocks[j] )) InterlockedIncrement( &params->errors );
+            blocks[j] = NULL;
+        }
+        else
+        {
+            sizes[j] = 1 + (seed >> 8) % 512;
+            if (!(blocks[j] = pRtlAllocateHeap( params->heap, 0, sizes[j] )))
+            {
+                InterlockedIncrement( &params->errors );
+                continue;
+            }
+            memset( blocks[j], j, sizes[j] );
+        }
+    }
+    for (j = 0; j < STRESS_BLOCKS; j++) pRtlFreeHeap( params->heap, 0, blocks[j] );
+    return 0;
+}
+
+static void run_stress( HANDLE heap )
+{
+    struct stress_params params[STRESS_THREADS];
+    HANDLE threads[STRESS_THREADS];
+    PROCESS_HEAP_ENTRY entry;
+    unsigned int i;
+    NTSTATUS status;
+
+    for (i = 0; i < STRESS_THREADS; i++)
+    {
+        params[i].heap = heap;
+        params[i].loops = 20000;
+        params[i].seed = i + 1;
+        params[i].errors = 0;
+        threads[i] = CreateThread( NULL, 0, stress_thread, &params[i], 0, NULL );
+        ok( threads[i] != NULL, "CreateThread failed %u\n", GetLastError() );
+    }
+    WaitForMultipleObjects( STRESS_THREADS, threads, TRUE, INFINITE );
+
+    for (i = 0; i < STRESS_THREADS; i++)
+    {
+        ok( !params[i].errors, "thread %u: %d errors\n", i, params[i].errors );
+        CloseHandle( threads[i] );
+    }
+
+    ok( pRtlValidateHeap( heap, 0, NULL ), "RtlValidateHeap failed\n" );
+    memset( &entry, 0, sizeof(entry) );
+    while (!(status = pRtlWalkHeap( heap, &entry ))) ;
+    ok( status == STATUS_NO_MORE_ENTRIES, "RtlWalkHeap returned %08x\n", status );
+}
+
+static HANDLE create_lfh_heap(void)
+{
+    HANDLE heap;
+    ULONG info = 2;
+
+    heap = pRtlCreateHeap( HEAP_GROWABLE, NULL, 0, 0, NULL, NULL );
+    ok( heap != NULL, "RtlCreateHeap failed\n" );
+    if (pRtlSetHeapInformation &&
+        !pRtlSetHeapInformation( heap, HeapCompatibilityInformation, &info, sizeof(info) ))
+        return heap;
+    pRtlDestroyHeap( heap );
+    return NULL;
+}
+
+/* small blocks on a heap with the low fragmentation front end are mostly
+ * handled without the heap lock */
+static void test_heap_stress(void)
+{
+    HANDLE heap;
+
+    heap = pRtlCreateHeap( HEAP_GROWABLE, NULL, 0, 0, NULL, NULL );
+    ok( heap != NULL, "RtlCreateHeap failed\n" );
+    run_stress( heap );
+    pRtlDestroyHeap( heap );
+
+    if (!(heap = create_lfh_heap()))
+    {
+        win_skip( "low fragmentation heap not available\n" );
+        return;
+    }
+    run_stress( heap );
+    pRtlDestroyHeap( heap );
+}
+
+static DWORD WINAPI lock_thread( void *arg )
+{
+    HANDLE heap = arg;
+    void *ptr;
+
+    ptr = pRtlAllocateHeap( heap, 0, 100 );
+    pRtlFreeHeap( heap, 0, ptr );
+    return ptr != NULL;
+}
+
+/* threads refilling the front end wait for the heap lock, the thread
+ * owning it must still be able to allocate */
+static void test_heap_lock(void)
+{
+    HANDLE heap, threads[8];
+    void *ptrs[64];
+    unsigned int i;
+    DWORD ret;
+
+    if (!pRtlLockHeap || !pRtlUnlockHeap || !(heap = create_lfh_heap()))
+    {
+        win_skip( "low fragmentation heap not available\n" );
+        return;
+    }
+
+    ok( pRtlLockHeap( heap ), "RtlLockHeap failed\n" );
+    for (i = 0; i < 8; i++)
+    {
+        threads[i] = CreateThread( NULL, 0, lock_thread, heap, 0, NULL );
+        ok( threads[i] != NULL, "CreateThread failed %u\n", GetLastError() );
+    }
+    Sleep( 100 );
+    for (i = 0; i < 64; i++)
+    {
+        ptrs[i] = pRtlAllocateHeap( heap, 0, 100 );
+        ok( ptrs[i] != NULL, "RtlAllocateHeap failed\n" );
+    }
+    for (i = 0; i < 64; i++) ok( pRtlFreeHeap( heap, 0, ptrs[i] ), "RtlFreeHeap failed\n" );
+    ok( pRtlUnlockHeap( heap ), "RtlUnlockHeap failed\n" );
+
+    ret = WaitForMultipleObjects( 8, threads, TRUE, 5000 );
+    ok( ret == WAIT_OBJECT_0, "threads didn't finish, ret %u\n", ret );
+    for (i = 0; i < 8; i++)
+    {
+        GetExitCodeThread( threads[i], &ret );
+        ok( ret == 1, "thread %u failed to allocate\n", i );
+        CloseHandle( threads[i] );
+    }
+    ok( pRtlValidateHeap( heap, 0, NULL ), "RtlValidateHeap failed\n" );
+    pRtlDestroyHeap( heap );
+}
+
+static unsigned int count_heap_regions( HANDLE heap )
+{
+    PROCESS_HEAP_ENTRY entry;
+    unsigned int count = 0;
+
+    memset( &entry, 0, sizeof(entry) );
+    while (!pRtlWalkHeap( heap, &entry ))
+        if (entry.wFlags & PROCESS_HEAP_REGION) count++;
+    return count;
+}
+
+/* sub-heaps emptied through the front end are still released */
+static void test_heap_shrink(void)
+{
+    unsigned int i, count = 0x10000, regions;
+    HANDLE heap;
+    void **ptrs;
+
+    if (!(heap = create_lfh_heap()))
+    {
+        win_skip( "low fragmentation heap not available\n" );
+        return;
+    }
+
+    ptrs = pRtlAllocateHeap( GetProcessHeap(), 0, count * sizeof(*ptrs) );
+    for (i = 0; i < count; i++)
+    {
+        ptrs[i] = pRtlAllocateHeap( heap, 0, 256 );
+        ok( ptrs[i] != NULL, "RtlAllocateHeap failed\n" );
+        if (!ptrs[i]) break;
+    }
+    count = i;
+    regions = count_heap_regions( heap );
+    ok( regions > 2, "got %u regions\n", regions );
+
+    for (i = 0; i < count; i++) pRtlFreeHeap( heap, 0, ptrs[i] );
+    ok( count_heap_regions( heap ) < regions, "sub-heaps not released, %u regions left of %u\n",
+        count_heap_regions( heap ), regions );
+    ok( pRtlValidateHeap( heap, 0, NULL ), "RtlValidateHeap failed\n" );
+
+    pRtlFreeHeap( GetProcessHeap(), 0, ptrs );
+    pRtlDestroyHeap( heap );
+}
+
+START_TEST(heap)
+{
+    init_function_pointers();
+
+    test_heap_compatibility();
+    test_heap_statistics();
+    test_heap_stress();
+    test_heap_lock();
+    test_heap_shrink();
+}
@@ -69,6 +69,9 @@ static NTSTATUS (WINAPI *pNtWaitForKeyedEvent)( HANDLE, const void *, BOOLEAN, c
 static NTSTATUS (WINAPI *pNtReleaseKeyedEvent)( HANDLE, const void *, BOOLEAN, const LARGE_INTEGER * );
 static NTSTATUS (WINAPI *pNtCreateIoCompletion)(PHANDLE, ACCESS_MASK, POBJECT_ATTRIBUTES, ULONG);
 static NTSTATUS (WINAPI *pNtOpenIoCompletion)( PHANDLE, ACCESS_MASK, POBJECT_ATTRIBUTES );
+static NTSTATUS (WINAPI *pRtlWaitOnAddress)( const void *, const void *, SIZE_T, const LARGE_INTEGER * );
+static void     (WINAPI *pRtlWakeAddressAll)( const void * );
+static void     (WINAPI *pRtlWakeAddressSingle)( const void * );
 
 #define KEYEDEVENT_WAIT       0x0001
 #define KEYEDEVENT_WAKE       0x0002
@@ -1773,6 +1776,109 @@ static void test_keyed_events(void)
     NtClose( event );
 }
 
+static LONG address_value;
+static LONG address_wakes;
+
+static DWORD WINAPI address_wait_thread( void *arg )
+{
+    LONG loops = (LONG_PTR)arg, val, cmp;
+    NTSTATUS status;
+
+    /* wait for each increment, bounded so that a lost wake can't hang the test */
+    for (cmp = 0; cmp < loops; cmp = val)
+    {
+        while ((val = address_value) == cmp)
+        {
+            LARGE_INTEGER timeout;
+
+            timeout.QuadPart = -10000000;
+            status = pRtlWaitOnAddress( &address_value, &cmp, sizeof(cmp), &timeout );
+            if (status == STATUS_TIMEOUT && address_value == cmp) return 1;
+        }
+        InterlockedIncrement( &address_wakes );
+    }
+    return 0;
+}
+
+static void test_wait_on_address(void)
+{
+    unsigned int loops = 1000;
+    LARGE_INTEGER timeout;
+    HANDLE threads[4];
+    NTSTATUS status;
+    LONG64 val64;
+    DWORD ret;
+    SHORT val16;
+    LONG val;
+    unsigned int i;
+
+    if (!pRtlWaitOnAddress)
+    {
+        win_skip( "RtlWaitOnAddress not supported\n" );
+        return;
+    }
+
+    val = 0;
+    timeout.QuadPart = -10000;
+    status = pRtlWaitOnAddress( &address_value, &val, 3, &timeout );
+    ok( status == STATUS_INVALID_PARAMETER, "RtlWaitOnAddress returned %x\n", status );
+    status = pRtlWaitOnAddress( &address_value, &val, 16, &timeout );
+    ok( status == STATUS_INVALID_PARAMETER, "RtlWaitOnAddress returned %x\n", status );
+
+    /* values that differ return right away */
+    address_value = 1;
+    status = pRtlWaitOnAddress( &address_value, &val, sizeof(val), NULL );
+    ok( status == STATUS_SUCCESS, "RtlWaitOnAddress returned %x\n", status );
+    val64 = 0;
+    status = pRtlWaitOnAddress( &val64, &address_value, sizeof(val64), NULL );
+    ok( status == STATUS_SUCCESS, "RtlWaitOnAddress returned %x\n", status );
+
+    address_value = 0;
+    status = pRtlWaitOnAddress( &address_value, &val, sizeof(val), &timeout );
+    ok( status == STATUS_TIMEOUT, "RtlWaitOnAddress returned %x\n", status );
+    val16 = 0;
+    status = pRtlWaitOnAddress( &val16, &val16, sizeof(val16), &timeout );
+    ok( status == STATUS_TIMEOUT, "RtlWaitOnAddress returned %x\n", status );
+    timeout.QuadPart = 0;
+    status = pRtlWaitOnAddress( &val64, &val64, sizeof(val64), &timeout );
+    ok( status == STATUS_TIMEOUT, "RtlWaitOnAddress returned %x\n", status );
+
+    /* wakes without waiters are harmless */
+    pRtlWakeAddressSingle( &address_value );
+    pRtlWakeAddressAll( &address_value );
+
+    threads[0] = CreateThread( NULL, 0, address_wait_thread, (void *)1, 0, NULL );
+    Sleep( 50 );
+    InterlockedIncrement( &address_value );
+    pRtlWakeAddressSingle( &address_value );
+    ret = WaitForSingleObject( threads[0], 5000 );
+    ok( ret == WAIT_OBJECT_0, "WaitForSingleObject returned %u\n", ret );
+    GetExitCodeThread( threads[0], &ret );
+    ok( !ret, "thread missed the wake\n" );
+    CloseHandle( threads[0] );
+
+    /* threads woken up for each increment */
+    address_value = 0;
+    address_wakes = 0;
+    for (i = 0; i < 4; i++)
+        threads[i] = CreateThread( NULL, 0, address_wait_thread, (void *)(LONG_PTR)loops, 0, NULL );
+    for (i = 0; i < loops; i++)
+    {
+        InterlockedIncrement( &address_value );
+        pRtlWakeAddressAll( &address_value );
+        if (!(i % 64)) Sleep( 0 );
+    }
+    ret = WaitForMultipleObjects( 4, threads, TRUE, 30000 );
+    ok( ret == WAIT_OBJECT_0, "WaitForMultipleObjects returned %u\n", ret );
+    for (i = 0; i < 4; i++)
+    {
+        GetExitCodeThread( threads[i], &ret );
+        ok( !ret, "thread %u missed a wake\n", i );
+        CloseHandle( threads[i] );
+    }
+    ok( address_wakes >= 4 && address_wakes <= 4 * loops, "got %d values seen\n", address_wakes );
+}
+
 static void test_null_device(void)
 {
     OBJECT_ATTRIBUTES attr;
@@ -2031,6 +2137,9 @@ START_TEST(om)
     pNtReleaseKeyedEvent    =  (void *)GetProcAddress(hntdll, "NtReleaseKeyedEvent");
     pNtCreateIoCompletion   =  (void *)GetProcAddress(hntdll, "NtCreateIoCompletion");
     pNtOpenIoCompletion     =  (void *)GetProcAddress(hntdll, "NtOpenIoCompletion");
+    pRtlWaitOnAddress       =  (void *)GetProcAddress(hntdll, "RtlWaitOnAddress");
+    pRtlWakeAddressAll      =  (void *)GetProcAddress(hntdll, "RtlWakeAddressAll");
+    pRtlWakeAddressSingle   =  (void *)GetProcAddress(hntdll, "RtlWakeAddressSingle");
 
     test_case_sensitive();
     test_namespace_pipe();
@@ -2043,5 +2152,6 @@ START_TEST(om)
     test_event();
     test_mutant();
     test_keyed_events();
+    test_wait_on_address();
     test_null_device();
 }
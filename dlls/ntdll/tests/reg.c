@@ -823,6 +823,161 @@ static void test_NtQueryValueKey(void)
     pNtClose(key);
 }
 
+/* values cached through one handle have to reflect changes made through another one */
+static void test_value_cache(void)
+{
+    KEY_VALUE_PARTIAL_INFORMATION *info;
+    OBJECT_ATTRIBUTES attr;
+    UNICODE_STRING name;
+    HANDLE key1, key2;
+    NTSTATUS status;
+    char buffer[64];
+    DWORD data, len;
+
+    info = (KEY_VALUE_PARTIAL_INFORMATION *)buffer;
+    pRtlCreateUnicodeStringFromAsciiz(&name, "cachetest");
+
+    InitializeObjectAttributes(&attr, &winetestpath, 0, 0, 0);
+    status = pNtOpenKey(&key1, KEY_READ, &attr);
+    ok(status == STATUS_SUCCESS, "NtOpenKey Failed: 0x%08x\n", status);
+    status = pNtOpenKey(&key2, KEY_READ|KEY_SET_VALUE, &attr);
+    ok(status == STATUS_SUCCESS, "NtOpenKey Failed: 0x%08x\n", status);
+
+    status = pNtQueryValueKey(key1, &name, KeyValuePartialInformation, info, sizeof(buffer), &len);
+    ok(status == STATUS_OBJECT_NAME_NOT_FOUND, "NtQueryValueKey returned 0x%08x\n", status);
+
+    data = 1;
+    status = pNtSetValueKey(key2, &name, 0, REG_DWORD, &data, sizeof(data));
+    ok(status == STATUS_SUCCESS, "NtSetValueKey Failed: 0x%08x\n", status);
+    status = pNtQueryValueKey(key1, &name, KeyValuePartialInformation, info, sizeof(buffer), &len);
+    ok(status == STATUS_SUCCESS, "NtQueryValueKey returned 0x%08x\n", status);
+    ok(*(DWORD *)info->Data == 1, "got %u\n", *(DWORD *)info->Data);
+    status = pNtQueryValueKey(key1, &name, KeyValuePartialInformation, info, sizeof(buffer), &len);
+    ok(status == STATUS_SUCCESS, "NtQueryValueKey returned 0x%08x\n", status);
+    ok(*(DWORD *)info->Data == 1, "got %u\n", *(DWORD *)info->Data);
+
+    data = 2;
+    status = pNtSetValueKey(key2, &name, 0, REG_DWORD, &data, sizeof(data));
+    ok(status == STATUS_SUCCESS, "NtSetValueKey Failed: 0x%08x\n", status);
+    status = pNtQueryValueKey(key1, &name, KeyValuePartialInformation, info, sizeof(buffer), &len);
+    ok(status == STATUS_SUCCESS, "NtQueryValueKey returned 0x%08x\n", status);
+    ok(*(DWORD *)info->Data == 2, "got %u\n", *(DWORD *)info->Data);
+
+    status = pNtDeleteValueKey(key2, &name);
+    ok(status == STATUS_SUCCESS, "NtDeleteValueKey Failed: 0x%08x\n", status);
+    status = pNtQueryValueKey(key1, &name, KeyValuePartialInformation, info, sizeof(buffer), &len);
+    ok(status == STATUS_OBJECT_NAME_NOT_FOUND, "NtQueryValueKey returned 0x%08x\n", status);
+
+    pNtClose(key1);
+    pNtClose(key2);
+    pRtlFreeUnicodeString(&name);
+}
+
+/* keys with many subkeys and values get a hash index in the server */
+static void test_large_key(void)
+{
+    static const char *fmt[] = { "key%05u", "KEY%05u" };
+    KEY_FULL_INFORMATION full_info;
+    unsigned int i, count = 1000;
+    OBJECT_ATTRIBUTES attr;
+    UNICODE_STRING str;
+    HANDLE parent, key;
+    NTSTATUS status;
+    char name[16];
+    DWORD len;
+
+    pRtlCreateUnicodeStringFromAsciiz( &str, "LargeKey" );
+    InitializeObjectAttributes( &attr, &winetestpath, 0, 0, 0 );
+    status = pNtOpenKey( &key, KEY_ALL_ACCESS, &attr );
+    ok( status == STATUS_SUCCESS, "NtOpenKey failed: 0x%08x\n", status );
+    InitializeObjectAttributes( &attr, &str, 0, key, 0 );
+    status = pNtCreateKey( &parent, KEY_ALL_ACCESS, &attr, 0, 0, 0, 0 );
+    ok( status == STATUS_SUCCESS, "NtCreateKey failed: 0x%08x\n", status );
+    pNtClose( key );
+    pRtlFreeUnicodeString( &str );
+
+    /* create in an order unrelated to the sorted order */
+    for (i = 0; i < count; i++)
+    {
+        sprintf( name, fmt[0], (i * 7919) % count );
+        pRtlCreateUnicodeStringFromAsciiz( &str, name );
+        InitializeObjectAttributes( &attr, &str, 0, parent, 0 );
+        status = pNtCreateKey( &key, KEY_ALL_ACCESS, &attr, 0, 0, 0, 0 );
+        ok( status == STATUS_SUCCESS, "NtCreateKey %s failed: 0x%08x\n", name, status );
+        pNtClose( key );
+        pRtlFreeUnicodeString( &str );
+    }
+
+    status = pNtQueryKey( parent, KeyFullInformation, &full_info, sizeof(full_info), &len );
+    ok( status == STATUS_SUCCESS, "NtQueryKey failed: 0x%08x\n", status );
+    ok( full_info.SubKeys == count, "got %u subkeys\n", full_info.SubKeys );
+
+    for (i = 0; i < count; i++)
+    {
+        sprintf( name, fmt[i & 1], i );
+        pRtlCreateUnicodeStringFromAsciiz( &str, name );
+        InitializeObjectAttributes( &attr, &str, 0, parent, 0 );
+        status = pNtOpenKey( &key, KEY_READ, &attr );
+        ok( status == STATUS_SUCCESS, "NtOpenKey %s failed: 0x%08x\n", name, status );
+        pNtClose( key );
+        pRtlFreeUnicodeString( &str );
+    }
+
+    pRtlCreateUnicodeStringFromAsciiz( &str, "nokey" );
+    InitializeObjectAttributes( &attr, &str, 0, parent, 0 );
+    status = pNtOpenKey( &key, KEY_READ, &attr );
+    ok( status == STATUS_OBJECT_NAME_NOT_FOUND, "NtOpenKey returned 0x%08x\n", status );
+    pRtlFreeUnicodeString( &str );
+
+    for (i = 0; i < count; i++)
+    {
+        sprintf( name, fmt[0], (i * 7919) % count );
+        pRtlCreateUnicodeStringFromAsciiz( &str, name );
+        status = pNtSetValueKey( parent, &str, 0, REG_DWORD, &i, sizeof(i) );
+        ok( status == STATUS_SUCCESS, "NtSetValueKey %s failed: 0x%08x\n", name, status );
+        pRtlFreeUnicodeString( &str );
+    }
+    for (i = 0; i < count; i++)
+    {
+        KEY_VALUE_PARTIAL_INFORMATION *info;
+        char buffer[32];
+
+        info = (KEY_VALUE_PARTIAL_INFORMATION *)buffer;
+        sprintf( name, fmt[i & 1], (i * 7919) % count );
+        pRtlCreateUnicodeStringFromAsciiz( &str, name );
+        status = pNtQueryValueKey( parent, &str, KeyValuePartialInformation, info, sizeof(buffer), &len );
+        ok( status == STATUS_SUCCESS, "NtQueryValueKey %s failed: 0x%08x\n", name, status );
+        ok( *(DWORD *)info->Data == i, "%s: got %u\n", name, *(DWORD *)info->Data );
+        if (i % 2)
+        {
+            status = pNtDeleteValueKey( parent, &str );
+            ok( status == STATUS_SUCCESS, "NtDeleteValueKey %s failed: 0x%08x\n", name, status );
+        }
+        pRtlFreeUnicodeString( &str );
+    }
+
+    status = pNtQueryKey( parent, KeyFullInformation, &full_info, sizeof(full_info), &len );
+    ok( status == STATUS_SUCCESS, "NtQueryKey failed: 0x%08x\n", status );
+    ok( full_info.Values == (count + 1) / 2, "got %u values\n", full_info.Values );
+
+    for (i = 0; i < count; i++)
+    {
+        sprintf( name, fmt[1], (i * 7919) % count );
+        pRtlCreateUnicodeStringFromAsciiz( &str, name );
+        InitializeObjectAttributes( &attr, &str, 0, parent, 0 );
+        status = pNtOpenKey( &key, DELETE, &attr );
+        ok( status == STATUS_SUCCESS, "NtOpenKey %s failed: 0x%08x\n", name, status );
+        status = pNtDeleteKey( key );
+        ok( status == STATUS_SUCCESS, "NtDeleteKey %s failed: 0x%08x\n", name, status );
+        pNtClose( key );
+        pRtlFreeUnicodeString( &str );
+    }
+
+    status = pNtDeleteKey( parent );
+    ok( status == STATUS_SUCCESS, "NtDeleteKey failed: 0x%08x\n", status );
+    pNtClose( parent );
+}
+
 static void test_NtDeleteKey(void)
 {
     NTSTATUS status;
@@ -1950,6 +2105,8 @@ START_TEST(reg)
     test_NtQueryKey();
     test_NtQueryLicenseKey();
     test_NtQueryValueKey();
+    test_value_cache();
+    test_large_key();
     test_long_value_name();
     test_notify();
     test_NtDeleteKey();
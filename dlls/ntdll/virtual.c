@@ -119,6 +119,34 @@ static RTL_CRITICAL_SECTION_DEBUG critsect_debug =
 };
 static RTL_CRITICAL_SECTION csVirtual = { &critsect_debug, -1, 0, 0, 0, 0 };
 
+/* Threads that only look at the views and page protections take the lock
+ * shared: they register in virtual_readers, and only fall back to taking
+ * csVirtual when a thread owns it exclusively. Exclusive owners wait for the
+ * registered readers to leave once they hold csVirtual. Shared owners must
+ * not access application memory; the only faults they can get are on their
+ * own stack guard pages. */
+static int virtual_readers;
+static int virtual_writer;
+
+/* Free ranges: tree of the gaps between views sorted by address, so that
+ * finding free space doesn't have to walk all the views. Each entry also
+ * stores the largest free area of its subtree, to skip the subtrees that are
+ * too small. Views allocated next to each other don't add any entry.
+ * Protected by the exclusive lock. */
+struct range_entry
+{
+    struct wine_rb_entry entry;
+    char                *base;
+    char                *end;
+    size_t               max_size;     /* largest range in the subtree */
+    size_t               max_aligned;  /* largest 64K-aligned area in the subtree */
+};
+
+static struct wine_rb_tree free_ranges;
+static BOOL free_ranges_valid;  /* FALSE if an entry couldn't be allocated */
+static struct range_entry *range_block_start, *range_block_end, *next_free_range;
+static const size_t range_block_size = 0x10000;
+
 #ifdef __i386__
 static const UINT page_shift = 12;
 static const UINT_PTR page_mask = 0xfff;
@@ -266,6 +294,87 @@ static BOOL alloc_pages_vprot( const void *addr, size_t size )
 }
 
 
+/***********************************************************************
+ *           virtual_lock_exclusive
+ *
+ * Take the lock for changing the views or the page protections. No signal
+ * masking is done if sigset is NULL.
+ */
+static void virtual_lock_exclusive( sigset_t *sigset )
+{
+    if (sigset) pthread_sigmask( SIG_BLOCK, &server_block_set, sigset );
+
+    /* a fault inside a shared section of the same thread, writers already wait for it */
+    if (ntdll_get_thread_data()->virtual_shared) return;
+
+    RtlEnterCriticalSection( &csVirtual );
+    if (csVirtual.RecursionCount > 1) return;
+    interlocked_xchg( &virtual_writer, 1 );
+    /* The wait is bounded: no new reader registers once virtual_writer is set,
+     * and the shared sections only walk the views or the page protections,
+     * without blocking or calling the server. Yielding lets a preempted reader
+     * run on a busy CPU. */
+    while (*(volatile int *)&virtual_readers) NtYieldExecution();
+}
+
+
+/***********************************************************************
+ *           virtual_unlock_exclusive
+ */
+static void virtual_unlock_exclusive( sigset_t *sigset )
+{
+    if (!ntdll_get_thread_data()->virtual_shared)
+    {
+        if (csVirtual.RecursionCount == 1) interlocked_xchg( &virtual_writer, 0 );
+        RtlLeaveCriticalSection( &csVirtual );
+    }
+
+    if (sigset) pthread_sigmask( SIG_SETMASK, sigset, NULL );
+}
+
+
+/***********************************************************************
+ *           virtual_lock_shared
+ *
+ * Take the lock for looking at the views and the page protections.
+ * Returns TRUE if csVirtual had to be taken because of an exclusive owner.
+ */
+static BOOL virtual_lock_shared( sigset_t *sigset )
+{
+    struct ntdll_thread_data *thread_data = ntdll_get_thread_data();
+
+    pthread_sigmask( SIG_BLOCK, &server_block_set, sigset );
+
+    interlocked_xchg_add( &virtual_readers, 1 );
+    /* a nested shared section must not wait for a writer that waits for the outer one */
+    if (thread_data->virtual_shared || !*(volatile int *)&virtual_writer)
+    {
+        thread_data->virtual_shared++;
+        return FALSE;
+    }
+    interlocked_xchg_add( &virtual_readers, -1 );
+
+    RtlEnterCriticalSection( &csVirtual );
+    return TRUE;
+}
+
+
+/***********************************************************************
+ *           virtual_unlock_shared
+ */
+static void virtual_unlock_shared( sigset_t *sigset, BOOL exclusive )
+{
+    if (exclusive) RtlLeaveCriticalSection( &csVirtual );
+    else
+    {
+        ntdll_get_thread_data()->virtual_shared--;
+        interlocked_xchg_add( &virtual_readers, -1 );
+    }
+
+    pthread_sigmask( SIG_SETMASK, sigset, NULL );
+}
+
+
 /***********************************************************************
  *           compare_view
  *
@@ -365,12 +474,12 @@ static void VIRTUAL_Dump(void)
     struct file_view *view;
 
     TRACE( "Dump of all virtual memory views:\n" );
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    virtual_lock_exclusive( &sigset );
     WINE_RB_FOR_EACH_ENTRY( view, &views_tree, struct file_view, entry )
     {
         VIRTUAL_DumpView( view );
     }
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    virtual_unlock_exclusive( &sigset );
 }
 #endif
 
@@ -450,6 +559,335 @@ static struct file_view *find_view_range( const void *addr, size_t size )
 }
 
 
+/***********************************************************************
+ *           compare_free_range
+ */
+static int compare_free_range( const void *addr, const struct wine_rb_entry *entry )
+{
+    struct range_entry *range = WINE_RB_ENTRY_VALUE( entry, struct range_entry, entry );
+
+    if ((const char *)addr < range->base) return -1;
+    if ((const char *)addr > range->base) return 1;
+    return 0;
+}
+
+
+/***********************************************************************
+ *           alloc_range_entry
+ *
+ * Allocate a free range entry. The csVirtual section must be held by caller.
+ */
+static struct range_entry *alloc_range_entry(void)
+{
+    if (next_free_range)
+    {
+        struct range_entry *ret = next_free_range;
+        next_free_range = *(struct range_entry **)ret;
+        return ret;
+    }
+    if (range_block_start == range_block_end)
+    {
+        void *ptr = wine_anon_mmap( NULL, range_block_size, PROT_READ | PROT_WRITE, 0 );
+        if (ptr == (void *)-1) return NULL;
+        range_block_start = ptr;
+        range_block_end = range_block_start + range_block_size / sizeof(*range_block_start);
+    }
+    return range_block_start++;
+}
+
+
+/***********************************************************************
+ *           free_range_entry
+ *
+ * Release a free range entry. The csVirtual section must be held by caller.
+ */
+static void free_range_entry( struct range_entry *range )
+{
+    *(struct range_entry **)range = next_free_range;
+    next_free_range = range;
+}
+
+
+/***********************************************************************
+ *           free_range_max
+ *
+ * Size of the largest free area with the given alignment in the subtree of a range.
+ * This is exact for 64K and page alignment, and an upper bound otherwise.
+ */
+static inline size_t free_range_max( const struct range_entry *range, size_t mask )
+{
+    return mask >= 0xffff ? range->max_aligned : range->max_size;
+}
+
+
+/***********************************************************************
+ *           free_range_update
+ *
+ * Recompute the largest sizes of a range subtree from its children.
+ */
+static void free_range_update( struct wine_rb_entry *entry )
+{
+    struct range_entry *range = WINE_RB_ENTRY_VALUE( entry, struct range_entry, entry ), *child;
+    char *start = ROUND_ADDR( range->base + 0xffff, 0xffff );
+
+    range->max_size = range->end - range->base;
+    range->max_aligned = (start >= range->base && start < range->end) ? range->end - start : 0;
+    if (entry->left)
+    {
+        child = WINE_RB_ENTRY_VALUE( entry->left, struct range_entry, entry );
+        range->max_size = max( range->max_size, child->max_size );
+        range->max_aligned = max( range->max_aligned, child->max_aligned );
+    }
+    if (entry->right)
+    {
+        child = WINE_RB_ENTRY_VALUE( entry->right, struct range_entry, entry );
+        range->max_size = max( range->max_size, child->max_size );
+        range->max_aligned = max( range->max_aligned, child->max_aligned );
+    }
+}
+
+
+/***********************************************************************
+ *           free_ranges_update_path
+ *
+ * Recompute the largest sizes from an entry up to the root after the entry
+ * was changed, inserted, or removed from below it. The tree rotations of an
+ * insertion or a removal only move nodes that end up on that path or as
+ * direct children of it, so refreshing the children of each node on the way
+ * up is enough and the tree doesn't need rotation callbacks.
+ */
+static void free_ranges_update_path( struct wine_rb_entry *entry )
+{
+    for ( ; entry; entry = entry->parent)
+    {
+        if (entry->left) free_range_update( entry->left );
+        if (entry->right) free_range_update( entry->right );
+        free_range_update( entry );
+    }
+}
+
+
+/***********************************************************************
+ *           free_ranges_add
+ *
+ * Add a new free range. Returns FALSE when out of memory.
+ * The csVirtual section must be held by caller.
+ */
+static BOOL free_ranges_add( char *base, char *end )
+{
+    struct range_entry *range;
+
+    if (!(range = alloc_range_entry()))
+    {
+        ERR( "out of memory for free range %p-%p\n", base, end );
+        free_ranges_valid = FALSE;
+        return FALSE;
+    }
+    range->base = base;
+    range->end = end;
+    wine_rb_put( &free_ranges, base, &range->entry );
+    free_ranges_update_path( &range->entry );
+    return TRUE;
+}
+
+
+/***********************************************************************
+ *           free_ranges_delete
+ *
+ * Remove a free range. The csVirtual section must be held by caller.
+ */
+static void free_ranges_delete( struct range_entry *range )
+{
+    struct wine_rb_entry *entry = &range->entry, *parent = entry->parent;
+
+    /* find the lowest node whose subtree changes, see wine_rb_remove */
+    if (entry->left && entry->right)
+    {
+        struct wine_rb_entry *next = entry->right;
+        while (next->left) next = next->left;
+        parent = (next->parent == entry) ? next : next->parent;
+    }
+    wine_rb_remove( &free_ranges, entry );
+    free_ranges_update_path( parent );
+    free_range_entry( range );
+}
+
+
+/***********************************************************************
+ *           free_ranges_lower_bound
+ *
+ * Find the first free range ending after the given address.
+ */
+static struct range_entry *free_ranges_lower_bound( const void *addr )
+{
+    struct wine_rb_entry *ptr = free_ranges.root;
+    struct range_entry *range, *ret = NULL;
+
+    while (ptr)
+    {
+        range = WINE_RB_ENTRY_VALUE( ptr, struct range_entry, entry );
+        if (range->end > (const char *)addr)
+        {
+            ret = range;
+            ptr = ptr->left;
+        }
+        else ptr = ptr->right;
+    }
+    return ret;
+}
+
+
+/***********************************************************************
+ *           free_ranges_next
+ */
+static inline struct range_entry *free_ranges_next( struct range_entry *range )
+{
+    struct wine_rb_entry *next = wine_rb_next( &range->entry );
+    return next ? WINE_RB_ENTRY_VALUE( next, struct range_entry, entry ) : NULL;
+}
+
+
+/***********************************************************************
+ *           free_ranges_insert_view
+ *
+ * Remove the space of a new view from the free ranges.
+ * The csVirtual section must be held by caller.
+ */
+static void free_ranges_insert_view( struct file_view *view )
+{
+    char *base = view->base, *end = base + view->size;
+    struct range_entry *range, *next;
+
+    if (!free_ranges_valid) return;
+
+    range = free_ranges_lower_bound( base );
+    while (range && range->base < end)
+    {
+        next = free_ranges_next( range );
+        if (range->base < base)
+        {
+            if (range->end > end)  /* split the range */
+            {
+                char *range_end = range->end;
+                range->end = base;
+                free_ranges_update_path( &range->entry );
+                free_ranges_add( end, range_end );
+                return;
+            }
+            range->end = base;
+            free_ranges_update_path( &range->entry );
+        }
+        else if (range->end > end)
+        {
+            range->base = end;  /* this doesn't change the order of the tree */
+            free_ranges_update_path( &range->entry );
+            return;
+        }
+        else free_ranges_delete( range );  /* the whole range is covered */
+        range = next;
+    }
+}
+
+
+/***********************************************************************
+ *           free_ranges_remove_view
+ *
+ * Give back the space of a view that is being deleted to the free ranges,
+ * merging it with the gaps around it. The view must still be in the tree.
+ * The csVirtual section must be held by caller.
+ */
+static void free_ranges_remove_view( struct file_view *view )
+{
+    struct wine_rb_entry *prev = wine_rb_prev( &view->entry ), *next = wine_rb_next( &view->entry );
+    char *base = NULL, *end = (char *)~(UINT_PTR)0;
+    struct range_entry *range, *next_range;
+
+    if (!free_ranges_valid) return;
+
+    if (prev)
+    {
+        struct file_view *prev_view = WINE_RB_ENTRY_VALUE( prev, struct file_view, entry );
+        base = (char *)prev_view->base + prev_view->size;
+    }
+    if (next)
+    {
+        struct file_view *next_view = WINE_RB_ENTRY_VALUE( next, struct file_view, entry );
+        end = next_view->base;
+    }
+
+    /* the gaps on both sides of the view are replaced by a single range */
+    range = free_ranges_lower_bound( base );
+    if (!range || range->base >= end)
+    {
+        free_ranges_add( base, end );
+        return;
+    }
+    while ((next_range = free_ranges_next( range )) && next_range->base < end)
+        free_ranges_delete( next_range );
+    range->base = base;
+    range->end = end;
+    free_ranges_update_path( &range->entry );
+}
+
+
+/***********************************************************************
+ *           free_range_fit
+ *
+ * Find the lowest (resp. highest) suitable address inside a free range
+ * clipped to the specified range.
+ */
+static void *free_range_fit( const struct range_entry *range, char *base, char *end,
+                             size_t size, size_t mask, int top_down )
+{
+    char *start, *range_base = max( range->base, base ), *range_end = min( range->end, end );
+
+    if (range_end <= range_base || (size_t)(range_end - range_base) < size) return NULL;
+    if (top_down)
+    {
+        start = ROUND_ADDR( range_end - size, mask );
+        if (start < range_base) return NULL;
+    }
+    else
+    {
+        start = ROUND_ADDR( range_base + mask, mask );
+        if (start < range_base || start > range_end - size) return NULL;
+    }
+    return start;
+}
+
+
+/***********************************************************************
+ *           find_free_range
+ *
+ * Find a free area inside the specified range using the free ranges.
+ * Subtrees without a large enough range are skipped, so this only descends
+ * into the subtrees that can contain the result or overlap the range limits.
+ * The csVirtual section must be held by caller.
+ */
+static void *find_free_range( struct wine_rb_entry *ptr, char *base, char *end,
+                              size_t size, size_t mask, int top_down )
+{
+    struct range_entry *range;
+    void *start;
+
+    while (ptr)
+    {
+        range = WINE_RB_ENTRY_VALUE( ptr, struct range_entry, entry );
+        if (free_range_max( range, mask ) < size) return NULL;
+        if (range->end <= base) ptr = ptr->right;
+        else if (range->base >= end) ptr = ptr->left;
+        else
+        {
+            if ((start = find_free_range( top_down ? ptr->right : ptr->left, base, end, size, mask, top_down )))
+                return start;
+            if ((start = free_range_fit( range, base, end, size, mask, top_down ))) return start;
+            ptr = top_down ? ptr->left : ptr->right;
+        }
+    }
+    return NULL;
+}
+
+
 /***********************************************************************
  *           find_free_area
  *
@@ -461,6 +899,8 @@ static void *find_free_area( void *base, void *end, size_t size, size_t mask, in
     struct wine_rb_entry *first = NULL, *ptr = views_tree.root;
     void *start;
 
+    if (free_ranges_valid) return find_free_range( free_ranges.root, base, end, size, mask, top_down );
+
     /* find the first (resp. last) view inside the range */
     while (ptr)
     {
@@ -686,6 +1126,7 @@ static void delete_view( struct file_view *view ) /* [in] View */
 {
     if (!(view->protect & VPROT_SYSTEM)) unmap_area( view->base, view->size );
     set_page_vprot( view->base, view->size, 0 );
+    free_ranges_remove_view( view );
     wine_rb_remove( &views_tree, &view->entry );
     *(struct file_view **)view = next_free_view;
     next_free_view = view;
@@ -733,6 +1174,7 @@ static NTSTATUS create_view( struct file_view **view_ret, void *base, size_t siz
     set_page_vprot( base, size, vprot );
 
     wine_rb_put( &views_tree, view->base, &view->entry );
+    free_ranges_insert_view( view );
 
     *view_ret = view;
 
@@ -1384,7 +1826,7 @@ static NTSTATUS map_image( HANDLE hmapping, ACCESS_MASK access, int fd, SIZE_T m
 
     /* zero-map the whole range */
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    virtual_lock_exclusive( &sigset );
 
     if (base >= (char *)address_space_start)  /* make sure the DOS area remains free */
         status = map_view( &view, base, total_size, mask, FALSE, SEC_IMAGE | SEC_FILE |
@@ -1586,7 +2028,7 @@ static NTSTATUS map_image( HANDLE hmapping, ACCESS_MASK access, int fd, SIZE_T m
     if (status) goto error;
 
     VIRTUAL_DEBUG_DUMP_VIEW( view );
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    virtual_unlock_exclusive( &sigset );
 
     *addr_ptr = ptr;
 #ifdef VALGRIND_LOAD_PDB_DEBUGINFO
@@ -1597,7 +2039,7 @@ static NTSTATUS map_image( HANDLE hmapping, ACCESS_MASK access, int fd, SIZE_T m
 
  error:
     if (view) delete_view( view );
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    virtual_unlock_exclusive( &sigset );
     return status;
 }
 
@@ -1708,7 +2150,7 @@ NTSTATUS virtual_map_section( HANDLE handle, PVOID *addr_ptr, ULONG zero_bits, S
 
     /* Reserve a properly aligned area */
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    virtual_lock_exclusive( &sigset );
 
     get_vprot_flags( protect, &vprot, sec_flags & SEC_IMAGE );
     vprot |= sec_flags;
@@ -1716,7 +2158,7 @@ NTSTATUS virtual_map_section( HANDLE handle, PVOID *addr_ptr, ULONG zero_bits, S
     res = map_view( &view, *addr_ptr, size, mask, FALSE, vprot );
     if (res)
     {
-        server_leave_uninterrupted_section( &csVirtual, &sigset );
+        virtual_unlock_exclusive( &sigset );
         goto done;
     }
 
@@ -1751,7 +2193,7 @@ NTSTATUS virtual_map_section( HANDLE handle, PVOID *addr_ptr, ULONG zero_bits, S
         delete_view( view );
     }
 
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    virtual_unlock_exclusive( &sigset );
 
 done:
     if (needs_close) close( unix_handle );
@@ -1832,6 +2274,10 @@ void virtual_init(void)
     pages_vprot = (void *)((char *)alloc_views.base + view_block_size);
     wine_rb_init( &views_tree, compare_view );
 
+    wine_rb_init( &free_ranges, compare_free_range );
+    free_ranges_valid = TRUE;
+    free_ranges_add( NULL, (char *)~(UINT_PTR)0 );
+
     /* make the DOS area accessible (except the low 64K) to hide bugs in broken apps like Excel 2003 */
     size = (char *)address_space_start - (char *)0x10000;
     if (size && wine_mmap_is_in_reserved_area( (void*)0x10000, size ) == 1)
@@ -1894,7 +2340,7 @@ NTSTATUS virtual_create_builtin_view( void *module )
 
     size = ROUND_SIZE( module, size );
     base = ROUND_ADDR( module, page_mask );
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    virtual_lock_exclusive( &sigset );
     status = create_view( &view, base, size, SEC_IMAGE | SEC_FILE | VPROT_SYSTEM |
                           VPROT_COMMITTED | VPROT_READ | VPROT_WRITECOPY | VPROT_EXEC );
     if (!status)
@@ -1916,7 +2362,7 @@ NTSTATUS virtual_create_builtin_view( void *module )
         }
         VIRTUAL_DEBUG_DUMP_VIEW( view );
     }
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    virtual_unlock_exclusive( &sigset );
     return status;
 }
 
@@ -1943,7 +2389,7 @@ NTSTATUS virtual_alloc_thread_stack( TEB *teb, SIZE_T reserve_size, SIZE_T commi
     size = (size + 0xffff) & ~0xffff;  /* round to 64K boundary */
     if (pthread_size) *pthread_size = extra_size = max( page_size, ROUND_SIZE( 0, *pthread_size ));
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    virtual_lock_exclusive( &sigset );
 
     if ((status = map_view( &view, NULL, size + extra_size, 0xffff, 0,
                             VPROT_READ | VPROT_WRITE | VPROT_COMMITTED )) != STATUS_SUCCESS)
@@ -1982,7 +2428,7 @@ NTSTATUS virtual_alloc_thread_stack( TEB *teb, SIZE_T reserve_size, SIZE_T commi
     teb->Tib.StackBase     = (char *)view->base + view->size;
     teb->Tib.StackLimit    = (char *)view->base + 2 * page_size;
 done:
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    virtual_unlock_exclusive( &sigset );
     return status;
 }
 
@@ -2010,9 +2456,24 @@ NTSTATUS virtual_handle_fault( LPCVOID addr, DWORD err, BOOL on_signal_stack )
     NTSTATUS ret = STATUS_ACCESS_VIOLATION;
     void *page = ROUND_ADDR( addr, page_mask );
     sigset_t sigset;
+    BOOL exclusive;
     BYTE vprot;
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    /* most faults are plain access violations that don't change anything */
+    exclusive = virtual_lock_shared( &sigset );
+    vprot = get_page_vprot( page );
+    if ((on_signal_stack || !(vprot & VPROT_GUARD)) &&
+        (!(err & EXCEPTION_WRITE_FAULT) || !(vprot & VPROT_WRITEWATCH)))
+    {
+        if ((err & EXCEPTION_WRITE_FAULT) && (VIRTUAL_GetUnixProt( vprot ) & PROT_WRITE) &&
+            is_write_watch_range( page, page_size ))
+            ret = STATUS_SUCCESS;
+        virtual_unlock_shared( &sigset, exclusive );
+        return ret;
+    }
+    virtual_unlock_shared( &sigset, exclusive );
+
+    virtual_lock_exclusive( &sigset );
     vprot = get_page_vprot( page );
     if (!on_signal_stack && (vprot & VPROT_GUARD))
     {
@@ -2034,7 +2495,7 @@ NTSTATUS virtual_handle_fault( LPCVOID addr, DWORD err, BOOL on_signal_stack )
                 ret = STATUS_SUCCESS;
         }
     }
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    virtual_unlock_exclusive( &sigset );
     return ret;
 }
 
@@ -2077,13 +2538,13 @@ unsigned int virtual_locked_server_call( void *req_ptr )
 
     if (!size) return wine_server_call( req_ptr );
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    virtual_lock_exclusive( &sigset );
     if (!(ret = check_write_access( addr, size, &has_write_watch )))
     {
         ret = server_call_unlocked( req );
         if (has_write_watch) update_write_watches( addr, size, wine_server_reply_size( req ));
     }
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    virtual_unlock_exclusive( &sigset );
     return ret;
 }
 
@@ -2100,14 +2561,14 @@ ssize_t virtual_locked_read( int fd, void *addr, size_t size )
     ssize_t ret = read( fd, addr, size );
     if (ret != -1 || errno != EFAULT) return ret;
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    virtual_lock_exclusive( &sigset );
     if (!check_write_access( addr, size, &has_write_watch ))
     {
         ret = read( fd, addr, size );
         err = errno;
         if (has_write_watch) update_write_watches( addr, size, max( 0, ret ));
     }
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    virtual_unlock_exclusive( &sigset );
     errno = err;
     return ret;
 }
@@ -2125,14 +2586,14 @@ ssize_t virtual_locked_pread( int fd, void *addr, size_t size, off_t offset )
     ssize_t ret = pread( fd, addr, size, offset );
     if (ret != -1 || errno != EFAULT) return ret;
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    virtual_lock_exclusive( &sigset );
     if (!check_write_access( addr, size, &has_write_watch ))
     {
         ret = pread( fd, addr, size, offset );
         err = errno;
         if (has_write_watch) update_write_watches( addr, size, max( 0, ret ));
     }
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    virtual_unlock_exclusive( &sigset );
     errno = err;
     return ret;
 }
@@ -2151,7 +2612,7 @@ ssize_t CDECL __wine_locked_recvmsg( int fd, struct msghdr *hdr, int flags )
     ssize_t ret = recvmsg( fd, hdr, flags );
     if (ret != -1 || errno != EFAULT) return ret;
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    virtual_lock_exclusive( &sigset );
     for (i = 0; i < hdr->msg_iovlen; i++)
         if (check_write_access( hdr->msg_iov[i].iov_base, hdr->msg_iov[i].iov_len, &has_write_watch ))
             break;
@@ -2163,7 +2624,7 @@ ssize_t CDECL __wine_locked_recvmsg( int fd, struct msghdr *hdr, int flags )
     if (has_write_watch)
         while (i--) update_write_watches( hdr->msg_iov[i].iov_base, hdr->msg_iov[i].iov_len, 0 );
 
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    virtual_unlock_exclusive( &sigset );
     errno = err;
     return ret;
 }
@@ -2175,13 +2636,13 @@ ssize_t CDECL __wine_locked_recvmsg( int fd, struct msghdr *hdr, int flags )
 BOOL virtual_is_valid_code_address( const void *addr, SIZE_T size )
 {
     struct file_view *view;
-    BOOL ret = FALSE;
+    BOOL ret = FALSE, exclusive;
     sigset_t sigset;
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    exclusive = virtual_lock_shared( &sigset );
     if ((view = VIRTUAL_FindView( addr, size )))
         ret = !(view->protect & VPROT_SYSTEM);  /* system views are not visible to the app */
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    virtual_unlock_shared( &sigset, exclusive );
     return ret;
 }
 
@@ -2196,7 +2657,7 @@ BOOL virtual_handle_stack_fault( void *addr )
 {
     BOOL ret = FALSE;
 
-    RtlEnterCriticalSection( &csVirtual );  /* no need for signal masking inside signal handler */
+    virtual_lock_exclusive( NULL );  /* no need for signal masking inside signal handler */
     if (get_page_vprot( addr ) & VPROT_GUARD)
     {
         char *page = ROUND_ADDR( addr, page_mask );
@@ -2211,7 +2672,7 @@ BOOL virtual_handle_stack_fault( void *addr )
         }
         ret = TRUE;
     }
-    RtlLeaveCriticalSection( &csVirtual );
+    virtual_unlock_exclusive( NULL );
     return ret;
 }
 
@@ -2298,7 +2759,7 @@ SIZE_T virtual_uninterrupted_read_memory( const void *addr, void *buffer, SIZE_T
 
     if (!size) return 0;
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    virtual_lock_exclusive( &sigset );
     if ((view = VIRTUAL_FindView( addr, size )))
     {
         if (!(view->protect & VPROT_SYSTEM))
@@ -2317,7 +2778,7 @@ SIZE_T virtual_uninterrupted_read_memory( const void *addr, void *buffer, SIZE_T
             }
         }
     }
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    virtual_unlock_exclusive( &sigset );
     return bytes_read;
 }
 
@@ -2337,13 +2798,13 @@ NTSTATUS virtual_uninterrupted_write_memory( void *addr, const void *buffer, SIZ
 
     if (!size) return STATUS_SUCCESS;
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    virtual_lock_exclusive( &sigset );
     if (!(ret = check_write_access( addr, size, &has_write_watch )))
     {
         memcpy( addr, buffer, size );
         if (has_write_watch) update_write_watches( addr, size, size );
     }
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    virtual_unlock_exclusive( &sigset );
     return ret;
 }
 
@@ -2358,7 +2819,7 @@ void VIRTUAL_SetForceExec( BOOL enable )
     struct file_view *view;
     sigset_t sigset;
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    virtual_lock_exclusive( &sigset );
     if (!force_exec_prot != !enable)  /* change all existing views */
     {
         force_exec_prot = enable;
@@ -2371,7 +2832,7 @@ void VIRTUAL_SetForceExec( BOOL enable )
             mprotect_range( view->base, view->size, commit, 0 );
         }
     }
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    virtual_unlock_exclusive( &sigset );
 }
 
 struct free_range
@@ -2409,7 +2870,7 @@ void virtual_release_address_space(void)
 
     if (is_win64) return;
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    virtual_lock_exclusive( &sigset );
 
     range.base  = (char *)0x82000000;
     range.limit = user_space_limit;
@@ -2427,7 +2888,7 @@ void virtual_release_address_space(void)
 #endif
     }
 
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    virtual_unlock_exclusive( &sigset );
 }
 
 
@@ -2532,7 +2993,7 @@ NTSTATUS WINAPI NtAllocateVirtualMemory( HANDLE process, PVOID *ret, ULONG zero_
 
     /* Reserve the memory */
 
-    if (use_locks) server_enter_uninterrupted_section( &csVirtual, &sigset );
+    if (use_locks) virtual_lock_exclusive( &sigset );
 
     if ((type & MEM_RESERVE) || !base)
     {
@@ -2573,7 +3034,7 @@ NTSTATUS WINAPI NtAllocateVirtualMemory( HANDLE process, PVOID *ret, ULONG zero_
 
     if (!status) VIRTUAL_DEBUG_DUMP_VIEW( view );
 
-    if (use_locks) server_leave_uninterrupted_section( &csVirtual, &sigset );
+    if (use_locks) virtual_unlock_exclusive( &sigset );
 
     if (status == STATUS_SUCCESS)
     {
@@ -2629,7 +3090,7 @@ NTSTATUS WINAPI NtFreeVirtualMemory( HANDLE process, PVOID *addr_ptr, SIZE_T *si
     /* avoid freeing the DOS area when a broken app passes a NULL pointer */
     if (!base) return STATUS_INVALID_PARAMETER;
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    virtual_lock_exclusive( &sigset );
 
     if (!(view = VIRTUAL_FindView( base, size )) || !is_view_valloc( view ))
     {
@@ -2662,7 +3123,7 @@ NTSTATUS WINAPI NtFreeVirtualMemory( HANDLE process, PVOID *addr_ptr, SIZE_T *si
         status = STATUS_INVALID_PARAMETER;
     }
 
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    virtual_unlock_exclusive( &sigset );
     return status;
 }
 
@@ -2716,7 +3177,7 @@ NTSTATUS WINAPI NtProtectVirtualMemory( HANDLE process, PVOID *addr_ptr, SIZE_T
     size = ROUND_SIZE( addr, size );
     base = ROUND_ADDR( addr, page_mask );
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    virtual_lock_exclusive( &sigset );
 
     if ((view = VIRTUAL_FindView( base, size )))
     {
@@ -2732,7 +3193,7 @@ NTSTATUS WINAPI NtProtectVirtualMemory( HANDLE process, PVOID *addr_ptr, SIZE_T
 
     if (!status) VIRTUAL_DEBUG_DUMP_VIEW( view );
 
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    virtual_unlock_exclusive( &sigset );
 
     if (status == STATUS_SUCCESS)
     {
@@ -2794,10 +3255,11 @@ NTSTATUS WINAPI NtQueryVirtualMemory( HANDLE process, LPCVOID addr,
                                       SIZE_T len, SIZE_T *res_len )
 {
     struct file_view *view;
-    char *base, *alloc_base = 0, *alloc_end = working_set_limit;
+    char *base, *alloc_base, *alloc_end;
     struct wine_rb_entry *ptr;
-    MEMORY_BASIC_INFORMATION *info = buffer;
+    MEMORY_BASIC_INFORMATION *info = buffer, mbi;
     sigset_t sigset;
+    BOOL exclusive, writer = FALSE;
 
     if (info_class != MemoryBasicInformation)
     {
@@ -2849,7 +3311,10 @@ NTSTATUS WINAPI NtQueryVirtualMemory( HANDLE process, LPCVOID addr,
 
     /* Find the view containing the address */
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    exclusive = virtual_lock_shared( &sigset );
+again:
+    alloc_base = 0;
+    alloc_end = working_set_limit;
     ptr = views_tree.root;
     while (ptr)
     {
@@ -2872,33 +3337,43 @@ NTSTATUS WINAPI NtQueryVirtualMemory( HANDLE process, LPCVOID addr,
         }
     }
 
+    /* the committed ranges of SEC_RESERVE views come from the server and get
+     * cached in the page protections, that needs the exclusive lock */
+    if (ptr && (view->protect & SEC_RESERVE) && !writer)
+    {
+        virtual_unlock_shared( &sigset, exclusive );
+        virtual_lock_exclusive( &sigset );
+        writer = TRUE;
+        goto again;
+    }
+
     /* Fill the info structure */
 
-    info->AllocationBase = alloc_base;
-    info->BaseAddress    = base;
-    info->RegionSize     = alloc_end - base;
+    mbi.AllocationBase = alloc_base;
+    mbi.BaseAddress    = base;
+    mbi.RegionSize     = alloc_end - base;
 
     if (!ptr)
     {
-        if (!wine_mmap_enum_reserved_areas( get_free_mem_state_callback, info, 0 ))
+        if (!wine_mmap_enum_reserved_areas( get_free_mem_state_callback, &mbi, 0 ))
         {
             /* not in a reserved area at all, pretend it's allocated */
 #ifdef __i386__
             if (base >= (char *)address_space_start)
             {
-                info->State             = MEM_RESERVE;
-                info->Protect           = PAGE_NOACCESS;
-                info->AllocationProtect = PAGE_NOACCESS;
-                info->Type              = MEM_PRIVATE;
+                mbi.State             = MEM_RESERVE;
+                mbi.Protect           = PAGE_NOACCESS;
+                mbi.AllocationProtect = PAGE_NOACCESS;
+                mbi.Type              = MEM_PRIVATE;
             }
             else
 #endif
             {
-                info->State             = MEM_FREE;
-                info->Protect           = PAGE_NOACCESS;
-                info->AllocationBase    = 0;
-                info->AllocationProtect = 0;
-                info->Type              = 0;
+                mbi.State             = MEM_FREE;
+                mbi.Protect           = PAGE_NOACCESS;
+                mbi.AllocationBase    = 0;
+                mbi.AllocationProtect = 0;
+                mbi.Type              = 0;
             }
         }
     }
@@ -2908,17 +3383,21 @@ NTSTATUS WINAPI NtQueryVirtualMemory( HANDLE process, LPCVOID addr,
         char *ptr;
         SIZE_T range_size = get_committed_size( view, base, &vprot );
 
-        info->State = (vprot & VPROT_COMMITTED) ? MEM_COMMIT : MEM_RESERVE;
-        info->Protect = (vprot & VPROT_COMMITTED) ? VIRTUAL_GetWin32Prot( vprot, view->protect ) : 0;
-        info->AllocationProtect = VIRTUAL_GetWin32Prot( view->protect, view->protect );
-        if (view->protect & SEC_IMAGE) info->Type = MEM_IMAGE;
-        else if (view->protect & (SEC_FILE | SEC_RESERVE | SEC_COMMIT)) info->Type = MEM_MAPPED;
-        else info->Type = MEM_PRIVATE;
+        mbi.State = (vprot & VPROT_COMMITTED) ? MEM_COMMIT : MEM_RESERVE;
+        mbi.Protect = (vprot & VPROT_COMMITTED) ? VIRTUAL_GetWin32Prot( vprot, view->protect ) : 0;
+        mbi.AllocationProtect = VIRTUAL_GetWin32Prot( view->protect, view->protect );
+        if (view->protect & SEC_IMAGE) mbi.Type = MEM_IMAGE;
+        else if (view->protect & (SEC_FILE | SEC_RESERVE | SEC_COMMIT)) mbi.Type = MEM_MAPPED;
+        else mbi.Type = MEM_PRIVATE;
         for (ptr = base; ptr < base + range_size; ptr += page_size)
             if ((get_page_vprot( ptr ) ^ vprot) & ~VPROT_WRITEWATCH) break;
-        info->RegionSize = ptr - base;
+        mbi.RegionSize = ptr - base;
     }
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    if (writer) virtual_unlock_exclusive( &sigset );
+    else virtual_unlock_shared( &sigset, exclusive );
+
+    /* the buffer is only written without the lock, it may fault */
+    *info = mbi;
 
     if (res_len) *res_len = sizeof(*info);
     return STATUS_SUCCESS;
@@ -3150,7 +3629,7 @@ NTSTATUS WINAPI NtUnmapViewOfSection( HANDLE process, PVOID addr )
         return status;
     }
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    virtual_lock_exclusive( &sigset );
     if ((view = VIRTUAL_FindView( addr, 0 )) && !is_view_valloc( view ))
     {
         if (!(view->protect & VPROT_SYSTEM))
@@ -3166,7 +3645,7 @@ NTSTATUS WINAPI NtUnmapViewOfSection( HANDLE process, PVOID addr )
         }
         else delete_view( view );
     }
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    virtual_unlock_exclusive( &sigset );
     return status;
 }
 
@@ -3282,7 +3761,7 @@ NTSTATUS WINAPI NtFlushVirtualMemory( HANDLE process, LPCVOID *addr_ptr,
         return result.virtual_flush.status;
     }
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    virtual_lock_exclusive( &sigset );
     if (!(view = VIRTUAL_FindView( addr, *size_ptr ))) status = STATUS_INVALID_PARAMETER;
     else
     {
@@ -3292,7 +3771,7 @@ NTSTATUS WINAPI NtFlushVirtualMemory( HANDLE process, LPCVOID *addr_ptr,
         if (msync( addr, *size_ptr, MS_ASYNC )) status = STATUS_NOT_MAPPED_DATA;
 #endif
     }
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    virtual_unlock_exclusive( &sigset );
     return status;
 }
 
@@ -3319,7 +3798,7 @@ NTSTATUS WINAPI NtGetWriteWatch( HANDLE process, ULONG flags, PVOID base, SIZE_T
     TRACE( "%p %x %p-%p %p %lu\n", process, flags, base, (char *)base + size,
            addresses, *count );
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    virtual_lock_exclusive( &sigset );
 
     if (is_write_watch_range( base, size ))
     {
@@ -3338,7 +3817,7 @@ NTSTATUS WINAPI NtGetWriteWatch( HANDLE process, ULONG flags, PVOID base, SIZE_T
     }
     else status = STATUS_INVALID_PARAMETER;
 
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    virtual_unlock_exclusive( &sigset );
     return status;
 }
 
@@ -3359,14 +3838,14 @@ NTSTATUS WINAPI NtResetWriteWatch( HANDLE process, PVOID base, SIZE_T size )
 
     if (!size) return STATUS_INVALID_PARAMETER;
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    virtual_lock_exclusive( &sigset );
 
     if (is_write_watch_range( base, size ))
         reset_write_watches( base, size );
     else
         status = STATUS_INVALID_PARAMETER;
 
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    virtual_unlock_exclusive( &sigset );
     return status;
 }
 
@@ -3443,7 +3922,7 @@ NTSTATUS WINAPI NtAreMappedFilesTheSame(PVOID addr1, PVOID addr2)
 
     TRACE("%p %p\n", addr1, addr2);
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    virtual_lock_exclusive( &sigset );
 
     view1 = VIRTUAL_FindView( addr1, 0 );
     view2 = VIRTUAL_FindView( addr2, 0 );
@@ -3467,6 +3946,6 @@ NTSTATUS WINAPI NtAreMappedFilesTheSame(PVOID addr1, PVOID addr2)
         SERVER_END_REQ;
     }
 
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    virtual_unlock_exclusive( &sigset );
     return status;
 }
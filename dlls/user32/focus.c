@@ -348,8 +348,11 @@ HWND WINAPI GetActiveWindow(void)
  */
 HWND WINAPI GetFocus(void)
 {
+    struct shared_input state;
     HWND ret = 0;
 
+    if (get_shared_thread_input( &state )) return wine_server_ptr_handle( state.focus );
+
     SERVER_START_REQ( get_thread_input )
     {
         req->tid = GetCurrentThreadId();
@@ -365,8 +368,11 @@ HWND WINAPI GetFocus(void)
  */
 HWND WINAPI GetForegroundWindow(void)
 {
+    struct shared_input state;
     HWND ret = 0;
 
+    if (get_shared_desktop( &state )) return wine_server_ptr_handle( state.foreground );
+
     SERVER_START_REQ( get_thread_input )
     {
         req->tid = 0;
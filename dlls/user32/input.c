@@ -54,6 +54,159 @@ WINE_DECLARE_DEBUG_CHANNEL(keyboard);
 
 INT global_key_state_counter = 0;
 
+static const struct shared_input *shared_input_region;  /* (void *)-1 if not available */
+
+
+/***********************************************************************
+ *           get_shared_input_region
+ *
+ * Map the region where the server publishes the input state.
+ */
+static const struct shared_input *get_shared_input_region(void)
+{
+    const struct shared_input *region = shared_input_region;
+    HANDLE file = 0, mapping;
+    void *ptr = NULL;
+
+    if (region) return region != (void *)-1 ? region : NULL;
+
+    SERVER_START_REQ( get_shared_input_region )
+    {
+        if (!wine_server_call( req )) file = wine_server_ptr_handle( reply->handle );
+    }
+    SERVER_END_REQ;
+
+    if (file)
+    {
+        if ((mapping = CreateFileMappingW( file, NULL, PAGE_READONLY, 0, 0, NULL )))
+        {
+            ptr = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+            CloseHandle( mapping );
+        }
+        CloseHandle( file );
+    }
+    if (!ptr) ptr = (void *)-1;
+
+    if ((region = InterlockedCompareExchangePointer( (void **)&shared_input_region, ptr, NULL )))
+    {
+        if (ptr != (void *)-1) UnmapViewOfFile( ptr );  /* another thread was faster */
+    }
+    else region = ptr;
+    return region != (void *)-1 ? region : NULL;
+}
+
+
+/***********************************************************************
+ *           get_shared_input_slots
+ */
+static struct user_shared_input *get_shared_input_slots( BOOL refresh )
+{
+    struct user_thread_info *thread_info = get_user_thread_info();
+    struct user_shared_input *slots = thread_info->shared_input;
+
+    if (!slots)
+    {
+        if (!(slots = HeapAlloc( GetProcessHeap(), 0, sizeof(*slots) ))) return NULL;
+        thread_info->shared_input = slots;
+        refresh = TRUE;
+    }
+    if (refresh)
+    {
+        slots->desktop_slot = slots->queue_slot = -1;
+        SERVER_START_REQ( get_shared_input )
+        {
+            if (!wine_server_call( req ))
+            {
+                slots->desktop_slot = reply->desktop_slot;
+                slots->desktop_id   = reply->desktop_id;
+                slots->queue_slot   = reply->queue_slot;
+                slots->queue_id     = reply->queue_id;
+            }
+        }
+        SERVER_END_REQ;
+        slots->no_queue = (slots->queue_slot == -1);
+    }
+    return slots;
+}
+
+
+/***********************************************************************
+ *           read_shared_input
+ *
+ * Copy a slot of the shared input region, consistently with respect to the server
+ * updates. Fails if the slot doesn't belong to the object with the given id.
+ */
+static BOOL read_shared_input( const struct shared_input *region, int slot, unsigned int id,
+                               struct shared_input *state )
+{
+    const struct shared_input *shared;
+    unsigned int seq;
+
+    if (slot < 0 || slot >= SHARED_INPUT_MAX_SLOTS) return FALSE;
+    shared = &region[slot];
+    for (;;)
+    {
+        seq = *(volatile const unsigned int *)&shared->seq;
+        __sync_synchronize();
+        if (seq & 1) continue;  /* the server is updating it */
+        memcpy( state, shared, sizeof(*state) );
+        __sync_synchronize();
+        if (*(volatile const unsigned int *)&shared->seq == seq) break;
+    }
+    return state->id == id;
+}
+
+
+/***********************************************************************
+ *           get_shared_desktop
+ *
+ * Get the published state of the thread desktop without a server call.
+ */
+BOOL get_shared_desktop( struct shared_input *state )
+{
+    const struct shared_input *region = get_shared_input_region();
+    struct user_shared_input *slots;
+
+    if (!region || !(slots = get_shared_input_slots( FALSE ))) return FALSE;
+    if (read_shared_input( region, slots->desktop_slot, slots->desktop_id, state )) return TRUE;
+
+    /* the desktop has changed since we looked it up */
+    if (!(slots = get_shared_input_slots( TRUE ))) return FALSE;
+    return read_shared_input( region, slots->desktop_slot, slots->desktop_id, state );
+}
+
+
+/***********************************************************************
+ *           get_shared_thread_input
+ *
+ * Get the published state of the thread input without a server call. Fails if the
+ * thread doesn't have a message queue, the server then uses the desktop state.
+ */
+BOOL get_shared_thread_input( struct shared_input *state )
+{
+    const struct shared_input *region = get_shared_input_region();
+    struct user_shared_input *slots;
+    struct shared_input queue;
+    int retry;
+
+    if (!region || !(slots = get_shared_input_slots( FALSE ))) return FALSE;
+    if (slots->queue_slot == -1)
+    {
+        /* the thread only gets a queue once it looks for messages, see peek_message */
+        if (slots->no_queue || !(slots = get_shared_input_slots( TRUE ))) return FALSE;
+        if (slots->queue_slot == -1) return FALSE;
+    }
+
+    /* the queue may get attached to another thread input while we look */
+    for (retry = 0; retry < 4; retry++)
+    {
+        if (!read_shared_input( region, slots->queue_slot, slots->queue_id, &queue )) return FALSE;
+        if (read_shared_input( region, queue.input_slot, queue.input_id, state )) return TRUE;
+    }
+    return FALSE;
+}
+
+
 /***********************************************************************
  *           get_key_state
  */
@@ -241,18 +394,29 @@ BOOL WINAPI DECLSPEC_HOTPATCH GetCursorPos( POINT *pt )
     BOOL ret;
     DWORD last_change;
 
+    struct shared_input state;
+
     if (!pt) return FALSE;
 
-    SERVER_START_REQ( set_cursor )
+    if ((ret = get_shared_desktop( &state )))
     {
-        if ((ret = !wine_server_call( req )))
+        pt->x = state.cursor_x;
+        pt->y = state.cursor_y;
+        last_change = state.cursor_change;
+    }
+    else
+    {
+        SERVER_START_REQ( set_cursor )
         {
-            pt->x = reply->new_x;
-            pt->y = reply->new_y;
-            last_change = reply->last_change;
+            if ((ret = !wine_server_call( req )))
+            {
+                pt->x = reply->new_x;
+                pt->y = reply->new_y;
+                last_change = reply->last_change;
+            }
         }
+        SERVER_END_REQ;
     }
-    SERVER_END_REQ;
 
     /* query new position from graphics driver if we haven't updated recently */
     if (ret && GetTickCount() - last_change > 100) ret = USER_Driver->pGetCursorPos( pt );
@@ -390,6 +554,7 @@ SHORT WINAPI DECLSPEC_HOTPATCH GetAsyncKeyState( INT key )
 {
     struct user_key_state_info *key_state_info = get_user_thread_info()->key_state;
     INT counter = global_key_state_counter;
+    struct shared_input state;
     BYTE prev_key_state;
     SHORT ret;
 
@@ -399,6 +564,10 @@ SHORT WINAPI DECLSPEC_HOTPATCH GetAsyncKeyState( INT key )
 
     if ((ret = USER_Driver->pGetAsyncKeyState( key )) == -1)
     {
+        /* the server only needs to be told when the key was pressed since the last call */
+        if (get_shared_desktop( &state ) && !(state.keystate[key] & 0x40))
+            return (state.keystate[key] & 0x80) ? 0x8000 : 0;
+
         if (key_state_info &&
             !(key_state_info->state[key] & 0xc0) &&
             key_state_info->counter == counter &&
@@ -800,15 +969,23 @@ BOOL WINAPI AttachThreadInput( DWORD from, DWORD to, BOOL attach )
  */
 SHORT WINAPI DECLSPEC_HOTPATCH GetKeyState(INT vkey)
 {
+    struct shared_input state;
     SHORT retval = 0;
 
-    SERVER_START_REQ( get_key_state )
+    if (get_shared_thread_input( &state ))
     {
-        req->tid = GetCurrentThreadId();
-        req->key = vkey;
-        if (!wine_server_call( req )) retval = (signed char)reply->state;
+        if (vkey >= 0) retval = (signed char)state.keystate[vkey & 0xff];
+    }
+    else
+    {
+        SERVER_START_REQ( get_key_state )
+        {
+            req->tid = GetCurrentThreadId();
+            req->key = vkey;
+            if (!wine_server_call( req )) retval = (signed char)reply->state;
+        }
+        SERVER_END_REQ;
     }
-    SERVER_END_REQ;
     TRACE("key (0x%x) -> %x\n", vkey, retval);
     return retval;
 }
@@ -2745,6 +2745,9 @@ static BOOL peek_message( MSG *msg, HWND hwnd, UINT first, UINT last, UINT flags
     if (!first && !last) last = ~0;
     if (hwnd == HWND_BROADCAST) hwnd = HWND_TOPMOST;
 
+    /* the server creates the thread queue if needed, its shared state can be looked up again */
+    if (thread_info->shared_input) thread_info->shared_input->no_queue = FALSE;
+
     for (;;)
     {
         NTSTATUS res;
@@ -2545,6 +2545,62 @@ static void test_OemKeyScan(void)
     }
 }
 
+static DWORD WINAPI input_state_thread(void *arg)
+{
+    POINT pt;
+    MSG msg;
+
+    /* no message queue yet */
+    ok(!GetFocus(), "GetFocus returned %p\n", GetFocus());
+    ok(!GetFocus(), "GetFocus returned %p\n", GetFocus());
+    ok(GetCursorPos(&pt), "GetCursorPos failed\n");
+    ok(!(GetKeyState('X') & 0x8000), "X is down\n");
+
+    PeekMessageA(&msg, NULL, 0, 0, PM_NOREMOVE);
+    ok(!GetFocus(), "GetFocus returned %p\n", GetFocus());
+    ok(!(GetKeyState('X') & 0x8000), "X is down\n");
+    return 0;
+}
+
+static void test_input_state_queries(void)
+{
+    unsigned int i;
+    BYTE keystate[256];
+    HANDLE thread;
+    POINT pt;
+    HWND hwnd;
+
+    hwnd = CreateWindowA("static", "Title", WS_OVERLAPPEDWINDOW | WS_VISIBLE,
+                         10, 10, 200, 200, NULL, NULL, NULL, NULL);
+    ok(hwnd != NULL, "CreateWindowA failed %u\n", GetLastError());
+    SetFocus(hwnd);
+    ok(GetFocus() == hwnd, "GetFocus returned %p\n", GetFocus());
+
+    /* changes are visible right away */
+    GetKeyboardState(keystate);
+    keystate['X'] = 0x80;
+    SetKeyboardState(keystate);
+    ok(GetKeyState('X') & 0x8000, "X is not down\n");
+    keystate['X'] = 0;
+    SetKeyboardState(keystate);
+    ok(!(GetKeyState('X') & 0x8000), "X is still down\n");
+
+    for (i = 0; i < 100; i++)
+    {
+        ok(GetCursorPos(&pt), "GetCursorPos failed\n");
+        ok(!(GetKeyState('X') & 0x8000), "X is down\n");
+        ok(GetFocus() == hwnd, "GetFocus returned %p\n", GetFocus());
+    }
+
+    thread = CreateThread(NULL, 0, input_state_thread, NULL, 0, NULL);
+    ok(thread != NULL, "CreateThread failed %u\n", GetLastError());
+    ok(WaitForSingleObject(thread, 5000) == WAIT_OBJECT_0, "thread didn't exit\n");
+    CloseHandle(thread);
+
+    DestroyWindow(hwnd);
+    ok(GetFocus() != hwnd, "GetFocus returned the destroyed window\n");
+}
+
 START_TEST(input)
 {
     init_function_pointers();
@@ -2569,6 +2625,7 @@ START_TEST(input)
     test_attach_input();
     test_GetKeyState();
     test_OemKeyScan();
+    test_input_state_queries();
 
     if(pGetMouseMovePointsEx)
         test_GetMouseMovePointsEx();
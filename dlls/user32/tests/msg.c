@@ -11731,6 +11731,50 @@ static void test_PeekMessage3(void)
     flush_events();
 }
 
+static void test_PeekMessage_flood(void)
+{
+    unsigned int i, count = 2000, found, last;
+    HWND hwnd, hwnd2;
+    MSG msg;
+
+    hwnd = CreateWindowA("TestWindowClass", "PeekMessage flood", WS_OVERLAPPEDWINDOW,
+                         10, 10, 100, 100, NULL, NULL, NULL, NULL);
+    ok(hwnd != NULL, "expected hwnd != NULL\n");
+    hwnd2 = CreateWindowA("TestWindowClass", "PeekMessage flood 2", WS_OVERLAPPEDWINDOW,
+                          10, 10, 100, 100, NULL, NULL, NULL, NULL);
+    ok(hwnd2 != NULL, "expected hwnd2 != NULL\n");
+    flush_events();
+
+    /* bury a few messages for the second window in a flood of messages for the first one */
+    for (i = 0; i < count; i++)
+    {
+        if (i % 100 == 50) PostMessageA(hwnd2, WM_USER + 10, i, 0);
+        else PostMessageA(hwnd, WM_USER + i % 4, i, 0);
+    }
+
+    for (found = 0; PeekMessageA(&msg, hwnd2, WM_USER + 10, WM_USER + 10, PM_REMOVE); found++)
+        ok(msg.wParam == found * 100 + 50, "got wparam %lu, expected %u\n", msg.wParam, found * 100 + 50);
+    ok(found == count / 100, "got %u messages for the second window\n", found);
+
+    for (found = 0; PeekMessageA(&msg, hwnd, WM_USER + 3, WM_USER + 3, PM_REMOVE); found++)
+        ok(msg.wParam == found * 4 + 3, "got wparam %lu, expected %u\n", msg.wParam, found * 4 + 3);
+    ok(found == count / 4, "got %u WM_USER + 3 messages\n", found);
+
+    /* the remaining messages still come in posting order */
+    last = 0;
+    for (found = 0; PeekMessageA(&msg, hwnd, WM_USER, WM_USER + 3, PM_REMOVE); found++)
+    {
+        ok(!found || msg.wParam > last, "got wparam %lu after %u\n", msg.wParam, last);
+        ok(msg.message == WM_USER + msg.wParam % 4, "got message %04x for wparam %lu\n", msg.message, msg.wParam);
+        last = msg.wParam;
+    }
+    ok(found == count - count / 100 - count / 4, "got %u remaining messages\n", found);
+
+    DestroyWindow(hwnd2);
+    DestroyWindow(hwnd);
+    flush_events();
+}
+
 static INT_PTR CALLBACK wm_quit_dlg_proc(HWND hwnd, UINT message, WPARAM wp, LPARAM lp)
 {
     struct recvd_message msg;
@@ -16715,6 +16759,7 @@ START_TEST(msg)
     test_PeekMessage();
     test_PeekMessage2();
     test_PeekMessage3();
+    test_PeekMessage_flood();
     test_WaitForInputIdle( test_argv[0] );
     test_scrollwindowex();
     test_messages();
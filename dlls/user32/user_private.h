@@ -185,6 +185,7 @@ struct user_thread_info
     HWND                          top_window;             /* Desktop window */
     HWND                          msg_window;             /* HWND_MESSAGE parent window */
     RAWINPUT                     *rawinput;
+    struct user_shared_input     *shared_input;           /* Slots of the shared input state */
 };
 
 C_ASSERT( sizeof(struct user_thread_info) <= sizeof(((TEB *)0)->Win32ClientInfo) );
@@ -200,6 +201,18 @@ struct user_key_state_info
     BYTE                          state[256];             /* State for each key */
 };
 
+struct shared_input;
+
+/* slots of the thread state in the shared input region of the server */
+struct user_shared_input
+{
+    int                           desktop_slot;           /* Slot of the thread desktop, or -1 */
+    unsigned int                  desktop_id;
+    int                           queue_slot;             /* Slot of the thread queue, or -1 */
+    unsigned int                  queue_id;
+    BOOL                          no_queue;               /* No queue at the last lookup, don't look again */
+};
+
 struct hook_extra_info
 {
     HHOOK handle;
@@ -242,6 +255,8 @@ extern LRESULT call_current_hook( HHOOK hhook, INT code, WPARAM wparam, LPARAM l
 extern DWORD get_input_codepage( void ) DECLSPEC_HIDDEN;
 extern BOOL map_wparam_AtoW( UINT message, WPARAM *wparam, enum wm_char_mapping mapping ) DECLSPEC_HIDDEN;
 extern NTSTATUS send_hardware_message( HWND hwnd, const INPUT *input, UINT flags ) DECLSPEC_HIDDEN;
+extern BOOL get_shared_desktop( struct shared_input *state ) DECLSPEC_HIDDEN;
+extern BOOL get_shared_thread_input( struct shared_input *state ) DECLSPEC_HIDDEN;
 extern LRESULT MSG_SendInternalMessageTimeout( DWORD dest_pid, DWORD dest_tid,
                                                UINT msg, WPARAM wparam, LPARAM lparam,
                                                UINT flags, UINT timeout, PDWORD_PTR res_ptr ) DECLSPEC_HIDDEN;
@@ -429,6 +429,8 @@ BOOL WINAPI SetThreadDesktop( HDESK handle )
         thread_info->top_window = 0;
         thread_info->msg_window = 0;
         if (key_state_info) key_state_info->time = 0;
+        HeapFree( GetProcessHeap(), 0, thread_info->shared_input );
+        thread_info->shared_input = NULL;
     }
     return ret;
 }
@@ -0,0 +1,810 @@
+/*
+ * Tests for winevulkan dispatch
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+
+#include "windef.h"
+#include "winbase.h"
+#include "wine/vulkan.h"
+#include "wine/test.h"
+
+/* Number of commands recorded before the command buffer is reset. */
+#define BATCH_SIZE 10000
+#define BATCH_COUNT 10
+
+static PFN_vkVoidFunction (WINAPI *pvk_icdGetInstanceProcAddr)(VkInstance, const char *);
+
+static PFN_vkVoidFunction (VKAPI_PTR *pvkGetInstanceProcAddr)(VkInstance, const char *);
+static PFN_vkVoidFunction (VKAPI_PTR *pvkGetDeviceProcAddr)(VkDevice, const char *);
+static VkResult (VKAPI_PTR *pvkCreateInstance)(const VkInstanceCreateInfo *, const VkAllocationCallbacks *, VkInstance *);
+static void (VKAPI_PTR *pvkDestroyInstance)(VkInstance, const VkAllocationCallbacks *);
+static VkResult (VKAPI_PTR *pvkEnumeratePhysicalDevices)(VkInstance, uint32_t *, VkPhysicalDevice *);
+static void (VKAPI_PTR *pvkGetPhysicalDeviceQueueFamilyProperties)(VkPhysicalDevice, uint32_t *, VkQueueFamilyProperties *);
+static void (VKAPI_PTR *pvkGetPhysicalDeviceMemoryProperties)(VkPhysicalDevice, VkPhysicalDeviceMemoryProperties *);
+static VkResult (VKAPI_PTR *pvkCreateDevice)(VkPhysicalDevice, const VkDeviceCreateInfo *, const VkAllocationCallbacks *, VkDevice *);
+
+static void (VKAPI_PTR *pvkDestroyDevice)(VkDevice, const VkAllocationCallbacks *);
+static VkResult (VKAPI_PTR *pvkCreateCommandPool)(VkDevice, const VkCommandPoolCreateInfo *, const VkAllocationCallbacks *, VkCommandPool *);
+static void (VKAPI_PTR *pvkDestroyCommandPool)(VkDevice, VkCommandPool, const VkAllocationCallbacks *);
+static VkResult (VKAPI_PTR *pvkAllocateCommandBuffers)(VkDevice, const VkCommandBufferAllocateInfo *, VkCommandBuffer *);
+static void (VKAPI_PTR *pvkGetDeviceQueue)(VkDevice, uint32_t, uint32_t, VkQueue *);
+static VkResult (VKAPI_PTR *pvkQueueSubmit)(VkQueue, uint32_t, const VkSubmitInfo *, VkFence);
+static VkResult (VKAPI_PTR *pvkQueueWaitIdle)(VkQueue);
+static VkResult (VKAPI_PTR *pvkDeviceWaitIdle)(VkDevice);
+static VkResult (VKAPI_PTR *pvkCreateFence)(VkDevice, const VkFenceCreateInfo *, const VkAllocationCallbacks *, VkFence *);
+static void (VKAPI_PTR *pvkDestroyFence)(VkDevice, VkFence, const VkAllocationCallbacks *);
+static VkResult (VKAPI_PTR *pvkResetFences)(VkDevice, uint32_t, const VkFence *);
+static VkResult (VKAPI_PTR *pvkWaitForFences)(VkDevice, uint32_t, const VkFence *, VkBool32, uint64_t);
+static void (VKAPI_PTR *pvkFreeCommandBuffers)(VkDevice, VkCommandPool, uint32_t, const VkCommandBuffer *);
+static VkResult (VKAPI_PTR *pvkResetCommandPool)(VkDevice, VkCommandPool, VkCommandPoolResetFlags);
+static VkResult (VKAPI_PTR *pvkBeginCommandBuffer)(VkCommandBuffer, const VkCommandBufferBeginInfo *);
+static VkResult (VKAPI_PTR *pvkEndCommandBuffer)(VkCommandBuffer);
+static VkResult (VKAPI_PTR *pvkResetCommandBuffer)(VkCommandBuffer, VkCommandBufferResetFlags);
+static VkResult (VKAPI_PTR *pvkCreateDescriptorSetLayout)(VkDevice, const VkDescriptorSetLayoutCreateInfo *, const VkAllocationCallbacks *, VkDescriptorSetLayout *);
+static void (VKAPI_PTR *pvkDestroyDescriptorSetLayout)(VkDevice, VkDescriptorSetLayout, const VkAllocationCallbacks *);
+static VkResult (VKAPI_PTR *pvkCreateDescriptorPool)(VkDevice, const VkDescriptorPoolCreateInfo *, const VkAllocationCallbacks *, VkDescriptorPool *);
+static void (VKAPI_PTR *pvkDestroyDescriptorPool)(VkDevice, VkDescriptorPool, const VkAllocationCallbacks *);
+static VkResult (VKAPI_PTR *pvkAllocateDescriptorSets)(VkDevice, const VkDescriptorSetAllocateInfo *, VkDescriptorSet *);
+static VkResult (VKAPI_PTR *pvkCreatePipelineLayout)(VkDevice, const VkPipelineLayoutCreateInfo *, const VkAllocationCallbacks *, VkPipelineLayout *);
+static void (VKAPI_PTR *pvkDestroyPipelineLayout)(VkDevice, VkPipelineLayout, const VkAllocationCallbacks *);
+static VkResult (VKAPI_PTR *pvkCreateRenderPass)(VkDevice, const VkRenderPassCreateInfo *, const VkAllocationCallbacks *, VkRenderPass *);
+static void (VKAPI_PTR *pvkDestroyRenderPass)(VkDevice, VkRenderPass, const VkAllocationCallbacks *);
+static VkResult (VKAPI_PTR *pvkCreateFramebuffer)(VkDevice, const VkFramebufferCreateInfo *, const VkAllocationCallbacks *, VkFramebuffer *);
+static void (VKAPI_PTR *pvkDestroyFramebuffer)(VkDevice, VkFramebuffer, const VkAllocationCallbacks *);
+static VkResult (VKAPI_PTR *pvkCreateShaderModule)(VkDevice, const VkShaderModuleCreateInfo *, const VkAllocationCallbacks *, VkShaderModule *);
+static void (VKAPI_PTR *pvkDestroyShaderModule)(VkDevice, VkShaderModule, const VkAllocationCallbacks *);
+static VkResult (VKAPI_PTR *pvkCreateGraphicsPipelines)(VkDevice, VkPipelineCache, uint32_t, const VkGraphicsPipelineCreateInfo *, const VkAllocationCallbacks *, VkPipeline *);
+static void (VKAPI_PTR *pvkDestroyPipeline)(VkDevice, VkPipeline, const VkAllocationCallbacks *);
+static void (VKAPI_PTR *pvkCmdBeginRenderPass)(VkCommandBuffer, const VkRenderPassBeginInfo *, VkSubpassContents);
+static void (VKAPI_PTR *pvkCmdEndRenderPass)(VkCommandBuffer);
+static void (VKAPI_PTR *pvkCmdBindPipeline)(VkCommandBuffer, VkPipelineBindPoint, VkPipeline);
+static void (VKAPI_PTR *pvkCmdBindDescriptorSets)(VkCommandBuffer, VkPipelineBindPoint, VkPipelineLayout,
+        uint32_t, uint32_t, const VkDescriptorSet *, uint32_t, const uint32_t *);
+static void (VKAPI_PTR *pvkCmdDraw)(VkCommandBuffer, uint32_t, uint32_t, uint32_t, uint32_t);
+static VkResult (VKAPI_PTR *pvkCreateBuffer)(VkDevice, const VkBufferCreateInfo *, const VkAllocationCallbacks *, VkBuffer *);
+static void (VKAPI_PTR *pvkDestroyBuffer)(VkDevice, VkBuffer, const VkAllocationCallbacks *);
+static void (VKAPI_PTR *pvkGetBufferMemoryRequirements)(VkDevice, VkBuffer, VkMemoryRequirements *);
+static VkResult (VKAPI_PTR *pvkAllocateMemory)(VkDevice, const VkMemoryAllocateInfo *, const VkAllocationCallbacks *, VkDeviceMemory *);
+static void (VKAPI_PTR *pvkFreeMemory)(VkDevice, VkDeviceMemory, const VkAllocationCallbacks *);
+static VkResult (VKAPI_PTR *pvkBindBufferMemory)(VkDevice, VkBuffer, VkDeviceMemory, VkDeviceSize);
+static VkResult (VKAPI_PTR *pvkMapMemory)(VkDevice, VkDeviceMemory, VkDeviceSize, VkDeviceSize, VkMemoryMapFlags, void **);
+static void (VKAPI_PTR *pvkUnmapMemory)(VkDevice, VkDeviceMemory);
+static void (VKAPI_PTR *pvkCmdFillBuffer)(VkCommandBuffer, VkBuffer, VkDeviceSize, VkDeviceSize, uint32_t);
+static void (VKAPI_PTR *pvkCmdPipelineBarrier)(VkCommandBuffer, VkPipelineStageFlags, VkPipelineStageFlags, VkDependencyFlags,
+        uint32_t, const VkMemoryBarrier *, uint32_t, const VkBufferMemoryBarrier *, uint32_t, const VkImageMemoryBarrier *);
+
+/* void main() {} */
+static const uint32_t vs_code[] =
+{
+    0x07230203, 0x00010000, 0x00000000, 0x00000005, 0x00000000,
+    0x00020011, 0x00000001,                                     /* OpCapability Shader */
+    0x0003000e, 0x00000000, 0x00000001,                         /* OpMemoryModel Logical GLSL450 */
+    0x0005000f, 0x00000000, 0x00000001, 0x6e69616d, 0x00000000, /* OpEntryPoint Vertex %1 "main" */
+    0x00020013, 0x00000002,                                     /* %2 = OpTypeVoid */
+    0x00030021, 0x00000003, 0x00000002,                         /* %3 = OpTypeFunction %2 */
+    0x00050036, 0x00000002, 0x00000001, 0x00000000, 0x00000003, /* %1 = OpFunction %2 None %3 */
+    0x000200f8, 0x00000004,                                     /* %4 = OpLabel */
+    0x000100fd,                                                 /* OpReturn */
+    0x00010038,                                                 /* OpFunctionEnd */
+};
+
+struct vulkan_test_context
+{
+    HMODULE module;
+    VkInstance instance;
+    VkPhysicalDevice physical_device;
+    VkDevice device;
+    VkQueue queue;
+    VkCommandPool command_pool;
+    VkCommandBuffer command_buffer;
+    VkDescriptorSetLayout set_layout;
+    VkDescriptorPool descriptor_pool;
+    VkDescriptorSet descriptor_set;
+    VkPipelineLayout pipeline_layout;
+    VkRenderPass render_pass;
+    VkFramebuffer framebuffer;
+    VkPipeline pipeline;
+};
+
+static BOOL init_instance(struct vulkan_test_context *context)
+{
+    VkInstanceCreateInfo instance_info;
+    VkResult vr;
+
+    if (!(context->module = LoadLibraryA("winevulkan.dll")))
+    {
+        skip("Failed to load winevulkan.dll.\n");
+        return FALSE;
+    }
+
+    pvk_icdGetInstanceProcAddr = (void *)GetProcAddress(context->module, "vk_icdGetInstanceProcAddr");
+    ok(!!pvk_icdGetInstanceProcAddr, "Failed to get vk_icdGetInstanceProcAddr.\n");
+    pvkGetInstanceProcAddr = (void *)pvk_icdGetInstanceProcAddr(NULL, "vkGetInstanceProcAddr");
+    pvkCreateInstance = (void *)pvk_icdGetInstanceProcAddr(NULL, "vkCreateInstance");
+    ok(pvkGetInstanceProcAddr && pvkCreateInstance, "Failed to get global functions.\n");
+
+    memset(&instance_info, 0, sizeof(instance_info));
+    instance_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    if ((vr = pvkCreateInstance(&instance_info, NULL, &context->instance)) < 0)
+    {
+        skip("Failed to create Vulkan instance, vr %d.\n", vr);
+        FreeLibrary(context->module);
+        return FALSE;
+    }
+
+#define VK_INSTANCE_FUNC(name) \
+    p##name = (void *)pvkGetInstanceProcAddr(context->instance, #name); \
+    ok(!!p##name, "Failed to get %s.\n", #name);
+    VK_INSTANCE_FUNC(vkDestroyInstance)
+    VK_INSTANCE_FUNC(vkEnumeratePhysicalDevices)
+    VK_INSTANCE_FUNC(vkGetPhysicalDeviceQueueFamilyProperties)
+    VK_INSTANCE_FUNC(vkGetPhysicalDeviceMemoryProperties)
+    VK_INSTANCE_FUNC(vkCreateDevice)
+    VK_INSTANCE_FUNC(vkGetDeviceProcAddr)
+#undef VK_INSTANCE_FUNC
+
+    return TRUE;
+}
+
+static BOOL init_device(struct vulkan_test_context *context)
+{
+    VkCommandPoolCreateInfo pool_info = {VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+    VkCommandBufferAllocateInfo allocate_info = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+    VkQueueFamilyProperties families[16];
+    VkDeviceQueueCreateInfo queue_info;
+    VkDeviceCreateInfo device_info;
+    uint32_t count, i;
+    float priority = 1.0f;
+    VkResult vr;
+
+    count = 1;
+    vr = pvkEnumeratePhysicalDevices(context->instance, &count, &context->physical_device);
+    if ((vr != VK_SUCCESS && vr != VK_INCOMPLETE) || !count)
+    {
+        skip("No Vulkan physical devices available, vr %d.\n", vr);
+        return FALSE;
+    }
+
+    count = sizeof(families) / sizeof(*families);
+    pvkGetPhysicalDeviceQueueFamilyProperties(context->physical_device, &count, families);
+    for (i = 0; i < count; ++i)
+    {
+        if (families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT)
+            break;
+    }
+    if (i == count)
+    {
+        skip("No graphics queue family available.\n");
+        return FALSE;
+    }
+
+    memset(&queue_info, 0, sizeof(queue_info));
+    queue_info.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+    queue_info.queueFamilyIndex = i;
+    queue_info.queueCount = 1;
+    queue_info.pQueuePriorities = &priority;
+
+    memset(&device_info, 0, sizeof(device_info));
+    device_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    device_info.queueCreateInfoCount = 1;
+    device_info.pQueueCreateInfos = &queue_info;
+
+    vr = pvkCreateDevice(context->physical_device, &device_info, NULL, &context->device);
+    ok(vr == VK_SUCCESS, "Failed to create device, vr %d.\n", vr);
+    if (vr != VK_SUCCESS)
+        return FALSE;
+
+#define VK_DEVICE_FUNC(name) \
+    p##name = (void *)pvkGetDeviceProcAddr(context->device, #name); \
+    ok(!!p##name, "Failed to get %s.\n", #name);
+    VK_DEVICE_FUNC(vkDestroyDevice)
+    VK_DEVICE_FUNC(vkCreateCommandPool)
+    VK_DEVICE_FUNC(vkDestroyCommandPool)
+    VK_DEVICE_FUNC(vkAllocateCommandBuffers)
+    VK_DEVICE_FUNC(vkGetDeviceQueue)
+    VK_DEVICE_FUNC(vkQueueSubmit)
+    VK_DEVICE_FUNC(vkQueueWaitIdle)
+    VK_DEVICE_FUNC(vkDeviceWaitIdle)
+    VK_DEVICE_FUNC(vkCreateFence)
+    VK_DEVICE_FUNC(vkDestroyFence)
+    VK_DEVICE_FUNC(vkResetFences)
+    VK_DEVICE_FUNC(vkWaitForFences)
+    VK_DEVICE_FUNC(vkFreeCommandBuffers)
+    VK_DEVICE_FUNC(vkResetCommandPool)
+    VK_DEVICE_FUNC(vkBeginCommandBuffer)
+    VK_DEVICE_FUNC(vkEndCommandBuffer)
+    VK_DEVICE_FUNC(vkResetCommandBuffer)
+    VK_DEVICE_FUNC(vkCreateDescriptorSetLayout)
+    VK_DEVICE_FUNC(vkDestroyDescriptorSetLayout)
+    VK_DEVICE_FUNC(vkCreateDescriptorPool)
+    VK_DEVICE_FUNC(vkDestroyDescriptorPool)
+    VK_DEVICE_FUNC(vkAllocateDescriptorSets)
+    VK_DEVICE_FUNC(vkCreatePipelineLayout)
+    VK_DEVICE_FUNC(vkDestroyPipelineLayout)
+    VK_DEVICE_FUNC(vkCreateRenderPass)
+    VK_DEVICE_FUNC(vkDestroyRenderPass)
+    VK_DEVICE_FUNC(vkCreateFramebuffer)
+    VK_DEVICE_FUNC(vkDestroyFramebuffer)
+    VK_DEVICE_FUNC(vkCreateShaderModule)
+    VK_DEVICE_FUNC(vkDestroyShaderModule)
+    VK_DEVICE_FUNC(vkCreateGraphicsPipelines)
+    VK_DEVICE_FUNC(vkDestroyPipeline)
+    VK_DEVICE_FUNC(vkCmdBeginRenderPass)
+    VK_DEVICE_FUNC(vkCmdEndRenderPass)
+    VK_DEVICE_FUNC(vkCmdBindPipeline)
+    VK_DEVICE_FUNC(vkCmdBindDescriptorSets)
+    VK_DEVICE_FUNC(vkCmdDraw)
+    VK_DEVICE_FUNC(vkCreateBuffer)
+    VK_DEVICE_FUNC(vkDestroyBuffer)
+    VK_DEVICE_FUNC(vkGetBufferMemoryRequirements)
+    VK_DEVICE_FUNC(vkAllocateMemory)
+    VK_DEVICE_FUNC(vkFreeMemory)
+    VK_DEVICE_FUNC(vkBindBufferMemory)
+    VK_DEVICE_FUNC(vkMapMemory)
+    VK_DEVICE_FUNC(vkUnmapMemory)
+    VK_DEVICE_FUNC(vkCmdFillBuffer)
+    VK_DEVICE_FUNC(vkCmdPipelineBarrier)
+#undef VK_DEVICE_FUNC
+
+    pvkGetDeviceQueue(context->device, i, 0, &context->queue);
+    ok(!!context->queue, "Failed to get queue.\n");
+
+    pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    pool_info.queueFamilyIndex = i;
+    vr = pvkCreateCommandPool(context->device, &pool_info, NULL, &context->command_pool);
+    ok(vr == VK_SUCCESS, "Failed to create command pool, vr %d.\n", vr);
+
+    allocate_info.commandPool = context->command_pool;
+    allocate_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocate_info.commandBufferCount = 1;
+    vr = pvkAllocateCommandBuffers(context->device, &allocate_info, &context->command_buffer);
+    ok(vr == VK_SUCCESS, "Failed to allocate command buffer, vr %d.\n", vr);
+
+    return TRUE;
+}
+
+static void init_pipeline(struct vulkan_test_context *context)
+{
+    VkDescriptorSetLayoutCreateInfo set_layout_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
+    VkDescriptorPoolCreateInfo descriptor_pool_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
+    VkDescriptorSetAllocateInfo set_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
+    VkPipelineLayoutCreateInfo pipeline_layout_info = {VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
+    VkRenderPassCreateInfo render_pass_info = {VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO};
+    VkFramebufferCreateInfo framebuffer_info = {VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO};
+    VkShaderModuleCreateInfo shader_info = {VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO};
+    VkPipelineShaderStageCreateInfo stage_info = {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO};
+    VkPipelineVertexInputStateCreateInfo vertex_input_info = {VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO};
+    VkPipelineInputAssemblyStateCreateInfo input_assembly_info = {VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO};
+    VkPipelineRasterizationStateCreateInfo rasterization_info = {VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO};
+    VkGraphicsPipelineCreateInfo pipeline_info = {VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO};
+    VkDescriptorPoolSize pool_size = {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1};
+    VkSubpassDescription subpass;
+    VkShaderModule shader_module;
+    VkResult vr;
+
+    vr = pvkCreateDescriptorSetLayout(context->device, &set_layout_info, NULL, &context->set_layout);
+    ok(vr == VK_SUCCESS, "Failed to create descriptor set layout, vr %d.\n", vr);
+
+    descriptor_pool_info.maxSets = 1;
+    descriptor_pool_info.poolSizeCount = 1;
+    descriptor_pool_info.pPoolSizes = &pool_size;
+    vr = pvkCreateDescriptorPool(context->device, &descriptor_pool_info, NULL, &context->descriptor_pool);
+    ok(vr == VK_SUCCESS, "Failed to create descriptor pool, vr %d.\n", vr);
+
+    set_info.descriptorPool = context->descriptor_pool;
+    set_info.descriptorSetCount = 1;
+    set_info.pSetLayouts = &context->set_layout;
+    vr = pvkAllocateDescriptorSets(context->device, &set_info, &context->descriptor_set);
+    ok(vr == VK_SUCCESS, "Failed to allocate descriptor set, vr %d.\n", vr);
+
+    pipeline_layout_info.setLayoutCount = 1;
+    pipeline_layout_info.pSetLayouts = &context->set_layout;
+    vr = pvkCreatePipelineLayout(context->device, &pipeline_layout_info, NULL, &context->pipeline_layout);
+    ok(vr == VK_SUCCESS, "Failed to create pipeline layout, vr %d.\n", vr);
+
+    memset(&subpass, 0, sizeof(subpass));
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    render_pass_info.subpassCount = 1;
+    render_pass_info.pSubpasses = &subpass;
+    vr = pvkCreateRenderPass(context->device, &render_pass_info, NULL, &context->render_pass);
+    ok(vr == VK_SUCCESS, "Failed to create render pass, vr %d.\n", vr);
+
+    framebuffer_info.renderPass = context->render_pass;
+    framebuffer_info.width = 1;
+    framebuffer_info.height = 1;
+    framebuffer_info.layers = 1;
+    vr = pvkCreateFramebuffer(context->device, &framebuffer_info, NULL, &context->framebuffer);
+    ok(vr == VK_SUCCESS, "Failed to create framebuffer, vr %d.\n", vr);
+
+    shader_info.codeSize = sizeof(vs_code);
+    shader_info.pCode = vs_code;
+    vr = pvkCreateShaderModule(context->device, &shader_info, NULL, &shader_module);
+    ok(vr == VK_SUCCESS, "Failed to create shader module, vr %d.\n", vr);
+
+    stage_info.stage = VK_SHADER_STAGE_VERTEX_BIT;
+    stage_info.module = shader_module;
+    stage_info.pName = "main";
+    input_assembly_info.topology = VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
+    /* Nothing is ever rasterized, which allows leaving out all other state. */
+    rasterization_info.rasterizerDiscardEnable = VK_TRUE;
+    rasterization_info.lineWidth = 1.0f;
+
+    pipeline_info.stageCount = 1;
+    pipeline_info.pStages = &stage_info;
+    pipeline_info.pVertexInputState = &vertex_input_info;
+    pipeline_info.pInputAssemblyState = &input_assembly_info;
+    pipeline_info.pRasterizationState = &rasterization_info;
+    pipeline_info.layout = context->pipeline_layout;
+    pipeline_info.renderPass = context->render_pass;
+    vr = pvkCreateGraphicsPipelines(context->device, VK_NULL_HANDLE, 1, &pipeline_info, NULL, &context->pipeline);
+    ok(vr == VK_SUCCESS, "Failed to create graphics pipeline, vr %d.\n", vr);
+
+    pvkDestroyShaderModule(context->device, shader_module, NULL);
+}
+
+static void destroy_context(struct vulkan_test_context *context)
+{
+    if (context->device)
+    {
+        pvkDestroyPipeline(context->device, context->pipeline, NULL);
+        pvkDestroyFramebuffer(context->device, context->framebuffer, NULL);
+        pvkDestroyRenderPass(context->device, context->render_pass, NULL);
+        pvkDestroyPipelineLayout(context->device, context->pipeline_layout, NULL);
+        pvkDestroyDescriptorPool(context->device, context->descriptor_pool, NULL);
+        pvkDestroyDescriptorSetLayout(context->device, context->set_layout, NULL);
+        pvkDestroyCommandPool(context->device, context->command_pool, NULL);
+        pvkDestroyDevice(context->device, NULL);
+    }
+    pvkDestroyInstance(context->instance, NULL);
+    FreeLibrary(context->module);
+}
+
+static void begin_batch(const struct vulkan_test_context *context)
+{
+    VkCommandBufferBeginInfo begin_info = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+    VkRenderPassBeginInfo pass_info = {VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO};
+    VkResult vr;
+
+    vr = pvkResetCommandBuffer(context->command_buffer, 0);
+    ok(vr == VK_SUCCESS, "Failed to reset command buffer, vr %d.\n", vr);
+
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vr = pvkBeginCommandBuffer(context->command_buffer, &begin_info);
+    ok(vr == VK_SUCCESS, "Failed to begin command buffer, vr %d.\n", vr);
+
+    pass_info.renderPass = context->render_pass;
+    pass_info.framebuffer = context->framebuffer;
+    pass_info.renderArea.extent.width = 1;
+    pass_info.renderArea.extent.height = 1;
+    pvkCmdBeginRenderPass(context->command_buffer, &pass_info, VK_SUBPASS_CONTENTS_INLINE);
+    pvkCmdBindPipeline(context->command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, context->pipeline);
+}
+
+static void end_batch(const struct vulkan_test_context *context)
+{
+    VkResult vr;
+
+    pvkCmdEndRenderPass(context->command_buffer);
+    vr = pvkEndCommandBuffer(context->command_buffer);
+    ok(vr == VK_SUCCESS, "Failed to end command buffer, vr %d.\n", vr);
+}
+
+static void test_command_buffers(void)
+{
+    VkCommandBufferInheritanceInfo inheritance_info = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO};
+    VkCommandBufferAllocateInfo allocate_info = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+    VkCommandBufferBeginInfo begin_info = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+    struct vulkan_test_context context;
+    VkCommandBuffer buffers[100];
+    unsigned int i, j;
+    VkResult vr;
+
+    memset(&context, 0, sizeof(context));
+    if (!init_instance(&context))
+        return;
+    if (!init_device(&context))
+    {
+        destroy_context(&context);
+        return;
+    }
+
+    allocate_info.commandPool = context.command_pool;
+    allocate_info.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+    allocate_info.commandBufferCount = sizeof(buffers) / sizeof(*buffers);
+    begin_info.pInheritanceInfo = &inheritance_info;
+
+    /* Wrappers are recycled, make sure they come back in a usable state. */
+    for (i = 0; i < 10; ++i)
+    {
+        vr = pvkAllocateCommandBuffers(context.device, &allocate_info, buffers);
+        ok(vr == VK_SUCCESS, "Failed to allocate command buffers, vr %d.\n", vr);
+        for (j = 0; j < allocate_info.commandBufferCount; ++j)
+        {
+            ok(!!buffers[j], "Got unexpected command buffer %p.\n", buffers[j]);
+            vr = pvkBeginCommandBuffer(buffers[j], &begin_info);
+            ok(vr == VK_SUCCESS, "Failed to begin command buffer, vr %d.\n", vr);
+            vr = pvkEndCommandBuffer(buffers[j]);
+            ok(vr == VK_SUCCESS, "Failed to end command buffer, vr %d.\n", vr);
+        }
+
+        if (i & 1)
+        {
+            vr = pvkResetCommandPool(context.device, context.command_pool, 0);
+            ok(vr == VK_SUCCESS, "Failed to reset command pool, vr %d.\n", vr);
+        }
+
+        buffers[0] = NULL;
+        pvkFreeCommandBuffers(context.device, context.command_pool, allocate_info.commandBufferCount, buffers);
+    }
+
+    /* The command buffers left over are freed along with the pool. */
+    vr = pvkAllocateCommandBuffers(context.device, &allocate_info, buffers);
+    ok(vr == VK_SUCCESS, "Failed to allocate command buffers, vr %d.\n", vr);
+
+    destroy_context(&context);
+}
+
+#define FILL_COUNT 4
+
+struct fill_buffer
+{
+    VkBuffer buffer;
+    VkDeviceMemory memory;
+    uint32_t *data;
+    VkCommandBuffer command_buffers[FILL_COUNT];
+};
+
+/* Command buffer i writes i + 1 to slot 0 and to slot i + 1 of a host visible buffer. */
+static BOOL init_fill_buffer(const struct vulkan_test_context *context, struct fill_buffer *fill)
+{
+    VkCommandBufferAllocateInfo allocate_info = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+    VkCommandBufferBeginInfo begin_info = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+    VkMemoryAllocateInfo memory_info = {VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+    VkBufferCreateInfo buffer_info = {VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+    VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    static const VkMemoryPropertyFlags host_flags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+            | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    VkPhysicalDeviceMemoryProperties memory_properties;
+    VkMemoryRequirements requirements;
+    unsigned int i;
+    VkResult vr;
+
+    buffer_info.size = (FILL_COUNT + 1) * sizeof(*fill->data);
+    buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    vr = pvkCreateBuffer(context->device, &buffer_info, NULL, &fill->buffer);
+    ok(vr == VK_SUCCESS, "Failed to create buffer, vr %d.\n", vr);
+
+    pvkGetBufferMemoryRequirements(context->device, fill->buffer, &requirements);
+    pvkGetPhysicalDeviceMemoryProperties(context->physical_device, &memory_properties);
+    for (i = 0; i < memory_properties.memoryTypeCount; ++i)
+    {
+        if ((requirements.memoryTypeBits & (1u << i))
+                && (memory_properties.memoryTypes[i].propertyFlags & host_flags) == host_flags)
+            break;
+    }
+    if (i == memory_properties.memoryTypeCount)
+    {
+        skip("No host visible memory type available.\n");
+        pvkDestroyBuffer(context->device, fill->buffer, NULL);
+        return FALSE;
+    }
+
+    memory_info.allocationSize = requirements.size;
+    memory_info.memoryTypeIndex = i;
+    vr = pvkAllocateMemory(context->device, &memory_info, NULL, &fill->memory);
+    ok(vr == VK_SUCCESS, "Failed to allocate memory, vr %d.\n", vr);
+    vr = pvkBindBufferMemory(context->device, fill->buffer, fill->memory, 0);
+    ok(vr == VK_SUCCESS, "Failed to bind buffer memory, vr %d.\n", vr);
+    vr = pvkMapMemory(context->device, fill->memory, 0, VK_WHOLE_SIZE, 0, (void **)&fill->data);
+    ok(vr == VK_SUCCESS, "Failed to map memory, vr %d.\n", vr);
+
+    allocate_info.commandPool = context->command_pool;
+    allocate_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocate_info.commandBufferCount = FILL_COUNT;
+    vr = pvkAllocateCommandBuffers(context->device, &allocate_info, fill->command_buffers);
+    ok(vr == VK_SUCCESS, "Failed to allocate command buffers, vr %d.\n", vr);
+
+    /* The barrier orders the writes with later submits and makes them visible to the host. */
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_HOST_READ_BIT;
+    for (i = 0; i < FILL_COUNT; ++i)
+    {
+        vr = pvkBeginCommandBuffer(fill->command_buffers[i], &begin_info);
+        ok(vr == VK_SUCCESS, "Failed to begin command buffer, vr %d.\n", vr);
+        pvkCmdFillBuffer(fill->command_buffers[i], fill->buffer, 0, sizeof(*fill->data), i + 1);
+        pvkCmdFillBuffer(fill->command_buffers[i], fill->buffer, (i + 1) * sizeof(*fill->data), sizeof(*fill->data), i + 1);
+        pvkCmdPipelineBarrier(fill->command_buffers[i], VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &barrier, 0, NULL, 0, NULL);
+        vr = pvkEndCommandBuffer(fill->command_buffers[i]);
+        ok(vr == VK_SUCCESS, "Failed to end command buffer, vr %d.\n", vr);
+    }
+
+    return TRUE;
+}
+
+static void destroy_fill_buffer(const struct vulkan_test_context *context, struct fill_buffer *fill)
+{
+    pvkFreeCommandBuffers(context->device, context->command_pool, FILL_COUNT, fill->command_buffers);
+    pvkUnmapMemory(context->device, fill->memory);
+    pvkDestroyBuffer(context->device, fill->buffer, NULL);
+    pvkFreeMemory(context->device, fill->memory, NULL);
+}
+
+/* Submit all fill command buffers one by one, without a fence. */
+static void submit_fills(const struct vulkan_test_context *context, struct fill_buffer *fill)
+{
+    VkSubmitInfo submit_info = {VK_STRUCTURE_TYPE_SUBMIT_INFO};
+    unsigned int i;
+    VkResult vr;
+
+    memset(fill->data, 0, (FILL_COUNT + 1) * sizeof(*fill->data));
+    submit_info.commandBufferCount = 1;
+    for (i = 0; i < FILL_COUNT; ++i)
+    {
+        submit_info.pCommandBuffers = &fill->command_buffers[i];
+        vr = pvkQueueSubmit(context->queue, 1, &submit_info, VK_NULL_HANDLE);
+        ok(vr == VK_SUCCESS, "Got unexpected vr %d.\n", vr);
+    }
+}
+
+#define check_fills(a) check_fills_(__LINE__, a)
+static void check_fills_(unsigned int line, const struct fill_buffer *fill)
+{
+    unsigned int i;
+
+    /* All submits completed, the last one last. */
+    ok_(__FILE__, line)(fill->data[0] == FILL_COUNT, "Got unexpected value %u in slot 0.\n", fill->data[0]);
+    for (i = 0; i < FILL_COUNT; ++i)
+        ok_(__FILE__, line)(fill->data[i + 1] == i + 1, "Got unexpected value %u in slot %u.\n", fill->data[i + 1], i + 1);
+}
+
+static void test_queue_submit(void)
+{
+    VkCommandBufferBeginInfo begin_info = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+    VkFenceCreateInfo fence_info = {VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
+    VkSubmitInfo submit_info[2];
+    struct vulkan_test_context context;
+    struct fill_buffer fill;
+    unsigned int i;
+    VkFence fence;
+    VkResult vr;
+
+    memset(&context, 0, sizeof(context));
+    if (!init_instance(&context))
+        return;
+    if (!init_device(&context))
+    {
+        destroy_context(&context);
+        return;
+    }
+
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+    vr = pvkBeginCommandBuffer(context.command_buffer, &begin_info);
+    ok(vr == VK_SUCCESS, "Failed to begin command buffer, vr %d.\n", vr);
+    vr = pvkEndCommandBuffer(context.command_buffer);
+    ok(vr == VK_SUCCESS, "Failed to end command buffer, vr %d.\n", vr);
+
+    vr = pvkCreateFence(context.device, &fence_info, NULL, &fence);
+    ok(vr == VK_SUCCESS, "Failed to create fence, vr %d.\n", vr);
+
+    memset(submit_info, 0, sizeof(submit_info));
+    submit_info[0].sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info[0].commandBufferCount = 1;
+    submit_info[0].pCommandBuffers = &context.command_buffer;
+    submit_info[1] = submit_info[0];
+
+    vr = pvkQueueSubmit(context.queue, 0, NULL, VK_NULL_HANDLE);
+    ok(vr == VK_SUCCESS, "Got unexpected vr %d.\n", vr);
+    vr = pvkQueueSubmit(context.queue, 1, submit_info, VK_NULL_HANDLE);
+    ok(vr == VK_SUCCESS, "Got unexpected vr %d.\n", vr);
+    vr = pvkQueueWaitIdle(context.queue);
+    ok(vr == VK_SUCCESS, "Got unexpected vr %d.\n", vr);
+
+    /* Submits without a fence may be merged with the next one that has one. */
+    for (i = 0; i < 10; ++i)
+    {
+        vr = pvkQueueSubmit(context.queue, 1, submit_info, VK_NULL_HANDLE);
+        ok(vr == VK_SUCCESS, "Got unexpected vr %d.\n", vr);
+        vr = pvkQueueSubmit(context.queue, 1, submit_info, VK_NULL_HANDLE);
+        ok(vr == VK_SUCCESS, "Got unexpected vr %d.\n", vr);
+        vr = pvkQueueSubmit(context.queue, 2, submit_info, fence);
+        ok(vr == VK_SUCCESS, "Got unexpected vr %d.\n", vr);
+        vr = pvkWaitForFences(context.device, 1, &fence, VK_TRUE, ~(uint64_t)0);
+        ok(vr == VK_SUCCESS, "Got unexpected vr %d.\n", vr);
+        vr = pvkResetFences(context.device, 1, &fence);
+        ok(vr == VK_SUCCESS, "Got unexpected vr %d.\n", vr);
+    }
+
+    vr = pvkQueueSubmit(context.queue, 0, NULL, fence);
+    ok(vr == VK_SUCCESS, "Got unexpected vr %d.\n", vr);
+    vr = pvkWaitForFences(context.device, 1, &fence, VK_TRUE, ~(uint64_t)0);
+    ok(vr == VK_SUCCESS, "Got unexpected vr %d.\n", vr);
+    vr = pvkResetFences(context.device, 1, &fence);
+    ok(vr == VK_SUCCESS, "Got unexpected vr %d.\n", vr);
+
+    /* Deferred submits reach the device in order and complete when waited for. */
+    if (init_fill_buffer(&context, &fill))
+    {
+        submit_fills(&context, &fill);
+        vr = pvkQueueWaitIdle(context.queue);
+        ok(vr == VK_SUCCESS, "Got unexpected vr %d.\n", vr);
+        check_fills(&fill);
+
+        submit_fills(&context, &fill);
+        vr = pvkDeviceWaitIdle(context.device);
+        ok(vr == VK_SUCCESS, "Got unexpected vr %d.\n", vr);
+        check_fills(&fill);
+
+        submit_fills(&context, &fill);
+        vr = pvkQueueSubmit(context.queue, 0, NULL, fence);
+        ok(vr == VK_SUCCESS, "Got unexpected vr %d.\n", vr);
+        vr = pvkWaitForFences(context.device, 1, &fence, VK_TRUE, ~(uint64_t)0);
+        ok(vr == VK_SUCCESS, "Got unexpected vr %d.\n", vr);
+        check_fills(&fill);
+
+        destroy_fill_buffer(&context, &fill);
+    }
+
+    pvkDestroyFence(context.device, fence, NULL);
+    destroy_context(&context);
+}
+
+/* winevulkan reads its settings when it is loaded, so tests depending on them run in a child process. */
+static void run_child(const char *test, const char *variable)
+{
+    STARTUPINFOA si = {sizeof(si)};
+    PROCESS_INFORMATION pi;
+    char cmdline[MAX_PATH + 64];
+    char **argv;
+    BOOL ret;
+
+    winetest_get_mainargs(&argv);
+    sprintf(cmdline, "\"%s\" vulkan %s", argv[0], test);
+    SetEnvironmentVariableA(variable, "1");
+    ret = CreateProcessA(argv[0], cmdline, NULL, NULL, FALSE, 0, NULL, NULL, &si, &pi);
+    SetEnvironmentVariableA(variable, NULL);
+    ok(ret, "CreateProcess failed, error %u.\n", GetLastError());
+    if (!ret)
+        return;
+    winetest_wait_child_process(pi.hProcess);
+    CloseHandle(pi.hThread);
+    CloseHandle(pi.hProcess);
+}
+
+static double calls_per_second(LONGLONG calls, LONGLONG ticks)
+{
+    LARGE_INTEGER frequency;
+
+    QueryPerformanceFrequency(&frequency);
+    return ticks ? (double)calls * frequency.QuadPart / ticks : 0.0;
+}
+
+static void test_dispatch(BOOL fast_dispatch)
+{
+    VkFenceCreateInfo fence_info = {VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
+    VkSubmitInfo submit_info = {VK_STRUCTURE_TYPE_SUBMIT_INFO};
+    LONGLONG draw_ticks = 0, bind_ticks = 0;
+    struct vulkan_test_context context;
+    LARGE_INTEGER start, end;
+    PFN_vkVoidFunction func;
+    unsigned int i, j;
+    VkFence fence;
+    VkResult vr;
+
+    memset(&context, 0, sizeof(context));
+    if (!init_instance(&context))
+        return;
+    if (!init_device(&context))
+    {
+        destroy_context(&context);
+        return;
+    }
+    init_pipeline(&context);
+
+    /* Device functions are the same for the instance and all its devices, unless
+     * fast dispatch hands out untraced thunks from vkGetDeviceProcAddr. Profiling
+     * turns fast dispatch off. */
+    if (fast_dispatch && GetEnvironmentVariableA("WINE_VK_PROFILE", NULL, 0))
+        fast_dispatch = FALSE;
+    func = pvkGetInstanceProcAddr(context.instance, "vkCmdDraw");
+    ok((func != (PFN_vkVoidFunction)pvkCmdDraw) == fast_dispatch, "Got unexpected vkCmdDraw %p, device %p.\n",
+            func, pvkCmdDraw);
+    func = pvkGetInstanceProcAddr(context.instance, "vkCmdBindDescriptorSets");
+    ok((func != (PFN_vkVoidFunction)pvkCmdBindDescriptorSets) == fast_dispatch,
+            "Got unexpected vkCmdBindDescriptorSets %p, device %p.\n", func, pvkCmdBindDescriptorSets);
+    /* Functions resetting the conversion arena are never dispatched directly. */
+    func = pvkGetInstanceProcAddr(context.instance, "vkBeginCommandBuffer");
+    ok(func == (PFN_vkVoidFunction)pvkBeginCommandBuffer, "Got unexpected vkBeginCommandBuffer %p, device %p.\n",
+            func, pvkBeginCommandBuffer);
+    func = pvkGetDeviceProcAddr(context.device, "vkCmdDrawNonexistent");
+    ok(!func, "Got unexpected function %p.\n", func);
+
+    for (i = 0; i < BATCH_COUNT; ++i)
+    {
+        begin_batch(&context);
+
+        QueryPerformanceCounter(&start);
+        for (j = 0; j < BATCH_SIZE; ++j)
+            pvkCmdDraw(context.command_buffer, 1, 1, 0, 0);
+        QueryPerformanceCounter(&end);
+        draw_ticks += end.QuadPart - start.QuadPart;
+
+        end_batch(&context);
+        begin_batch(&context);
+
+        QueryPerformanceCounter(&start);
+        for (j = 0; j < BATCH_SIZE; ++j)
+        {
+            pvkCmdBindDescriptorSets(context.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                    context.pipeline_layout, 0, 1, &context.descriptor_set, 0, NULL);
+        }
+        QueryPerformanceCounter(&end);
+        bind_ticks += end.QuadPart - start.QuadPart;
+
+        end_batch(&context);
+    }
+
+    trace("%s dispatch: vkCmdDraw %.0f calls/s, vkCmdBindDescriptorSets %.0f calls/s.\n",
+            fast_dispatch ? "fast" : "regular",
+            calls_per_second((LONGLONG)BATCH_COUNT * BATCH_SIZE, draw_ticks),
+            calls_per_second((LONGLONG)BATCH_COUNT * BATCH_SIZE, bind_ticks));
+
+    begin_batch(&context);
+    for (i = 0; i < 1000; ++i)
+    {
+        pvkCmdBindDescriptorSets(context.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                context.pipeline_layout, 0, 1, &context.descriptor_set, 0, NULL);
+        pvkCmdDraw(context.command_buffer, 1, 1, 0, 0);
+    }
+    end_batch(&context);
+
+    vr = pvkCreateFence(context.device, &fence_info, NULL, &fence);
+    ok(vr == VK_SUCCESS, "Failed to create fence, vr %d.\n", vr);
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &context.command_buffer;
+    vr = pvkQueueSubmit(context.queue, 1, &submit_info, fence);
+    ok(vr == VK_SUCCESS, "Got unexpected vr %d.\n", vr);
+    vr = pvkWaitForFences(context.device, 1, &fence, VK_TRUE, ~(uint64_t)0);
+    ok(vr == VK_SUCCESS, "Got unexpected vr %d.\n", vr);
+
+    pvkDestroyFence(context.device, fence, NULL);
+    destroy_context(&context);
+}
+
+START_TEST(vulkan)
+{
+    char **argv;
+    int argc;
+
+    argc = winetest_get_mainargs(&argv);
+    if (argc >= 3)
+    {
+        if (!strcmp(argv[2], "coalesce_submits"))
+            test_queue_submit();
+        else if (!strcmp(argv[2], "fast_dispatch"))
+            test_dispatch(TRUE);
+        return;
+    }
+
+    test_command_buffers();
+    test_queue_submit();
+    run_child("coalesce_submits", "WINE_VK_COALESCE_SUBMITS");
+    test_dispatch(FALSE);
+    run_child("fast_dispatch", "WINE_VK_FAST_DISPATCH");
+}
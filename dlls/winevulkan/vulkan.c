@@ -17,7 +17,12 @@
  * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
  */
 
+#include "config.h"
+
 #include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
 
 #include "windef.h"
 #include "winbase.h"
@@ -25,6 +30,7 @@
 
 #include "wine/debug.h"
 #include "wine/heap.h"
+#include "wine/unicode.h"
 #include "wine/vulkan.h"
 #include "wine/vulkan_driver.h"
 #include "vulkan_private.h"
@@ -43,21 +49,728 @@ static void wine_vk_physical_device_free(struct VkPhysicalDevice_T *phys_dev);
 
 static const struct vulkan_funcs *vk_funcs = NULL;
 
+/* Hand out untraced thunks from vkGetDeviceProcAddr where possible. */
+static BOOL fast_dispatch = FALSE;
+
+/* Defer vkQueueSubmit calls without fence and signal semaphores, merging them
+ * with the next submit which needs to reach the host.
+ */
+static BOOL coalesce_submits = FALSE;
+
+/* Keep an implicit pipeline cache per device, persisted across runs. */
+static BOOL implicit_pipeline_cache = FALSE;
+
+#if defined(USE_STRUCT_CONVERSION)
+/* Minimum size of an arena chunk and the amount of chunk memory an arena holds on to across resets. */
+#define WINE_VK_ARENA_CHUNK_SIZE 4096
+#define WINE_VK_ARENA_MAX_RETAINED (256 * 1024)
+
+static DWORD arena_tls_index = TLS_OUT_OF_INDEXES;
+
+/* Slow path of wine_vk_arena_alloc, called when the current chunk is exhausted. */
+void *wine_vk_arena_alloc_chunk(struct wine_vk_arena *arena, SIZE_T size)
+{
+    struct wine_vk_arena_chunk *chunk = arena->current, *next;
+    SIZE_T chunk_size;
+
+    /* Reuse a chunk retained from before the last reset if it is large enough. */
+    if (chunk && (next = chunk->next) && next->size >= size)
+    {
+        next->used = size;
+        arena->current = next;
+        return next->data;
+    }
+
+    chunk_size = max(size, WINE_VK_ARENA_CHUNK_SIZE);
+    if (chunk)
+        chunk_size = max(chunk_size, min(chunk->size * 2, WINE_VK_ARENA_MAX_RETAINED));
+
+    if (!(next = heap_alloc(FIELD_OFFSET(struct wine_vk_arena_chunk, data[chunk_size]))))
+    {
+        ERR("Failed to allocate %lu bytes of conversion memory.\n", (unsigned long)size);
+        return NULL;
+    }
+    next->size = chunk_size;
+    next->used = size;
+
+    if (chunk)
+    {
+        next->next = chunk->next;
+        chunk->next = next;
+    }
+    else
+    {
+        next->next = NULL;
+        arena->first = next;
+    }
+    arena->current = next;
+    return next->data;
+}
+
+void wine_vk_arena_reset(struct wine_vk_arena *arena)
+{
+    struct wine_vk_arena_chunk *chunk, **prev;
+    SIZE_T retained = 0;
+
+    if (!arena->current || (arena->current == arena->first && !arena->first->used))
+        return;
+
+    /* Trim chunks exceeding our retention budget, so a single huge conversion
+     * doesn't pin memory for the lifetime of the arena.
+     */
+    for (prev = &arena->first; (chunk = *prev); )
+    {
+        if (chunk != arena->first && retained + chunk->size > WINE_VK_ARENA_MAX_RETAINED)
+        {
+            *prev = chunk->next;
+            heap_free(chunk);
+            continue;
+        }
+        chunk->used = 0;
+        retained += chunk->size;
+        prev = &chunk->next;
+    }
+    arena->current = arena->first;
+}
+
+void wine_vk_arena_free(struct wine_vk_arena *arena)
+{
+    struct wine_vk_arena_chunk *chunk, *next;
+
+    for (chunk = arena->first; chunk; chunk = next)
+    {
+        next = chunk->next;
+        heap_free(chunk);
+    }
+    arena->first = arena->current = NULL;
+}
+
+/* Arena for conversions done by calls not recorded into a command buffer. It is reset
+ * at the end of each call, which is safe as the calls are not reentrant.
+ */
+struct wine_vk_arena *wine_vk_get_thread_arena(void)
+{
+    struct wine_vk_arena *arena = TlsGetValue(arena_tls_index);
+
+    if (!arena)
+    {
+        if (!(arena = heap_alloc_zero(sizeof(*arena))))
+        {
+            ERR("Failed to allocate thread arena.\n");
+            return NULL;
+        }
+        TlsSetValue(arena_tls_index, arena);
+    }
+    return arena;
+}
+
+static void wine_vk_free_thread_arena(void)
+{
+    struct wine_vk_arena *arena = TlsGetValue(arena_tls_index);
+
+    if (!arena)
+        return;
+
+    wine_vk_arena_free(arena);
+    heap_free(arena);
+    TlsSetValue(arena_tls_index, NULL);
+}
+#endif
+
+/* Call profiling. Counters are written to the file named by WINE_VK_PROFILE
+ * every few seconds and when the process exits, sorted by total time.
+ */
+#define WINE_VK_PROFILE_INTERVAL 5000
+
+BOOL wine_vk_profiling = FALSE;
+static char profile_filename[MAX_PATH];
+
+/* Counters for the hand written functions, the thunks have their own. */
+enum wine_vk_custom_profile_id
+{
+    PROFILE_vkAcquireNextImageKHR,
+    PROFILE_vkAllocateCommandBuffers,
+    PROFILE_vkCmdExecuteCommands,
+    PROFILE_vkCreateCommandPool,
+    PROFILE_vkDestroyCommandPool,
+    PROFILE_vkFreeCommandBuffers,
+    PROFILE_vkQueuePresentKHR,
+    PROFILE_vkQueueSubmit,
+    PROFILE_vkResetCommandPool,
+};
+
+static struct wine_vk_profile_counters custom_profile_counters[] =
+{
+    {"vkAcquireNextImageKHR"},
+    {"vkAllocateCommandBuffers"},
+    {"vkCmdExecuteCommands"},
+    {"vkCreateCommandPool"},
+    {"vkDestroyCommandPool"},
+    {"vkFreeCommandBuffers"},
+    {"vkQueuePresentKHR"},
+    {"vkQueueSubmit"},
+    {"vkResetCommandPool"},
+};
+
+ULONGLONG wine_vk_profile_time(void)
+{
+#if defined(HAVE_CLOCK_GETTIME) && defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ULONGLONG)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#else
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+
+    if (!frequency.QuadPart)
+        QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return counter.QuadPart * 1000000000 / frequency.QuadPart;
+#endif
+}
+
+static inline void wine_vk_profile_add(LONGLONG volatile *dest, LONGLONG value)
+{
+    LONGLONG old;
+
+    do
+    {
+        old = *dest;
+    } while (InterlockedCompareExchange64(dest, old + value, old) != old);
+}
+
+void wine_vk_profile_update(struct wine_vk_profile_counters *counters, const struct wine_vk_profile_timer *timer)
+{
+    ULONGLONG total = wine_vk_profile_time() - timer->start;
+    ULONGLONG host = timer->host_start ? timer->host_time : total;
+    unsigned int bucket = 0;
+
+    while (bucket < WINE_VK_PROFILE_BUCKETS - 1 && total >> (bucket + 1))
+        bucket++;
+
+    wine_vk_profile_add(&counters->calls, 1);
+    wine_vk_profile_add(&counters->conversion_time, total - host);
+    wine_vk_profile_add(&counters->host_time, host);
+    InterlockedIncrement(&counters->histogram[bucket]);
+}
+
+static int wine_vk_profile_compare(const void *a, const void *b)
+{
+    const struct wine_vk_profile_counters *c1 = *(struct wine_vk_profile_counters * const *)a;
+    const struct wine_vk_profile_counters *c2 = *(struct wine_vk_profile_counters * const *)b;
+    LONGLONG t1 = c1->conversion_time + c1->host_time, t2 = c2->conversion_time + c2->host_time;
+
+    return t1 < t2 ? 1 : t1 > t2 ? -1 : 0;
+}
+
+static BOOL wine_vk_profile_dump(void)
+{
+    struct wine_vk_profile_counters *counters, **sorted;
+    unsigned int count, used, i, j;
+    char line[1024];
+    HANDLE file;
+    DWORD size;
+    int len;
+
+    counters = wine_vk_get_profile_counters(&count);
+    if (!(sorted = heap_alloc((count + ARRAY_SIZE(custom_profile_counters)) * sizeof(*sorted))))
+        return FALSE;
+
+    for (i = 0, used = 0; i < count; i++)
+    {
+        if (counters[i].calls)
+            sorted[used++] = &counters[i];
+    }
+    for (i = 0; i < ARRAY_SIZE(custom_profile_counters); i++)
+    {
+        if (custom_profile_counters[i].calls)
+            sorted[used++] = &custom_profile_counters[i];
+    }
+    qsort(sorted, used, sizeof(*sorted), wine_vk_profile_compare);
+
+    file = CreateFileA(profile_filename, GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, 0, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        WARN("Failed to open %s, error %u.\n", debugstr_a(profile_filename), GetLastError());
+        heap_free(sorted);
+        return FALSE;
+    }
+
+    len = sprintf(line, "%-48s %12s %16s %16s  %s\n", "function", "calls", "conversion ns", "host ns",
+            "log2(ns):calls");
+    WriteFile(file, line, len, &size, NULL);
+
+    for (i = 0; i < used; i++)
+    {
+        len = sprintf(line, "%-48s %12.0f %16.0f %16.0f ", sorted[i]->name, (double)sorted[i]->calls,
+                (double)sorted[i]->conversion_time, (double)sorted[i]->host_time);
+        for (j = 0; j < WINE_VK_PROFILE_BUCKETS; j++)
+        {
+            if (sorted[i]->histogram[j])
+                len += sprintf(line + len, " %u:%d", j, sorted[i]->histogram[j]);
+        }
+        line[len++] = '\n';
+        WriteFile(file, line, len, &size, NULL);
+    }
+
+    CloseHandle(file);
+    heap_free(sorted);
+    return TRUE;
+}
+
+/* The thread holds a reference on the module, which keeps winevulkan loaded
+ * while it runs. It only exits when the profile can't be written anymore.
+ */
+static DWORD WINAPI wine_vk_profile_thread(void *arg)
+{
+    do
+    {
+        Sleep(WINE_VK_PROFILE_INTERVAL);
+    } while (wine_vk_profile_dump());
+
+    ERR("Failed to write the call profile, stopping.\n");
+    wine_vk_profiling = FALSE;
+    FreeLibraryAndExitThread(arg, 0);
+}
+
+static void wine_vk_profile_init(void)
+{
+    HMODULE module;
+    HANDLE thread;
+
+    if (!GetEnvironmentVariableA("WINE_VK_PROFILE", profile_filename, sizeof(profile_filename))
+            || !profile_filename[0])
+        return;
+
+    TRACE("Writing call profile to %s.\n", debugstr_a(profile_filename));
+    wine_vk_profiling = TRUE;
+
+    if (!GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS, (const WCHAR *)wine_vk_profile_thread, &module))
+    {
+        ERR("Failed to get a module reference, error %u.\n", GetLastError());
+        return;
+    }
+    if ((thread = CreateThread(NULL, 0, wine_vk_profile_thread, module, 0, NULL)))
+        CloseHandle(thread);
+    else
+    {
+        ERR("Failed to create profiling thread.\n");
+        FreeLibrary(module);
+    }
+}
+
+/* Hash map helpers. The map grows once the average chain length exceeds one. */
+#define WINE_VK_HANDLE_MAP_MIN_BUCKETS 16
+
+static inline unsigned int wine_vk_handle_hash(uint64_t handle, unsigned int bucket_count)
+{
+    return (unsigned int)((handle * 0x9e3779b97f4a7c15ull) >> 32) & (bucket_count - 1);
+}
+
+void wine_vk_handle_map_init(struct wine_vk_handle_map *map)
+{
+    map->buckets = NULL;
+    map->bucket_count = 0;
+    map->count = 0;
+    InitializeSRWLock(&map->lock);
+}
+
+void wine_vk_handle_map_destroy(struct wine_vk_handle_map *map)
+{
+    heap_free(map->buckets);
+    map->buckets = NULL;
+    map->bucket_count = 0;
+    map->count = 0;
+}
+
+static BOOL wine_vk_handle_map_grow(struct wine_vk_handle_map *map)
+{
+    unsigned int i, bucket_count = max(map->bucket_count * 2, WINE_VK_HANDLE_MAP_MIN_BUCKETS);
+    struct wine_vk_handle_entry **buckets, *entry, *next;
+
+    if (!(buckets = heap_alloc_zero(bucket_count * sizeof(*buckets))))
+        return FALSE;
+
+    for (i = 0; i < map->bucket_count; i++)
+    {
+        for (entry = map->buckets[i]; entry; entry = next)
+        {
+            unsigned int idx = wine_vk_handle_hash(entry->host_handle, bucket_count);
+
+            next = entry->next;
+            entry->next = buckets[idx];
+            buckets[idx] = entry;
+        }
+    }
+
+    heap_free(map->buckets);
+    map->buckets = buckets;
+    map->bucket_count = bucket_count;
+    return TRUE;
+}
+
+BOOL wine_vk_handle_map_insert(struct wine_vk_handle_map *map, struct wine_vk_handle_entry *entry)
+{
+    unsigned int idx;
+    BOOL ret = TRUE;
+
+    AcquireSRWLockExclusive(&map->lock);
+    if (map->count >= map->bucket_count && !wine_vk_handle_map_grow(map) && !map->bucket_count)
+        ret = FALSE;
+    else
+    {
+        idx = wine_vk_handle_hash(entry->host_handle, map->bucket_count);
+        entry->next = map->buckets[idx];
+        map->buckets[idx] = entry;
+        map->count++;
+    }
+    ReleaseSRWLockExclusive(&map->lock);
+
+    return ret;
+}
+
+void wine_vk_handle_map_remove(struct wine_vk_handle_map *map, struct wine_vk_handle_entry *entry)
+{
+    struct wine_vk_handle_entry **cur;
+
+    AcquireSRWLockExclusive(&map->lock);
+    if (map->bucket_count)
+    {
+        for (cur = &map->buckets[wine_vk_handle_hash(entry->host_handle, map->bucket_count)]; *cur; cur = &(*cur)->next)
+        {
+            if (*cur == entry)
+            {
+                *cur = entry->next;
+                map->count--;
+                break;
+            }
+        }
+    }
+    ReleaseSRWLockExclusive(&map->lock);
+}
+
+struct wine_vk_handle_entry *wine_vk_handle_map_get(struct wine_vk_handle_map *map, uint64_t host_handle)
+{
+    struct wine_vk_handle_entry *entry = NULL;
+
+    AcquireSRWLockShared(&map->lock);
+    if (map->bucket_count)
+    {
+        for (entry = map->buckets[wine_vk_handle_hash(host_handle, map->bucket_count)]; entry; entry = entry->next)
+        {
+            if (entry->host_handle == host_handle)
+                break;
+        }
+    }
+    ReleaseSRWLockShared(&map->lock);
+
+    return entry;
+}
+
+/* Number of command buffer wrappers allocated at once by a command pool. */
+#define WINE_VK_COMMAND_BUFFER_SLAB_SIZE 32
+
+struct wine_cmd_buffer_slab
+{
+    struct list entry;
+    struct VkCommandBuffer_T buffers[WINE_VK_COMMAND_BUFFER_SLAB_SIZE];
+};
+
+static struct wine_cmd_pool *wine_cmd_pool_from_handle(struct VkDevice_T *device, VkCommandPool handle)
+{
+    struct wine_vk_handle_entry *entry = wine_vk_handle_map_get(&device->command_pools, handle);
+
+    return entry ? CONTAINING_RECORD(entry, struct wine_cmd_pool, entry) : NULL;
+}
+
+static struct VkCommandBuffer_T *wine_cmd_pool_alloc_buffer(struct wine_cmd_pool *pool)
+{
+    struct VkCommandBuffer_T *buffer;
+    struct list *entry;
+
+    if (!(entry = list_head(&pool->free_command_buffers)))
+    {
+        struct wine_cmd_buffer_slab *slab;
+        unsigned int i;
+
+        if (!(slab = heap_alloc_zero(sizeof(*slab))))
+            return NULL;
+
+        list_add_tail(&pool->slabs, &slab->entry);
+        for (i = 0; i < WINE_VK_COMMAND_BUFFER_SLAB_SIZE; i++)
+            list_add_tail(&pool->free_command_buffers, &slab->buffers[i].pool_entry);
+
+        entry = list_head(&pool->free_command_buffers);
+    }
+
+    list_remove(entry);
+    buffer = LIST_ENTRY(entry, struct VkCommandBuffer_T, pool_entry);
+    list_add_tail(&pool->command_buffers, &buffer->pool_entry);
+    return buffer;
+}
+
+/* Return a wrapper to the pool's free list, the host command buffer is released by the caller. */
+static void wine_cmd_pool_recycle_buffer(struct wine_cmd_pool *pool, struct VkCommandBuffer_T *buffer)
+{
+    buffer->command_buffer = VK_NULL_HANDLE;
+#if defined(USE_STRUCT_CONVERSION)
+    wine_vk_arena_reset(&buffer->arena);
+#endif
+    list_remove(&buffer->pool_entry);
+    list_add_head(&pool->free_command_buffers, &buffer->pool_entry);
+}
+
+static void wine_cmd_pool_free(struct wine_cmd_pool *pool)
+{
+    struct wine_cmd_buffer_slab *slab, *next;
+#if defined(USE_STRUCT_CONVERSION)
+    unsigned int i;
+#endif
+
+    LIST_FOR_EACH_ENTRY_SAFE(slab, next, &pool->slabs, struct wine_cmd_buffer_slab, entry)
+    {
+#if defined(USE_STRUCT_CONVERSION)
+        for (i = 0; i < WINE_VK_COMMAND_BUFFER_SLAB_SIZE; i++)
+            wine_vk_arena_free(&slab->buffers[i].arena);
+#endif
+        heap_free(slab);
+    }
+
+    heap_free(pool);
+}
+
+static void wine_vk_device_free_queues(struct VkQueue_T *queues, uint32_t queue_count)
+{
+    uint32_t i;
+
+    for (i = 0; i < queue_count; i++)
+    {
+        struct VkQueue_T *queue = &queues[i];
+
+        heap_free(queue->submits);
+        heap_free(queue->command_buffers);
+        heap_free(queue->semaphores);
+        heap_free(queue->wait_stages);
+        queue->cs.DebugInfo->Spare[0] = 0;
+        DeleteCriticalSection(&queue->cs);
+    }
+
+    heap_free(queues);
+}
+
+/* The implicit pipeline cache lives in the prefix, in a file per application and
+ * driver. Drivers validate the cache header themselves, the key just avoids
+ * applications and GPUs evicting each other's data.
+ */
+static WCHAR *wine_vk_get_pipeline_cache_path(const struct VkPhysicalDevice_T *phys_dev)
+{
+    static const WCHAR localappdataW[] = {'L','O','C','A','L','A','P','P','D','A','T','A',0};
+    static const WCHAR wineW[] = {'\\','W','i','n','e',0};
+    static const WCHAR cacheW[] = {'\\','V','u','l','k','a','n','P','i','p','e','l','i','n','e','C','a','c','h','e',0};
+    static const WCHAR formatW[] = {'\\','%','s','-','%','0','4','x','-','%','0','4','x','-','%','s','.','b','i','n',0};
+    static const WCHAR hexW[] = {'0','1','2','3','4','5','6','7','8','9','a','b','c','d','e','f'};
+#if defined(USE_STRUCT_CONVERSION)
+    VkPhysicalDeviceProperties_host properties;
+#else
+    VkPhysicalDeviceProperties properties;
+#endif
+    WCHAR exe_path[MAX_PATH], uuid[VK_UUID_SIZE * 2 + 1], *path, *exe_name;
+    DWORD len;
+    int i;
+
+    phys_dev->instance->funcs.p_vkGetPhysicalDeviceProperties(phys_dev->phys_dev, &properties);
+
+    if (!GetModuleFileNameW(NULL, exe_path, ARRAY_SIZE(exe_path)))
+        return NULL;
+    exe_name = strrchrW(exe_path, '\\') ? strrchrW(exe_path, '\\') + 1 : exe_path;
+
+    for (i = 0; i < VK_UUID_SIZE; i++)
+    {
+        uuid[i * 2] = hexW[properties.pipelineCacheUUID[i] >> 4];
+        uuid[i * 2 + 1] = hexW[properties.pipelineCacheUUID[i] & 0xf];
+    }
+    uuid[VK_UUID_SIZE * 2] = 0;
+
+    if (!(len = GetEnvironmentVariableW(localappdataW, NULL, 0)))
+        return NULL;
+    len += strlenW(wineW) + strlenW(cacheW) + strlenW(exe_name) + ARRAY_SIZE(uuid) + 16;
+    if (!(path = heap_alloc(len * sizeof(*path))))
+        return NULL;
+
+    GetEnvironmentVariableW(localappdataW, path, len);
+    strcatW(path, wineW);
+    CreateDirectoryW(path, NULL);
+    strcatW(path, cacheW);
+    CreateDirectoryW(path, NULL);
+    sprintfW(path + strlenW(path), formatW, exe_name, properties.vendorID, properties.deviceID, uuid);
+
+    return path;
+}
+
+static void wine_vk_device_init_pipeline_cache(struct VkDevice_T *device)
+{
+    VkPipelineCacheCreateInfo create_info;
+    void *data = NULL;
+    DWORD size = 0;
+    HANDLE file;
+    VkResult res;
+
+    if (!(device->pipeline_cache_path = wine_vk_get_pipeline_cache_path(device->phys_dev)))
+    {
+        WARN("Failed to build pipeline cache path.\n");
+        return;
+    }
+    TRACE("Using pipeline cache %s.\n", debugstr_w(device->pipeline_cache_path));
+
+    file = CreateFileW(device->pipeline_cache_path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, 0, NULL);
+    if (file != INVALID_HANDLE_VALUE)
+    {
+        if ((size = GetFileSize(file, NULL)) != INVALID_FILE_SIZE && (data = heap_alloc(size))
+                && (!ReadFile(file, data, size, &size, NULL)))
+            size = 0;
+        CloseHandle(file);
+    }
+
+    memset(&create_info, 0, sizeof(create_info));
+    create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    create_info.initialDataSize = data ? size : 0;
+    create_info.pInitialData = data;
+
+    res = device->funcs.p_vkCreatePipelineCache(device->device, &create_info, NULL, &device->pipeline_cache);
+    if (res != VK_SUCCESS && create_info.initialDataSize)
+    {
+        WARN("Failed to create pipeline cache from %u bytes of data, res=%d.\n", size, res);
+        create_info.initialDataSize = 0;
+        create_info.pInitialData = NULL;
+        res = device->funcs.p_vkCreatePipelineCache(device->device, &create_info, NULL, &device->pipeline_cache);
+    }
+    heap_free(data);
+
+    if (res != VK_SUCCESS)
+    {
+        ERR("Failed to create pipeline cache, res=%d.\n", res);
+        device->pipeline_cache = VK_NULL_HANDLE;
+        heap_free(device->pipeline_cache_path);
+        device->pipeline_cache_path = NULL;
+        return;
+    }
+
+    device->pipeline_cache_size = create_info.initialDataSize;
+}
+
+struct wine_vk_pipeline_cache_data
+{
+    HMODULE module;
+    WCHAR *path;
+    size_t size;
+    BYTE data[1];
+};
+
+/* Write out pipeline cache data in the background. The thread holds a reference to
+ * the module so that it can't go away under it.
+ */
+static DWORD WINAPI wine_vk_pipeline_cache_write_thread(void *arg)
+{
+    static const WCHAR tmpW[] = {'.','t','m','p',0};
+    struct wine_vk_pipeline_cache_data *cache_data = arg;
+    HMODULE module = cache_data->module;
+    WCHAR *tmp_path;
+    HANDLE file;
+    DWORD size;
+    BOOL ret = FALSE;
+
+    if ((tmp_path = heap_alloc((strlenW(cache_data->path) + ARRAY_SIZE(tmpW)) * sizeof(*tmp_path))))
+    {
+        strcpyW(tmp_path, cache_data->path);
+        strcatW(tmp_path, tmpW);
+
+        file = CreateFileW(tmp_path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, NULL);
+        if (file != INVALID_HANDLE_VALUE)
+        {
+            ret = WriteFile(file, cache_data->data, cache_data->size, &size, NULL) && size == cache_data->size;
+            CloseHandle(file);
+
+            if (ret)
+                ret = MoveFileExW(tmp_path, cache_data->path, MOVEFILE_REPLACE_EXISTING);
+            else
+                DeleteFileW(tmp_path);
+        }
+        heap_free(tmp_path);
+    }
+
+    if (ret)
+        TRACE("Wrote %lu bytes to %s.\n", (unsigned long)cache_data->size, debugstr_w(cache_data->path));
+    else
+        WARN("Failed to write pipeline cache %s, error %u.\n", debugstr_w(cache_data->path), GetLastError());
+
+    heap_free(cache_data->path);
+    heap_free(cache_data);
+    FreeLibraryAndExitThread(module, 0);
+}
+
+static void wine_vk_device_save_pipeline_cache(struct VkDevice_T *device)
+{
+    struct wine_vk_pipeline_cache_data *cache_data = NULL;
+    size_t size = 0;
+    HANDLE thread;
+    VkResult res;
+
+    if (!device->pipeline_cache)
+        return;
+
+    res = device->funcs.p_vkGetPipelineCacheData(device->device, device->pipeline_cache, &size, NULL);
+    if (res == VK_SUCCESS && size != device->pipeline_cache_size
+            && (cache_data = heap_alloc(FIELD_OFFSET(struct wine_vk_pipeline_cache_data, data[size]))))
+    {
+        cache_data->size = size;
+        res = device->funcs.p_vkGetPipelineCacheData(device->device, device->pipeline_cache,
+                &cache_data->size, cache_data->data);
+    }
+    device->funcs.p_vkDestroyPipelineCache(device->device, device->pipeline_cache, NULL);
+    device->pipeline_cache = VK_NULL_HANDLE;
+
+    if (!cache_data || res != VK_SUCCESS)
+    {
+        TRACE("Not writing pipeline cache, size %lu, res=%d.\n", (unsigned long)size, res);
+        heap_free(cache_data);
+        heap_free(device->pipeline_cache_path);
+        device->pipeline_cache_path = NULL;
+        return;
+    }
+
+    cache_data->path = device->pipeline_cache_path;
+    device->pipeline_cache_path = NULL;
+
+    GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS, (const WCHAR *)wine_vk_device_save_pipeline_cache,
+            &cache_data->module);
+    if (!(thread = CreateThread(NULL, 0, wine_vk_pipeline_cache_write_thread, cache_data, 0, NULL)))
+    {
+        ERR("Failed to create pipeline cache write thread.\n");
+        FreeLibrary(cache_data->module);
+        heap_free(cache_data->path);
+        heap_free(cache_data);
+        return;
+    }
+    CloseHandle(thread);
+}
+
 /* Helper function used for freeing a device structure. This function supports full
  * and partial object cleanups and can thus be used vkCreateDevice failures.
  */
 static void wine_vk_device_free(struct VkDevice_T *device)
 {
+    unsigned int i;
+
     if (!device)
         return;
 
     if (device->queues)
     {
-        int i;
         for (i = 0; i < device->max_queue_families; i++)
         {
             if (device->queues[i])
-                heap_free(device->queues[i]);
+                wine_vk_device_free_queues(device->queues[i], device->queue_count[i]);
         }
         heap_free(device->queues);
         device->queues = NULL;
@@ -66,6 +779,22 @@ static void wine_vk_device_free(struct VkDevice_T *device)
     if (device->queue_count)
         heap_free(device->queue_count);
 
+    /* Command pools not destroyed by the application go away with the device. */
+    for (i = 0; i < device->command_pools.bucket_count; i++)
+    {
+        while (device->command_pools.buckets[i])
+        {
+            struct wine_cmd_pool *pool = CONTAINING_RECORD(device->command_pools.buckets[i],
+                    struct wine_cmd_pool, entry);
+
+            wine_vk_handle_map_remove(&device->command_pools, &pool->entry);
+            wine_cmd_pool_free(pool);
+        }
+    }
+    wine_vk_handle_map_destroy(&device->command_pools);
+
+    wine_vk_device_save_pipeline_cache(device);
+
     if (device->device && device->funcs.p_vkDestroyDevice)
     {
         device->funcs.p_vkDestroyDevice(device->device, NULL /* pAllocator */);
@@ -75,22 +804,31 @@ static void wine_vk_device_free(struct VkDevice_T *device)
 }
 
 /* Helper function for release command buffers. */
-static void wine_vk_device_free_command_buffers(VkDevice device, VkCommandPool pool, uint32_t count, const VkCommandBuffer *buffers)
+static void wine_vk_device_free_command_buffers(VkDevice device, VkCommandPool pool, uint32_t count,
+        const VkCommandBuffer *buffers, struct wine_vk_profile_timer *timer)
 {
     int i;
 
     /* To avoid have to wrap all command buffers just loop over them one by one. */
     for (i = 0; i < count; i++)
     {
+        if (!buffers[i])
+            continue;
+
         if (buffers[i]->command_buffer)
+        {
+            wine_vk_profile_host_begin(timer);
             device->funcs.p_vkFreeCommandBuffers(device->device, pool, 1, &buffers[i]->command_buffer);
+            wine_vk_profile_host_end(timer);
+        }
 
-        heap_free(buffers[i]);
+        wine_cmd_pool_recycle_buffer(buffers[i]->pool, buffers[i]);
     }
 }
 
 static BOOL wine_vk_init(HINSTANCE hinst)
 {
+    char env[16];
     HDC hdc = GetDC(0);
 
     vk_funcs =  __wine_get_vulkan_driver(hdc, WINE_VULKAN_DRIVER_VERSION);
@@ -101,7 +839,37 @@ static BOOL wine_vk_init(HINSTANCE hinst)
         return FALSE;
     }
 
+#if defined(USE_STRUCT_CONVERSION)
+    /* Thread notifications are needed for cleaning up conversion arenas. */
+    if ((arena_tls_index = TlsAlloc()) == TLS_OUT_OF_INDEXES)
+    {
+        ERR("Failed to allocate TLS index.\n");
+        ReleaseDC(0, hdc);
+        return FALSE;
+    }
+#else
     DisableThreadLibraryCalls(hinst);
+#endif
+
+    if (GetEnvironmentVariableA("WINE_VK_FAST_DISPATCH", env, sizeof(env)) && atoi(env))
+    {
+        TRACE("Using fast dispatch for device functions.\n");
+        fast_dispatch = TRUE;
+    }
+
+    if (GetEnvironmentVariableA("WINE_VK_COALESCE_SUBMITS", env, sizeof(env)) && atoi(env))
+    {
+        TRACE("Coalescing queue submits.\n");
+        coalesce_submits = TRUE;
+    }
+
+    if (GetEnvironmentVariableA("WINE_VK_PIPELINE_CACHE", env, sizeof(env)) && atoi(env))
+    {
+        TRACE("Using implicit pipeline caches.\n");
+        implicit_pipeline_cache = TRUE;
+    }
+
+    wine_vk_profile_init();
 
     ReleaseDC(0, hdc);
     return TRUE;
@@ -112,7 +880,7 @@ static struct VkQueue_T *wine_vk_device_alloc_queues(struct VkDevice_T *device,
 {
     int i;
 
-    struct VkQueue_T *queues = heap_alloc(sizeof(struct VkQueue_T)*queue_count);
+    struct VkQueue_T *queues = heap_alloc_zero(sizeof(struct VkQueue_T)*queue_count);
     if (!queues)
     {
         ERR("Failed to allocate memory for queues\n");
@@ -123,6 +891,8 @@ static struct VkQueue_T *wine_vk_device_alloc_queues(struct VkDevice_T *device,
     {
         struct VkQueue_T *queue = &queues[i];
         queue->device = device;
+        InitializeCriticalSection(&queue->cs);
+        queue->cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": VkQueue_T.cs");
 
         /* The native device was already allocated with the required number of queues, 
          * so just fetch them from there.
@@ -333,30 +1103,44 @@ static void wine_vk_physical_device_free(struct VkPhysicalDevice_T *phys_dev)
 VkResult WINAPI wine_vkAcquireNextImageKHR(VkDevice device, VkSwapchainKHR swapchain, uint64_t timeout,
         VkSemaphore semaphore, VkFence fence, uint32_t *pImageIndex)
 {
+    struct wine_vk_profile_timer timer;
+    VkResult res;
+
     TRACE("%p, 0x%s, 0x%s, 0x%s, 0x%s, %p\n", device, wine_dbgstr_longlong(swapchain), wine_dbgstr_longlong(timeout),
             wine_dbgstr_longlong(semaphore), wine_dbgstr_longlong(fence), pImageIndex);
 
-    return vk_funcs->p_vkAcquireNextImageKHR(device->device, swapchain, timeout, semaphore, fence, pImageIndex);
+    wine_vk_profile_begin(&timer);
+    res = vk_funcs->p_vkAcquireNextImageKHR(device->device, swapchain, timeout, semaphore, fence, pImageIndex);
+    wine_vk_profile_end(&timer, &custom_profile_counters[PROFILE_vkAcquireNextImageKHR]);
+    return res;
 }
 
 VkResult WINAPI wine_vkAllocateCommandBuffers(VkDevice device, const VkCommandBufferAllocateInfo *pAllocateInfo,
         VkCommandBuffer *buffers)
 {
+    struct wine_vk_profile_timer timer;
+    struct wine_cmd_pool *pool;
     VkResult res = VK_SUCCESS;
     int i;
 
     TRACE("%p %p %p\n", device, pAllocateInfo, buffers);
 
+    wine_vk_profile_begin(&timer);
+
     /* The application provides an array of buffers, we just clear it for error handling reasons. */
     memset(buffers, 0, sizeof(*buffers)*pAllocateInfo->commandBufferCount);
 
+    if (!(pool = wine_cmd_pool_from_handle(device, pAllocateInfo->commandPool)))
+    {
+        ERR("Unknown command pool 0x%s\n", wine_dbgstr_longlong(pAllocateInfo->commandPool));
+        res = VK_ERROR_OUT_OF_HOST_MEMORY;
+        goto done;
+    }
+
     for (i = 0; i < pAllocateInfo->commandBufferCount; i++)
     {
-#if defined(USE_STRUCT_CONVERSION)
-        VkCommandBufferAllocateInfo_host allocate_info;
-#else
+        /* The layout of VkCommandBufferAllocateInfo is the same on win32 and host. */
         VkCommandBufferAllocateInfo allocate_info;
-#endif
         /* TODO: future extensions (none yet) may require us to do conversions on pNext. */
         allocate_info.pNext = pAllocateInfo->pNext;
         allocate_info.sType = pAllocateInfo->sType;
@@ -366,7 +1150,7 @@ VkResult WINAPI wine_vkAllocateCommandBuffers(VkDevice device, const VkCommandBu
 
         TRACE("Creating command buffer %d, pool 0x%s, level %d\n", i, wine_dbgstr_longlong(allocate_info.commandPool),
                 allocate_info.level);
-        buffers[i] = heap_alloc(sizeof(struct VkCommandBuffer_T));
+        buffers[i] = wine_cmd_pool_alloc_buffer(pool);
         if (!buffers[i])
         {
             res = VK_ERROR_OUT_OF_HOST_MEMORY;
@@ -375,26 +1159,35 @@ VkResult WINAPI wine_vkAllocateCommandBuffers(VkDevice device, const VkCommandBu
 
         buffers[i]->base.loader_magic = VULKAN_ICD_MAGIC_VALUE;
         buffers[i]->device = device;
+        buffers[i]->pool = pool;
+        wine_vk_profile_host_begin(&timer);
         res = device->funcs.p_vkAllocateCommandBuffers(device->device, &allocate_info, &buffers[i]->command_buffer);
+        wine_vk_profile_host_end(&timer);
         if (res != VK_SUCCESS)
         {
             ERR("Failed to allocate command buffer, res=%d\n", res);
+            /* Include the failed wrapper in the cleanup below. */
+            buffers[i]->command_buffer = VK_NULL_HANDLE;
+            i++;
             break;
         }
     }
 
     if (res != VK_SUCCESS)
     {
-        wine_vk_device_free_command_buffers(device, pAllocateInfo->commandPool, i, buffers);
-        return res;
+        wine_vk_device_free_command_buffers(device, pAllocateInfo->commandPool, i, buffers, &timer);
+        memset(buffers, 0, sizeof(*buffers)*pAllocateInfo->commandBufferCount);
     }
 
-    return VK_SUCCESS;
+done:
+    wine_vk_profile_end(&timer, &custom_profile_counters[PROFILE_vkAllocateCommandBuffers]);
+    return res;
 }
 
 void WINAPI wine_vkCmdExecuteCommands(VkCommandBuffer commandBuffer, uint32_t commandBufferCount,
         const VkCommandBuffer *pCommandBuffers)
 {
+    struct wine_vk_profile_timer timer;
     VkCommandBuffer *buffers;
     int i;
 
@@ -403,6 +1196,8 @@ void WINAPI wine_vkCmdExecuteCommands(VkCommandBuffer commandBuffer, uint32_t co
     if (!pCommandBuffers || !commandBufferCount)
         return;
 
+    wine_vk_profile_begin(&timer);
+
     /* Unfortunately we need a temporary buffer as our command buffers are wrapped.
      * This call is called often. Maybe we should use alloca? We don't need much memory
      * space and it needs to be cleaned up after the call anyway.
@@ -417,9 +1212,58 @@ void WINAPI wine_vkCmdExecuteCommands(VkCommandBuffer commandBuffer, uint32_t co
     for (i = 0; i < commandBufferCount; i++)
         buffers[i] = pCommandBuffers[i]->command_buffer;
 
+    wine_vk_profile_host_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdExecuteCommands(commandBuffer->command_buffer, commandBufferCount, buffers);
+    wine_vk_profile_host_end(&timer);
 
     heap_free(buffers);
+    wine_vk_profile_end(&timer, &custom_profile_counters[PROFILE_vkCmdExecuteCommands]);
+}
+
+VkResult WINAPI wine_vkCreateCommandPool(VkDevice device, const VkCommandPoolCreateInfo *pCreateInfo,
+        const VkAllocationCallbacks *pAllocator, VkCommandPool *pCommandPool)
+{
+    struct wine_vk_profile_timer timer;
+    struct wine_cmd_pool *pool;
+    VkResult res;
+
+    TRACE("%p, %p, %p, %p\n", device, pCreateInfo, pAllocator, pCommandPool);
+
+    if (pAllocator)
+        FIXME("Support for allocation callbacks not implemented yet\n");
+
+    wine_vk_profile_begin(&timer);
+
+    if (!(pool = heap_alloc(sizeof(*pool))))
+    {
+        res = VK_ERROR_OUT_OF_HOST_MEMORY;
+        goto done;
+    }
+
+    list_init(&pool->command_buffers);
+    list_init(&pool->free_command_buffers);
+    list_init(&pool->slabs);
+
+    wine_vk_profile_host_begin(&timer);
+    res = device->funcs.p_vkCreateCommandPool(device->device, pCreateInfo, NULL, pCommandPool);
+    wine_vk_profile_host_end(&timer);
+    if (res != VK_SUCCESS)
+    {
+        heap_free(pool);
+        goto done;
+    }
+
+    pool->entry.host_handle = *pCommandPool;
+    if (!wine_vk_handle_map_insert(&device->command_pools, &pool->entry))
+    {
+        device->funcs.p_vkDestroyCommandPool(device->device, *pCommandPool, NULL);
+        heap_free(pool);
+        res = VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+
+done:
+    wine_vk_profile_end(&timer, &custom_profile_counters[PROFILE_vkCreateCommandPool]);
+    return res;
 }
 
 VkResult WINAPI wine_vkCreateDevice(VkPhysicalDevice physicalDevice, const VkDeviceCreateInfo *pCreateInfo,
@@ -437,11 +1281,12 @@ VkResult WINAPI wine_vkCreateDevice(VkPhysicalDevice physicalDevice, const VkDev
         FIXME("Support for allocation callbacks not implemented yet\n");
     }
 
-    device = heap_alloc(sizeof(*device));
+    device = heap_alloc_zero(sizeof(*device));
     if (!device)
         return VK_ERROR_OUT_OF_HOST_MEMORY;
 
     device->base.loader_magic = VULKAN_ICD_MAGIC_VALUE;
+    wine_vk_handle_map_init(&device->command_pools);
 
     /* At least for now we can directly pass pCreateInfo through. All extensions we report
      * should be compatible. In addition the loader is supposed to santize values e.g. layers.
@@ -467,6 +1312,9 @@ VkResult WINAPI wine_vkCreateDevice(VkPhysicalDevice physicalDevice, const VkDev
     ALL_VK_DEVICE_FUNCS()
 #undef USE_VK_FUNC
 
+    if (implicit_pipeline_cache)
+        wine_vk_device_init_pipeline_cache(device);
+
     /* We need to cache all queues within the device as each requires wrapping since queues are
      * dispatchable objects.
      */
@@ -475,14 +1323,14 @@ VkResult WINAPI wine_vkCreateDevice(VkPhysicalDevice physicalDevice, const VkDev
     device->max_queue_families = max_queue_families;
     TRACE("Max queue families: %d\n", device->max_queue_families);
 
-    device->queues = heap_alloc(sizeof(*device->queues)*max_queue_families);
+    device->queues = heap_alloc_zero(sizeof(*device->queues)*max_queue_families);
     if (!device->queues)
     {
         res = VK_ERROR_OUT_OF_HOST_MEMORY;
         goto err;
     }
 
-    device->queue_count = heap_alloc(sizeof(*device->queue_count)*max_queue_families);
+    device->queue_count = heap_alloc_zero(sizeof(*device->queue_count)*max_queue_families);
     if (!device->queue_count)
     {
         res = VK_ERROR_OUT_OF_HOST_MEMORY;
@@ -626,6 +1474,34 @@ VkResult WINAPI wine_vkCreateWin32SurfaceKHR(VkInstance instance, const VkWin32S
     return vk_funcs->p_vkCreateWin32SurfaceKHR(instance->instance, pCreateInfo, NULL /* pAllocator */, pSurface);
 }
 
+void WINAPI wine_vkDestroyCommandPool(VkDevice device, VkCommandPool commandPool,
+        const VkAllocationCallbacks *pAllocator)
+{
+    struct wine_vk_profile_timer timer;
+    struct wine_cmd_pool *pool;
+
+    TRACE("%p, 0x%s, %p\n", device, wine_dbgstr_longlong(commandPool), pAllocator);
+
+    if (pAllocator)
+        FIXME("Support for allocation callbacks not implemented yet\n");
+
+    wine_vk_profile_begin(&timer);
+
+    /* The host may hand out the same handle again once the pool is destroyed. */
+    if ((pool = wine_cmd_pool_from_handle(device, commandPool)))
+        wine_vk_handle_map_remove(&device->command_pools, &pool->entry);
+
+    /* Destroying the host pool frees all command buffers allocated from it. */
+    wine_vk_profile_host_begin(&timer);
+    device->funcs.p_vkDestroyCommandPool(device->device, commandPool, NULL);
+    wine_vk_profile_host_end(&timer);
+
+    if (pool)
+        wine_cmd_pool_free(pool);
+
+    wine_vk_profile_end(&timer, &custom_profile_counters[PROFILE_vkDestroyCommandPool]);
+}
+
 void WINAPI wine_vkDestroyDevice(VkDevice device, const VkAllocationCallbacks *pAllocator)
 {
     TRACE("%p %p\n", device, pAllocator);
@@ -842,9 +1718,13 @@ VkResult WINAPI wine_vkEnumeratePhysicalDevices(VkInstance instance, uint32_t *d
 void WINAPI wine_vkFreeCommandBuffers(VkDevice device, VkCommandPool pool, uint32_t count,
         const VkCommandBuffer *buffers)
 {
+    struct wine_vk_profile_timer timer;
+
     TRACE("%p 0x%s %d %p\n", device, wine_dbgstr_longlong(pool), count, buffers);
 
-    wine_vk_device_free_command_buffers(device, pool, count, buffers);
+    wine_vk_profile_begin(&timer);
+    wine_vk_device_free_command_buffers(device, pool, count, buffers, &timer);
+    wine_vk_profile_end(&timer, &custom_profile_counters[PROFILE_vkFreeCommandBuffers]);
 }
 
 PFN_vkVoidFunction WINAPI wine_vkGetDeviceProcAddr(VkDevice device, const char *name)
@@ -860,7 +1740,13 @@ PFN_vkVoidFunction WINAPI wine_vkGetDeviceProcAddr(VkDevice device, const char *
      * for which the first parameter is vkDevice or a child of vkDevice like a
      * vkCommanBuffer, vkQueue.
      * Loader takes are of filtering of extensions which are enabled or not.
+     * In fast dispatch mode functions which don't need any conversions go
+     * straight to the host driver, skipping tracing. The fast thunks aren't
+     * profiled, so they are only handed out while profiling is off.
      */
+    if (fast_dispatch && !wine_vk_profiling && (func = wine_vk_get_device_fast_proc_addr(name)))
+        return func;
+
     func = wine_vk_get_device_proc_addr(name);
     if (func)
         return func;
@@ -971,8 +1857,19 @@ VkResult WINAPI wine_vkGetSwapchainImagesKHR(VkDevice device, VkSwapchainKHR swa
 
 VkResult WINAPI wine_vkQueuePresentKHR(VkQueue queue, const VkPresentInfoKHR *pPresentInfo)
 {
+    struct wine_vk_profile_timer timer;
+    VkResult res;
+
     TRACE("%p, %p\n", queue, pPresentInfo);
-    return vk_funcs->p_vkQueuePresentKHR(queue->queue, pPresentInfo);
+
+    wine_vk_profile_begin(&timer);
+
+    /* Presenting ends a frame, don't hold back any of its work. */
+    wine_vk_queue_flush_submits(queue);
+    res = vk_funcs->p_vkQueuePresentKHR(queue->queue, pPresentInfo);
+
+    wine_vk_profile_end(&timer, &custom_profile_counters[PROFILE_vkQueuePresentKHR]);
+    return res;
 }
 
 void * WINAPI wine_vk_icdGetInstanceProcAddr(VkInstance instance, const char *name)
@@ -1005,66 +1902,265 @@ VkResult WINAPI wine_vk_icdNegotiateLoaderICDInterfaceVersion(uint32_t *supporte
     return VK_SUCCESS;
 }
 
-VkResult WINAPI wine_vkQueueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo *pSubmits, VkFence fence)
+static BOOL wine_vk_array_reserve(void **elements, SIZE_T *capacity, SIZE_T count, SIZE_T size)
 {
-    VkSubmitInfo *submits;
-    VkResult res;
-    VkCommandBuffer *command_buffers;
-    int i, num_command_buffers;
+    SIZE_T max_capacity, new_capacity;
+    void *new_elements;
 
-    TRACE("%p %u %p 0x%s\n", queue, submitCount, pSubmits, wine_dbgstr_longlong(fence));
+    if (count <= *capacity)
+        return TRUE;
+
+    max_capacity = ~(SIZE_T)0 / size;
+    if (count > max_capacity)
+        return FALSE;
+
+    new_capacity = max(4, *capacity);
+    while (new_capacity < count && new_capacity <= max_capacity / 2)
+        new_capacity *= 2;
+    if (new_capacity < count)
+        new_capacity = count;
+
+    if (!(new_elements = heap_realloc(*elements, new_capacity * size)))
+        return FALSE;
+
+    *elements = new_elements;
+    *capacity = new_capacity;
+    return TRUE;
+}
+
+/* Append a host copy of a submit to the queue's submit buffers. Array pointers
+ * are only set up by wine_vk_queue_submit, as the buffers may still move.
+ */
+static BOOL wine_vk_queue_add_submit(struct VkQueue_T *queue, const VkSubmitInfo *submit)
+{
+    uint32_t semaphore_count = submit->waitSemaphoreCount + submit->signalSemaphoreCount;
+    uint32_t i;
+
+    if (!wine_vk_array_reserve((void **)&queue->submits, &queue->submits_size,
+            queue->submit_count + 1, sizeof(*queue->submits))
+            || !wine_vk_array_reserve((void **)&queue->command_buffers, &queue->command_buffers_size,
+            queue->command_buffer_count + submit->commandBufferCount, sizeof(*queue->command_buffers))
+            || !wine_vk_array_reserve((void **)&queue->semaphores, &queue->semaphores_size,
+            queue->semaphore_count + semaphore_count, sizeof(*queue->semaphores))
+            || !wine_vk_array_reserve((void **)&queue->wait_stages, &queue->wait_stages_size,
+            queue->wait_stage_count + submit->waitSemaphoreCount, sizeof(*queue->wait_stages)))
+        return FALSE;
+
+    queue->submits[queue->submit_count++] = *submit;
+
+    for (i = 0; i < submit->commandBufferCount; i++)
+        queue->command_buffers[queue->command_buffer_count++] = submit->pCommandBuffers[i]->command_buffer;
 
-    if (submitCount == 0)
+    if (submit->waitSemaphoreCount)
     {
-        return queue->device->funcs.p_vkQueueSubmit(queue->queue, 0, NULL, fence);
+        memcpy(&queue->semaphores[queue->semaphore_count], submit->pWaitSemaphores,
+                submit->waitSemaphoreCount * sizeof(*queue->semaphores));
+        queue->semaphore_count += submit->waitSemaphoreCount;
+        memcpy(&queue->wait_stages[queue->wait_stage_count], submit->pWaitDstStageMask,
+                submit->waitSemaphoreCount * sizeof(*queue->wait_stages));
+        queue->wait_stage_count += submit->waitSemaphoreCount;
     }
 
-    submits = heap_alloc(sizeof(*submits)*submitCount);
-    if (!submits)
+    if (submit->signalSemaphoreCount)
     {
-        ERR("Unable to allocate memory for submit buffers!\n");
-        return VK_ERROR_OUT_OF_HOST_MEMORY;
+        memcpy(&queue->semaphores[queue->semaphore_count], submit->pSignalSemaphores,
+                submit->signalSemaphoreCount * sizeof(*queue->semaphores));
+        queue->semaphore_count += submit->signalSemaphoreCount;
     }
 
-    for (i = 0; i < submitCount; i++)
+    return TRUE;
+}
+
+/* Pass all submits in the queue's submit buffers to the host in one go. */
+static VkResult wine_vk_queue_submit(struct VkQueue_T *queue, VkFence fence)
+{
+    VkCommandBuffer *command_buffers = queue->command_buffers;
+    VkPipelineStageFlags *wait_stages = queue->wait_stages;
+    VkSemaphore *semaphores = queue->semaphores;
+    VkResult res;
+    uint32_t i;
+
+    for (i = 0; i < queue->submit_count; i++)
     {
-        int j;
+        VkSubmitInfo *submit = &queue->submits[i];
+
+        submit->pWaitSemaphores = semaphores;
+        submit->pWaitDstStageMask = wait_stages;
+        semaphores += submit->waitSemaphoreCount;
+        wait_stages += submit->waitSemaphoreCount;
+        submit->pCommandBuffers = command_buffers;
+        command_buffers += submit->commandBufferCount;
+        submit->pSignalSemaphores = semaphores;
+        semaphores += submit->signalSemaphoreCount;
+    }
+
+    res = queue->device->funcs.p_vkQueueSubmit(queue->queue, queue->submit_count, queue->submits, fence);
 
-        memcpy(&submits[i], &pSubmits[i], sizeof(*submits));
+    queue->submit_count = 0;
+    queue->command_buffer_count = 0;
+    queue->semaphore_count = 0;
+    queue->wait_stage_count = 0;
+    if (queue->deferred)
+    {
+        queue->deferred = FALSE;
+        InterlockedDecrement(&queue->device->deferred_queues);
+    }
+    return res;
+}
+
+void wine_vk_queue_flush_submits(VkQueue queue)
+{
+    VkResult res;
+
+    if (!coalesce_submits)
+        return;
+
+    EnterCriticalSection(&queue->cs);
+    if (queue->submit_count)
+    {
+        TRACE("Flushing %u deferred submits on queue %p.\n", queue->submit_count, queue);
+        if ((res = wine_vk_queue_submit(queue, VK_NULL_HANDLE)) != VK_SUCCESS)
+            WARN("Failed to flush deferred submits, res=%d\n", res);
+    }
+    LeaveCriticalSection(&queue->cs);
+}
+
+/* Flush the deferred submits of all queues of a device except 'skip'. */
+static void wine_vk_device_flush_queues(VkDevice device, VkQueue skip)
+{
+    uint32_t i, j;
+
+    if (!coalesce_submits || !*(volatile LONG *)&device->deferred_queues)
+        return;
 
-        num_command_buffers = pSubmits[i].commandBufferCount;
-        command_buffers = heap_alloc(sizeof(*submits)*num_command_buffers);
-        if (!command_buffers)
+    for (i = 0; i < device->max_queue_families; i++)
+    {
+        for (j = 0; j < device->queue_count[i]; j++)
         {
-            ERR("Unable to allocate memory for comman buffers!\n");
-            res = VK_ERROR_OUT_OF_HOST_MEMORY;
-            goto err;
+            if (&device->queues[i][j] != skip)
+                wine_vk_queue_flush_submits(&device->queues[i][j]);
         }
+    }
+}
+
+void wine_vk_device_flush_submits(VkDevice device)
+{
+    wine_vk_device_flush_queues(device, NULL);
+}
+
+/* Submits can be held back as long as nothing on the host side can observe their
+ * completion. Submits with a fence or signal semaphores flush everything deferred
+ * so far along with them, as do submits to other queues of the device, presenting
+ * and the functions listed in FLUSH_SUBMIT_FUNCS.
+ */
+static BOOL wine_vk_can_defer_submits(uint32_t count, const VkSubmitInfo *submits, VkFence fence)
+{
+    uint32_t i;
+
+    if (fence != VK_NULL_HANDLE)
+        return FALSE;
+
+    for (i = 0; i < count; i++)
+    {
+        if (submits[i].pNext || submits[i].signalSemaphoreCount)
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+VkResult WINAPI wine_vkQueueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo *pSubmits, VkFence fence)
+{
+    uint32_t submit_count, command_buffer_count, semaphore_count, wait_stage_count;
+    struct wine_vk_profile_timer timer;
+    VkResult res = VK_SUCCESS;
+    uint32_t i;
+
+    TRACE("%p %u %p 0x%s\n", queue, submitCount, pSubmits, wine_dbgstr_longlong(fence));
+
+    wine_vk_profile_begin(&timer);
+
+    if (coalesce_submits)
+    {
+        /* Keep the order of submits across queues, the other queues' locks
+         * must not be taken while holding ours. */
+        wine_vk_device_flush_queues(queue->device, queue);
+        EnterCriticalSection(&queue->cs);
+    }
+
+    submit_count = queue->submit_count;
+    command_buffer_count = queue->command_buffer_count;
+    semaphore_count = queue->semaphore_count;
+    wait_stage_count = queue->wait_stage_count;
 
-        for (j = 0; j < num_command_buffers; j++)
+    for (i = 0; i < submitCount; i++)
+    {
+        if (!wine_vk_queue_add_submit(queue, &pSubmits[i]))
         {
-            command_buffers[j] = pSubmits[i].pCommandBuffers[j]->command_buffer;
+            ERR("Unable to allocate memory for submit buffers!\n");
+            queue->submit_count = submit_count;
+            queue->command_buffer_count = command_buffer_count;
+            queue->semaphore_count = semaphore_count;
+            queue->wait_stage_count = wait_stage_count;
+            res = VK_ERROR_OUT_OF_HOST_MEMORY;
+            goto done;
         }
-        submits[i].pCommandBuffers = command_buffers;
     }
 
-    res = queue->device->funcs.p_vkQueueSubmit(queue->queue, submitCount, submits, fence);
-
-err:
-    if (submits)
+    if (coalesce_submits && wine_vk_can_defer_submits(submitCount, pSubmits, fence))
     {
-        for (i = 0; i < submitCount; i++)
+        TRACE("Deferring %u submits, %u pending.\n", submitCount, queue->submit_count);
+        if (queue->submit_count && !queue->deferred)
         {
-            if (submits[i].pCommandBuffers)
-                heap_free((void*)submits[i].pCommandBuffers);
+            queue->deferred = TRUE;
+            InterlockedIncrement(&queue->device->deferred_queues);
         }
-        heap_free(submits);
+    }
+    else
+    {
+        wine_vk_profile_host_begin(&timer);
+        res = wine_vk_queue_submit(queue, fence);
+        wine_vk_profile_host_end(&timer);
     }
 
+done:
+    if (coalesce_submits)
+        LeaveCriticalSection(&queue->cs);
+
+    wine_vk_profile_end(&timer, &custom_profile_counters[PROFILE_vkQueueSubmit]);
     TRACE("Returning %d\n", res);
     return res;
 }
 
+VkResult WINAPI wine_vkResetCommandPool(VkDevice device, VkCommandPool commandPool, VkCommandPoolResetFlags flags)
+{
+#if defined(USE_STRUCT_CONVERSION)
+    struct wine_cmd_pool *pool;
+#endif
+    struct wine_vk_profile_timer timer;
+    VkResult res;
+
+    TRACE("%p, 0x%s, %#x\n", device, wine_dbgstr_longlong(commandPool), flags);
+
+    wine_vk_profile_begin(&timer);
+    wine_vk_profile_host_begin(&timer);
+    res = device->funcs.p_vkResetCommandPool(device->device, commandPool, flags);
+    wine_vk_profile_host_end(&timer);
+
+#if defined(USE_STRUCT_CONVERSION)
+    if (res == VK_SUCCESS && (pool = wine_cmd_pool_from_handle(device, commandPool)))
+    {
+        struct VkCommandBuffer_T *buffer;
+
+        /* All command buffers of the pool are back in the initial state. */
+        LIST_FOR_EACH_ENTRY(buffer, &pool->command_buffers, struct VkCommandBuffer_T, pool_entry)
+            wine_vk_arena_reset(&buffer->arena);
+    }
+#endif
+
+    wine_vk_profile_end(&timer, &custom_profile_counters[PROFILE_vkResetCommandPool]);
+    return res;
+}
 
 BOOL WINAPI DllMain(HINSTANCE hinst, DWORD reason, LPVOID reserved)
 {
@@ -1073,8 +2169,19 @@ BOOL WINAPI DllMain(HINSTANCE hinst, DWORD reason, LPVOID reserved)
         case DLL_PROCESS_ATTACH:
             return wine_vk_init(hinst);
 
+        case DLL_PROCESS_DETACH:
+            if (wine_vk_profiling)
+                wine_vk_profile_dump();
+            break;
+
         case DLL_THREAD_ATTACH:
             break;
+
+#if defined(USE_STRUCT_CONVERSION)
+        case DLL_THREAD_DETACH:
+            wine_vk_free_thread_arena();
+            break;
+#endif
     }
     return TRUE;
 }
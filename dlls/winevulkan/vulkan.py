@@ -45,7 +45,9 @@ from enum import Enum
 # - Vulkan structures have different alignment between win32 and 32-bit Linux.
 #   This means structures with alignment differences need conversion logic.
 #   Often structures are nested, so the parent structure may not need any
-#   conversion, but some child may need some.
+#   conversion, but some child may need some. Many structures containing
+#   64-bit members still end up with identical layouts, we compute the
+#   layouts for both platforms and only convert when they really differ.
 #
 # vk.xml parsing challenges:
 # - Contains type data for all platforms (generic Vulkan, Windows, Linux,..).
@@ -137,12 +139,15 @@ FUNCTION_OVERRIDES = {
     # Device functions
     "vkAllocateCommandBuffers" : {"dispatch" : True, "driver" : False, "thunk" : False},
     "vkCmdExecuteCommands" : {"dispatch" : True, "driver" : False, "thunk" : False},
+    "vkCreateCommandPool" : {"dispatch" : True, "driver" : False, "thunk" : False},
+    "vkDestroyCommandPool" : {"dispatch" : True, "driver" : False, "thunk" : False},
     "vkDestroyDevice" : {"dispatch" : True, "driver" : False, "thunk" : False},
     "vkEnumerateDeviceExtensionProperties" : {"dispatch" : True, "driver" : False, "thunk" : False},
     "vkFreeCommandBuffers" : {"dispatch" : True, "driver" : False, "thunk" : False},
     "vkGetDeviceProcAddr" : {"dispatch" : True, "driver" : True, "thunk" : False},
     "vkGetDeviceQueue" : {"dispatch": True, "driver" : False, "thunk" : False},
     "vkQueueSubmit" : {"dispatch": True, "driver" : False, "thunk" : False},
+    "vkResetCommandPool" : {"dispatch" : True, "driver" : False, "thunk" : False},
 
     # VK_KHR_surface
     "vkDestroySurfaceKHR" : {"dispatch" : True, "driver" : True, "thunk" : False},
@@ -164,6 +169,57 @@ FUNCTION_OVERRIDES = {
 }
 
 
+# Size of basic types on 32-bit platforms. 64-bit types are handled separately
+# as their alignment within structures differs between win32 and i386 Linux.
+BASE_TYPE_SIZES_32 = {
+    "char" : 1,
+    "float" : 4,
+    "int32_t" : 4,
+    "size_t" : 4,
+    "uint8_t" : 1,
+    "uint32_t" : 4,
+    "HINSTANCE" : 4,
+    "HWND" : 4,
+}
+
+# Structures read by the host from descriptor update template data, at offsets
+# and strides given by the application. Template data is passed through as is,
+# which relies on their members being at the same offsets on win32 and host.
+TEMPLATE_DATA_STRUCTS = [
+    "VkDescriptorBufferInfo",
+    "VkDescriptorImageInfo",
+]
+
+# Prefix of the untraced thunks used for fast dispatch.
+FAST_PREFIX = "wine_fast_"
+
+# Functions after which any scratch memory used for struct conversions
+# while recording a command buffer is no longer referenced by the host.
+# The command buffer's arena is reset when these are called.
+ARENA_RESET_FUNCS = [
+    "vkBeginCommandBuffer",
+    "vkResetCommandBuffer",
+]
+
+# Functions which may depend on the execution of previously submitted work.
+# Any submits deferred by submit coalescing are flushed to the host first.
+FLUSH_SUBMIT_FUNCS = [
+    "vkDeviceWaitIdle",
+    "vkGetEventStatus",
+    "vkGetQueryPoolResults",
+    "vkQueueBindSparse",
+    "vkQueueWaitIdle",
+    "vkWaitForFences",
+]
+
+# Functions which use the implicit device pipeline cache, if enabled, when
+# the application doesn't pass a pipeline cache.
+IMPLICIT_PIPELINE_CACHE_FUNCS = [
+    "vkCreateComputePipelines",
+    "vkCreateGraphicsPipelines",
+]
+
+
 class Direction(Enum):
     """ Parameter direction: input, output, input_output. """
     INPUT = 1
@@ -402,6 +458,15 @@ class VkFunction(object):
     def is_required(self):
         return self.required
 
+    def needs_arena(self):
+        """ Check if any of the parameter conversions need scratch memory. """
+
+        for p in self.params:
+            if p.needs_arena():
+                return True
+
+        return False
+
     def needs_conversion(self):
         """ Check if the function needs any input/output type conversion.
         Funcsions need input/output conversion if struct parameters have
@@ -418,6 +483,24 @@ class VkFunction(object):
     def needs_dispatch(self):
         return self.dispatch
 
+    def needs_fast_thunk(self):
+        """ Check if the function can be dispatched straight to the host.
+
+        This is the case for device functions which only need their dispatchable
+        handle unwrapped, which includes most vkCmd* functions.
+        """
+
+        if not self.is_device_func() or not self.needs_thunk() or not self.needs_dispatch():
+            return False
+
+        if self.name in ARENA_RESET_FUNCS or self.name in FLUSH_SUBMIT_FUNCS:
+            return False
+
+        if self.name in IMPLICIT_PIPELINE_CACHE_FUNCS:
+            return False
+
+        return not self.needs_conversion()
+
     def needs_thunk(self):
         return self.thunk_needed
 
@@ -448,6 +531,11 @@ class VkFunction(object):
         pfn += ")"
         return pfn
 
+    def profile_counters(self):
+        """ Return an expression for the profiling counter block of the function. """
+
+        return "&vk_profile_counters[WINE_VK_PROFILE_{0}]".format(self.name)
+
     def prototype(self, call_conv=None, prefix=None, postfix=None):
         """ Generate prototype for given function.
 
@@ -477,17 +565,88 @@ class VkFunction(object):
 
         return proto
 
-    def body(self):
-        body = "    {0}".format(self.trace())
+    def failure_result(self, prefix=""):
+        """ Return value used when the conversion runs out of memory, empty for void functions. """
+
+        if self.type == "void":
+            return ""
+        if self.type != "VkResult":
+            LOGGER.error("No out of memory result for {0} returning {1}".format(self.name, self.type))
+        return "{0}VK_ERROR_OUT_OF_HOST_MEMORY".format(prefix)
+
+    def arena(self):
+        """ Return an expression for the arena to draw conversion scratch memory from.
+
+        Command buffers carry their own arena, which lives until the command buffer
+        is reset. Any other call uses a per-thread arena, which is reset at the end
+        of the call.
+        """
+
+        if self.params[0].type == "VkCommandBuffer":
+            return "&{0}->arena".format(self.params[0].name)
+        return "wine_vk_get_thread_arena()"
+
+    def call_params(self, conv=False):
+        """ Parameters to pass to the host function. """
+
+        params = []
+        for p in self.params:
+            if self.name in IMPLICIT_PIPELINE_CACHE_FUNCS and p.type == "VkPipelineCache":
+                params.append("wine_vk_device_pipeline_cache({0}, {1})".format(self.params[0].name, p.name))
+            else:
+                params.append(p.variable(conv=conv))
+
+        return ", ".join(params)
+
+    def flush_submits(self):
+        """ Flush deferred queue submits before calling functions which depend on them. """
+
+        if self.name not in FLUSH_SUBMIT_FUNCS:
+            return ""
+
+        if self.params[0].type == "VkQueue":
+            return "    wine_vk_queue_flush_submits({0});\n".format(self.params[0].name)
+        return "    wine_vk_device_flush_submits({0});\n".format(self.params[0].name)
 
-        params = ", ".join([p.variable(conv=False) for p in self.params])
+    def body(self, arena_reset=True, instrument=True):
+        """ Thunk body for functions without conversions.
+
+        Args:
+            arena_reset (bool, optional): reset the command buffer arena for ARENA_RESET_FUNCS
+            instrument (bool, optional): include tracing and profiling
+        """
+
+        body = ""
+
+        if instrument:
+            if self.type != "void":
+                body += "    {0} result;\n".format(self.type)
+            body += "    struct wine_vk_profile_timer timer;\n"
+            body += "    {0}".format(self.trace())
+            body += "    wine_vk_profile_begin(&timer);\n"
+
+        body += self.flush_submits()
+
+        if arena_reset and self.name in ARENA_RESET_FUNCS:
+            body += "#if defined(USE_STRUCT_CONVERSION)\n"
+            body += "    wine_vk_arena_reset({0});\n".format(self.arena())
+            body += "#endif\n"
+
+        params = self.call_params(conv=False)
 
         # Call the native Vulkan function.
         if self.type == "void":
             body += "    {0}.p_{1}({2});\n".format(self.params[0].dispatch_table(), self.name, params)
+        elif instrument:
+            body += "    result = {0}.p_{1}({2});\n".format(self.params[0].dispatch_table(), self.name, params)
         else:
             body += "    return {0}.p_{1}({2});\n".format(self.params[0].dispatch_table(), self.name, params)
 
+        if instrument:
+            body += "    wine_vk_profile_end(&timer, {0});\n".format(self.profile_counters())
+            if self.type != "void":
+                body += "    return result;\n"
+
         return body
 
     def body_conversion(self):
@@ -497,6 +656,10 @@ class VkFunction(object):
         if self.type != "void":
             body += "    {0} result;\n".format(self.type)
 
+        if self.needs_arena():
+            body += "    struct wine_vk_arena *arena;\n"
+        body += "    struct wine_vk_profile_timer timer;\n"
+
         # Declare any tmp parameters for conversion.
         for p in self.params:
             if not p.needs_conversion():
@@ -507,24 +670,49 @@ class VkFunction(object):
             else:
                 body += "    {0}_host {1}_host;\n".format(p.type, p.name)
 
-        body += "    {0}\n".format(self.trace())
+        body += "    {0}".format(self.trace())
+
+        # The per-thread arena is allocated on first use.
+        if self.needs_arena() and self.params[0].type != "VkCommandBuffer":
+            body += "    if (!(arena = {0})) return{1};\n".format(self.arena(), self.failure_result(" "))
+
+        body += "    wine_vk_profile_begin(&timer);\n"
+        body += self.flush_submits()
+        body += "\n"
+
+        if self.needs_arena() and self.params[0].type == "VkCommandBuffer":
+            body += "    arena = {0};\n".format(self.arena())
+            if self.name in ARENA_RESET_FUNCS:
+                body += "    wine_vk_arena_reset(arena);\n"
+            body += "\n"
+        elif self.name in ARENA_RESET_FUNCS:
+            body += "    wine_vk_arena_reset({0});\n\n".format(self.arena())
 
-        # Call any win_to_host conversion calls.
+        # Call any win_to_host conversion calls, skipping the host call if the arena is out of memory.
+        if self.type == "void":
+            fail = "        goto done;\n"
+        else:
+            fail = "    {\n"
+            fail += "        result ={0};\n".format(self.failure_result(" "))
+            fail += "        goto done;\n"
+            fail += "    }\n"
         for p in self.params:
             if not p.needs_input_conversion():
                 continue
 
-            body += p.copy(Direction.INPUT)
+            body += p.copy(Direction.INPUT, fail=fail)
 
         # Build list of parameters containing converted and non-converted parameters.
         # The param itself knows if conversion is needed and applies it when we set conv=True.
-        params = ", ".join([p.variable(conv=True) for p in self.params])
+        params = self.call_params(conv=True)
 
         # Call the native Vulkan function.
+        body += "    wine_vk_profile_host_begin(&timer);\n"
         if self.type == "void":
             body += "    {0}.p_{1}({2});\n".format(self.params[0].dispatch_table(), self.name, params)
         else:
             body += "    result = {0}.p_{1}({2});\n".format(self.params[0].dispatch_table(), self.name, params)
+        body += "    wine_vk_profile_host_end(&timer);\n"
 
         body += "\n"
 
@@ -535,12 +723,15 @@ class VkFunction(object):
 
             body += p.copy(Direction.OUTPUT)
 
-        # Perform any required cleanups. Most of these are for array functions.
-        for p in self.params:
-            if not p.needs_free():
-                continue
+        if self.needs_arena():
+            body += "done:\n"
+
+        # Scratch memory of the per-thread arena is only needed for the duration of the call.
+        # Command buffer arenas are reset on vkBeginCommandBuffer / vkResetCommandBuffer.
+        if self.needs_arena() and self.params[0].type != "VkCommandBuffer":
+            body += "    wine_vk_arena_reset(arena);\n"
 
-            body += p.free()
+        body += "    wine_vk_profile_end(&timer, {0});\n".format(self.profile_counters())
 
         # Finally return the result.
         if self.type != "void":
@@ -567,7 +758,7 @@ class VkFunction(object):
             thunk += "#if defined(USE_STRUCT_CONVERSION)\n"
             thunk += self.body_conversion()
             thunk += "#else\n"
-            thunk += self.body()
+            thunk += self.body(arena_reset=False)
             thunk += "#endif\n"
         else:
             thunk += self.body()
@@ -575,6 +766,15 @@ class VkFunction(object):
         thunk += "}\n\n"
         return thunk
 
+    def fast_thunk(self, call_conv=None, prefix=None):
+        """ Thunk which only unwraps the dispatchable handle, without any tracing. """
+
+        thunk = self.prototype(call_conv=call_conv, prefix=prefix)
+        thunk += "\n{\n"
+        thunk += self.body(instrument=False)
+        thunk += "}\n\n"
+        return thunk
+
     def trace(self, trace_func=None):
         """ Create a trace string including all parameters.
 
@@ -732,6 +932,9 @@ class VkMember(object):
         self.optional = optional
         self.extension_structs = extension_structs
 
+        # Numeric value of array_len, resolved once API constants are known.
+        self.array_count = None
+
     def __eq__(self, other):
         """ Compare member based on name against a string.
 
@@ -798,8 +1001,12 @@ class VkMember(object):
         return VkMember(const=const, _type=member_type, pointer=pointer, name=name_elem.text, array_len=array_len,
                 dyn_array_len=dyn_array_len, optional=optional, extension_structs=extension_structs)
 
-    def copy(self, input, output, direction):
-        """ Helper method for use by conversion logic to generate a C-code statement to copy this member. """
+    def copy(self, input, output, direction, fail=None):
+        """ Helper method for use by conversion logic to generate a C-code statement to copy this member.
+
+        Args:
+            fail (str, optional): statement to run when the arena runs out of memory.
+        """
 
         if self.needs_conversion():
             if self.is_dynamic_array():
@@ -808,7 +1015,8 @@ class VkMember(object):
                 else:
                     # Array length is either a variable name (string) or an int.
                     count = self.dyn_array_len if isinstance(self.dyn_array_len, int) else "{0}{1}".format(input, self.dyn_array_len)
-                    return "{0}{1} = convert_{2}_array_win_to_host({3}{1}, {4});\n".format(output, self.name, self.type, input, count)
+                    return "if (!({0}{1} = convert_{2}_array_win_to_host({3}{1}, {4}, arena)) && {3}{1}) {5}\n".format(
+                            output, self.name, self.type, input, count, fail)
             elif self.is_static_array():
                 count = self.array_len
                 if direction == Direction.OUTPUT:
@@ -820,6 +1028,8 @@ class VkMember(object):
             else:
                 if direction == Direction.OUTPUT:
                     return "convert_{0}_host_to_win(&{2}{1}, &{3}{1});\n".format(self.type, self.name, input, output)
+                elif self.needs_arena():
+                    return "if (!convert_{0}_win_to_host(&{2}{1}, &{3}{1}, arena)) {4}\n".format(self.type, self.name, input, output, fail)
                 else:
                     return "convert_{0}_win_to_host(&{2}{1}, &{3}{1});\n".format(self.type, self.name, input, output)
         elif self.is_static_array():
@@ -858,8 +1068,12 @@ class VkMember(object):
 
         return text
 
-    def get_conversions(self):
-        """ Return any conversion description for this member and its children when conversion is needed. """
+    def get_conversions(self, in_array=False):
+        """ Return any conversion description for this member and its children when conversion is needed.
+
+        Args:
+            in_array (bool, optional): The parent structure is converted as a dynamic array.
+        """
 
         # Check if we need conversion either for this member itself or for any child members
         # in case member represents a struct.
@@ -872,20 +1086,20 @@ class VkMember(object):
         struct = self.type_info["data"]
         for m in struct:
             if m.needs_conversion():
-                conversions.extend(m.get_conversions())
+                conversions.extend(m.get_conversions(in_array=self.is_dynamic_array()))
 
         struct = self.type_info["data"]
         direction = Direction.OUTPUT if struct.returnedonly else Direction.INPUT
-        if self.is_dynamic_array():
+        if in_array and self.is_flat_array():
+            # Converted into the memory block of the parent array.
+            conversions.append(ConversionFunction(True, False, direction, struct))
+        elif self.is_dynamic_array():
             conversions.append(ConversionFunction(False, True, direction, struct))
         elif self.is_static_array():
             conversions.append(ConversionFunction(True, False, direction, struct))
         else:
             conversions.append(ConversionFunction(False, False, direction, struct))
 
-        if self.needs_free():
-            conversions.append(FreeFunction(self.is_dynamic_array(), struct))
-
         return conversions
 
     def is_const(self):
@@ -898,6 +1112,18 @@ class VkMember(object):
         """
         return self.dyn_array_len is not None
 
+    def is_flat_array(self):
+        """ Returns if the member is an input array of structures, which convert
+        without any scratch memory of their own. Array conversions of the parent
+        structure place these right behind the converted array.
+        """
+
+        if not self.is_dynamic_array() or not self.needs_conversion():
+            return False
+
+        struct = self.type_info["data"]
+        return not struct.returnedonly and not struct.needs_arena()
+
     def is_handle(self):
         return self.type_info["category"] == "handle"
 
@@ -917,6 +1143,41 @@ class VkMember(object):
     def is_union(self):
         return self.type_info["category"] == "union"
 
+    def layout(self, win32):
+        """ Return size and alignment of the member on 32-bit x86.
+
+        Args:
+            win32 (bool): Use win32 rules, which align 64-bit members to 8 bytes
+                as opposed to 4 bytes on i386 Linux.
+        """
+
+        category = self.type_info["category"]
+        if self.is_pointer() or category == "funcpointer":
+            size, align = 4, 4
+        elif category in ["enum", "bitmask"]:
+            size, align = 4, 4
+        elif category in ["struct", "union"]:
+            size, align = self.type_info["data"].layout(win32)[0:2]
+        elif self.needs_alignment():
+            # uint64_t, VkDeviceSize and non-dispatchable handles.
+            size, align = 8, 8 if win32 else 4
+        elif self.is_handle():
+            size, align = 4, 4
+        elif category == "basetype":
+            size = align = BASE_TYPE_SIZES_32[self.type_info["data"].type]
+        elif self.type in BASE_TYPE_SIZES_32:
+            size = align = BASE_TYPE_SIZES_32[self.type]
+        else:
+            # Platform types of other window systems e.g. Window or xcb_window_t,
+            # which are 32-bit. Structures using them are never passed to the host.
+            LOGGER.debug("Assuming 32-bit type for: {0}".format(self.type))
+            size, align = 4, 4
+
+        if self.is_static_array():
+            size *= self.array_count
+
+        return size, align
+
     def needs_alignment(self):
         """ Check if this member needs alignment for 64-bit data.
         Various structures need alignment on 64-bit variables due
@@ -948,24 +1209,28 @@ class VkMember(object):
         struct = self.type_info["data"]
         return struct.needs_conversion()
 
-    def needs_free(self):
+    def needs_arena(self):
+        """ Check if conversion of this member needs scratch memory from an arena. """
+
         if not self.needs_conversion():
             return False
 
         if self.is_dynamic_array():
             return True
 
-        # TODO: some non-pointer structs and optional pointer structs may need freeing,
-        # though none of this type have been encountered yet.
-        return False
+        struct = self.type_info["data"]
+        return struct.needs_arena()
 
-    def set_type_info(self, type_info):
+    def set_type_info(self, type_info, consts):
         """ Helper function to set type information from the type registry.
         This is needed, because not all type data is available at time of
         parsing.
         """
         self.type_info = type_info
 
+        if self.is_static_array():
+            self.array_count = int(consts.get(self.array_len, self.array_len))
+
 
 class VkParam(object):
     """ Helper class which describes a parameter to a function call. """
@@ -1023,7 +1288,6 @@ class VkParam(object):
     def _set_conversions(self):
         """ Internal helper function to configure any needed conversion functions. """
 
-        self.free_func = None
         self.input_conv = None
         self.output_conv = None
         if not self.needs_conversion():
@@ -1037,11 +1301,6 @@ class VkParam(object):
         if self._direction in [Direction.INPUT_OUTPUT, Direction.OUTPUT]:
             self.output_conv = ConversionFunction(False, self.is_dynamic_array(), Direction.OUTPUT, self.struct)
 
-        # Dynamic arrays, but also some normal structs (e.g. VkCommandBufferBeginInfo) need memory
-        # allocation and thus some cleanup.
-        if self.is_dynamic_array() or self.struct.needs_free():
-            self.free_func = FreeFunction(self.is_dynamic_array(), self.struct)
-
     def _set_direction(self):
         """ Internal helper function to set parameter direction (input/output/input_output). """
 
@@ -1116,10 +1375,19 @@ class VkParam(object):
             else:
                 LOGGER.warn("Unhandled type: {0}".format(self.type_info))
 
-    def copy(self, direction):
+    def copy(self, direction, fail=None):
+        """ Generate the statements converting the parameter.
+
+        Args:
+            fail (str, optional): statements to run when the arena runs out of memory.
+        """
+
         if direction == Direction.INPUT:
             if self.is_dynamic_array():
-                return "    {0}_host = convert_{1}_array_win_to_host({0}, {2});\n".format(self.name, self.type, self.dyn_array_len)
+                return "    if (!({0}_host = convert_{1}_array_win_to_host({0}, {2}, arena)) && {0})\n{3}".format(
+                        self.name, self.type, self.dyn_array_len, fail)
+            elif self.needs_arena():
+                return "    if (!convert_{0}_win_to_host({1}, &{1}_host, arena))\n{2}".format(self.type, self.name, fail)
             else:
                 return "    convert_{0}_win_to_host({1}, &{1}_host);\n".format(self.type, self.name)
         else:
@@ -1171,20 +1439,6 @@ class VkParam(object):
     def format_string(self):
         return self.format_str
 
-    def free(self):
-        if self.is_dynamic_array():
-            if self.struct.returnedonly:
-                # For returnedonly, counts is stored in a pointer.
-                return "    free_{0}_array({1}_host, *{2});\n".format(self.type, self.name, self.dyn_array_len)
-            else:
-                return "    free_{0}_array({1}_host, {2});\n".format(self.type, self.name, self.dyn_array_len)
-        else:
-            # We are operating on a single structure. Some structs (very rare) contain dynamic members,
-            # which would need freeing.
-            if self.struct.needs_free():
-                return "    free_{0}(&{1}_host);\n".format(self.type, self.name)
-        return ""
-
     def get_conversions(self):
         """ Get a list of conversions required for this parameter if any.
         Parameters which are structures may require conversion between win32
@@ -1210,15 +1464,13 @@ class VkParam(object):
             if not m.needs_conversion():
                 continue
 
-            conversions.extend(m.get_conversions())
+            conversions.extend(m.get_conversions(in_array=self.is_dynamic_array()))
 
         # Conversion requirements for the 'parent' parameter.
         if self.input_conv is not None:
             conversions.append(self.input_conv)
         if self.output_conv is not None:
             conversions.append(self.output_conv)
-        if self.free_func is not None:
-            conversions.append(self.free_func)
 
         return conversions
 
@@ -1252,22 +1504,22 @@ class VkParam(object):
         if not self.is_struct():
             return False
 
-        # VkSparseImageMemoryRequirements is used by vkGetImageSparseMemoryRequirements.
-        # This function is tricky to wrap, becauset how to wrap depends on pSparseMemoryRequirements
-        # is NULL or not. Luckily for VkSparseImageMemoryRequirements the alignment works out in such
-        # a way that no conversion is needed between win32 and Linux.
-        if self.type == "VkSparseImageMemoryRequirements":
-            return False
-
-        # If a structure needs alignment changes, it means we need to
+        # If the structure layout differs, it means we need to
         # perform parameter conversion between win32 and host.
+        # E.g. VkSparseImageMemoryRequirements used by vkGetImageSparseMemoryRequirements
+        # would be tricky to wrap, but luckily its layout is the same on win32 and Linux.
         if self.struct.needs_conversion():
             return True
 
         return False
 
-    def needs_free(self):
-        return self.free_func is not None
+    def needs_arena(self):
+        """ Returns if win32 to host conversion of the parameter needs scratch memory. """
+
+        if not self.needs_input_conversion():
+            return False
+
+        return self.is_dynamic_array() or self.struct.needs_arena()
 
     def needs_input_conversion(self):
         return self.input_conv is not None
@@ -1313,6 +1565,7 @@ class VkStruct(Sequence):
         self.required = False
         self.union = union
         self.type_info = None # To be set later.
+        self._layout_compatible = None
 
     def __getitem__(self, i):
         return self.members[i]
@@ -1420,6 +1673,63 @@ class VkStruct(Sequence):
             text += "}} {0};\n\n".format(self.name)
         return text
 
+    def is_layout_compatible(self):
+        """ Check if the win32 and host layouts of the structure are byte-identical.
+
+        Only i386 needs checking, other platforms share the win32 alignment rules.
+        Structures pointed to by members need to be compatible as well, so the
+        structure can be passed to the host as is.
+        """
+
+        if self._layout_compatible is not None:
+            return self._layout_compatible
+
+        # Assume compatibility while recursing in case structures refer to each other.
+        self._layout_compatible = True
+
+        win32_size, _, win32_offsets = self.layout(win32=True)
+        host_size, _, host_offsets = self.layout(win32=False)
+        compatible = win32_size == host_size and win32_offsets == host_offsets
+
+        for m in self.members:
+            if not compatible:
+                break
+
+            if m.is_struct() and not m.type_info["data"].is_layout_compatible():
+                compatible = False
+
+        self._layout_compatible = compatible
+        return compatible
+
+    def layout(self, win32):
+        """ Compute the structure layout on 32-bit x86.
+
+        Args:
+            win32 (bool): Use win32 rules, which align 64-bit members to 8 bytes
+                as opposed to 4 bytes on i386 Linux.
+
+        Returns:
+            Tuple of size, alignment and a list of member offsets.
+        """
+
+        offset = 0
+        alignment = 1
+        offsets = []
+        for m in self.members:
+            size, align = m.layout(win32)
+            alignment = max(alignment, align)
+
+            if self.union:
+                offsets.append(0)
+                offset = max(offset, size)
+            else:
+                offset = (offset + align - 1) & ~(align - 1)
+                offsets.append(offset)
+                offset += size
+
+        size = (offset + alignment - 1) & ~(alignment - 1)
+        return size, alignment, offsets
+
     def needs_alignment(self):
         """ Check if structure needs alignment for 64-bit data.
         Various structures need alignment on 64-bit variables due
@@ -1433,37 +1743,30 @@ class VkStruct(Sequence):
 
     def needs_conversion(self):
         """ Returns if struct members needs conversion between win32 and host.
-        Structures need conversion if they contain members requiring alignment
-        or if they include other structures which need alignment.
+        Structures need conversion if their layout, or the layout of any
+        structure they include or point to, differs between win32 and host.
+        Structures with 64-bit members often end up with the same layout.
         """
 
-        if self.needs_alignment():
-            return True
-
-        for m in self.members:
-            if m.needs_conversion():
-                return True
-        return False
+        return not self.is_layout_compatible()
 
-    def needs_free(self):
-        """ Check if any struct member needs some memory freeing."""
+    def needs_arena(self):
+        """ Check if any struct member needs scratch memory for conversion. """
 
         for m in self.members:
-            if m.needs_free():
+            if m.needs_arena():
                 return True
 
-            continue
-
         return False
 
-    def set_type_info(self, types):
+    def set_type_info(self, types, consts):
         """ Helper function to set type information from the type registry.
         This is needed, because not all type data is available at time of
         parsing.
         """
         for m in self.members:
             type_info = types[m.type]
-            m.set_type_info(type_info)
+            m.set_type_info(type_info, consts)
 
 
 class ConversionFunction(object):
@@ -1486,22 +1789,43 @@ class ConversionFunction(object):
         """ Helper function for generating a conversion function for array structs. """
 
         if self.direction == Direction.OUTPUT:
-            params = ["const {0}_host *in".format(self.type), "uint32_t count"]
+            params = ["const {0}_host *in".format(self.type), "uint32_t count", "struct wine_vk_arena *arena"]
             return_type = self.type
         else:
-            params = ["const {0} *in".format(self.type), "uint32_t count"]
+            params = ["const {0} *in".format(self.type), "uint32_t count", "struct wine_vk_arena *arena"]
             return_type = "{0}_host".format(self.type)
 
+        # Nested arrays of input structures which convert without scratch memory
+        # are placed behind the array itself, so the whole conversion needs only
+        # a single allocation.
+        flat_members = []
+        if self.direction == Direction.INPUT:
+            flat_members = [m for m in self.struct if m.is_flat_array()]
+
         # Generate function prototype.
         body = "static inline {0} * {1}(".format(return_type, self.name)
         body += ", ".join(p for p in params)
         body += ")\n{\n"
 
         body += "    {0} *out;\n".format(return_type)
+        if flat_members:
+            body += "    SIZE_T size;\n"
+            body += "    BYTE *ptr;\n"
         body += "    unsigned int i;\n\n"
         body += "    if (!in) return NULL;\n\n"
 
-        body += "    out = ({0} *)heap_alloc(count * sizeof(*out));\n".format(return_type)
+        if flat_members:
+            body += "    size = count * sizeof(*out);\n"
+            body += "    for (i = 0; i < count; i++)\n"
+            body += "    {\n"
+            for m in flat_members:
+                body += "        if (in[i].{0}) size += {1} * sizeof({2}_host);\n".format(m.name,
+                        self._member_count(m, "in[i]."), m.type)
+            body += "    }\n\n"
+            body += "    if (!(out = wine_vk_arena_alloc(arena, size))) return NULL;\n"
+            body += "    ptr = (BYTE *)(out + count);\n"
+        else:
+            body += "    if (!(out = wine_vk_arena_alloc(arena, count * sizeof(*out)))) return NULL;\n"
 
         body += "    for (i = 0; i < count; i++)\n"
         body += "    {\n"
@@ -1509,7 +1833,18 @@ class ConversionFunction(object):
         for m in self.struct:
             # TODO: support copying of pNext extension structures!
             # Luckily though no extension struct at this point needs conversion.
-            body += "        " + m.copy("in[i].", "out[i].", self.direction)
+            if m in flat_members:
+                count = self._member_count(m, "in[i].")
+                body += "        if (in[i].{0})\n".format(m.name)
+                body += "        {\n"
+                body += "            out[i].{0} = ({1}_host *)ptr;\n".format(m.name, m.type)
+                body += "            convert_{0}_static_array_win_to_host(in[i].{1}, ({0}_host *)ptr, {2});\n".format(m.type, m.name, count)
+                body += "            ptr += {0} * sizeof({1}_host);\n".format(count, m.type)
+                body += "        }\n"
+                body += "        else\n"
+                body += "            out[i].{0} = NULL;\n".format(m.name)
+            else:
+                body += "        " + m.copy("in[i].", "out[i].", self.direction, fail="return NULL;")
 
         body += "    }\n\n"
         body += "    return out;\n"
@@ -1523,14 +1858,25 @@ class ConversionFunction(object):
             params = ["const {0}_host *in".format(self.type), "{0} *out".format(self.type)]
         else:
             params = ["const {0} *in".format(self.type), "{0}_host *out".format(self.type)]
+            if self.struct.needs_arena():
+                params.append("struct wine_vk_arena *arena")
 
-        body = "static inline void {0}(".format(self.name)
+        # Conversions drawing from an arena return FALSE when it runs out of memory.
+        failable = self.direction == Direction.INPUT and self.struct.needs_arena()
+
+        if failable:
+            body = "static inline BOOL {0}(".format(self.name)
+        else:
+            body = "static inline void {0}(".format(self.name)
 
         # Generate parameter list
         body += ", ".join(p for p in params)
         body += ")\n{\n"
 
-        body += "    if (!in) return;\n\n"
+        if failable:
+            body += "    if (!in) return TRUE;\n\n"
+        else:
+            body += "    if (!in) return;\n\n"
 
         if self.direction == Direction.INPUT and "pNext" in self.struct and self.struct.returnedonly:
             # We are dealing with an input_output parameter. For these we only need to copy
@@ -1543,8 +1889,10 @@ class ConversionFunction(object):
         else:
             for m in self.struct:
                 # TODO: support copying of pNext extension structures!
-                body += "    " + m.copy("in->", "out->", self.direction)
+                body += "    " + m.copy("in->", "out->", self.direction, fail="return FALSE;")
 
+        if failable:
+            body += "\n    return TRUE;\n"
         body += "}\n\n"
         return body
 
@@ -1555,7 +1903,7 @@ class ConversionFunction(object):
             params = ["const {0}_host *in".format(self.type), "{0} *out".format(self.type), "uint32_t count"]
             return_type = self.type
         else:
-            params = ["const {0} *in".format(self.type), "{0} *out_host".format(self.type), "uint32_t count"]
+            params = ["const {0} *in".format(self.type), "{0}_host *out".format(self.type), "uint32_t count"]
             return_type = "{0}_host".format(self.type)
 
         # Generate function prototype.
@@ -1575,6 +1923,14 @@ class ConversionFunction(object):
         body += "}\n\n"
         return body
 
+    def _member_count(self, member, input):
+        """ Return the element count of a dynamic array member. """
+
+        # Array length is either a variable name (string) or an int.
+        if isinstance(member.dyn_array_len, int):
+            return str(member.dyn_array_len)
+        return "{0}{1}".format(input, member.dyn_array_len)
+
     def _set_name(self):
         if self.direction == Direction.INPUT:
             if self.array:
@@ -1602,83 +1958,6 @@ class ConversionFunction(object):
             return self._generate_conversion_func()
 
 
-class FreeFunction(object):
-    def __init__(self, dyn_array, struct):
-        self.dyn_array = dyn_array
-        self.struct = struct
-        self.type = struct.name
-
-        if dyn_array:
-            self.name = "free_{0}_array".format(self.type)
-        else:
-            self.name = "free_{0}".format(self.type)
-
-    def __eq__(self, other):
-        if self.name == other.name:
-            return True
-
-        return False
-
-    def _generate_array_free_func(self):
-        """ Helper function for cleaning up temporary buffers required for array conversions. """
-
-        # Generate function prototype.
-        body = "static inline void {0}({1}_host *in, uint32_t count)\n{{\n".format(self.name, self.type)
-
-        # E.g. VkGraphicsPipelineCreateInfo_host needs freeing for pStages.
-        if self.struct.needs_free():
-            body += "    unsigned int i;\n\n"
-            body += "    if (!in) return;\n\n"
-            body += "    for (i = 0; i < count; i++)\n"
-            body += "    {\n"
-
-            for m in self.struct:
-                if m.needs_conversion() and m.is_dynamic_array():
-                    if m.is_const():
-                        # Add a cast to ignore const on conversion structs we allocated ourselves.
-                        body += "        free_{0}_array(({0}_host *)in[i].{1}, in[i].{2});\n".format(m.type, m.name, m.dyn_array_len)
-                    else:
-                        body += "        free_{0}_array(in[i].{1}, in[i].{2});\n".format(m.type, m.name, m.dyn_array_len)
-                elif m.needs_conversion():
-                    LOGGER.error("Unhandled conversion for {0}".format(m.name))
-            body += "    }\n"
-        else:
-            body += "    if (!in) return;\n\n"
-
-        body += "    heap_free(in);\n"
-
-        body += "}\n\n"
-        return body
-
-    def _generate_free_func(self):
-        # E.g. VkCommandBufferBeginInfo.pInheritanceInfo needs freeing.
-        if not self.struct.needs_free():
-            return ""
-
-        # Generate function prototype.
-        body = "static inline void {0}({1}_host *in)\n{{\n".format(self.name, self.type)
-
-        for m in self.struct:
-            if m.needs_conversion() and m.is_dynamic_array():
-                count = m.dyn_array_len if isinstance(m.dyn_array_len, int) else "in->{0}".format(m.dyn_array_len)
-                if m.is_const():
-                    # Add a cast to ignore const on conversion structs we allocated ourselves.
-                    body += "    free_{0}_array(({0}_host *)in->{1}, {2});\n".format(m.type, m.name, count)
-                else:
-                    body += "    free_{0}_array(in->{1}, {2});\n".format(m.type, m.name, count)
-
-        body += "}\n\n"
-        return body
-
-    def definition(self):
-        if self.dyn_array:
-            return self._generate_array_free_func()
-        else:
-            # Some structures need freeing too if they contain dynamic arrays.
-            # E.g. VkCommandBufferBeginInfo
-            return self._generate_free_func()
-
-
 class VkGenerator(object):
     def __init__(self, registry):
         self.registry = registry
@@ -1731,24 +2010,73 @@ class VkGenerator(object):
 
         # Generate any conversion helper functions.
         f.write("#if defined(USE_STRUCT_CONVERSION)\n")
+
+        # Structures with 64-bit members, which we pass through as their layout
+        # happens to match. Make sure the compiler agrees with our layout logic.
+        for struct in self.registry.structs:
+            if not struct.required or not struct.needs_alignment() or struct.needs_conversion():
+                continue
+
+            size, _, offsets = struct.layout(win32=True)
+            f.write("C_ASSERT(sizeof({0}) == {1});\n".format(struct.name, size))
+            for m, offset in zip(struct, offsets):
+                if m.needs_alignment():
+                    f.write("C_ASSERT(FIELD_OFFSET({0}, {1}) == {2});\n".format(struct.name, m.name, offset))
+        f.write("\n")
+
+        # Structures in descriptor update template data only differ in size, if at all.
+        for name in TEMPLATE_DATA_STRUCTS:
+            struct = self.registry.types[name]["data"]
+            if not struct.needs_conversion():
+                continue
+
+            _, _, win32_offsets = struct.layout(win32=True)
+            _, _, host_offsets = struct.layout(win32=False)
+            if win32_offsets != host_offsets:
+                LOGGER.error("Template data structure {0} needs conversion".format(name))
+
+            for m, offset in zip(struct, host_offsets):
+                f.write("C_ASSERT(FIELD_OFFSET({0}_host, {1}) == {2});\n".format(struct.name, m.name, offset))
+        f.write("\n")
+
         for conv in self.conversions:
             f.write(conv.definition())
         f.write("#endif /* USE_STRUCT_CONVERSION */\n\n")
 
-        # Create thunks for instance and device functions.
+        # Instance and device functions go through the thunks.
         # Global functions don't go through the thunks.
-        for vk_func in self.registry.funcs.values():
-            if not vk_func.is_required():
-                continue
+        thunk_funcs = [vk_func for vk_func in self.registry.funcs.values()
+                if vk_func.is_required() and not vk_func.is_global_func() and vk_func.needs_thunk()]
 
-            if vk_func.is_global_func():
-                continue
+        # Create a profiling counter block for each thunk.
+        f.write("enum wine_vk_profile_id\n{\n")
+        for vk_func in thunk_funcs:
+            f.write("    WINE_VK_PROFILE_{0},\n".format(vk_func.name))
+        f.write("};\n\n")
 
-            if not vk_func.needs_thunk():
-                continue
+        f.write("static struct wine_vk_profile_counters vk_profile_counters[] =\n{\n")
+        for vk_func in thunk_funcs:
+            f.write("    {{\"{0}\"}},\n".format(vk_func.name))
+        f.write("};\n\n")
 
+        f.write("struct wine_vk_profile_counters *wine_vk_get_profile_counters(unsigned int *count)\n")
+        f.write("{\n")
+        f.write("    *count = ARRAY_SIZE(vk_profile_counters);\n")
+        f.write("    return vk_profile_counters;\n")
+        f.write("}\n\n")
+
+        # Create thunks for instance and device functions.
+        for vk_func in thunk_funcs:
             f.write("static " + vk_func.thunk(prefix=prefix, call_conv="WINAPI"))
 
+        # Create untraced thunks for functions which don't need any conversions,
+        # used when fast dispatch is enabled.
+        for vk_func in self.registry.device_funcs:
+            if not vk_func.is_required() or not vk_func.needs_fast_thunk():
+                continue
+
+            f.write("static " + vk_func.fast_thunk(prefix=FAST_PREFIX, call_conv="WINAPI"))
+
         f.write("static const struct vulkan_func vk_device_dispatch_table[] =\n{\n")
         for vk_func in self.registry.device_funcs:
             if not vk_func.is_required():
@@ -1761,6 +2089,14 @@ class VkGenerator(object):
             f.write("    {{\"{0}\", &{1}{0}}},\n".format(vk_func.name, prefix))
         f.write("};\n\n")
 
+        f.write("static const struct vulkan_func vk_device_fast_dispatch_table[] =\n{\n")
+        for vk_func in self.registry.device_funcs:
+            if not vk_func.is_required() or not vk_func.needs_fast_thunk():
+                continue
+
+            f.write("    {{\"{0}\", &{1}{0}}},\n".format(vk_func.name, FAST_PREFIX))
+        f.write("};\n\n")
+
         f.write("static const struct vulkan_func vk_instance_dispatch_table[] =\n{\n")
         for vk_func in self.registry.instance_funcs:
             if not vk_func.is_required():
@@ -1787,6 +2123,20 @@ class VkGenerator(object):
         f.write("    return NULL;\n")
         f.write("}\n\n")
 
+        f.write("void *wine_vk_get_device_fast_proc_addr(const char *name)\n")
+        f.write("{\n")
+        f.write("    unsigned int i;\n")
+        f.write("    for (i = 0; i < ARRAY_SIZE(vk_device_fast_dispatch_table); i++)\n")
+        f.write("    {\n")
+        f.write("        if (strcmp(vk_device_fast_dispatch_table[i].name, name) == 0)\n")
+        f.write("        {\n")
+        f.write("            TRACE(\"Found pName=%s in device fast table\\n\", name);\n")
+        f.write("            return vk_device_fast_dispatch_table[i].func;\n")
+        f.write("        }\n")
+        f.write("    }\n")
+        f.write("    return NULL;\n")
+        f.write("}\n\n")
+
         f.write("void *wine_vk_get_instance_proc_addr(const char *name)\n")
         f.write("{\n")
         f.write("    unsigned int i;\n")
@@ -1847,20 +2197,23 @@ class VkGenerator(object):
         f.write("#ifndef __WINE_VULKAN_THUNKS_H\n")
         f.write("#define __WINE_VULKAN_THUNKS_H\n\n")
 
-        f.write("/* Perform vulkan struct conversion on 32-bit platforms.\n")
-        f.write(" * Is this sufficient? Do we care about some other 32-bit platforms?\n")
+        f.write("/* Perform vulkan struct conversion on i386, where 64-bit members are only\n")
+        f.write(" * 4-byte aligned within host structures. Other platforms share the win32 layout.\n")
         f.write(" */\n")
-        f.write("#if (defined(__i386__) || defined(__arm__))\n")
+        f.write("#if defined(__i386__)\n")
         f.write("    #define USE_STRUCT_CONVERSION\n")
         f.write("#endif\n\n")
 
         f.write("/* For use by vk_icdGetInstanceProcAddr / vkGetInstanceProcAddr */\n")
         f.write("void *wine_vk_get_device_proc_addr(const char *name) DECLSPEC_HIDDEN;\n")
+        f.write("void *wine_vk_get_device_fast_proc_addr(const char *name) DECLSPEC_HIDDEN;\n")
         f.write("void *wine_vk_get_instance_proc_addr(const char *name) DECLSPEC_HIDDEN;\n\n")
 
         f.write("BOOL wine_vk_device_extension_supported(const char *name) DECLSPEC_HIDDEN;\n")
         f.write("BOOL wine_vk_instance_extension_supported(const char *name) DECLSPEC_HIDDEN;\n\n")
 
+        f.write("struct wine_vk_profile_counters *wine_vk_get_profile_counters(unsigned int *count) DECLSPEC_HIDDEN;\n\n")
+
         # Generate prototypes for device and instance functions requiring a custom implementation.
         f.write("/* Functions for which we have custom implementations outside of the thunks. */\n")
         for vk_func in self.registry.funcs.values():
@@ -2402,8 +2755,9 @@ class VkRegistry(object):
         # are parsed among other types, so there is no guarantee
         # that any types needed have been parsed already, so set
         # the data now.
+        consts = {c.name : c.value for c in self.consts}
         for struct in structs:
-            struct.set_type_info(self.types)
+            struct.set_type_info(self.types, consts)
 
         # Guarantee everything is sorted, so code generation doesn't have
         # to deal with this.
@@ -20,6 +20,8 @@
 #ifndef __WINE_VULKAN_PRIVATE_H
 #define __WINE_VULKAN_PRIVATE_H
 
+#include "wine/list.h"
+
 #include "vulkan_thunks.h"
 
 /* Magic value defined by Vulkan ICD / Loader spec */
@@ -48,11 +50,149 @@ struct wine_vk_base
     UINT_PTR loader_magic;
 };
 
+#if defined(USE_STRUCT_CONVERSION)
+/* Scratch memory for win32 to host struct conversions. Allocations bump a pointer
+ * within a list of chunks and are only released all at once by wine_vk_arena_reset,
+ * which keeps the chunks around for reuse. This keeps the heap out of the thunks.
+ */
+struct wine_vk_arena_chunk
+{
+    struct wine_vk_arena_chunk *next;
+    SIZE_T size;
+    SIZE_T used;
+    BYTE DECLSPEC_ALIGN(8) data[1];
+};
+
+struct wine_vk_arena
+{
+    struct wine_vk_arena_chunk *first;
+    struct wine_vk_arena_chunk *current;
+};
+
+void *wine_vk_arena_alloc_chunk(struct wine_vk_arena *arena, SIZE_T size) DECLSPEC_HIDDEN;
+void wine_vk_arena_free(struct wine_vk_arena *arena) DECLSPEC_HIDDEN;
+void wine_vk_arena_reset(struct wine_vk_arena *arena) DECLSPEC_HIDDEN;
+struct wine_vk_arena *wine_vk_get_thread_arena(void) DECLSPEC_HIDDEN;
+
+static inline void *wine_vk_arena_alloc(struct wine_vk_arena *arena, SIZE_T size)
+{
+    struct wine_vk_arena_chunk *chunk = arena->current;
+    void *ptr;
+
+    size = (size + 7) & ~7;
+    if (!chunk || chunk->size - chunk->used < size)
+        return wine_vk_arena_alloc_chunk(arena, size);
+
+    ptr = chunk->data + chunk->used;
+    chunk->used += size;
+    return ptr;
+}
+#endif
+
+/* Call profiling, enabled through WINE_VK_PROFILE. The generated thunks and
+ * the hand written hot paths time their whole call as well as the host calls
+ * and add the result to a counter block per entry point, conversion time is
+ * the difference between the two.
+ */
+#define WINE_VK_PROFILE_BUCKETS 32
+
+struct wine_vk_profile_counters
+{
+    const char *name;
+    LONGLONG calls;
+    LONGLONG conversion_time; /* in ns */
+    LONGLONG host_time; /* in ns */
+    LONG histogram[WINE_VK_PROFILE_BUCKETS]; /* calls by log2 of their duration in ns */
+};
+
+struct wine_vk_profile_timer
+{
+    ULONGLONG start;
+    ULONGLONG host_start; /* start of the last host call, 0 if none was marked */
+    ULONGLONG host_time; /* total time of the marked host calls */
+};
+
+extern BOOL wine_vk_profiling DECLSPEC_HIDDEN;
+
+ULONGLONG wine_vk_profile_time(void) DECLSPEC_HIDDEN;
+void wine_vk_profile_update(struct wine_vk_profile_counters *counters,
+        const struct wine_vk_profile_timer *timer) DECLSPEC_HIDDEN;
+
+static inline void wine_vk_profile_begin(struct wine_vk_profile_timer *timer)
+{
+    timer->start = wine_vk_profiling ? wine_vk_profile_time() : 0;
+    timer->host_start = timer->host_time = 0;
+}
+
+static inline void wine_vk_profile_host_begin(struct wine_vk_profile_timer *timer)
+{
+    if (timer->start)
+        timer->host_start = wine_vk_profile_time();
+}
+
+static inline void wine_vk_profile_host_end(struct wine_vk_profile_timer *timer)
+{
+    if (timer->start)
+        timer->host_time += wine_vk_profile_time() - timer->host_start;
+}
+
+/* Thunks without conversions don't mark the host call, it makes up the whole call.
+ * Functions may mark several host calls, their times add up. */
+static inline void wine_vk_profile_end(struct wine_vk_profile_timer *timer,
+        struct wine_vk_profile_counters *counters)
+{
+    if (timer->start)
+        wine_vk_profile_update(counters, timer);
+}
+
+/* Hash map from host handles to the objects tracking them. Entries are
+ * embedded in the objects and chained per bucket.
+ */
+struct wine_vk_handle_entry
+{
+    struct wine_vk_handle_entry *next;
+    uint64_t host_handle;
+};
+
+struct wine_vk_handle_map
+{
+    struct wine_vk_handle_entry **buckets;
+    unsigned int bucket_count;
+    unsigned int count;
+    SRWLOCK lock;
+};
+
+void wine_vk_handle_map_init(struct wine_vk_handle_map *map) DECLSPEC_HIDDEN;
+void wine_vk_handle_map_destroy(struct wine_vk_handle_map *map) DECLSPEC_HIDDEN;
+BOOL wine_vk_handle_map_insert(struct wine_vk_handle_map *map, struct wine_vk_handle_entry *entry) DECLSPEC_HIDDEN;
+void wine_vk_handle_map_remove(struct wine_vk_handle_map *map, struct wine_vk_handle_entry *entry) DECLSPEC_HIDDEN;
+struct wine_vk_handle_entry *wine_vk_handle_map_get(struct wine_vk_handle_map *map,
+        uint64_t host_handle) DECLSPEC_HIDDEN;
+
+/* Command pools are not dispatchable, but we track the command buffer wrappers
+ * allocated from them. Wrappers are carved out of slabs owned by the pool and
+ * recycled through a free list, access is externally synchronized by the application.
+ */
+struct wine_cmd_pool
+{
+    struct wine_vk_handle_entry entry; /* in device->command_pools */
+    struct list command_buffers;
+    struct list free_command_buffers;
+    struct list slabs;
+};
+
 struct VkCommandBuffer_T
 {
     struct wine_vk_base base;
     VkDevice device; /* parent */
+    struct wine_cmd_pool *pool; /* parent */
     VkCommandBuffer command_buffer; /* native command buffer */
+    struct list pool_entry;
+
+#if defined(USE_STRUCT_CONVERSION)
+    /* Conversion scratch memory, reset when recording starts over. */
+    struct wine_vk_arena arena;
+#endif
 };
 
 struct VkDevice_T
@@ -65,10 +205,24 @@ struct VkDevice_T
     struct VkQueue_T **queues;
     /* Stores number of queues per queue family */
     int *queue_count;
+    LONG deferred_queues; /* number of queues holding deferred submits */
+
+    struct wine_vk_handle_map command_pools;
+
+    /* Implicit pipeline cache persisted across runs, used for pipelines
+     * created without a pipeline cache. */
+    VkPipelineCache pipeline_cache;
+    WCHAR *pipeline_cache_path;
+    size_t pipeline_cache_size; /* size of the data loaded from disk */
 
     VkDevice device; /* native device */
 };
 
+static inline VkPipelineCache wine_vk_device_pipeline_cache(VkDevice device, VkPipelineCache pipeline_cache)
+{
+    return pipeline_cache != VK_NULL_HANDLE ? pipeline_cache : device->pipeline_cache;
+}
+
 struct VkInstance_T
 {
     struct wine_vk_base base;
@@ -100,6 +254,28 @@ struct VkQueue_T
     struct wine_vk_base base;
     VkDevice device; /* parent */
     VkQueue queue; /* native queue */
+
+    /* Host copies of VkSubmitInfo and the arrays it points to, reused across
+     * vkQueueSubmit calls. With submit coalescing enabled these also hold
+     * deferred submits until the queue is flushed, guarded by 'cs'.
+     */
+    VkSubmitInfo *submits;
+    SIZE_T submits_size;
+    uint32_t submit_count;
+    VkCommandBuffer *command_buffers;
+    SIZE_T command_buffers_size;
+    uint32_t command_buffer_count;
+    VkSemaphore *semaphores;
+    SIZE_T semaphores_size;
+    uint32_t semaphore_count;
+    VkPipelineStageFlags *wait_stages;
+    SIZE_T wait_stages_size;
+    uint32_t wait_stage_count;
+    BOOL deferred; /* holds deferred submits, counted in the device's deferred_queues */
+    CRITICAL_SECTION cs;
 };
 
+void wine_vk_device_flush_submits(VkDevice device) DECLSPEC_HIDDEN;
+void wine_vk_queue_flush_submits(VkQueue queue) DECLSPEC_HIDDEN;
+
 #endif /* __WINE_VULKAN_PRIVATE_H */
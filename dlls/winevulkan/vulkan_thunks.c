@@ -12,27 +12,51 @@
 WINE_DEFAULT_DEBUG_CHANNEL(vulkan);
 
 #if defined(USE_STRUCT_CONVERSION)
-static inline void convert_VkCommandBufferAllocateInfo_win_to_host(const VkCommandBufferAllocateInfo *in, VkCommandBufferAllocateInfo_host *out)
-{
-    if (!in) return;
-
-    out->sType = in->sType;
-    out->pNext = in->pNext;
-    out->commandPool = in->commandPool;
-    out->level = in->level;
-    out->commandBufferCount = in->commandBufferCount;
-}
-
-static inline void convert_VkDescriptorSetAllocateInfo_win_to_host(const VkDescriptorSetAllocateInfo *in, VkDescriptorSetAllocateInfo_host *out)
-{
-    if (!in) return;
-
-    out->sType = in->sType;
-    out->pNext = in->pNext;
-    out->descriptorPool = in->descriptorPool;
-    out->descriptorSetCount = in->descriptorSetCount;
-    out->pSetLayouts = in->pSetLayouts;
-}
+C_ASSERT(sizeof(VkBufferCopy) == 24);
+C_ASSERT(FIELD_OFFSET(VkBufferCopy, srcOffset) == 0);
+C_ASSERT(FIELD_OFFSET(VkBufferCopy, dstOffset) == 8);
+C_ASSERT(FIELD_OFFSET(VkBufferCopy, size) == 16);
+C_ASSERT(sizeof(VkBufferImageCopy) == 56);
+C_ASSERT(FIELD_OFFSET(VkBufferImageCopy, bufferOffset) == 0);
+C_ASSERT(sizeof(VkBufferMemoryBarrier) == 48);
+C_ASSERT(FIELD_OFFSET(VkBufferMemoryBarrier, buffer) == 24);
+C_ASSERT(FIELD_OFFSET(VkBufferMemoryBarrier, offset) == 32);
+C_ASSERT(FIELD_OFFSET(VkBufferMemoryBarrier, size) == 40);
+C_ASSERT(sizeof(VkCommandBufferAllocateInfo) == 24);
+C_ASSERT(FIELD_OFFSET(VkCommandBufferAllocateInfo, commandPool) == 8);
+C_ASSERT(sizeof(VkDescriptorBufferInfo) == 24);
+C_ASSERT(FIELD_OFFSET(VkDescriptorBufferInfo, buffer) == 0);
+C_ASSERT(FIELD_OFFSET(VkDescriptorBufferInfo, offset) == 8);
+C_ASSERT(FIELD_OFFSET(VkDescriptorBufferInfo, range) == 16);
+C_ASSERT(sizeof(VkDescriptorSetAllocateInfo) == 24);
+C_ASSERT(FIELD_OFFSET(VkDescriptorSetAllocateInfo, descriptorPool) == 8);
+C_ASSERT(sizeof(VkImageFormatProperties) == 32);
+C_ASSERT(FIELD_OFFSET(VkImageFormatProperties, maxResourceSize) == 24);
+C_ASSERT(sizeof(VkImageFormatProperties2KHR) == 40);
+C_ASSERT(FIELD_OFFSET(VkImageFormatProperties2KHR, imageFormatProperties) == 8);
+C_ASSERT(sizeof(VkMappedMemoryRange) == 32);
+C_ASSERT(FIELD_OFFSET(VkMappedMemoryRange, memory) == 8);
+C_ASSERT(FIELD_OFFSET(VkMappedMemoryRange, offset) == 16);
+C_ASSERT(FIELD_OFFSET(VkMappedMemoryRange, size) == 24);
+C_ASSERT(sizeof(VkPipelineShaderStageCreateInfo) == 32);
+C_ASSERT(FIELD_OFFSET(VkPipelineShaderStageCreateInfo, module) == 16);
+C_ASSERT(sizeof(VkRenderPassBeginInfo) == 48);
+C_ASSERT(FIELD_OFFSET(VkRenderPassBeginInfo, renderPass) == 8);
+C_ASSERT(FIELD_OFFSET(VkRenderPassBeginInfo, framebuffer) == 16);
+C_ASSERT(sizeof(VkSparseImageMemoryRequirements) == 48);
+C_ASSERT(FIELD_OFFSET(VkSparseImageMemoryRequirements, imageMipTailSize) == 24);
+C_ASSERT(FIELD_OFFSET(VkSparseImageMemoryRequirements, imageMipTailOffset) == 32);
+C_ASSERT(FIELD_OFFSET(VkSparseImageMemoryRequirements, imageMipTailStride) == 40);
+C_ASSERT(sizeof(VkSubresourceLayout) == 40);
+C_ASSERT(FIELD_OFFSET(VkSubresourceLayout, offset) == 0);
+C_ASSERT(FIELD_OFFSET(VkSubresourceLayout, size) == 8);
+C_ASSERT(FIELD_OFFSET(VkSubresourceLayout, rowPitch) == 16);
+C_ASSERT(FIELD_OFFSET(VkSubresourceLayout, arrayPitch) == 24);
+C_ASSERT(FIELD_OFFSET(VkSubresourceLayout, depthPitch) == 32);
+
+C_ASSERT(FIELD_OFFSET(VkDescriptorImageInfo_host, sampler) == 0);
+C_ASSERT(FIELD_OFFSET(VkDescriptorImageInfo_host, imageView) == 8);
+C_ASSERT(FIELD_OFFSET(VkDescriptorImageInfo_host, imageLayout) == 16);
 
 static inline void convert_VkMemoryAllocateInfo_win_to_host(const VkMemoryAllocateInfo *in, VkMemoryAllocateInfo_host *out)
 {
@@ -44,14 +68,14 @@ static inline void convert_VkMemoryAllocateInfo_win_to_host(const VkMemoryAlloca
     out->memoryTypeIndex = in->memoryTypeIndex;
 }
 
-static inline VkCommandBufferInheritanceInfo_host * convert_VkCommandBufferInheritanceInfo_array_win_to_host(const VkCommandBufferInheritanceInfo *in, uint32_t count)
+static inline VkCommandBufferInheritanceInfo_host * convert_VkCommandBufferInheritanceInfo_array_win_to_host(const VkCommandBufferInheritanceInfo *in, uint32_t count, struct wine_vk_arena *arena)
 {
     VkCommandBufferInheritanceInfo_host *out;
-    int i;
+    unsigned int i;
 
     if (!in) return NULL;
 
-    out = (VkCommandBufferInheritanceInfo_host *)heap_alloc(count * sizeof(*out));
+    if (!(out = wine_vk_arena_alloc(arena, count * sizeof(*out)))) return NULL;
     for (i = 0; i < count; i++)
     {
         out[i].sType = in[i].sType;
@@ -67,133 +91,26 @@ static inline VkCommandBufferInheritanceInfo_host * convert_VkCommandBufferInher
     return out;
 }
 
-static inline void free_VkCommandBufferInheritanceInfo_array(VkCommandBufferInheritanceInfo_host *in, uint32_t count)
-{
-    if (!in) return;
-
-    heap_free(in);
-}
-
-static inline void convert_VkCommandBufferBeginInfo_win_to_host(const VkCommandBufferBeginInfo *in, VkCommandBufferBeginInfo_host *out)
+static inline BOOL convert_VkCommandBufferBeginInfo_win_to_host(const VkCommandBufferBeginInfo *in, VkCommandBufferBeginInfo_host *out, struct wine_vk_arena *arena)
 {
-    if (!in) return;
+    if (!in) return TRUE;
 
     out->sType = in->sType;
     out->pNext = in->pNext;
     out->flags = in->flags;
-    out->pInheritanceInfo = convert_VkCommandBufferInheritanceInfo_array_win_to_host(in->pInheritanceInfo, 1);
-}
-
-static inline void free_VkCommandBufferBeginInfo(VkCommandBufferBeginInfo_host *in)
-{
-    free_VkCommandBufferInheritanceInfo_array((VkCommandBufferInheritanceInfo_host *)in->pInheritanceInfo, 1);
-}
-
-static inline void convert_VkRenderPassBeginInfo_win_to_host(const VkRenderPassBeginInfo *in, VkRenderPassBeginInfo_host *out)
-{
-    if (!in) return;
-
-    out->sType = in->sType;
-    out->pNext = in->pNext;
-    out->renderPass = in->renderPass;
-    out->framebuffer = in->framebuffer;
-    out->renderArea = in->renderArea;
-    out->clearValueCount = in->clearValueCount;
-    out->pClearValues = in->pClearValues;
-}
-
-static inline VkBufferCopy_host * convert_VkBufferCopy_array_win_to_host(const VkBufferCopy *in, uint32_t count)
-{
-    VkBufferCopy_host *out;
-    int i;
-
-    if (!in) return NULL;
-
-    out = (VkBufferCopy_host *)heap_alloc(count * sizeof(*out));
-    for (i = 0; i < count; i++)
-    {
-        out[i].srcOffset = in[i].srcOffset;
-        out[i].dstOffset = in[i].dstOffset;
-        out[i].size = in[i].size;
-    }
-
-    return out;
-}
-
-static inline void free_VkBufferCopy_array(VkBufferCopy_host *in, uint32_t count)
-{
-    if (!in) return;
-
-    heap_free(in);
-}
-
-static inline VkBufferImageCopy_host * convert_VkBufferImageCopy_array_win_to_host(const VkBufferImageCopy *in, uint32_t count)
-{
-    VkBufferImageCopy_host *out;
-    int i;
-
-    if (!in) return NULL;
-
-    out = (VkBufferImageCopy_host *)heap_alloc(count * sizeof(*out));
-    for (i = 0; i < count; i++)
-    {
-        out[i].bufferOffset = in[i].bufferOffset;
-        out[i].bufferRowLength = in[i].bufferRowLength;
-        out[i].bufferImageHeight = in[i].bufferImageHeight;
-        out[i].imageSubresource = in[i].imageSubresource;
-        out[i].imageOffset = in[i].imageOffset;
-        out[i].imageExtent = in[i].imageExtent;
-    }
-
-    return out;
-}
-
-static inline void free_VkBufferImageCopy_array(VkBufferImageCopy_host *in, uint32_t count)
-{
-    if (!in) return;
-
-    heap_free(in);
-}
-
-static inline VkBufferMemoryBarrier_host * convert_VkBufferMemoryBarrier_array_win_to_host(const VkBufferMemoryBarrier *in, uint32_t count)
-{
-    VkBufferMemoryBarrier_host *out;
-    int i;
-
-    if (!in) return NULL;
-
-    out = (VkBufferMemoryBarrier_host *)heap_alloc(count * sizeof(*out));
-    for (i = 0; i < count; i++)
-    {
-        out[i].sType = in[i].sType;
-        out[i].pNext = in[i].pNext;
-        out[i].srcAccessMask = in[i].srcAccessMask;
-        out[i].dstAccessMask = in[i].dstAccessMask;
-        out[i].srcQueueFamilyIndex = in[i].srcQueueFamilyIndex;
-        out[i].dstQueueFamilyIndex = in[i].dstQueueFamilyIndex;
-        out[i].buffer = in[i].buffer;
-        out[i].offset = in[i].offset;
-        out[i].size = in[i].size;
-    }
-
-    return out;
-}
-
-static inline void free_VkBufferMemoryBarrier_array(VkBufferMemoryBarrier_host *in, uint32_t count)
-{
-    if (!in) return;
+    if (!(out->pInheritanceInfo = convert_VkCommandBufferInheritanceInfo_array_win_to_host(in->pInheritanceInfo, 1, arena)) && in->pInheritanceInfo) return FALSE;
 
-    heap_free(in);
+    return TRUE;
 }
 
-static inline VkImageMemoryBarrier_host * convert_VkImageMemoryBarrier_array_win_to_host(const VkImageMemoryBarrier *in, uint32_t count)
+static inline VkImageMemoryBarrier_host * convert_VkImageMemoryBarrier_array_win_to_host(const VkImageMemoryBarrier *in, uint32_t count, struct wine_vk_arena *arena)
 {
     VkImageMemoryBarrier_host *out;
-    int i;
+    unsigned int i;
 
     if (!in) return NULL;
 
-    out = (VkImageMemoryBarrier_host *)heap_alloc(count * sizeof(*out));
+    if (!(out = wine_vk_arena_alloc(arena, count * sizeof(*out)))) return NULL;
     for (i = 0; i < count; i++)
     {
         out[i].sType = in[i].sType;
@@ -211,71 +128,37 @@ static inline VkImageMemoryBarrier_host * convert_VkImageMemoryBarrier_array_win
     return out;
 }
 
-static inline void free_VkImageMemoryBarrier_array(VkImageMemoryBarrier_host *in, uint32_t count)
-{
-    if (!in) return;
-
-    heap_free(in);
-}
-
-static inline VkDescriptorImageInfo_host * convert_VkDescriptorImageInfo_array_win_to_host(const VkDescriptorImageInfo *in, uint32_t count)
+static inline void convert_VkDescriptorImageInfo_static_array_win_to_host(const VkDescriptorImageInfo *in, VkDescriptorImageInfo_host *out, uint32_t count)
 {
-    VkDescriptorImageInfo_host *out;
-    int i;
+    unsigned int i;
 
-    if (!in) return NULL;
+    if (!in) return;
 
-    out = (VkDescriptorImageInfo_host *)heap_alloc(count * sizeof(*out));
     for (i = 0; i < count; i++)
     {
         out[i].sampler = in[i].sampler;
         out[i].imageView = in[i].imageView;
         out[i].imageLayout = in[i].imageLayout;
     }
-
-    return out;
-}
-
-static inline void free_VkDescriptorImageInfo_array(VkDescriptorImageInfo_host *in, uint32_t count)
-{
-    if (!in) return;
-
-    heap_free(in);
 }
 
-static inline VkDescriptorBufferInfo_host * convert_VkDescriptorBufferInfo_array_win_to_host(const VkDescriptorBufferInfo *in, uint32_t count)
+static inline VkWriteDescriptorSet_host * convert_VkWriteDescriptorSet_array_win_to_host(const VkWriteDescriptorSet *in, uint32_t count, struct wine_vk_arena *arena)
 {
-    VkDescriptorBufferInfo_host *out;
-    int i;
+    VkWriteDescriptorSet_host *out;
+    SIZE_T size;
+    BYTE *ptr;
+    unsigned int i;
 
     if (!in) return NULL;
 
-    out = (VkDescriptorBufferInfo_host *)heap_alloc(count * sizeof(*out));
+    size = count * sizeof(*out);
     for (i = 0; i < count; i++)
     {
-        out[i].buffer = in[i].buffer;
-        out[i].offset = in[i].offset;
-        out[i].range = in[i].range;
+        if (in[i].pImageInfo) size += in[i].descriptorCount * sizeof(VkDescriptorImageInfo_host);
     }
 
-    return out;
-}
-
-static inline void free_VkDescriptorBufferInfo_array(VkDescriptorBufferInfo_host *in, uint32_t count)
-{
-    if (!in) return;
-
-    heap_free(in);
-}
-
-static inline VkWriteDescriptorSet_host * convert_VkWriteDescriptorSet_array_win_to_host(const VkWriteDescriptorSet *in, uint32_t count)
-{
-    VkWriteDescriptorSet_host *out;
-    int i;
-
-    if (!in) return NULL;
-
-    out = (VkWriteDescriptorSet_host *)heap_alloc(count * sizeof(*out));
+    if (!(out = wine_vk_arena_alloc(arena, size))) return NULL;
+    ptr = (BYTE *)(out + count);
     for (i = 0; i < count; i++)
     {
         out[i].sType = in[i].sType;
@@ -285,28 +168,21 @@ static inline VkWriteDescriptorSet_host * convert_VkWriteDescriptorSet_array_win
         out[i].dstArrayElement = in[i].dstArrayElement;
         out[i].descriptorCount = in[i].descriptorCount;
         out[i].descriptorType = in[i].descriptorType;
-        out[i].pImageInfo = convert_VkDescriptorImageInfo_array_win_to_host(in[i].pImageInfo, in[i].descriptorCount);
-        out[i].pBufferInfo = convert_VkDescriptorBufferInfo_array_win_to_host(in[i].pBufferInfo, in[i].descriptorCount);
+        if (in[i].pImageInfo)
+        {
+            out[i].pImageInfo = (VkDescriptorImageInfo_host *)ptr;
+            convert_VkDescriptorImageInfo_static_array_win_to_host(in[i].pImageInfo, (VkDescriptorImageInfo_host *)ptr, in[i].descriptorCount);
+            ptr += in[i].descriptorCount * sizeof(VkDescriptorImageInfo_host);
+        }
+        else
+            out[i].pImageInfo = NULL;
+        out[i].pBufferInfo = in[i].pBufferInfo;
         out[i].pTexelBufferView = in[i].pTexelBufferView;
     }
 
     return out;
 }
 
-static inline void free_VkWriteDescriptorSet_array(VkWriteDescriptorSet_host *in, uint32_t count)
-{
-    int i;
-
-    if (!in) return;
-
-    for (i = 0; i < count; i++)
-    {
-        free_VkDescriptorImageInfo_array((VkDescriptorImageInfo_host *)in[i].pImageInfo, in[i].descriptorCount);
-        free_VkDescriptorBufferInfo_array((VkDescriptorBufferInfo_host *)in[i].pBufferInfo, in[i].descriptorCount);
-    }
-    heap_free(in);
-}
-
 static inline void convert_VkBufferCreateInfo_win_to_host(const VkBufferCreateInfo *in, VkBufferCreateInfo_host *out)
 {
     if (!in) return;
@@ -334,33 +210,20 @@ static inline void convert_VkBufferViewCreateInfo_win_to_host(const VkBufferView
     out->range = in->range;
 }
 
-static inline void convert_VkPipelineShaderStageCreateInfo_win_to_host(const VkPipelineShaderStageCreateInfo *in, VkPipelineShaderStageCreateInfo_host *out)
-{
-    if (!in) return;
-
-    out->sType = in->sType;
-    out->pNext = in->pNext;
-    out->flags = in->flags;
-    out->stage = in->stage;
-    out->module = in->module;
-    out->pName = in->pName;
-    out->pSpecializationInfo = in->pSpecializationInfo;
-}
-
-static inline VkComputePipelineCreateInfo_host * convert_VkComputePipelineCreateInfo_array_win_to_host(const VkComputePipelineCreateInfo *in, uint32_t count)
+static inline VkComputePipelineCreateInfo_host * convert_VkComputePipelineCreateInfo_array_win_to_host(const VkComputePipelineCreateInfo *in, uint32_t count, struct wine_vk_arena *arena)
 {
     VkComputePipelineCreateInfo_host *out;
-    int i;
+    unsigned int i;
 
     if (!in) return NULL;
 
-    out = (VkComputePipelineCreateInfo_host *)heap_alloc(count * sizeof(*out));
+    if (!(out = wine_vk_arena_alloc(arena, count * sizeof(*out)))) return NULL;
     for (i = 0; i < count; i++)
     {
         out[i].sType = in[i].sType;
         out[i].pNext = in[i].pNext;
         out[i].flags = in[i].flags;
-        convert_VkPipelineShaderStageCreateInfo_win_to_host(&in[i].stage, &out[i].stage);
+        out[i].stage = in[i].stage;
         out[i].layout = in[i].layout;
         out[i].basePipelineHandle = in[i].basePipelineHandle;
         out[i].basePipelineIndex = in[i].basePipelineIndex;
@@ -369,13 +232,6 @@ static inline VkComputePipelineCreateInfo_host * convert_VkComputePipelineCreate
     return out;
 }
 
-static inline void free_VkComputePipelineCreateInfo_array(VkComputePipelineCreateInfo_host *in, uint32_t count)
-{
-    if (!in) return;
-
-    heap_free(in);
-}
-
 static inline void convert_VkDescriptorUpdateTemplateCreateInfoKHR_win_to_host(const VkDescriptorUpdateTemplateCreateInfoKHR *in, VkDescriptorUpdateTemplateCreateInfoKHR_host *out)
 {
     if (!in) return;
@@ -407,50 +263,21 @@ static inline void convert_VkFramebufferCreateInfo_win_to_host(const VkFramebuff
     out->layers = in->layers;
 }
 
-static inline VkPipelineShaderStageCreateInfo_host * convert_VkPipelineShaderStageCreateInfo_array_win_to_host(const VkPipelineShaderStageCreateInfo *in, uint32_t count)
-{
-    VkPipelineShaderStageCreateInfo_host *out;
-    int i;
-
-    if (!in) return NULL;
-
-    out = (VkPipelineShaderStageCreateInfo_host *)heap_alloc(count * sizeof(*out));
-    for (i = 0; i < count; i++)
-    {
-        out[i].sType = in[i].sType;
-        out[i].pNext = in[i].pNext;
-        out[i].flags = in[i].flags;
-        out[i].stage = in[i].stage;
-        out[i].module = in[i].module;
-        out[i].pName = in[i].pName;
-        out[i].pSpecializationInfo = in[i].pSpecializationInfo;
-    }
-
-    return out;
-}
-
-static inline void free_VkPipelineShaderStageCreateInfo_array(VkPipelineShaderStageCreateInfo_host *in, uint32_t count)
-{
-    if (!in) return;
-
-    heap_free(in);
-}
-
-static inline VkGraphicsPipelineCreateInfo_host * convert_VkGraphicsPipelineCreateInfo_array_win_to_host(const VkGraphicsPipelineCreateInfo *in, uint32_t count)
+static inline VkGraphicsPipelineCreateInfo_host * convert_VkGraphicsPipelineCreateInfo_array_win_to_host(const VkGraphicsPipelineCreateInfo *in, uint32_t count, struct wine_vk_arena *arena)
 {
     VkGraphicsPipelineCreateInfo_host *out;
-    int i;
+    unsigned int i;
 
     if (!in) return NULL;
 
-    out = (VkGraphicsPipelineCreateInfo_host *)heap_alloc(count * sizeof(*out));
+    if (!(out = wine_vk_arena_alloc(arena, count * sizeof(*out)))) return NULL;
     for (i = 0; i < count; i++)
     {
         out[i].sType = in[i].sType;
         out[i].pNext = in[i].pNext;
         out[i].flags = in[i].flags;
         out[i].stageCount = in[i].stageCount;
-        out[i].pStages = convert_VkPipelineShaderStageCreateInfo_array_win_to_host(in[i].pStages, in[i].stageCount);
+        out[i].pStages = in[i].pStages;
         out[i].pVertexInputState = in[i].pVertexInputState;
         out[i].pInputAssemblyState = in[i].pInputAssemblyState;
         out[i].pTessellationState = in[i].pTessellationState;
@@ -470,19 +297,6 @@ static inline VkGraphicsPipelineCreateInfo_host * convert_VkGraphicsPipelineCrea
     return out;
 }
 
-static inline void free_VkGraphicsPipelineCreateInfo_array(VkGraphicsPipelineCreateInfo_host *in, uint32_t count)
-{
-    int i;
-
-    if (!in) return;
-
-    for (i = 0; i < count; i++)
-    {
-        free_VkPipelineShaderStageCreateInfo_array((VkPipelineShaderStageCreateInfo_host *)in[i].pStages, in[i].stageCount);
-    }
-    heap_free(in);
-}
-
 static inline void convert_VkImageViewCreateInfo_win_to_host(const VkImageViewCreateInfo *in, VkImageViewCreateInfo_host *out)
 {
     if (!in) return;
@@ -497,33 +311,6 @@ static inline void convert_VkImageViewCreateInfo_win_to_host(const VkImageViewCr
     out->subresourceRange = in->subresourceRange;
 }
 
-static inline VkMappedMemoryRange_host * convert_VkMappedMemoryRange_array_win_to_host(const VkMappedMemoryRange *in, uint32_t count)
-{
-    VkMappedMemoryRange_host *out;
-    int i;
-
-    if (!in) return NULL;
-
-    out = (VkMappedMemoryRange_host *)heap_alloc(count * sizeof(*out));
-    for (i = 0; i < count; i++)
-    {
-        out[i].sType = in[i].sType;
-        out[i].pNext = in[i].pNext;
-        out[i].memory = in[i].memory;
-        out[i].offset = in[i].offset;
-        out[i].size = in[i].size;
-    }
-
-    return out;
-}
-
-static inline void free_VkMappedMemoryRange_array(VkMappedMemoryRange_host *in, uint32_t count)
-{
-    if (!in) return;
-
-    heap_free(in);
-}
-
 static inline void convert_VkMemoryRequirements_host_to_win(const VkMemoryRequirements_host *in, VkMemoryRequirements *out)
 {
     if (!in) return;
@@ -533,48 +320,9 @@ static inline void convert_VkMemoryRequirements_host_to_win(const VkMemoryRequir
     out->memoryTypeBits = in->memoryTypeBits;
 }
 
-static inline void convert_VkSubresourceLayout_host_to_win(const VkSubresourceLayout_host *in, VkSubresourceLayout *out)
-{
-    if (!in) return;
-
-    out->offset = in->offset;
-    out->size = in->size;
-    out->rowPitch = in->rowPitch;
-    out->arrayPitch = in->arrayPitch;
-    out->depthPitch = in->depthPitch;
-}
-
-static inline void convert_VkImageFormatProperties_host_to_win(const VkImageFormatProperties_host *in, VkImageFormatProperties *out)
-{
-    if (!in) return;
-
-    out->maxExtent = in->maxExtent;
-    out->maxMipLevels = in->maxMipLevels;
-    out->maxArrayLayers = in->maxArrayLayers;
-    out->sampleCounts = in->sampleCounts;
-    out->maxResourceSize = in->maxResourceSize;
-}
-
-static inline void convert_VkImageFormatProperties2KHR_win_to_host(const VkImageFormatProperties2KHR *in, VkImageFormatProperties2KHR_host *out)
-{
-    if (!in) return;
-
-    out->pNext = in->pNext;
-    out->sType = in->sType;
-}
-
-static inline void convert_VkImageFormatProperties2KHR_host_to_win(const VkImageFormatProperties2KHR_host *in, VkImageFormatProperties2KHR *out)
-{
-    if (!in) return;
-
-    out->sType = in->sType;
-    out->pNext = in->pNext;
-    convert_VkImageFormatProperties_host_to_win(&in->imageFormatProperties, &out->imageFormatProperties);
-}
-
 static inline void convert_VkMemoryHeap_static_array_host_to_win(const VkMemoryHeap_host *in, VkMemoryHeap *out, uint32_t count)
 {
-    int i;
+    unsigned int i;
 
     if (!in) return;
 
@@ -756,14 +504,12 @@ static inline void convert_VkPhysicalDeviceProperties2KHR_host_to_win(const VkPh
     convert_VkPhysicalDeviceProperties_host_to_win(&in->properties, &out->properties);
 }
 
-static inline VkSparseMemoryBind_host * convert_VkSparseMemoryBind_array_win_to_host(const VkSparseMemoryBind *in, uint32_t count)
+static inline void convert_VkSparseMemoryBind_static_array_win_to_host(const VkSparseMemoryBind *in, VkSparseMemoryBind_host *out, uint32_t count)
 {
-    VkSparseMemoryBind_host *out;
-    int i;
+    unsigned int i;
 
-    if (!in) return NULL;
+    if (!in) return;
 
-    out = (VkSparseMemoryBind_host *)heap_alloc(count * sizeof(*out));
     for (i = 0; i < count; i++)
     {
         out[i].resourceOffset = in[i].resourceOffset;
@@ -772,87 +518,82 @@ static inline VkSparseMemoryBind_host * convert_VkSparseMemoryBind_array_win_to_
         out[i].memoryOffset = in[i].memoryOffset;
         out[i].flags = in[i].flags;
     }
-
-    return out;
-}
-
-static inline void free_VkSparseMemoryBind_array(VkSparseMemoryBind_host *in, uint32_t count)
-{
-    if (!in) return;
-
-    heap_free(in);
 }
 
-static inline VkSparseBufferMemoryBindInfo_host * convert_VkSparseBufferMemoryBindInfo_array_win_to_host(const VkSparseBufferMemoryBindInfo *in, uint32_t count)
+static inline VkSparseBufferMemoryBindInfo_host * convert_VkSparseBufferMemoryBindInfo_array_win_to_host(const VkSparseBufferMemoryBindInfo *in, uint32_t count, struct wine_vk_arena *arena)
 {
     VkSparseBufferMemoryBindInfo_host *out;
-    int i;
+    SIZE_T size;
+    BYTE *ptr;
+    unsigned int i;
 
     if (!in) return NULL;
 
-    out = (VkSparseBufferMemoryBindInfo_host *)heap_alloc(count * sizeof(*out));
+    size = count * sizeof(*out);
+    for (i = 0; i < count; i++)
+    {
+        if (in[i].pBinds) size += in[i].bindCount * sizeof(VkSparseMemoryBind_host);
+    }
+
+    if (!(out = wine_vk_arena_alloc(arena, size))) return NULL;
+    ptr = (BYTE *)(out + count);
     for (i = 0; i < count; i++)
     {
         out[i].buffer = in[i].buffer;
         out[i].bindCount = in[i].bindCount;
-        out[i].pBinds = convert_VkSparseMemoryBind_array_win_to_host(in[i].pBinds, in[i].bindCount);
+        if (in[i].pBinds)
+        {
+            out[i].pBinds = (VkSparseMemoryBind_host *)ptr;
+            convert_VkSparseMemoryBind_static_array_win_to_host(in[i].pBinds, (VkSparseMemoryBind_host *)ptr, in[i].bindCount);
+            ptr += in[i].bindCount * sizeof(VkSparseMemoryBind_host);
+        }
+        else
+            out[i].pBinds = NULL;
     }
 
     return out;
 }
 
-static inline void free_VkSparseBufferMemoryBindInfo_array(VkSparseBufferMemoryBindInfo_host *in, uint32_t count)
+static inline VkSparseImageOpaqueMemoryBindInfo_host * convert_VkSparseImageOpaqueMemoryBindInfo_array_win_to_host(const VkSparseImageOpaqueMemoryBindInfo *in, uint32_t count, struct wine_vk_arena *arena)
 {
-    int i;
+    VkSparseImageOpaqueMemoryBindInfo_host *out;
+    SIZE_T size;
+    BYTE *ptr;
+    unsigned int i;
 
-    if (!in) return;
+    if (!in) return NULL;
 
+    size = count * sizeof(*out);
     for (i = 0; i < count; i++)
     {
-        free_VkSparseMemoryBind_array((VkSparseMemoryBind_host *)in[i].pBinds, in[i].bindCount);
+        if (in[i].pBinds) size += in[i].bindCount * sizeof(VkSparseMemoryBind_host);
     }
-    heap_free(in);
-}
-
-static inline VkSparseImageOpaqueMemoryBindInfo_host * convert_VkSparseImageOpaqueMemoryBindInfo_array_win_to_host(const VkSparseImageOpaqueMemoryBindInfo *in, uint32_t count)
-{
-    VkSparseImageOpaqueMemoryBindInfo_host *out;
-    int i;
-
-    if (!in) return NULL;
 
-    out = (VkSparseImageOpaqueMemoryBindInfo_host *)heap_alloc(count * sizeof(*out));
+    if (!(out = wine_vk_arena_alloc(arena, size))) return NULL;
+    ptr = (BYTE *)(out + count);
     for (i = 0; i < count; i++)
     {
         out[i].image = in[i].image;
         out[i].bindCount = in[i].bindCount;
-        out[i].pBinds = convert_VkSparseMemoryBind_array_win_to_host(in[i].pBinds, in[i].bindCount);
+        if (in[i].pBinds)
+        {
+            out[i].pBinds = (VkSparseMemoryBind_host *)ptr;
+            convert_VkSparseMemoryBind_static_array_win_to_host(in[i].pBinds, (VkSparseMemoryBind_host *)ptr, in[i].bindCount);
+            ptr += in[i].bindCount * sizeof(VkSparseMemoryBind_host);
+        }
+        else
+            out[i].pBinds = NULL;
     }
 
     return out;
 }
 
-static inline void free_VkSparseImageOpaqueMemoryBindInfo_array(VkSparseImageOpaqueMemoryBindInfo_host *in, uint32_t count)
+static inline void convert_VkSparseImageMemoryBind_static_array_win_to_host(const VkSparseImageMemoryBind *in, VkSparseImageMemoryBind_host *out, uint32_t count)
 {
-    int i;
+    unsigned int i;
 
     if (!in) return;
 
-    for (i = 0; i < count; i++)
-    {
-        free_VkSparseMemoryBind_array((VkSparseMemoryBind_host *)in[i].pBinds, in[i].bindCount);
-    }
-    heap_free(in);
-}
-
-static inline VkSparseImageMemoryBind_host * convert_VkSparseImageMemoryBind_array_win_to_host(const VkSparseImageMemoryBind *in, uint32_t count)
-{
-    VkSparseImageMemoryBind_host *out;
-    int i;
-
-    if (!in) return NULL;
-
-    out = (VkSparseImageMemoryBind_host *)heap_alloc(count * sizeof(*out));
     for (i = 0; i < count; i++)
     {
         out[i].subresource = in[i].subresource;
@@ -862,56 +603,50 @@ static inline VkSparseImageMemoryBind_host * convert_VkSparseImageMemoryBind_arr
         out[i].memoryOffset = in[i].memoryOffset;
         out[i].flags = in[i].flags;
     }
-
-    return out;
-}
-
-static inline void free_VkSparseImageMemoryBind_array(VkSparseImageMemoryBind_host *in, uint32_t count)
-{
-    if (!in) return;
-
-    heap_free(in);
 }
 
-static inline VkSparseImageMemoryBindInfo_host * convert_VkSparseImageMemoryBindInfo_array_win_to_host(const VkSparseImageMemoryBindInfo *in, uint32_t count)
+static inline VkSparseImageMemoryBindInfo_host * convert_VkSparseImageMemoryBindInfo_array_win_to_host(const VkSparseImageMemoryBindInfo *in, uint32_t count, struct wine_vk_arena *arena)
 {
     VkSparseImageMemoryBindInfo_host *out;
-    int i;
+    SIZE_T size;
+    BYTE *ptr;
+    unsigned int i;
 
     if (!in) return NULL;
 
-    out = (VkSparseImageMemoryBindInfo_host *)heap_alloc(count * sizeof(*out));
+    size = count * sizeof(*out);
     for (i = 0; i < count; i++)
     {
-        out[i].image = in[i].image;
-        out[i].bindCount = in[i].bindCount;
-        out[i].pBinds = convert_VkSparseImageMemoryBind_array_win_to_host(in[i].pBinds, in[i].bindCount);
+        if (in[i].pBinds) size += in[i].bindCount * sizeof(VkSparseImageMemoryBind_host);
     }
 
-    return out;
-}
-
-static inline void free_VkSparseImageMemoryBindInfo_array(VkSparseImageMemoryBindInfo_host *in, uint32_t count)
-{
-    int i;
-
-    if (!in) return;
-
+    if (!(out = wine_vk_arena_alloc(arena, size))) return NULL;
+    ptr = (BYTE *)(out + count);
     for (i = 0; i < count; i++)
     {
-        free_VkSparseImageMemoryBind_array((VkSparseImageMemoryBind_host *)in[i].pBinds, in[i].bindCount);
+        out[i].image = in[i].image;
+        out[i].bindCount = in[i].bindCount;
+        if (in[i].pBinds)
+        {
+            out[i].pBinds = (VkSparseImageMemoryBind_host *)ptr;
+            convert_VkSparseImageMemoryBind_static_array_win_to_host(in[i].pBinds, (VkSparseImageMemoryBind_host *)ptr, in[i].bindCount);
+            ptr += in[i].bindCount * sizeof(VkSparseImageMemoryBind_host);
+        }
+        else
+            out[i].pBinds = NULL;
     }
-    heap_free(in);
+
+    return out;
 }
 
-static inline VkBindSparseInfo_host * convert_VkBindSparseInfo_array_win_to_host(const VkBindSparseInfo *in, uint32_t count)
+static inline VkBindSparseInfo_host * convert_VkBindSparseInfo_array_win_to_host(const VkBindSparseInfo *in, uint32_t count, struct wine_vk_arena *arena)
 {
     VkBindSparseInfo_host *out;
-    int i;
+    unsigned int i;
 
     if (!in) return NULL;
 
-    out = (VkBindSparseInfo_host *)heap_alloc(count * sizeof(*out));
+    if (!(out = wine_vk_arena_alloc(arena, count * sizeof(*out)))) return NULL;
     for (i = 0; i < count; i++)
     {
         out[i].sType = in[i].sType;
@@ -919,11 +654,11 @@ static inline VkBindSparseInfo_host * convert_VkBindSparseInfo_array_win_to_host
         out[i].waitSemaphoreCount = in[i].waitSemaphoreCount;
         out[i].pWaitSemaphores = in[i].pWaitSemaphores;
         out[i].bufferBindCount = in[i].bufferBindCount;
-        out[i].pBufferBinds = convert_VkSparseBufferMemoryBindInfo_array_win_to_host(in[i].pBufferBinds, in[i].bufferBindCount);
+        if (!(out[i].pBufferBinds = convert_VkSparseBufferMemoryBindInfo_array_win_to_host(in[i].pBufferBinds, in[i].bufferBindCount, arena)) && in[i].pBufferBinds) return NULL;
         out[i].imageOpaqueBindCount = in[i].imageOpaqueBindCount;
-        out[i].pImageOpaqueBinds = convert_VkSparseImageOpaqueMemoryBindInfo_array_win_to_host(in[i].pImageOpaqueBinds, in[i].imageOpaqueBindCount);
+        if (!(out[i].pImageOpaqueBinds = convert_VkSparseImageOpaqueMemoryBindInfo_array_win_to_host(in[i].pImageOpaqueBinds, in[i].imageOpaqueBindCount, arena)) && in[i].pImageOpaqueBinds) return NULL;
         out[i].imageBindCount = in[i].imageBindCount;
-        out[i].pImageBinds = convert_VkSparseImageMemoryBindInfo_array_win_to_host(in[i].pImageBinds, in[i].imageBindCount);
+        if (!(out[i].pImageBinds = convert_VkSparseImageMemoryBindInfo_array_win_to_host(in[i].pImageBinds, in[i].imageBindCount, arena)) && in[i].pImageBinds) return NULL;
         out[i].signalSemaphoreCount = in[i].signalSemaphoreCount;
         out[i].pSignalSemaphores = in[i].pSignalSemaphores;
     }
@@ -931,29 +666,14 @@ static inline VkBindSparseInfo_host * convert_VkBindSparseInfo_array_win_to_host
     return out;
 }
 
-static inline void free_VkBindSparseInfo_array(VkBindSparseInfo_host *in, uint32_t count)
-{
-    int i;
-
-    if (!in) return;
-
-    for (i = 0; i < count; i++)
-    {
-        free_VkSparseBufferMemoryBindInfo_array((VkSparseBufferMemoryBindInfo_host *)in[i].pBufferBinds, in[i].bufferBindCount);
-        free_VkSparseImageOpaqueMemoryBindInfo_array((VkSparseImageOpaqueMemoryBindInfo_host *)in[i].pImageOpaqueBinds, in[i].imageOpaqueBindCount);
-        free_VkSparseImageMemoryBindInfo_array((VkSparseImageMemoryBindInfo_host *)in[i].pImageBinds, in[i].imageBindCount);
-    }
-    heap_free(in);
-}
-
-static inline VkCopyDescriptorSet_host * convert_VkCopyDescriptorSet_array_win_to_host(const VkCopyDescriptorSet *in, uint32_t count)
+static inline VkCopyDescriptorSet_host * convert_VkCopyDescriptorSet_array_win_to_host(const VkCopyDescriptorSet *in, uint32_t count, struct wine_vk_arena *arena)
 {
     VkCopyDescriptorSet_host *out;
-    int i;
+    unsigned int i;
 
     if (!in) return NULL;
 
-    out = (VkCopyDescriptorSet_host *)heap_alloc(count * sizeof(*out));
+    if (!(out = wine_vk_arena_alloc(arena, count * sizeof(*out)))) return NULL;
     for (i = 0; i < count; i++)
     {
         out[i].sType = in[i].sType;
@@ -970,46 +690,331 @@ static inline VkCopyDescriptorSet_host * convert_VkCopyDescriptorSet_array_win_t
     return out;
 }
 
-static inline void free_VkCopyDescriptorSet_array(VkCopyDescriptorSet_host *in, uint32_t count)
-{
-    if (!in) return;
+#endif /* USE_STRUCT_CONVERSION */
 
-    heap_free(in);
-}
+enum wine_vk_profile_id
+{
+    WINE_VK_PROFILE_vkAllocateDescriptorSets,
+    WINE_VK_PROFILE_vkAllocateMemory,
+    WINE_VK_PROFILE_vkBeginCommandBuffer,
+    WINE_VK_PROFILE_vkBindBufferMemory,
+    WINE_VK_PROFILE_vkBindImageMemory,
+    WINE_VK_PROFILE_vkCmdBeginQuery,
+    WINE_VK_PROFILE_vkCmdBeginRenderPass,
+    WINE_VK_PROFILE_vkCmdBindDescriptorSets,
+    WINE_VK_PROFILE_vkCmdBindIndexBuffer,
+    WINE_VK_PROFILE_vkCmdBindPipeline,
+    WINE_VK_PROFILE_vkCmdBindVertexBuffers,
+    WINE_VK_PROFILE_vkCmdBlitImage,
+    WINE_VK_PROFILE_vkCmdClearAttachments,
+    WINE_VK_PROFILE_vkCmdClearColorImage,
+    WINE_VK_PROFILE_vkCmdClearDepthStencilImage,
+    WINE_VK_PROFILE_vkCmdCopyBuffer,
+    WINE_VK_PROFILE_vkCmdCopyBufferToImage,
+    WINE_VK_PROFILE_vkCmdCopyImage,
+    WINE_VK_PROFILE_vkCmdCopyImageToBuffer,
+    WINE_VK_PROFILE_vkCmdCopyQueryPoolResults,
+    WINE_VK_PROFILE_vkCmdDispatch,
+    WINE_VK_PROFILE_vkCmdDispatchIndirect,
+    WINE_VK_PROFILE_vkCmdDraw,
+    WINE_VK_PROFILE_vkCmdDrawIndexed,
+    WINE_VK_PROFILE_vkCmdDrawIndexedIndirect,
+    WINE_VK_PROFILE_vkCmdDrawIndexedIndirectCountAMD,
+    WINE_VK_PROFILE_vkCmdDrawIndirect,
+    WINE_VK_PROFILE_vkCmdDrawIndirectCountAMD,
+    WINE_VK_PROFILE_vkCmdEndQuery,
+    WINE_VK_PROFILE_vkCmdEndRenderPass,
+    WINE_VK_PROFILE_vkCmdFillBuffer,
+    WINE_VK_PROFILE_vkCmdNextSubpass,
+    WINE_VK_PROFILE_vkCmdPipelineBarrier,
+    WINE_VK_PROFILE_vkCmdPushConstants,
+    WINE_VK_PROFILE_vkCmdPushDescriptorSetKHR,
+    WINE_VK_PROFILE_vkCmdPushDescriptorSetWithTemplateKHR,
+    WINE_VK_PROFILE_vkCmdResetEvent,
+    WINE_VK_PROFILE_vkCmdResetQueryPool,
+    WINE_VK_PROFILE_vkCmdResolveImage,
+    WINE_VK_PROFILE_vkCmdSetBlendConstants,
+    WINE_VK_PROFILE_vkCmdSetDepthBias,
+    WINE_VK_PROFILE_vkCmdSetDepthBounds,
+    WINE_VK_PROFILE_vkCmdSetDiscardRectangleEXT,
+    WINE_VK_PROFILE_vkCmdSetEvent,
+    WINE_VK_PROFILE_vkCmdSetLineWidth,
+    WINE_VK_PROFILE_vkCmdSetScissor,
+    WINE_VK_PROFILE_vkCmdSetStencilCompareMask,
+    WINE_VK_PROFILE_vkCmdSetStencilReference,
+    WINE_VK_PROFILE_vkCmdSetStencilWriteMask,
+    WINE_VK_PROFILE_vkCmdSetViewport,
+    WINE_VK_PROFILE_vkCmdSetViewportWScalingNV,
+    WINE_VK_PROFILE_vkCmdUpdateBuffer,
+    WINE_VK_PROFILE_vkCmdWaitEvents,
+    WINE_VK_PROFILE_vkCmdWriteTimestamp,
+    WINE_VK_PROFILE_vkCreateBuffer,
+    WINE_VK_PROFILE_vkCreateBufferView,
+    WINE_VK_PROFILE_vkCreateComputePipelines,
+    WINE_VK_PROFILE_vkCreateDescriptorPool,
+    WINE_VK_PROFILE_vkCreateDescriptorSetLayout,
+    WINE_VK_PROFILE_vkCreateDescriptorUpdateTemplateKHR,
+    WINE_VK_PROFILE_vkCreateEvent,
+    WINE_VK_PROFILE_vkCreateFence,
+    WINE_VK_PROFILE_vkCreateFramebuffer,
+    WINE_VK_PROFILE_vkCreateGraphicsPipelines,
+    WINE_VK_PROFILE_vkCreateImage,
+    WINE_VK_PROFILE_vkCreateImageView,
+    WINE_VK_PROFILE_vkCreatePipelineCache,
+    WINE_VK_PROFILE_vkCreatePipelineLayout,
+    WINE_VK_PROFILE_vkCreateQueryPool,
+    WINE_VK_PROFILE_vkCreateRenderPass,
+    WINE_VK_PROFILE_vkCreateSampler,
+    WINE_VK_PROFILE_vkCreateSemaphore,
+    WINE_VK_PROFILE_vkCreateShaderModule,
+    WINE_VK_PROFILE_vkDestroyBuffer,
+    WINE_VK_PROFILE_vkDestroyBufferView,
+    WINE_VK_PROFILE_vkDestroyDescriptorPool,
+    WINE_VK_PROFILE_vkDestroyDescriptorSetLayout,
+    WINE_VK_PROFILE_vkDestroyDescriptorUpdateTemplateKHR,
+    WINE_VK_PROFILE_vkDestroyEvent,
+    WINE_VK_PROFILE_vkDestroyFence,
+    WINE_VK_PROFILE_vkDestroyFramebuffer,
+    WINE_VK_PROFILE_vkDestroyImage,
+    WINE_VK_PROFILE_vkDestroyImageView,
+    WINE_VK_PROFILE_vkDestroyPipeline,
+    WINE_VK_PROFILE_vkDestroyPipelineCache,
+    WINE_VK_PROFILE_vkDestroyPipelineLayout,
+    WINE_VK_PROFILE_vkDestroyQueryPool,
+    WINE_VK_PROFILE_vkDestroyRenderPass,
+    WINE_VK_PROFILE_vkDestroySampler,
+    WINE_VK_PROFILE_vkDestroySemaphore,
+    WINE_VK_PROFILE_vkDestroyShaderModule,
+    WINE_VK_PROFILE_vkDeviceWaitIdle,
+    WINE_VK_PROFILE_vkEndCommandBuffer,
+    WINE_VK_PROFILE_vkEnumerateDeviceLayerProperties,
+    WINE_VK_PROFILE_vkFlushMappedMemoryRanges,
+    WINE_VK_PROFILE_vkFreeDescriptorSets,
+    WINE_VK_PROFILE_vkFreeMemory,
+    WINE_VK_PROFILE_vkGetBufferMemoryRequirements,
+    WINE_VK_PROFILE_vkGetDeviceMemoryCommitment,
+    WINE_VK_PROFILE_vkGetEventStatus,
+    WINE_VK_PROFILE_vkGetFenceStatus,
+    WINE_VK_PROFILE_vkGetImageMemoryRequirements,
+    WINE_VK_PROFILE_vkGetImageSparseMemoryRequirements,
+    WINE_VK_PROFILE_vkGetImageSubresourceLayout,
+    WINE_VK_PROFILE_vkGetPhysicalDeviceFeatures,
+    WINE_VK_PROFILE_vkGetPhysicalDeviceFeatures2KHR,
+    WINE_VK_PROFILE_vkGetPhysicalDeviceFormatProperties,
+    WINE_VK_PROFILE_vkGetPhysicalDeviceFormatProperties2KHR,
+    WINE_VK_PROFILE_vkGetPhysicalDeviceImageFormatProperties,
+    WINE_VK_PROFILE_vkGetPhysicalDeviceImageFormatProperties2KHR,
+    WINE_VK_PROFILE_vkGetPhysicalDeviceMemoryProperties,
+    WINE_VK_PROFILE_vkGetPhysicalDeviceMemoryProperties2KHR,
+    WINE_VK_PROFILE_vkGetPhysicalDeviceProperties,
+    WINE_VK_PROFILE_vkGetPhysicalDeviceProperties2KHR,
+    WINE_VK_PROFILE_vkGetPhysicalDeviceQueueFamilyProperties,
+    WINE_VK_PROFILE_vkGetPhysicalDeviceQueueFamilyProperties2KHR,
+    WINE_VK_PROFILE_vkGetPhysicalDeviceSparseImageFormatProperties,
+    WINE_VK_PROFILE_vkGetPhysicalDeviceSparseImageFormatProperties2KHR,
+    WINE_VK_PROFILE_vkGetPipelineCacheData,
+    WINE_VK_PROFILE_vkGetQueryPoolResults,
+    WINE_VK_PROFILE_vkGetRenderAreaGranularity,
+    WINE_VK_PROFILE_vkInvalidateMappedMemoryRanges,
+    WINE_VK_PROFILE_vkMapMemory,
+    WINE_VK_PROFILE_vkMergePipelineCaches,
+    WINE_VK_PROFILE_vkQueueBindSparse,
+    WINE_VK_PROFILE_vkQueueWaitIdle,
+    WINE_VK_PROFILE_vkResetCommandBuffer,
+    WINE_VK_PROFILE_vkResetDescriptorPool,
+    WINE_VK_PROFILE_vkResetEvent,
+    WINE_VK_PROFILE_vkResetFences,
+    WINE_VK_PROFILE_vkSetEvent,
+    WINE_VK_PROFILE_vkSetHdrMetadataEXT,
+    WINE_VK_PROFILE_vkTrimCommandPoolKHR,
+    WINE_VK_PROFILE_vkUnmapMemory,
+    WINE_VK_PROFILE_vkUpdateDescriptorSetWithTemplateKHR,
+    WINE_VK_PROFILE_vkUpdateDescriptorSets,
+    WINE_VK_PROFILE_vkWaitForFences,
+};
 
-#endif /* USE_STRUCT_CONVERSION */
+static struct wine_vk_profile_counters vk_profile_counters[] =
+{
+    {"vkAllocateDescriptorSets"},
+    {"vkAllocateMemory"},
+    {"vkBeginCommandBuffer"},
+    {"vkBindBufferMemory"},
+    {"vkBindImageMemory"},
+    {"vkCmdBeginQuery"},
+    {"vkCmdBeginRenderPass"},
+    {"vkCmdBindDescriptorSets"},
+    {"vkCmdBindIndexBuffer"},
+    {"vkCmdBindPipeline"},
+    {"vkCmdBindVertexBuffers"},
+    {"vkCmdBlitImage"},
+    {"vkCmdClearAttachments"},
+    {"vkCmdClearColorImage"},
+    {"vkCmdClearDepthStencilImage"},
+    {"vkCmdCopyBuffer"},
+    {"vkCmdCopyBufferToImage"},
+    {"vkCmdCopyImage"},
+    {"vkCmdCopyImageToBuffer"},
+    {"vkCmdCopyQueryPoolResults"},
+    {"vkCmdDispatch"},
+    {"vkCmdDispatchIndirect"},
+    {"vkCmdDraw"},
+    {"vkCmdDrawIndexed"},
+    {"vkCmdDrawIndexedIndirect"},
+    {"vkCmdDrawIndexedIndirectCountAMD"},
+    {"vkCmdDrawIndirect"},
+    {"vkCmdDrawIndirectCountAMD"},
+    {"vkCmdEndQuery"},
+    {"vkCmdEndRenderPass"},
+    {"vkCmdFillBuffer"},
+    {"vkCmdNextSubpass"},
+    {"vkCmdPipelineBarrier"},
+    {"vkCmdPushConstants"},
+    {"vkCmdPushDescriptorSetKHR"},
+    {"vkCmdPushDescriptorSetWithTemplateKHR"},
+    {"vkCmdResetEvent"},
+    {"vkCmdResetQueryPool"},
+    {"vkCmdResolveImage"},
+    {"vkCmdSetBlendConstants"},
+    {"vkCmdSetDepthBias"},
+    {"vkCmdSetDepthBounds"},
+    {"vkCmdSetDiscardRectangleEXT"},
+    {"vkCmdSetEvent"},
+    {"vkCmdSetLineWidth"},
+    {"vkCmdSetScissor"},
+    {"vkCmdSetStencilCompareMask"},
+    {"vkCmdSetStencilReference"},
+    {"vkCmdSetStencilWriteMask"},
+    {"vkCmdSetViewport"},
+    {"vkCmdSetViewportWScalingNV"},
+    {"vkCmdUpdateBuffer"},
+    {"vkCmdWaitEvents"},
+    {"vkCmdWriteTimestamp"},
+    {"vkCreateBuffer"},
+    {"vkCreateBufferView"},
+    {"vkCreateComputePipelines"},
+    {"vkCreateDescriptorPool"},
+    {"vkCreateDescriptorSetLayout"},
+    {"vkCreateDescriptorUpdateTemplateKHR"},
+    {"vkCreateEvent"},
+    {"vkCreateFence"},
+    {"vkCreateFramebuffer"},
+    {"vkCreateGraphicsPipelines"},
+    {"vkCreateImage"},
+    {"vkCreateImageView"},
+    {"vkCreatePipelineCache"},
+    {"vkCreatePipelineLayout"},
+    {"vkCreateQueryPool"},
+    {"vkCreateRenderPass"},
+    {"vkCreateSampler"},
+    {"vkCreateSemaphore"},
+    {"vkCreateShaderModule"},
+    {"vkDestroyBuffer"},
+    {"vkDestroyBufferView"},
+    {"vkDestroyDescriptorPool"},
+    {"vkDestroyDescriptorSetLayout"},
+    {"vkDestroyDescriptorUpdateTemplateKHR"},
+    {"vkDestroyEvent"},
+    {"vkDestroyFence"},
+    {"vkDestroyFramebuffer"},
+    {"vkDestroyImage"},
+    {"vkDestroyImageView"},
+    {"vkDestroyPipeline"},
+    {"vkDestroyPipelineCache"},
+    {"vkDestroyPipelineLayout"},
+    {"vkDestroyQueryPool"},
+    {"vkDestroyRenderPass"},
+    {"vkDestroySampler"},
+    {"vkDestroySemaphore"},
+    {"vkDestroyShaderModule"},
+    {"vkDeviceWaitIdle"},
+    {"vkEndCommandBuffer"},
+    {"vkEnumerateDeviceLayerProperties"},
+    {"vkFlushMappedMemoryRanges"},
+    {"vkFreeDescriptorSets"},
+    {"vkFreeMemory"},
+    {"vkGetBufferMemoryRequirements"},
+    {"vkGetDeviceMemoryCommitment"},
+    {"vkGetEventStatus"},
+    {"vkGetFenceStatus"},
+    {"vkGetImageMemoryRequirements"},
+    {"vkGetImageSparseMemoryRequirements"},
+    {"vkGetImageSubresourceLayout"},
+    {"vkGetPhysicalDeviceFeatures"},
+    {"vkGetPhysicalDeviceFeatures2KHR"},
+    {"vkGetPhysicalDeviceFormatProperties"},
+    {"vkGetPhysicalDeviceFormatProperties2KHR"},
+    {"vkGetPhysicalDeviceImageFormatProperties"},
+    {"vkGetPhysicalDeviceImageFormatProperties2KHR"},
+    {"vkGetPhysicalDeviceMemoryProperties"},
+    {"vkGetPhysicalDeviceMemoryProperties2KHR"},
+    {"vkGetPhysicalDeviceProperties"},
+    {"vkGetPhysicalDeviceProperties2KHR"},
+    {"vkGetPhysicalDeviceQueueFamilyProperties"},
+    {"vkGetPhysicalDeviceQueueFamilyProperties2KHR"},
+    {"vkGetPhysicalDeviceSparseImageFormatProperties"},
+    {"vkGetPhysicalDeviceSparseImageFormatProperties2KHR"},
+    {"vkGetPipelineCacheData"},
+    {"vkGetQueryPoolResults"},
+    {"vkGetRenderAreaGranularity"},
+    {"vkInvalidateMappedMemoryRanges"},
+    {"vkMapMemory"},
+    {"vkMergePipelineCaches"},
+    {"vkQueueBindSparse"},
+    {"vkQueueWaitIdle"},
+    {"vkResetCommandBuffer"},
+    {"vkResetDescriptorPool"},
+    {"vkResetEvent"},
+    {"vkResetFences"},
+    {"vkSetEvent"},
+    {"vkSetHdrMetadataEXT"},
+    {"vkTrimCommandPoolKHR"},
+    {"vkUnmapMemory"},
+    {"vkUpdateDescriptorSetWithTemplateKHR"},
+    {"vkUpdateDescriptorSets"},
+    {"vkWaitForFences"},
+};
+
+struct wine_vk_profile_counters *wine_vk_get_profile_counters(unsigned int *count)
+{
+    *count = ARRAY_SIZE(vk_profile_counters);
+    return vk_profile_counters;
+}
 
 static VkResult WINAPI wine_vkAllocateDescriptorSets(VkDevice device, const VkDescriptorSetAllocateInfo *pAllocateInfo, VkDescriptorSet *pDescriptorSets)
 {
-#if defined(USE_STRUCT_CONVERSION)
     VkResult result;
-    VkDescriptorSetAllocateInfo_host pAllocateInfo_host;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %p, %p\n", device, pAllocateInfo, pDescriptorSets);
-
-    convert_VkDescriptorSetAllocateInfo_win_to_host(pAllocateInfo, &pAllocateInfo_host);
-    result = device->funcs.p_vkAllocateDescriptorSets(device->device, &pAllocateInfo_host, pDescriptorSets);
-
+    wine_vk_profile_begin(&timer);
+    result = device->funcs.p_vkAllocateDescriptorSets(device->device, pAllocateInfo, pDescriptorSets);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkAllocateDescriptorSets]);
     return result;
-#else
-    TRACE("%p, %p, %p\n", device, pAllocateInfo, pDescriptorSets);
-    return device->funcs.p_vkAllocateDescriptorSets(device->device, pAllocateInfo, pDescriptorSets);
-#endif
 }
 
 static VkResult WINAPI wine_vkAllocateMemory(VkDevice device, const VkMemoryAllocateInfo *pAllocateInfo, const VkAllocationCallbacks *pAllocator, VkDeviceMemory *pMemory)
 {
 #if defined(USE_STRUCT_CONVERSION)
     VkResult result;
+    struct wine_vk_profile_timer timer;
     VkMemoryAllocateInfo_host pAllocateInfo_host;
     TRACE("%p, %p, %p, %p\n", device, pAllocateInfo, pAllocator, pMemory);
+    wine_vk_profile_begin(&timer);
 
     convert_VkMemoryAllocateInfo_win_to_host(pAllocateInfo, &pAllocateInfo_host);
+    wine_vk_profile_host_begin(&timer);
     result = device->funcs.p_vkAllocateMemory(device->device, &pAllocateInfo_host, NULL, pMemory);
+    wine_vk_profile_host_end(&timer);
 
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkAllocateMemory]);
     return result;
 #else
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %p, %p, %p\n", device, pAllocateInfo, pAllocator, pMemory);
-    return device->funcs.p_vkAllocateMemory(device->device, pAllocateInfo, NULL, pMemory);
+    wine_vk_profile_begin(&timer);
+    result = device->funcs.p_vkAllocateMemory(device->device, pAllocateInfo, NULL, pMemory);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkAllocateMemory]);
+    return result;
 #endif
 }
 
@@ -1017,415 +1022,582 @@ static VkResult WINAPI wine_vkBeginCommandBuffer(VkCommandBuffer commandBuffer,
 {
 #if defined(USE_STRUCT_CONVERSION)
     VkResult result;
+    struct wine_vk_arena *arena;
+    struct wine_vk_profile_timer timer;
     VkCommandBufferBeginInfo_host pBeginInfo_host;
     TRACE("%p, %p\n", commandBuffer, pBeginInfo);
+    wine_vk_profile_begin(&timer);
+
+    arena = &commandBuffer->arena;
+    wine_vk_arena_reset(arena);
 
-    convert_VkCommandBufferBeginInfo_win_to_host(pBeginInfo, &pBeginInfo_host);
+    if (!convert_VkCommandBufferBeginInfo_win_to_host(pBeginInfo, &pBeginInfo_host, arena))
+    {
+        result = VK_ERROR_OUT_OF_HOST_MEMORY;
+        goto done;
+    }
+    wine_vk_profile_host_begin(&timer);
     result = commandBuffer->device->funcs.p_vkBeginCommandBuffer(commandBuffer->command_buffer, &pBeginInfo_host);
+    wine_vk_profile_host_end(&timer);
 
-    free_VkCommandBufferBeginInfo(&pBeginInfo_host);
+done:
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkBeginCommandBuffer]);
     return result;
 #else
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %p\n", commandBuffer, pBeginInfo);
-    return commandBuffer->device->funcs.p_vkBeginCommandBuffer(commandBuffer->command_buffer, pBeginInfo);
+    wine_vk_profile_begin(&timer);
+    result = commandBuffer->device->funcs.p_vkBeginCommandBuffer(commandBuffer->command_buffer, pBeginInfo);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkBeginCommandBuffer]);
+    return result;
 #endif
 }
 
 static VkResult WINAPI wine_vkBindBufferMemory(VkDevice device, VkBuffer buffer, VkDeviceMemory memory, VkDeviceSize memoryOffset)
 {
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, 0x%s, 0x%s\n", device, wine_dbgstr_longlong(buffer), wine_dbgstr_longlong(memory), wine_dbgstr_longlong(memoryOffset));
-    return device->funcs.p_vkBindBufferMemory(device->device, buffer, memory, memoryOffset);
+    wine_vk_profile_begin(&timer);
+    result = device->funcs.p_vkBindBufferMemory(device->device, buffer, memory, memoryOffset);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkBindBufferMemory]);
+    return result;
 }
 
 static VkResult WINAPI wine_vkBindImageMemory(VkDevice device, VkImage image, VkDeviceMemory memory, VkDeviceSize memoryOffset)
 {
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, 0x%s, 0x%s\n", device, wine_dbgstr_longlong(image), wine_dbgstr_longlong(memory), wine_dbgstr_longlong(memoryOffset));
-    return device->funcs.p_vkBindImageMemory(device->device, image, memory, memoryOffset);
+    wine_vk_profile_begin(&timer);
+    result = device->funcs.p_vkBindImageMemory(device->device, image, memory, memoryOffset);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkBindImageMemory]);
+    return result;
 }
 
 static void WINAPI wine_vkCmdBeginQuery(VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32_t query, VkQueryControlFlags flags)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %u, %#x\n", commandBuffer, wine_dbgstr_longlong(queryPool), query, flags);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdBeginQuery(commandBuffer->command_buffer, queryPool, query, flags);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdBeginQuery]);
 }
 
 static void WINAPI wine_vkCmdBeginRenderPass(VkCommandBuffer commandBuffer, const VkRenderPassBeginInfo *pRenderPassBegin, VkSubpassContents contents)
 {
-#if defined(USE_STRUCT_CONVERSION)
-    VkRenderPassBeginInfo_host pRenderPassBegin_host;
-    TRACE("%p, %p, %d\n", commandBuffer, pRenderPassBegin, contents);
-
-    convert_VkRenderPassBeginInfo_win_to_host(pRenderPassBegin, &pRenderPassBegin_host);
-    commandBuffer->device->funcs.p_vkCmdBeginRenderPass(commandBuffer->command_buffer, &pRenderPassBegin_host, contents);
-
-#else
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %p, %d\n", commandBuffer, pRenderPassBegin, contents);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdBeginRenderPass(commandBuffer->command_buffer, pRenderPassBegin, contents);
-#endif
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdBeginRenderPass]);
 }
 
 static void WINAPI wine_vkCmdBindDescriptorSets(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout, uint32_t firstSet, uint32_t descriptorSetCount, const VkDescriptorSet *pDescriptorSets, uint32_t dynamicOffsetCount, const uint32_t *pDynamicOffsets)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %d, 0x%s, %u, %u, %p, %u, %p\n", commandBuffer, pipelineBindPoint, wine_dbgstr_longlong(layout), firstSet, descriptorSetCount, pDescriptorSets, dynamicOffsetCount, pDynamicOffsets);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdBindDescriptorSets(commandBuffer->command_buffer, pipelineBindPoint, layout, firstSet, descriptorSetCount, pDescriptorSets, dynamicOffsetCount, pDynamicOffsets);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdBindDescriptorSets]);
 }
 
 static void WINAPI wine_vkCmdBindIndexBuffer(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, 0x%s, %d\n", commandBuffer, wine_dbgstr_longlong(buffer), wine_dbgstr_longlong(offset), indexType);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdBindIndexBuffer(commandBuffer->command_buffer, buffer, offset, indexType);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdBindIndexBuffer]);
 }
 
 static void WINAPI wine_vkCmdBindPipeline(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipeline pipeline)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %d, 0x%s\n", commandBuffer, pipelineBindPoint, wine_dbgstr_longlong(pipeline));
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdBindPipeline(commandBuffer->command_buffer, pipelineBindPoint, pipeline);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdBindPipeline]);
 }
 
 static void WINAPI wine_vkCmdBindVertexBuffers(VkCommandBuffer commandBuffer, uint32_t firstBinding, uint32_t bindingCount, const VkBuffer *pBuffers, const VkDeviceSize *pOffsets)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %u, %u, %p, %p\n", commandBuffer, firstBinding, bindingCount, pBuffers, pOffsets);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdBindVertexBuffers(commandBuffer->command_buffer, firstBinding, bindingCount, pBuffers, pOffsets);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdBindVertexBuffers]);
 }
 
 static void WINAPI wine_vkCmdBlitImage(VkCommandBuffer commandBuffer, VkImage srcImage, VkImageLayout srcImageLayout, VkImage dstImage, VkImageLayout dstImageLayout, uint32_t regionCount, const VkImageBlit *pRegions, VkFilter filter)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %d, 0x%s, %d, %u, %p, %d\n", commandBuffer, wine_dbgstr_longlong(srcImage), srcImageLayout, wine_dbgstr_longlong(dstImage), dstImageLayout, regionCount, pRegions, filter);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdBlitImage(commandBuffer->command_buffer, srcImage, srcImageLayout, dstImage, dstImageLayout, regionCount, pRegions, filter);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdBlitImage]);
 }
 
 static void WINAPI wine_vkCmdClearAttachments(VkCommandBuffer commandBuffer, uint32_t attachmentCount, const VkClearAttachment *pAttachments, uint32_t rectCount, const VkClearRect *pRects)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %u, %p, %u, %p\n", commandBuffer, attachmentCount, pAttachments, rectCount, pRects);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdClearAttachments(commandBuffer->command_buffer, attachmentCount, pAttachments, rectCount, pRects);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdClearAttachments]);
 }
 
 static void WINAPI wine_vkCmdClearColorImage(VkCommandBuffer commandBuffer, VkImage image, VkImageLayout imageLayout, const VkClearColorValue *pColor, uint32_t rangeCount, const VkImageSubresourceRange *pRanges)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %d, %p, %u, %p\n", commandBuffer, wine_dbgstr_longlong(image), imageLayout, pColor, rangeCount, pRanges);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdClearColorImage(commandBuffer->command_buffer, image, imageLayout, pColor, rangeCount, pRanges);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdClearColorImage]);
 }
 
 static void WINAPI wine_vkCmdClearDepthStencilImage(VkCommandBuffer commandBuffer, VkImage image, VkImageLayout imageLayout, const VkClearDepthStencilValue *pDepthStencil, uint32_t rangeCount, const VkImageSubresourceRange *pRanges)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %d, %p, %u, %p\n", commandBuffer, wine_dbgstr_longlong(image), imageLayout, pDepthStencil, rangeCount, pRanges);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdClearDepthStencilImage(commandBuffer->command_buffer, image, imageLayout, pDepthStencil, rangeCount, pRanges);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdClearDepthStencilImage]);
 }
 
 static void WINAPI wine_vkCmdCopyBuffer(VkCommandBuffer commandBuffer, VkBuffer srcBuffer, VkBuffer dstBuffer, uint32_t regionCount, const VkBufferCopy *pRegions)
 {
-#if defined(USE_STRUCT_CONVERSION)
-    VkBufferCopy_host *pRegions_host;
-    TRACE("%p, 0x%s, 0x%s, %u, %p\n", commandBuffer, wine_dbgstr_longlong(srcBuffer), wine_dbgstr_longlong(dstBuffer), regionCount, pRegions);
-
-    pRegions_host = convert_VkBufferCopy_array_win_to_host(pRegions, regionCount);
-    commandBuffer->device->funcs.p_vkCmdCopyBuffer(commandBuffer->command_buffer, srcBuffer, dstBuffer, regionCount, pRegions_host);
-
-    free_VkBufferCopy_array(pRegions_host, regionCount);
-#else
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, 0x%s, %u, %p\n", commandBuffer, wine_dbgstr_longlong(srcBuffer), wine_dbgstr_longlong(dstBuffer), regionCount, pRegions);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdCopyBuffer(commandBuffer->command_buffer, srcBuffer, dstBuffer, regionCount, pRegions);
-#endif
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdCopyBuffer]);
 }
 
 static void WINAPI wine_vkCmdCopyBufferToImage(VkCommandBuffer commandBuffer, VkBuffer srcBuffer, VkImage dstImage, VkImageLayout dstImageLayout, uint32_t regionCount, const VkBufferImageCopy *pRegions)
 {
-#if defined(USE_STRUCT_CONVERSION)
-    VkBufferImageCopy_host *pRegions_host;
-    TRACE("%p, 0x%s, 0x%s, %d, %u, %p\n", commandBuffer, wine_dbgstr_longlong(srcBuffer), wine_dbgstr_longlong(dstImage), dstImageLayout, regionCount, pRegions);
-
-    pRegions_host = convert_VkBufferImageCopy_array_win_to_host(pRegions, regionCount);
-    commandBuffer->device->funcs.p_vkCmdCopyBufferToImage(commandBuffer->command_buffer, srcBuffer, dstImage, dstImageLayout, regionCount, pRegions_host);
-
-    free_VkBufferImageCopy_array(pRegions_host, regionCount);
-#else
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, 0x%s, %d, %u, %p\n", commandBuffer, wine_dbgstr_longlong(srcBuffer), wine_dbgstr_longlong(dstImage), dstImageLayout, regionCount, pRegions);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdCopyBufferToImage(commandBuffer->command_buffer, srcBuffer, dstImage, dstImageLayout, regionCount, pRegions);
-#endif
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdCopyBufferToImage]);
 }
 
 static void WINAPI wine_vkCmdCopyImage(VkCommandBuffer commandBuffer, VkImage srcImage, VkImageLayout srcImageLayout, VkImage dstImage, VkImageLayout dstImageLayout, uint32_t regionCount, const VkImageCopy *pRegions)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %d, 0x%s, %d, %u, %p\n", commandBuffer, wine_dbgstr_longlong(srcImage), srcImageLayout, wine_dbgstr_longlong(dstImage), dstImageLayout, regionCount, pRegions);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdCopyImage(commandBuffer->command_buffer, srcImage, srcImageLayout, dstImage, dstImageLayout, regionCount, pRegions);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdCopyImage]);
 }
 
 static void WINAPI wine_vkCmdCopyImageToBuffer(VkCommandBuffer commandBuffer, VkImage srcImage, VkImageLayout srcImageLayout, VkBuffer dstBuffer, uint32_t regionCount, const VkBufferImageCopy *pRegions)
 {
-#if defined(USE_STRUCT_CONVERSION)
-    VkBufferImageCopy_host *pRegions_host;
-    TRACE("%p, 0x%s, %d, 0x%s, %u, %p\n", commandBuffer, wine_dbgstr_longlong(srcImage), srcImageLayout, wine_dbgstr_longlong(dstBuffer), regionCount, pRegions);
-
-    pRegions_host = convert_VkBufferImageCopy_array_win_to_host(pRegions, regionCount);
-    commandBuffer->device->funcs.p_vkCmdCopyImageToBuffer(commandBuffer->command_buffer, srcImage, srcImageLayout, dstBuffer, regionCount, pRegions_host);
-
-    free_VkBufferImageCopy_array(pRegions_host, regionCount);
-#else
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %d, 0x%s, %u, %p\n", commandBuffer, wine_dbgstr_longlong(srcImage), srcImageLayout, wine_dbgstr_longlong(dstBuffer), regionCount, pRegions);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdCopyImageToBuffer(commandBuffer->command_buffer, srcImage, srcImageLayout, dstBuffer, regionCount, pRegions);
-#endif
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdCopyImageToBuffer]);
 }
 
 static void WINAPI wine_vkCmdCopyQueryPoolResults(VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32_t firstQuery, uint32_t queryCount, VkBuffer dstBuffer, VkDeviceSize dstOffset, VkDeviceSize stride, VkQueryResultFlags flags)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %u, %u, 0x%s, 0x%s, 0x%s, %#x\n", commandBuffer, wine_dbgstr_longlong(queryPool), firstQuery, queryCount, wine_dbgstr_longlong(dstBuffer), wine_dbgstr_longlong(dstOffset), wine_dbgstr_longlong(stride), flags);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdCopyQueryPoolResults(commandBuffer->command_buffer, queryPool, firstQuery, queryCount, dstBuffer, dstOffset, stride, flags);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdCopyQueryPoolResults]);
 }
 
 static void WINAPI wine_vkCmdDispatch(VkCommandBuffer commandBuffer, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %u, %u, %u\n", commandBuffer, groupCountX, groupCountY, groupCountZ);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdDispatch(commandBuffer->command_buffer, groupCountX, groupCountY, groupCountZ);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdDispatch]);
 }
 
 static void WINAPI wine_vkCmdDispatchIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, 0x%s\n", commandBuffer, wine_dbgstr_longlong(buffer), wine_dbgstr_longlong(offset));
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdDispatchIndirect(commandBuffer->command_buffer, buffer, offset);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdDispatchIndirect]);
 }
 
 static void WINAPI wine_vkCmdDraw(VkCommandBuffer commandBuffer, uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %u, %u, %u, %u\n", commandBuffer, vertexCount, instanceCount, firstVertex, firstInstance);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdDraw(commandBuffer->command_buffer, vertexCount, instanceCount, firstVertex, firstInstance);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdDraw]);
 }
 
 static void WINAPI wine_vkCmdDrawIndexed(VkCommandBuffer commandBuffer, uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %u, %u, %u, %d, %u\n", commandBuffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdDrawIndexed(commandBuffer->command_buffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdDrawIndexed]);
 }
 
 static void WINAPI wine_vkCmdDrawIndexedIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, 0x%s, %u, %u\n", commandBuffer, wine_dbgstr_longlong(buffer), wine_dbgstr_longlong(offset), drawCount, stride);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdDrawIndexedIndirect(commandBuffer->command_buffer, buffer, offset, drawCount, stride);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdDrawIndexedIndirect]);
 }
 
 static void WINAPI wine_vkCmdDrawIndexedIndirectCountAMD(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkBuffer countBuffer, VkDeviceSize countBufferOffset, uint32_t maxDrawCount, uint32_t stride)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, 0x%s, 0x%s, 0x%s, %u, %u\n", commandBuffer, wine_dbgstr_longlong(buffer), wine_dbgstr_longlong(offset), wine_dbgstr_longlong(countBuffer), wine_dbgstr_longlong(countBufferOffset), maxDrawCount, stride);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdDrawIndexedIndirectCountAMD(commandBuffer->command_buffer, buffer, offset, countBuffer, countBufferOffset, maxDrawCount, stride);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdDrawIndexedIndirectCountAMD]);
 }
 
 static void WINAPI wine_vkCmdDrawIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, 0x%s, %u, %u\n", commandBuffer, wine_dbgstr_longlong(buffer), wine_dbgstr_longlong(offset), drawCount, stride);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdDrawIndirect(commandBuffer->command_buffer, buffer, offset, drawCount, stride);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdDrawIndirect]);
 }
 
 static void WINAPI wine_vkCmdDrawIndirectCountAMD(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkBuffer countBuffer, VkDeviceSize countBufferOffset, uint32_t maxDrawCount, uint32_t stride)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, 0x%s, 0x%s, 0x%s, %u, %u\n", commandBuffer, wine_dbgstr_longlong(buffer), wine_dbgstr_longlong(offset), wine_dbgstr_longlong(countBuffer), wine_dbgstr_longlong(countBufferOffset), maxDrawCount, stride);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdDrawIndirectCountAMD(commandBuffer->command_buffer, buffer, offset, countBuffer, countBufferOffset, maxDrawCount, stride);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdDrawIndirectCountAMD]);
 }
 
 static void WINAPI wine_vkCmdEndQuery(VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32_t query)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %u\n", commandBuffer, wine_dbgstr_longlong(queryPool), query);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdEndQuery(commandBuffer->command_buffer, queryPool, query);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdEndQuery]);
 }
 
 static void WINAPI wine_vkCmdEndRenderPass(VkCommandBuffer commandBuffer)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p\n", commandBuffer);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdEndRenderPass(commandBuffer->command_buffer);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdEndRenderPass]);
 }
 
 static void WINAPI wine_vkCmdFillBuffer(VkCommandBuffer commandBuffer, VkBuffer dstBuffer, VkDeviceSize dstOffset, VkDeviceSize size, uint32_t data)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, 0x%s, 0x%s, %u\n", commandBuffer, wine_dbgstr_longlong(dstBuffer), wine_dbgstr_longlong(dstOffset), wine_dbgstr_longlong(size), data);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdFillBuffer(commandBuffer->command_buffer, dstBuffer, dstOffset, size, data);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdFillBuffer]);
 }
 
 static void WINAPI wine_vkCmdNextSubpass(VkCommandBuffer commandBuffer, VkSubpassContents contents)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %d\n", commandBuffer, contents);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdNextSubpass(commandBuffer->command_buffer, contents);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdNextSubpass]);
 }
 
 static void WINAPI wine_vkCmdPipelineBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask, VkDependencyFlags dependencyFlags, uint32_t memoryBarrierCount, const VkMemoryBarrier *pMemoryBarriers, uint32_t bufferMemoryBarrierCount, const VkBufferMemoryBarrier *pBufferMemoryBarriers, uint32_t imageMemoryBarrierCount, const VkImageMemoryBarrier *pImageMemoryBarriers)
 {
 #if defined(USE_STRUCT_CONVERSION)
-    VkBufferMemoryBarrier_host *pBufferMemoryBarriers_host;
+    struct wine_vk_arena *arena;
+    struct wine_vk_profile_timer timer;
     VkImageMemoryBarrier_host *pImageMemoryBarriers_host;
     TRACE("%p, %#x, %#x, %#x, %u, %p, %u, %p, %u, %p\n", commandBuffer, srcStageMask, dstStageMask, dependencyFlags, memoryBarrierCount, pMemoryBarriers, bufferMemoryBarrierCount, pBufferMemoryBarriers, imageMemoryBarrierCount, pImageMemoryBarriers);
+    wine_vk_profile_begin(&timer);
 
-    pBufferMemoryBarriers_host = convert_VkBufferMemoryBarrier_array_win_to_host(pBufferMemoryBarriers, bufferMemoryBarrierCount);
-    pImageMemoryBarriers_host = convert_VkImageMemoryBarrier_array_win_to_host(pImageMemoryBarriers, imageMemoryBarrierCount);
-    commandBuffer->device->funcs.p_vkCmdPipelineBarrier(commandBuffer->command_buffer, srcStageMask, dstStageMask, dependencyFlags, memoryBarrierCount, pMemoryBarriers, bufferMemoryBarrierCount, pBufferMemoryBarriers_host, imageMemoryBarrierCount, pImageMemoryBarriers_host);
+    arena = &commandBuffer->arena;
 
-    free_VkBufferMemoryBarrier_array(pBufferMemoryBarriers_host, bufferMemoryBarrierCount);
-    free_VkImageMemoryBarrier_array(pImageMemoryBarriers_host, imageMemoryBarrierCount);
+    if (!(pImageMemoryBarriers_host = convert_VkImageMemoryBarrier_array_win_to_host(pImageMemoryBarriers, imageMemoryBarrierCount, arena)) && pImageMemoryBarriers)
+        goto done;
+    wine_vk_profile_host_begin(&timer);
+    commandBuffer->device->funcs.p_vkCmdPipelineBarrier(commandBuffer->command_buffer, srcStageMask, dstStageMask, dependencyFlags, memoryBarrierCount, pMemoryBarriers, bufferMemoryBarrierCount, pBufferMemoryBarriers, imageMemoryBarrierCount, pImageMemoryBarriers_host);
+    wine_vk_profile_host_end(&timer);
+
+done:
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdPipelineBarrier]);
 #else
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %#x, %#x, %#x, %u, %p, %u, %p, %u, %p\n", commandBuffer, srcStageMask, dstStageMask, dependencyFlags, memoryBarrierCount, pMemoryBarriers, bufferMemoryBarrierCount, pBufferMemoryBarriers, imageMemoryBarrierCount, pImageMemoryBarriers);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdPipelineBarrier(commandBuffer->command_buffer, srcStageMask, dstStageMask, dependencyFlags, memoryBarrierCount, pMemoryBarriers, bufferMemoryBarrierCount, pBufferMemoryBarriers, imageMemoryBarrierCount, pImageMemoryBarriers);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdPipelineBarrier]);
 #endif
 }
 
 static void WINAPI wine_vkCmdPushConstants(VkCommandBuffer commandBuffer, VkPipelineLayout layout, VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size, const void *pValues)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %#x, %u, %u, %p\n", commandBuffer, wine_dbgstr_longlong(layout), stageFlags, offset, size, pValues);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdPushConstants(commandBuffer->command_buffer, layout, stageFlags, offset, size, pValues);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdPushConstants]);
 }
 
 static void WINAPI wine_vkCmdPushDescriptorSetKHR(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout, uint32_t set, uint32_t descriptorWriteCount, const VkWriteDescriptorSet *pDescriptorWrites)
 {
 #if defined(USE_STRUCT_CONVERSION)
+    struct wine_vk_arena *arena;
+    struct wine_vk_profile_timer timer;
     VkWriteDescriptorSet_host *pDescriptorWrites_host;
     TRACE("%p, %d, 0x%s, %u, %u, %p\n", commandBuffer, pipelineBindPoint, wine_dbgstr_longlong(layout), set, descriptorWriteCount, pDescriptorWrites);
+    wine_vk_profile_begin(&timer);
+
+    arena = &commandBuffer->arena;
 
-    pDescriptorWrites_host = convert_VkWriteDescriptorSet_array_win_to_host(pDescriptorWrites, descriptorWriteCount);
+    if (!(pDescriptorWrites_host = convert_VkWriteDescriptorSet_array_win_to_host(pDescriptorWrites, descriptorWriteCount, arena)) && pDescriptorWrites)
+        goto done;
+    wine_vk_profile_host_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdPushDescriptorSetKHR(commandBuffer->command_buffer, pipelineBindPoint, layout, set, descriptorWriteCount, pDescriptorWrites_host);
+    wine_vk_profile_host_end(&timer);
 
-    free_VkWriteDescriptorSet_array(pDescriptorWrites_host, descriptorWriteCount);
+done:
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdPushDescriptorSetKHR]);
 #else
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %d, 0x%s, %u, %u, %p\n", commandBuffer, pipelineBindPoint, wine_dbgstr_longlong(layout), set, descriptorWriteCount, pDescriptorWrites);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdPushDescriptorSetKHR(commandBuffer->command_buffer, pipelineBindPoint, layout, set, descriptorWriteCount, pDescriptorWrites);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdPushDescriptorSetKHR]);
 #endif
 }
 
 static void WINAPI wine_vkCmdPushDescriptorSetWithTemplateKHR(VkCommandBuffer commandBuffer, VkDescriptorUpdateTemplateKHR descriptorUpdateTemplate, VkPipelineLayout layout, uint32_t set, const void *pData)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, 0x%s, %u, %p\n", commandBuffer, wine_dbgstr_longlong(descriptorUpdateTemplate), wine_dbgstr_longlong(layout), set, pData);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdPushDescriptorSetWithTemplateKHR(commandBuffer->command_buffer, descriptorUpdateTemplate, layout, set, pData);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdPushDescriptorSetWithTemplateKHR]);
 }
 
 static void WINAPI wine_vkCmdResetEvent(VkCommandBuffer commandBuffer, VkEvent event, VkPipelineStageFlags stageMask)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %#x\n", commandBuffer, wine_dbgstr_longlong(event), stageMask);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdResetEvent(commandBuffer->command_buffer, event, stageMask);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdResetEvent]);
 }
 
 static void WINAPI wine_vkCmdResetQueryPool(VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32_t firstQuery, uint32_t queryCount)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %u, %u\n", commandBuffer, wine_dbgstr_longlong(queryPool), firstQuery, queryCount);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdResetQueryPool(commandBuffer->command_buffer, queryPool, firstQuery, queryCount);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdResetQueryPool]);
 }
 
 static void WINAPI wine_vkCmdResolveImage(VkCommandBuffer commandBuffer, VkImage srcImage, VkImageLayout srcImageLayout, VkImage dstImage, VkImageLayout dstImageLayout, uint32_t regionCount, const VkImageResolve *pRegions)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %d, 0x%s, %d, %u, %p\n", commandBuffer, wine_dbgstr_longlong(srcImage), srcImageLayout, wine_dbgstr_longlong(dstImage), dstImageLayout, regionCount, pRegions);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdResolveImage(commandBuffer->command_buffer, srcImage, srcImageLayout, dstImage, dstImageLayout, regionCount, pRegions);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdResolveImage]);
 }
 
 static void WINAPI wine_vkCmdSetBlendConstants(VkCommandBuffer commandBuffer, const float blendConstants[4])
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %p\n", commandBuffer, blendConstants);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdSetBlendConstants(commandBuffer->command_buffer, blendConstants);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdSetBlendConstants]);
 }
 
 static void WINAPI wine_vkCmdSetDepthBias(VkCommandBuffer commandBuffer, float depthBiasConstantFactor, float depthBiasClamp, float depthBiasSlopeFactor)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %f, %f, %f\n", commandBuffer, depthBiasConstantFactor, depthBiasClamp, depthBiasSlopeFactor);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdSetDepthBias(commandBuffer->command_buffer, depthBiasConstantFactor, depthBiasClamp, depthBiasSlopeFactor);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdSetDepthBias]);
 }
 
 static void WINAPI wine_vkCmdSetDepthBounds(VkCommandBuffer commandBuffer, float minDepthBounds, float maxDepthBounds)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %f, %f\n", commandBuffer, minDepthBounds, maxDepthBounds);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdSetDepthBounds(commandBuffer->command_buffer, minDepthBounds, maxDepthBounds);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdSetDepthBounds]);
 }
 
 static void WINAPI wine_vkCmdSetDiscardRectangleEXT(VkCommandBuffer commandBuffer, uint32_t firstDiscardRectangle, uint32_t discardRectangleCount, const VkRect2D *pDiscardRectangles)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %u, %u, %p\n", commandBuffer, firstDiscardRectangle, discardRectangleCount, pDiscardRectangles);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdSetDiscardRectangleEXT(commandBuffer->command_buffer, firstDiscardRectangle, discardRectangleCount, pDiscardRectangles);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdSetDiscardRectangleEXT]);
 }
 
 static void WINAPI wine_vkCmdSetEvent(VkCommandBuffer commandBuffer, VkEvent event, VkPipelineStageFlags stageMask)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %#x\n", commandBuffer, wine_dbgstr_longlong(event), stageMask);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdSetEvent(commandBuffer->command_buffer, event, stageMask);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdSetEvent]);
 }
 
 static void WINAPI wine_vkCmdSetLineWidth(VkCommandBuffer commandBuffer, float lineWidth)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %f\n", commandBuffer, lineWidth);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdSetLineWidth(commandBuffer->command_buffer, lineWidth);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdSetLineWidth]);
 }
 
 static void WINAPI wine_vkCmdSetScissor(VkCommandBuffer commandBuffer, uint32_t firstScissor, uint32_t scissorCount, const VkRect2D *pScissors)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %u, %u, %p\n", commandBuffer, firstScissor, scissorCount, pScissors);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdSetScissor(commandBuffer->command_buffer, firstScissor, scissorCount, pScissors);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdSetScissor]);
 }
 
 static void WINAPI wine_vkCmdSetStencilCompareMask(VkCommandBuffer commandBuffer, VkStencilFaceFlags faceMask, uint32_t compareMask)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %#x, %u\n", commandBuffer, faceMask, compareMask);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdSetStencilCompareMask(commandBuffer->command_buffer, faceMask, compareMask);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdSetStencilCompareMask]);
 }
 
 static void WINAPI wine_vkCmdSetStencilReference(VkCommandBuffer commandBuffer, VkStencilFaceFlags faceMask, uint32_t reference)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %#x, %u\n", commandBuffer, faceMask, reference);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdSetStencilReference(commandBuffer->command_buffer, faceMask, reference);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdSetStencilReference]);
 }
 
 static void WINAPI wine_vkCmdSetStencilWriteMask(VkCommandBuffer commandBuffer, VkStencilFaceFlags faceMask, uint32_t writeMask)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %#x, %u\n", commandBuffer, faceMask, writeMask);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdSetStencilWriteMask(commandBuffer->command_buffer, faceMask, writeMask);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdSetStencilWriteMask]);
 }
 
 static void WINAPI wine_vkCmdSetViewport(VkCommandBuffer commandBuffer, uint32_t firstViewport, uint32_t viewportCount, const VkViewport *pViewports)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %u, %u, %p\n", commandBuffer, firstViewport, viewportCount, pViewports);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdSetViewport(commandBuffer->command_buffer, firstViewport, viewportCount, pViewports);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdSetViewport]);
 }
 
 static void WINAPI wine_vkCmdSetViewportWScalingNV(VkCommandBuffer commandBuffer, uint32_t firstViewport, uint32_t viewportCount, const VkViewportWScalingNV *pViewportWScalings)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %u, %u, %p\n", commandBuffer, firstViewport, viewportCount, pViewportWScalings);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdSetViewportWScalingNV(commandBuffer->command_buffer, firstViewport, viewportCount, pViewportWScalings);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdSetViewportWScalingNV]);
 }
 
 static void WINAPI wine_vkCmdUpdateBuffer(VkCommandBuffer commandBuffer, VkBuffer dstBuffer, VkDeviceSize dstOffset, VkDeviceSize dataSize, const void *pData)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, 0x%s, 0x%s, %p\n", commandBuffer, wine_dbgstr_longlong(dstBuffer), wine_dbgstr_longlong(dstOffset), wine_dbgstr_longlong(dataSize), pData);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdUpdateBuffer(commandBuffer->command_buffer, dstBuffer, dstOffset, dataSize, pData);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdUpdateBuffer]);
 }
 
 static void WINAPI wine_vkCmdWaitEvents(VkCommandBuffer commandBuffer, uint32_t eventCount, const VkEvent *pEvents, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask, uint32_t memoryBarrierCount, const VkMemoryBarrier *pMemoryBarriers, uint32_t bufferMemoryBarrierCount, const VkBufferMemoryBarrier *pBufferMemoryBarriers, uint32_t imageMemoryBarrierCount, const VkImageMemoryBarrier *pImageMemoryBarriers)
 {
 #if defined(USE_STRUCT_CONVERSION)
-    VkBufferMemoryBarrier_host *pBufferMemoryBarriers_host;
+    struct wine_vk_arena *arena;
+    struct wine_vk_profile_timer timer;
     VkImageMemoryBarrier_host *pImageMemoryBarriers_host;
     TRACE("%p, %u, %p, %#x, %#x, %u, %p, %u, %p, %u, %p\n", commandBuffer, eventCount, pEvents, srcStageMask, dstStageMask, memoryBarrierCount, pMemoryBarriers, bufferMemoryBarrierCount, pBufferMemoryBarriers, imageMemoryBarrierCount, pImageMemoryBarriers);
+    wine_vk_profile_begin(&timer);
 
-    pBufferMemoryBarriers_host = convert_VkBufferMemoryBarrier_array_win_to_host(pBufferMemoryBarriers, bufferMemoryBarrierCount);
-    pImageMemoryBarriers_host = convert_VkImageMemoryBarrier_array_win_to_host(pImageMemoryBarriers, imageMemoryBarrierCount);
-    commandBuffer->device->funcs.p_vkCmdWaitEvents(commandBuffer->command_buffer, eventCount, pEvents, srcStageMask, dstStageMask, memoryBarrierCount, pMemoryBarriers, bufferMemoryBarrierCount, pBufferMemoryBarriers_host, imageMemoryBarrierCount, pImageMemoryBarriers_host);
+    arena = &commandBuffer->arena;
 
-    free_VkBufferMemoryBarrier_array(pBufferMemoryBarriers_host, bufferMemoryBarrierCount);
-    free_VkImageMemoryBarrier_array(pImageMemoryBarriers_host, imageMemoryBarrierCount);
+    if (!(pImageMemoryBarriers_host = convert_VkImageMemoryBarrier_array_win_to_host(pImageMemoryBarriers, imageMemoryBarrierCount, arena)) && pImageMemoryBarriers)
+        goto done;
+    wine_vk_profile_host_begin(&timer);
+    commandBuffer->device->funcs.p_vkCmdWaitEvents(commandBuffer->command_buffer, eventCount, pEvents, srcStageMask, dstStageMask, memoryBarrierCount, pMemoryBarriers, bufferMemoryBarrierCount, pBufferMemoryBarriers, imageMemoryBarrierCount, pImageMemoryBarriers_host);
+    wine_vk_profile_host_end(&timer);
+
+done:
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdWaitEvents]);
 #else
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %u, %p, %#x, %#x, %u, %p, %u, %p, %u, %p\n", commandBuffer, eventCount, pEvents, srcStageMask, dstStageMask, memoryBarrierCount, pMemoryBarriers, bufferMemoryBarrierCount, pBufferMemoryBarriers, imageMemoryBarrierCount, pImageMemoryBarriers);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdWaitEvents(commandBuffer->command_buffer, eventCount, pEvents, srcStageMask, dstStageMask, memoryBarrierCount, pMemoryBarriers, bufferMemoryBarrierCount, pBufferMemoryBarriers, imageMemoryBarrierCount, pImageMemoryBarriers);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdWaitEvents]);
 #endif
 }
 
 static void WINAPI wine_vkCmdWriteTimestamp(VkCommandBuffer commandBuffer, VkPipelineStageFlagBits pipelineStage, VkQueryPool queryPool, uint32_t query)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %d, 0x%s, %u\n", commandBuffer, pipelineStage, wine_dbgstr_longlong(queryPool), query);
+    wine_vk_profile_begin(&timer);
     commandBuffer->device->funcs.p_vkCmdWriteTimestamp(commandBuffer->command_buffer, pipelineStage, queryPool, query);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCmdWriteTimestamp]);
 }
 
 static VkResult WINAPI wine_vkCreateBuffer(VkDevice device, const VkBufferCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkBuffer *pBuffer)
 {
 #if defined(USE_STRUCT_CONVERSION)
     VkResult result;
+    struct wine_vk_profile_timer timer;
     VkBufferCreateInfo_host pCreateInfo_host;
     TRACE("%p, %p, %p, %p\n", device, pCreateInfo, pAllocator, pBuffer);
+    wine_vk_profile_begin(&timer);
 
     convert_VkBufferCreateInfo_win_to_host(pCreateInfo, &pCreateInfo_host);
+    wine_vk_profile_host_begin(&timer);
     result = device->funcs.p_vkCreateBuffer(device->device, &pCreateInfo_host, NULL, pBuffer);
+    wine_vk_profile_host_end(&timer);
 
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCreateBuffer]);
     return result;
 #else
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %p, %p, %p\n", device, pCreateInfo, pAllocator, pBuffer);
-    return device->funcs.p_vkCreateBuffer(device->device, pCreateInfo, NULL, pBuffer);
+    wine_vk_profile_begin(&timer);
+    result = device->funcs.p_vkCreateBuffer(device->device, pCreateInfo, NULL, pBuffer);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCreateBuffer]);
+    return result;
 #endif
 }
 
@@ -1433,98 +1605,159 @@ static VkResult WINAPI wine_vkCreateBufferView(VkDevice device, const VkBufferVi
 {
 #if defined(USE_STRUCT_CONVERSION)
     VkResult result;
+    struct wine_vk_profile_timer timer;
     VkBufferViewCreateInfo_host pCreateInfo_host;
     TRACE("%p, %p, %p, %p\n", device, pCreateInfo, pAllocator, pView);
+    wine_vk_profile_begin(&timer);
 
     convert_VkBufferViewCreateInfo_win_to_host(pCreateInfo, &pCreateInfo_host);
+    wine_vk_profile_host_begin(&timer);
     result = device->funcs.p_vkCreateBufferView(device->device, &pCreateInfo_host, NULL, pView);
+    wine_vk_profile_host_end(&timer);
 
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCreateBufferView]);
     return result;
 #else
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %p, %p, %p\n", device, pCreateInfo, pAllocator, pView);
-    return device->funcs.p_vkCreateBufferView(device->device, pCreateInfo, NULL, pView);
+    wine_vk_profile_begin(&timer);
+    result = device->funcs.p_vkCreateBufferView(device->device, pCreateInfo, NULL, pView);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCreateBufferView]);
+    return result;
 #endif
 }
 
-static VkResult WINAPI wine_vkCreateCommandPool(VkDevice device, const VkCommandPoolCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkCommandPool *pCommandPool)
-{
-    TRACE("%p, %p, %p, %p\n", device, pCreateInfo, pAllocator, pCommandPool);
-    return device->funcs.p_vkCreateCommandPool(device->device, pCreateInfo, NULL, pCommandPool);
-}
-
 static VkResult WINAPI wine_vkCreateComputePipelines(VkDevice device, VkPipelineCache pipelineCache, uint32_t createInfoCount, const VkComputePipelineCreateInfo *pCreateInfos, const VkAllocationCallbacks *pAllocator, VkPipeline *pPipelines)
 {
 #if defined(USE_STRUCT_CONVERSION)
     VkResult result;
+    struct wine_vk_arena *arena;
+    struct wine_vk_profile_timer timer;
     VkComputePipelineCreateInfo_host *pCreateInfos_host;
     TRACE("%p, 0x%s, %u, %p, %p, %p\n", device, wine_dbgstr_longlong(pipelineCache), createInfoCount, pCreateInfos, pAllocator, pPipelines);
+    if (!(arena = wine_vk_get_thread_arena())) return VK_ERROR_OUT_OF_HOST_MEMORY;
+    wine_vk_profile_begin(&timer);
 
-    pCreateInfos_host = convert_VkComputePipelineCreateInfo_array_win_to_host(pCreateInfos, createInfoCount);
-    result = device->funcs.p_vkCreateComputePipelines(device->device, pipelineCache, createInfoCount, pCreateInfos_host, NULL, pPipelines);
+    if (!(pCreateInfos_host = convert_VkComputePipelineCreateInfo_array_win_to_host(pCreateInfos, createInfoCount, arena)) && pCreateInfos)
+    {
+        result = VK_ERROR_OUT_OF_HOST_MEMORY;
+        goto done;
+    }
+    wine_vk_profile_host_begin(&timer);
+    result = device->funcs.p_vkCreateComputePipelines(device->device, wine_vk_device_pipeline_cache(device, pipelineCache), createInfoCount, pCreateInfos_host, NULL, pPipelines);
+    wine_vk_profile_host_end(&timer);
 
-    free_VkComputePipelineCreateInfo_array(pCreateInfos_host, createInfoCount);
+done:
+    wine_vk_arena_reset(arena);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCreateComputePipelines]);
     return result;
 #else
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %u, %p, %p, %p\n", device, wine_dbgstr_longlong(pipelineCache), createInfoCount, pCreateInfos, pAllocator, pPipelines);
-    return device->funcs.p_vkCreateComputePipelines(device->device, pipelineCache, createInfoCount, pCreateInfos, NULL, pPipelines);
+    wine_vk_profile_begin(&timer);
+    result = device->funcs.p_vkCreateComputePipelines(device->device, wine_vk_device_pipeline_cache(device, pipelineCache), createInfoCount, pCreateInfos, NULL, pPipelines);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCreateComputePipelines]);
+    return result;
 #endif
 }
 
 static VkResult WINAPI wine_vkCreateDescriptorPool(VkDevice device, const VkDescriptorPoolCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkDescriptorPool *pDescriptorPool)
 {
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %p, %p, %p\n", device, pCreateInfo, pAllocator, pDescriptorPool);
-    return device->funcs.p_vkCreateDescriptorPool(device->device, pCreateInfo, NULL, pDescriptorPool);
+    wine_vk_profile_begin(&timer);
+    result = device->funcs.p_vkCreateDescriptorPool(device->device, pCreateInfo, NULL, pDescriptorPool);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCreateDescriptorPool]);
+    return result;
 }
 
 static VkResult WINAPI wine_vkCreateDescriptorSetLayout(VkDevice device, const VkDescriptorSetLayoutCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkDescriptorSetLayout *pSetLayout)
 {
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %p, %p, %p\n", device, pCreateInfo, pAllocator, pSetLayout);
-    return device->funcs.p_vkCreateDescriptorSetLayout(device->device, pCreateInfo, NULL, pSetLayout);
+    wine_vk_profile_begin(&timer);
+    result = device->funcs.p_vkCreateDescriptorSetLayout(device->device, pCreateInfo, NULL, pSetLayout);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCreateDescriptorSetLayout]);
+    return result;
 }
 
 static VkResult WINAPI wine_vkCreateDescriptorUpdateTemplateKHR(VkDevice device, const VkDescriptorUpdateTemplateCreateInfoKHR *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkDescriptorUpdateTemplateKHR *pDescriptorUpdateTemplate)
 {
 #if defined(USE_STRUCT_CONVERSION)
     VkResult result;
+    struct wine_vk_profile_timer timer;
     VkDescriptorUpdateTemplateCreateInfoKHR_host pCreateInfo_host;
     TRACE("%p, %p, %p, %p\n", device, pCreateInfo, pAllocator, pDescriptorUpdateTemplate);
+    wine_vk_profile_begin(&timer);
 
     convert_VkDescriptorUpdateTemplateCreateInfoKHR_win_to_host(pCreateInfo, &pCreateInfo_host);
+    wine_vk_profile_host_begin(&timer);
     result = device->funcs.p_vkCreateDescriptorUpdateTemplateKHR(device->device, &pCreateInfo_host, NULL, pDescriptorUpdateTemplate);
+    wine_vk_profile_host_end(&timer);
 
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCreateDescriptorUpdateTemplateKHR]);
     return result;
 #else
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %p, %p, %p\n", device, pCreateInfo, pAllocator, pDescriptorUpdateTemplate);
-    return device->funcs.p_vkCreateDescriptorUpdateTemplateKHR(device->device, pCreateInfo, NULL, pDescriptorUpdateTemplate);
+    wine_vk_profile_begin(&timer);
+    result = device->funcs.p_vkCreateDescriptorUpdateTemplateKHR(device->device, pCreateInfo, NULL, pDescriptorUpdateTemplate);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCreateDescriptorUpdateTemplateKHR]);
+    return result;
 #endif
 }
 
 static VkResult WINAPI wine_vkCreateEvent(VkDevice device, const VkEventCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkEvent *pEvent)
 {
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %p, %p, %p\n", device, pCreateInfo, pAllocator, pEvent);
-    return device->funcs.p_vkCreateEvent(device->device, pCreateInfo, NULL, pEvent);
+    wine_vk_profile_begin(&timer);
+    result = device->funcs.p_vkCreateEvent(device->device, pCreateInfo, NULL, pEvent);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCreateEvent]);
+    return result;
 }
 
 static VkResult WINAPI wine_vkCreateFence(VkDevice device, const VkFenceCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkFence *pFence)
 {
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %p, %p, %p\n", device, pCreateInfo, pAllocator, pFence);
-    return device->funcs.p_vkCreateFence(device->device, pCreateInfo, NULL, pFence);
+    wine_vk_profile_begin(&timer);
+    result = device->funcs.p_vkCreateFence(device->device, pCreateInfo, NULL, pFence);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCreateFence]);
+    return result;
 }
 
 static VkResult WINAPI wine_vkCreateFramebuffer(VkDevice device, const VkFramebufferCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkFramebuffer *pFramebuffer)
 {
 #if defined(USE_STRUCT_CONVERSION)
     VkResult result;
+    struct wine_vk_profile_timer timer;
     VkFramebufferCreateInfo_host pCreateInfo_host;
     TRACE("%p, %p, %p, %p\n", device, pCreateInfo, pAllocator, pFramebuffer);
+    wine_vk_profile_begin(&timer);
 
     convert_VkFramebufferCreateInfo_win_to_host(pCreateInfo, &pCreateInfo_host);
+    wine_vk_profile_host_begin(&timer);
     result = device->funcs.p_vkCreateFramebuffer(device->device, &pCreateInfo_host, NULL, pFramebuffer);
+    wine_vk_profile_host_end(&timer);
 
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCreateFramebuffer]);
     return result;
 #else
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %p, %p, %p\n", device, pCreateInfo, pAllocator, pFramebuffer);
-    return device->funcs.p_vkCreateFramebuffer(device->device, pCreateInfo, NULL, pFramebuffer);
+    wine_vk_profile_begin(&timer);
+    result = device->funcs.p_vkCreateFramebuffer(device->device, pCreateInfo, NULL, pFramebuffer);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCreateFramebuffer]);
+    return result;
 #endif
 }
 
@@ -1532,629 +1765,1425 @@ static VkResult WINAPI wine_vkCreateGraphicsPipelines(VkDevice device, VkPipelin
 {
 #if defined(USE_STRUCT_CONVERSION)
     VkResult result;
+    struct wine_vk_arena *arena;
+    struct wine_vk_profile_timer timer;
     VkGraphicsPipelineCreateInfo_host *pCreateInfos_host;
     TRACE("%p, 0x%s, %u, %p, %p, %p\n", device, wine_dbgstr_longlong(pipelineCache), createInfoCount, pCreateInfos, pAllocator, pPipelines);
+    if (!(arena = wine_vk_get_thread_arena())) return VK_ERROR_OUT_OF_HOST_MEMORY;
+    wine_vk_profile_begin(&timer);
 
-    pCreateInfos_host = convert_VkGraphicsPipelineCreateInfo_array_win_to_host(pCreateInfos, createInfoCount);
-    result = device->funcs.p_vkCreateGraphicsPipelines(device->device, pipelineCache, createInfoCount, pCreateInfos_host, NULL, pPipelines);
+    if (!(pCreateInfos_host = convert_VkGraphicsPipelineCreateInfo_array_win_to_host(pCreateInfos, createInfoCount, arena)) && pCreateInfos)
+    {
+        result = VK_ERROR_OUT_OF_HOST_MEMORY;
+        goto done;
+    }
+    wine_vk_profile_host_begin(&timer);
+    result = device->funcs.p_vkCreateGraphicsPipelines(device->device, wine_vk_device_pipeline_cache(device, pipelineCache), createInfoCount, pCreateInfos_host, NULL, pPipelines);
+    wine_vk_profile_host_end(&timer);
 
-    free_VkGraphicsPipelineCreateInfo_array(pCreateInfos_host, createInfoCount);
+done:
+    wine_vk_arena_reset(arena);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCreateGraphicsPipelines]);
     return result;
 #else
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %u, %p, %p, %p\n", device, wine_dbgstr_longlong(pipelineCache), createInfoCount, pCreateInfos, pAllocator, pPipelines);
-    return device->funcs.p_vkCreateGraphicsPipelines(device->device, pipelineCache, createInfoCount, pCreateInfos, NULL, pPipelines);
+    wine_vk_profile_begin(&timer);
+    result = device->funcs.p_vkCreateGraphicsPipelines(device->device, wine_vk_device_pipeline_cache(device, pipelineCache), createInfoCount, pCreateInfos, NULL, pPipelines);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCreateGraphicsPipelines]);
+    return result;
 #endif
 }
 
 static VkResult WINAPI wine_vkCreateImage(VkDevice device, const VkImageCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkImage *pImage)
 {
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %p, %p, %p\n", device, pCreateInfo, pAllocator, pImage);
-    return device->funcs.p_vkCreateImage(device->device, pCreateInfo, NULL, pImage);
+    wine_vk_profile_begin(&timer);
+    result = device->funcs.p_vkCreateImage(device->device, pCreateInfo, NULL, pImage);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCreateImage]);
+    return result;
 }
 
 static VkResult WINAPI wine_vkCreateImageView(VkDevice device, const VkImageViewCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkImageView *pView)
 {
 #if defined(USE_STRUCT_CONVERSION)
     VkResult result;
+    struct wine_vk_profile_timer timer;
     VkImageViewCreateInfo_host pCreateInfo_host;
     TRACE("%p, %p, %p, %p\n", device, pCreateInfo, pAllocator, pView);
+    wine_vk_profile_begin(&timer);
 
     convert_VkImageViewCreateInfo_win_to_host(pCreateInfo, &pCreateInfo_host);
+    wine_vk_profile_host_begin(&timer);
     result = device->funcs.p_vkCreateImageView(device->device, &pCreateInfo_host, NULL, pView);
+    wine_vk_profile_host_end(&timer);
 
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCreateImageView]);
     return result;
 #else
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %p, %p, %p\n", device, pCreateInfo, pAllocator, pView);
-    return device->funcs.p_vkCreateImageView(device->device, pCreateInfo, NULL, pView);
+    wine_vk_profile_begin(&timer);
+    result = device->funcs.p_vkCreateImageView(device->device, pCreateInfo, NULL, pView);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCreateImageView]);
+    return result;
 #endif
 }
 
 static VkResult WINAPI wine_vkCreatePipelineCache(VkDevice device, const VkPipelineCacheCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkPipelineCache *pPipelineCache)
 {
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %p, %p, %p\n", device, pCreateInfo, pAllocator, pPipelineCache);
-    return device->funcs.p_vkCreatePipelineCache(device->device, pCreateInfo, NULL, pPipelineCache);
+    wine_vk_profile_begin(&timer);
+    result = device->funcs.p_vkCreatePipelineCache(device->device, pCreateInfo, NULL, pPipelineCache);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCreatePipelineCache]);
+    return result;
 }
 
 static VkResult WINAPI wine_vkCreatePipelineLayout(VkDevice device, const VkPipelineLayoutCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkPipelineLayout *pPipelineLayout)
 {
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %p, %p, %p\n", device, pCreateInfo, pAllocator, pPipelineLayout);
-    return device->funcs.p_vkCreatePipelineLayout(device->device, pCreateInfo, NULL, pPipelineLayout);
+    wine_vk_profile_begin(&timer);
+    result = device->funcs.p_vkCreatePipelineLayout(device->device, pCreateInfo, NULL, pPipelineLayout);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCreatePipelineLayout]);
+    return result;
 }
 
 static VkResult WINAPI wine_vkCreateQueryPool(VkDevice device, const VkQueryPoolCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkQueryPool *pQueryPool)
 {
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %p, %p, %p\n", device, pCreateInfo, pAllocator, pQueryPool);
-    return device->funcs.p_vkCreateQueryPool(device->device, pCreateInfo, NULL, pQueryPool);
+    wine_vk_profile_begin(&timer);
+    result = device->funcs.p_vkCreateQueryPool(device->device, pCreateInfo, NULL, pQueryPool);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCreateQueryPool]);
+    return result;
 }
 
 static VkResult WINAPI wine_vkCreateRenderPass(VkDevice device, const VkRenderPassCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkRenderPass *pRenderPass)
 {
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %p, %p, %p\n", device, pCreateInfo, pAllocator, pRenderPass);
-    return device->funcs.p_vkCreateRenderPass(device->device, pCreateInfo, NULL, pRenderPass);
+    wine_vk_profile_begin(&timer);
+    result = device->funcs.p_vkCreateRenderPass(device->device, pCreateInfo, NULL, pRenderPass);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCreateRenderPass]);
+    return result;
 }
 
 static VkResult WINAPI wine_vkCreateSampler(VkDevice device, const VkSamplerCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkSampler *pSampler)
 {
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %p, %p, %p\n", device, pCreateInfo, pAllocator, pSampler);
-    return device->funcs.p_vkCreateSampler(device->device, pCreateInfo, NULL, pSampler);
+    wine_vk_profile_begin(&timer);
+    result = device->funcs.p_vkCreateSampler(device->device, pCreateInfo, NULL, pSampler);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCreateSampler]);
+    return result;
 }
 
 static VkResult WINAPI wine_vkCreateSemaphore(VkDevice device, const VkSemaphoreCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkSemaphore *pSemaphore)
 {
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %p, %p, %p\n", device, pCreateInfo, pAllocator, pSemaphore);
-    return device->funcs.p_vkCreateSemaphore(device->device, pCreateInfo, NULL, pSemaphore);
+    wine_vk_profile_begin(&timer);
+    result = device->funcs.p_vkCreateSemaphore(device->device, pCreateInfo, NULL, pSemaphore);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCreateSemaphore]);
+    return result;
 }
 
 static VkResult WINAPI wine_vkCreateShaderModule(VkDevice device, const VkShaderModuleCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkShaderModule *pShaderModule)
 {
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %p, %p, %p\n", device, pCreateInfo, pAllocator, pShaderModule);
-    return device->funcs.p_vkCreateShaderModule(device->device, pCreateInfo, NULL, pShaderModule);
+    wine_vk_profile_begin(&timer);
+    result = device->funcs.p_vkCreateShaderModule(device->device, pCreateInfo, NULL, pShaderModule);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkCreateShaderModule]);
+    return result;
 }
 
 static void WINAPI wine_vkDestroyBuffer(VkDevice device, VkBuffer buffer, const VkAllocationCallbacks *pAllocator)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %p\n", device, wine_dbgstr_longlong(buffer), pAllocator);
+    wine_vk_profile_begin(&timer);
     device->funcs.p_vkDestroyBuffer(device->device, buffer, NULL);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkDestroyBuffer]);
 }
 
 static void WINAPI wine_vkDestroyBufferView(VkDevice device, VkBufferView bufferView, const VkAllocationCallbacks *pAllocator)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %p\n", device, wine_dbgstr_longlong(bufferView), pAllocator);
+    wine_vk_profile_begin(&timer);
     device->funcs.p_vkDestroyBufferView(device->device, bufferView, NULL);
-}
-
-static void WINAPI wine_vkDestroyCommandPool(VkDevice device, VkCommandPool commandPool, const VkAllocationCallbacks *pAllocator)
-{
-    TRACE("%p, 0x%s, %p\n", device, wine_dbgstr_longlong(commandPool), pAllocator);
-    device->funcs.p_vkDestroyCommandPool(device->device, commandPool, NULL);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkDestroyBufferView]);
 }
 
 static void WINAPI wine_vkDestroyDescriptorPool(VkDevice device, VkDescriptorPool descriptorPool, const VkAllocationCallbacks *pAllocator)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %p\n", device, wine_dbgstr_longlong(descriptorPool), pAllocator);
+    wine_vk_profile_begin(&timer);
     device->funcs.p_vkDestroyDescriptorPool(device->device, descriptorPool, NULL);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkDestroyDescriptorPool]);
 }
 
 static void WINAPI wine_vkDestroyDescriptorSetLayout(VkDevice device, VkDescriptorSetLayout descriptorSetLayout, const VkAllocationCallbacks *pAllocator)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %p\n", device, wine_dbgstr_longlong(descriptorSetLayout), pAllocator);
+    wine_vk_profile_begin(&timer);
     device->funcs.p_vkDestroyDescriptorSetLayout(device->device, descriptorSetLayout, NULL);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkDestroyDescriptorSetLayout]);
 }
 
 static void WINAPI wine_vkDestroyDescriptorUpdateTemplateKHR(VkDevice device, VkDescriptorUpdateTemplateKHR descriptorUpdateTemplate, const VkAllocationCallbacks *pAllocator)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %p\n", device, wine_dbgstr_longlong(descriptorUpdateTemplate), pAllocator);
+    wine_vk_profile_begin(&timer);
     device->funcs.p_vkDestroyDescriptorUpdateTemplateKHR(device->device, descriptorUpdateTemplate, NULL);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkDestroyDescriptorUpdateTemplateKHR]);
 }
 
 static void WINAPI wine_vkDestroyEvent(VkDevice device, VkEvent event, const VkAllocationCallbacks *pAllocator)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %p\n", device, wine_dbgstr_longlong(event), pAllocator);
+    wine_vk_profile_begin(&timer);
     device->funcs.p_vkDestroyEvent(device->device, event, NULL);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkDestroyEvent]);
 }
 
 static void WINAPI wine_vkDestroyFence(VkDevice device, VkFence fence, const VkAllocationCallbacks *pAllocator)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %p\n", device, wine_dbgstr_longlong(fence), pAllocator);
+    wine_vk_profile_begin(&timer);
     device->funcs.p_vkDestroyFence(device->device, fence, NULL);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkDestroyFence]);
 }
 
 static void WINAPI wine_vkDestroyFramebuffer(VkDevice device, VkFramebuffer framebuffer, const VkAllocationCallbacks *pAllocator)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %p\n", device, wine_dbgstr_longlong(framebuffer), pAllocator);
+    wine_vk_profile_begin(&timer);
     device->funcs.p_vkDestroyFramebuffer(device->device, framebuffer, NULL);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkDestroyFramebuffer]);
 }
 
 static void WINAPI wine_vkDestroyImage(VkDevice device, VkImage image, const VkAllocationCallbacks *pAllocator)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %p\n", device, wine_dbgstr_longlong(image), pAllocator);
+    wine_vk_profile_begin(&timer);
     device->funcs.p_vkDestroyImage(device->device, image, NULL);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkDestroyImage]);
 }
 
 static void WINAPI wine_vkDestroyImageView(VkDevice device, VkImageView imageView, const VkAllocationCallbacks *pAllocator)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %p\n", device, wine_dbgstr_longlong(imageView), pAllocator);
+    wine_vk_profile_begin(&timer);
     device->funcs.p_vkDestroyImageView(device->device, imageView, NULL);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkDestroyImageView]);
 }
 
 static void WINAPI wine_vkDestroyPipeline(VkDevice device, VkPipeline pipeline, const VkAllocationCallbacks *pAllocator)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %p\n", device, wine_dbgstr_longlong(pipeline), pAllocator);
+    wine_vk_profile_begin(&timer);
     device->funcs.p_vkDestroyPipeline(device->device, pipeline, NULL);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkDestroyPipeline]);
 }
 
 static void WINAPI wine_vkDestroyPipelineCache(VkDevice device, VkPipelineCache pipelineCache, const VkAllocationCallbacks *pAllocator)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %p\n", device, wine_dbgstr_longlong(pipelineCache), pAllocator);
+    wine_vk_profile_begin(&timer);
     device->funcs.p_vkDestroyPipelineCache(device->device, pipelineCache, NULL);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkDestroyPipelineCache]);
 }
 
 static void WINAPI wine_vkDestroyPipelineLayout(VkDevice device, VkPipelineLayout pipelineLayout, const VkAllocationCallbacks *pAllocator)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %p\n", device, wine_dbgstr_longlong(pipelineLayout), pAllocator);
+    wine_vk_profile_begin(&timer);
     device->funcs.p_vkDestroyPipelineLayout(device->device, pipelineLayout, NULL);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkDestroyPipelineLayout]);
 }
 
 static void WINAPI wine_vkDestroyQueryPool(VkDevice device, VkQueryPool queryPool, const VkAllocationCallbacks *pAllocator)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %p\n", device, wine_dbgstr_longlong(queryPool), pAllocator);
+    wine_vk_profile_begin(&timer);
     device->funcs.p_vkDestroyQueryPool(device->device, queryPool, NULL);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkDestroyQueryPool]);
 }
 
 static void WINAPI wine_vkDestroyRenderPass(VkDevice device, VkRenderPass renderPass, const VkAllocationCallbacks *pAllocator)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %p\n", device, wine_dbgstr_longlong(renderPass), pAllocator);
+    wine_vk_profile_begin(&timer);
     device->funcs.p_vkDestroyRenderPass(device->device, renderPass, NULL);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkDestroyRenderPass]);
 }
 
 static void WINAPI wine_vkDestroySampler(VkDevice device, VkSampler sampler, const VkAllocationCallbacks *pAllocator)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %p\n", device, wine_dbgstr_longlong(sampler), pAllocator);
+    wine_vk_profile_begin(&timer);
     device->funcs.p_vkDestroySampler(device->device, sampler, NULL);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkDestroySampler]);
 }
 
 static void WINAPI wine_vkDestroySemaphore(VkDevice device, VkSemaphore semaphore, const VkAllocationCallbacks *pAllocator)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %p\n", device, wine_dbgstr_longlong(semaphore), pAllocator);
+    wine_vk_profile_begin(&timer);
     device->funcs.p_vkDestroySemaphore(device->device, semaphore, NULL);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkDestroySemaphore]);
 }
 
 static void WINAPI wine_vkDestroyShaderModule(VkDevice device, VkShaderModule shaderModule, const VkAllocationCallbacks *pAllocator)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %p\n", device, wine_dbgstr_longlong(shaderModule), pAllocator);
+    wine_vk_profile_begin(&timer);
     device->funcs.p_vkDestroyShaderModule(device->device, shaderModule, NULL);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkDestroyShaderModule]);
 }
 
 static VkResult WINAPI wine_vkDeviceWaitIdle(VkDevice device)
 {
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p\n", device);
-    return device->funcs.p_vkDeviceWaitIdle(device->device);
+    wine_vk_profile_begin(&timer);
+    wine_vk_device_flush_submits(device);
+    result = device->funcs.p_vkDeviceWaitIdle(device->device);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkDeviceWaitIdle]);
+    return result;
 }
 
 static VkResult WINAPI wine_vkEndCommandBuffer(VkCommandBuffer commandBuffer)
 {
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p\n", commandBuffer);
-    return commandBuffer->device->funcs.p_vkEndCommandBuffer(commandBuffer->command_buffer);
+    wine_vk_profile_begin(&timer);
+    result = commandBuffer->device->funcs.p_vkEndCommandBuffer(commandBuffer->command_buffer);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkEndCommandBuffer]);
+    return result;
 }
 
 static VkResult WINAPI wine_vkEnumerateDeviceLayerProperties(VkPhysicalDevice physicalDevice, uint32_t *pPropertyCount, VkLayerProperties *pProperties)
 {
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %p, %p\n", physicalDevice, pPropertyCount, pProperties);
-    return physicalDevice->instance->funcs.p_vkEnumerateDeviceLayerProperties(physicalDevice->phys_dev, pPropertyCount, pProperties);
+    wine_vk_profile_begin(&timer);
+    result = physicalDevice->instance->funcs.p_vkEnumerateDeviceLayerProperties(physicalDevice->phys_dev, pPropertyCount, pProperties);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkEnumerateDeviceLayerProperties]);
+    return result;
 }
 
 static VkResult WINAPI wine_vkFlushMappedMemoryRanges(VkDevice device, uint32_t memoryRangeCount, const VkMappedMemoryRange *pMemoryRanges)
 {
-#if defined(USE_STRUCT_CONVERSION)
     VkResult result;
-    VkMappedMemoryRange_host *pMemoryRanges_host;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %u, %p\n", device, memoryRangeCount, pMemoryRanges);
-
-    pMemoryRanges_host = convert_VkMappedMemoryRange_array_win_to_host(pMemoryRanges, memoryRangeCount);
-    result = device->funcs.p_vkFlushMappedMemoryRanges(device->device, memoryRangeCount, pMemoryRanges_host);
-
-    free_VkMappedMemoryRange_array(pMemoryRanges_host, memoryRangeCount);
+    wine_vk_profile_begin(&timer);
+    result = device->funcs.p_vkFlushMappedMemoryRanges(device->device, memoryRangeCount, pMemoryRanges);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkFlushMappedMemoryRanges]);
     return result;
-#else
-    TRACE("%p, %u, %p\n", device, memoryRangeCount, pMemoryRanges);
-    return device->funcs.p_vkFlushMappedMemoryRanges(device->device, memoryRangeCount, pMemoryRanges);
-#endif
 }
 
 static VkResult WINAPI wine_vkFreeDescriptorSets(VkDevice device, VkDescriptorPool descriptorPool, uint32_t descriptorSetCount, const VkDescriptorSet *pDescriptorSets)
 {
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %u, %p\n", device, wine_dbgstr_longlong(descriptorPool), descriptorSetCount, pDescriptorSets);
-    return device->funcs.p_vkFreeDescriptorSets(device->device, descriptorPool, descriptorSetCount, pDescriptorSets);
+    wine_vk_profile_begin(&timer);
+    result = device->funcs.p_vkFreeDescriptorSets(device->device, descriptorPool, descriptorSetCount, pDescriptorSets);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkFreeDescriptorSets]);
+    return result;
 }
 
 static void WINAPI wine_vkFreeMemory(VkDevice device, VkDeviceMemory memory, const VkAllocationCallbacks *pAllocator)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %p\n", device, wine_dbgstr_longlong(memory), pAllocator);
+    wine_vk_profile_begin(&timer);
     device->funcs.p_vkFreeMemory(device->device, memory, NULL);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkFreeMemory]);
 }
 
 static void WINAPI wine_vkGetBufferMemoryRequirements(VkDevice device, VkBuffer buffer, VkMemoryRequirements *pMemoryRequirements)
 {
 #if defined(USE_STRUCT_CONVERSION)
+    struct wine_vk_profile_timer timer;
     VkMemoryRequirements_host pMemoryRequirements_host;
     TRACE("%p, 0x%s, %p\n", device, wine_dbgstr_longlong(buffer), pMemoryRequirements);
+    wine_vk_profile_begin(&timer);
 
+    wine_vk_profile_host_begin(&timer);
     device->funcs.p_vkGetBufferMemoryRequirements(device->device, buffer, &pMemoryRequirements_host);
+    wine_vk_profile_host_end(&timer);
 
     convert_VkMemoryRequirements_host_to_win(&pMemoryRequirements_host, pMemoryRequirements);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkGetBufferMemoryRequirements]);
 #else
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %p\n", device, wine_dbgstr_longlong(buffer), pMemoryRequirements);
+    wine_vk_profile_begin(&timer);
     device->funcs.p_vkGetBufferMemoryRequirements(device->device, buffer, pMemoryRequirements);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkGetBufferMemoryRequirements]);
 #endif
 }
 
 static void WINAPI wine_vkGetDeviceMemoryCommitment(VkDevice device, VkDeviceMemory memory, VkDeviceSize *pCommittedMemoryInBytes)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %p\n", device, wine_dbgstr_longlong(memory), pCommittedMemoryInBytes);
+    wine_vk_profile_begin(&timer);
     device->funcs.p_vkGetDeviceMemoryCommitment(device->device, memory, pCommittedMemoryInBytes);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkGetDeviceMemoryCommitment]);
 }
 
 static VkResult WINAPI wine_vkGetEventStatus(VkDevice device, VkEvent event)
 {
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s\n", device, wine_dbgstr_longlong(event));
-    return device->funcs.p_vkGetEventStatus(device->device, event);
+    wine_vk_profile_begin(&timer);
+    wine_vk_device_flush_submits(device);
+    result = device->funcs.p_vkGetEventStatus(device->device, event);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkGetEventStatus]);
+    return result;
 }
 
 static VkResult WINAPI wine_vkGetFenceStatus(VkDevice device, VkFence fence)
 {
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s\n", device, wine_dbgstr_longlong(fence));
-    return device->funcs.p_vkGetFenceStatus(device->device, fence);
+    wine_vk_profile_begin(&timer);
+    result = device->funcs.p_vkGetFenceStatus(device->device, fence);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkGetFenceStatus]);
+    return result;
 }
 
 static void WINAPI wine_vkGetImageMemoryRequirements(VkDevice device, VkImage image, VkMemoryRequirements *pMemoryRequirements)
 {
 #if defined(USE_STRUCT_CONVERSION)
+    struct wine_vk_profile_timer timer;
     VkMemoryRequirements_host pMemoryRequirements_host;
     TRACE("%p, 0x%s, %p\n", device, wine_dbgstr_longlong(image), pMemoryRequirements);
+    wine_vk_profile_begin(&timer);
 
+    wine_vk_profile_host_begin(&timer);
     device->funcs.p_vkGetImageMemoryRequirements(device->device, image, &pMemoryRequirements_host);
+    wine_vk_profile_host_end(&timer);
 
     convert_VkMemoryRequirements_host_to_win(&pMemoryRequirements_host, pMemoryRequirements);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkGetImageMemoryRequirements]);
 #else
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %p\n", device, wine_dbgstr_longlong(image), pMemoryRequirements);
+    wine_vk_profile_begin(&timer);
     device->funcs.p_vkGetImageMemoryRequirements(device->device, image, pMemoryRequirements);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkGetImageMemoryRequirements]);
 #endif
 }
 
 static void WINAPI wine_vkGetImageSparseMemoryRequirements(VkDevice device, VkImage image, uint32_t *pSparseMemoryRequirementCount, VkSparseImageMemoryRequirements *pSparseMemoryRequirements)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %p, %p\n", device, wine_dbgstr_longlong(image), pSparseMemoryRequirementCount, pSparseMemoryRequirements);
+    wine_vk_profile_begin(&timer);
     device->funcs.p_vkGetImageSparseMemoryRequirements(device->device, image, pSparseMemoryRequirementCount, pSparseMemoryRequirements);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkGetImageSparseMemoryRequirements]);
 }
 
 static void WINAPI wine_vkGetImageSubresourceLayout(VkDevice device, VkImage image, const VkImageSubresource *pSubresource, VkSubresourceLayout *pLayout)
 {
-#if defined(USE_STRUCT_CONVERSION)
-    VkSubresourceLayout_host pLayout_host;
-    TRACE("%p, 0x%s, %p, %p\n", device, wine_dbgstr_longlong(image), pSubresource, pLayout);
-
-    device->funcs.p_vkGetImageSubresourceLayout(device->device, image, pSubresource, &pLayout_host);
-
-    convert_VkSubresourceLayout_host_to_win(&pLayout_host, pLayout);
-#else
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %p, %p\n", device, wine_dbgstr_longlong(image), pSubresource, pLayout);
+    wine_vk_profile_begin(&timer);
     device->funcs.p_vkGetImageSubresourceLayout(device->device, image, pSubresource, pLayout);
-#endif
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkGetImageSubresourceLayout]);
 }
 
 static void WINAPI wine_vkGetPhysicalDeviceFeatures(VkPhysicalDevice physicalDevice, VkPhysicalDeviceFeatures *pFeatures)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %p\n", physicalDevice, pFeatures);
+    wine_vk_profile_begin(&timer);
     physicalDevice->instance->funcs.p_vkGetPhysicalDeviceFeatures(physicalDevice->phys_dev, pFeatures);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkGetPhysicalDeviceFeatures]);
 }
 
 static void WINAPI wine_vkGetPhysicalDeviceFeatures2KHR(VkPhysicalDevice physicalDevice, VkPhysicalDeviceFeatures2KHR *pFeatures)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %p\n", physicalDevice, pFeatures);
+    wine_vk_profile_begin(&timer);
     physicalDevice->instance->funcs.p_vkGetPhysicalDeviceFeatures2KHR(physicalDevice->phys_dev, pFeatures);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkGetPhysicalDeviceFeatures2KHR]);
 }
 
 static void WINAPI wine_vkGetPhysicalDeviceFormatProperties(VkPhysicalDevice physicalDevice, VkFormat format, VkFormatProperties *pFormatProperties)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %d, %p\n", physicalDevice, format, pFormatProperties);
+    wine_vk_profile_begin(&timer);
     physicalDevice->instance->funcs.p_vkGetPhysicalDeviceFormatProperties(physicalDevice->phys_dev, format, pFormatProperties);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkGetPhysicalDeviceFormatProperties]);
 }
 
 static void WINAPI wine_vkGetPhysicalDeviceFormatProperties2KHR(VkPhysicalDevice physicalDevice, VkFormat format, VkFormatProperties2KHR *pFormatProperties)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %d, %p\n", physicalDevice, format, pFormatProperties);
+    wine_vk_profile_begin(&timer);
     physicalDevice->instance->funcs.p_vkGetPhysicalDeviceFormatProperties2KHR(physicalDevice->phys_dev, format, pFormatProperties);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkGetPhysicalDeviceFormatProperties2KHR]);
 }
 
 static VkResult WINAPI wine_vkGetPhysicalDeviceImageFormatProperties(VkPhysicalDevice physicalDevice, VkFormat format, VkImageType type, VkImageTiling tiling, VkImageUsageFlags usage, VkImageCreateFlags flags, VkImageFormatProperties *pImageFormatProperties)
 {
-#if defined(USE_STRUCT_CONVERSION)
     VkResult result;
-    VkImageFormatProperties_host pImageFormatProperties_host;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %d, %d, %d, %#x, %#x, %p\n", physicalDevice, format, type, tiling, usage, flags, pImageFormatProperties);
-
-    result = physicalDevice->instance->funcs.p_vkGetPhysicalDeviceImageFormatProperties(physicalDevice->phys_dev, format, type, tiling, usage, flags, &pImageFormatProperties_host);
-
-    convert_VkImageFormatProperties_host_to_win(&pImageFormatProperties_host, pImageFormatProperties);
+    wine_vk_profile_begin(&timer);
+    result = physicalDevice->instance->funcs.p_vkGetPhysicalDeviceImageFormatProperties(physicalDevice->phys_dev, format, type, tiling, usage, flags, pImageFormatProperties);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkGetPhysicalDeviceImageFormatProperties]);
     return result;
-#else
-    TRACE("%p, %d, %d, %d, %#x, %#x, %p\n", physicalDevice, format, type, tiling, usage, flags, pImageFormatProperties);
-    return physicalDevice->instance->funcs.p_vkGetPhysicalDeviceImageFormatProperties(physicalDevice->phys_dev, format, type, tiling, usage, flags, pImageFormatProperties);
-#endif
 }
 
 static VkResult WINAPI wine_vkGetPhysicalDeviceImageFormatProperties2KHR(VkPhysicalDevice physicalDevice, const VkPhysicalDeviceImageFormatInfo2KHR *pImageFormatInfo, VkImageFormatProperties2KHR *pImageFormatProperties)
 {
-#if defined(USE_STRUCT_CONVERSION)
     VkResult result;
-    VkImageFormatProperties2KHR_host pImageFormatProperties_host;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %p, %p\n", physicalDevice, pImageFormatInfo, pImageFormatProperties);
-
-    convert_VkImageFormatProperties2KHR_win_to_host(pImageFormatProperties, &pImageFormatProperties_host);
-    result = physicalDevice->instance->funcs.p_vkGetPhysicalDeviceImageFormatProperties2KHR(physicalDevice->phys_dev, pImageFormatInfo, &pImageFormatProperties_host);
-
-    convert_VkImageFormatProperties2KHR_host_to_win(&pImageFormatProperties_host, pImageFormatProperties);
+    wine_vk_profile_begin(&timer);
+    result = physicalDevice->instance->funcs.p_vkGetPhysicalDeviceImageFormatProperties2KHR(physicalDevice->phys_dev, pImageFormatInfo, pImageFormatProperties);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkGetPhysicalDeviceImageFormatProperties2KHR]);
     return result;
-#else
-    TRACE("%p, %p, %p\n", physicalDevice, pImageFormatInfo, pImageFormatProperties);
-    return physicalDevice->instance->funcs.p_vkGetPhysicalDeviceImageFormatProperties2KHR(physicalDevice->phys_dev, pImageFormatInfo, pImageFormatProperties);
-#endif
 }
 
 static void WINAPI wine_vkGetPhysicalDeviceMemoryProperties(VkPhysicalDevice physicalDevice, VkPhysicalDeviceMemoryProperties *pMemoryProperties)
 {
 #if defined(USE_STRUCT_CONVERSION)
+    struct wine_vk_profile_timer timer;
     VkPhysicalDeviceMemoryProperties_host pMemoryProperties_host;
     TRACE("%p, %p\n", physicalDevice, pMemoryProperties);
+    wine_vk_profile_begin(&timer);
 
+    wine_vk_profile_host_begin(&timer);
     physicalDevice->instance->funcs.p_vkGetPhysicalDeviceMemoryProperties(physicalDevice->phys_dev, &pMemoryProperties_host);
+    wine_vk_profile_host_end(&timer);
 
     convert_VkPhysicalDeviceMemoryProperties_host_to_win(&pMemoryProperties_host, pMemoryProperties);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkGetPhysicalDeviceMemoryProperties]);
 #else
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %p\n", physicalDevice, pMemoryProperties);
+    wine_vk_profile_begin(&timer);
     physicalDevice->instance->funcs.p_vkGetPhysicalDeviceMemoryProperties(physicalDevice->phys_dev, pMemoryProperties);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkGetPhysicalDeviceMemoryProperties]);
 #endif
 }
 
 static void WINAPI wine_vkGetPhysicalDeviceMemoryProperties2KHR(VkPhysicalDevice physicalDevice, VkPhysicalDeviceMemoryProperties2KHR *pMemoryProperties)
 {
 #if defined(USE_STRUCT_CONVERSION)
+    struct wine_vk_profile_timer timer;
     VkPhysicalDeviceMemoryProperties2KHR_host pMemoryProperties_host;
     TRACE("%p, %p\n", physicalDevice, pMemoryProperties);
+    wine_vk_profile_begin(&timer);
 
     convert_VkPhysicalDeviceMemoryProperties2KHR_win_to_host(pMemoryProperties, &pMemoryProperties_host);
+    wine_vk_profile_host_begin(&timer);
     physicalDevice->instance->funcs.p_vkGetPhysicalDeviceMemoryProperties2KHR(physicalDevice->phys_dev, &pMemoryProperties_host);
+    wine_vk_profile_host_end(&timer);
 
     convert_VkPhysicalDeviceMemoryProperties2KHR_host_to_win(&pMemoryProperties_host, pMemoryProperties);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkGetPhysicalDeviceMemoryProperties2KHR]);
 #else
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %p\n", physicalDevice, pMemoryProperties);
+    wine_vk_profile_begin(&timer);
     physicalDevice->instance->funcs.p_vkGetPhysicalDeviceMemoryProperties2KHR(physicalDevice->phys_dev, pMemoryProperties);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkGetPhysicalDeviceMemoryProperties2KHR]);
 #endif
 }
 
 static void WINAPI wine_vkGetPhysicalDeviceProperties(VkPhysicalDevice physicalDevice, VkPhysicalDeviceProperties *pProperties)
 {
 #if defined(USE_STRUCT_CONVERSION)
+    struct wine_vk_profile_timer timer;
     VkPhysicalDeviceProperties_host pProperties_host;
     TRACE("%p, %p\n", physicalDevice, pProperties);
+    wine_vk_profile_begin(&timer);
 
+    wine_vk_profile_host_begin(&timer);
     physicalDevice->instance->funcs.p_vkGetPhysicalDeviceProperties(physicalDevice->phys_dev, &pProperties_host);
+    wine_vk_profile_host_end(&timer);
 
     convert_VkPhysicalDeviceProperties_host_to_win(&pProperties_host, pProperties);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkGetPhysicalDeviceProperties]);
 #else
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %p\n", physicalDevice, pProperties);
+    wine_vk_profile_begin(&timer);
     physicalDevice->instance->funcs.p_vkGetPhysicalDeviceProperties(physicalDevice->phys_dev, pProperties);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkGetPhysicalDeviceProperties]);
 #endif
 }
 
 static void WINAPI wine_vkGetPhysicalDeviceProperties2KHR(VkPhysicalDevice physicalDevice, VkPhysicalDeviceProperties2KHR *pProperties)
 {
 #if defined(USE_STRUCT_CONVERSION)
+    struct wine_vk_profile_timer timer;
     VkPhysicalDeviceProperties2KHR_host pProperties_host;
     TRACE("%p, %p\n", physicalDevice, pProperties);
+    wine_vk_profile_begin(&timer);
 
     convert_VkPhysicalDeviceProperties2KHR_win_to_host(pProperties, &pProperties_host);
+    wine_vk_profile_host_begin(&timer);
     physicalDevice->instance->funcs.p_vkGetPhysicalDeviceProperties2KHR(physicalDevice->phys_dev, &pProperties_host);
+    wine_vk_profile_host_end(&timer);
 
     convert_VkPhysicalDeviceProperties2KHR_host_to_win(&pProperties_host, pProperties);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkGetPhysicalDeviceProperties2KHR]);
 #else
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %p\n", physicalDevice, pProperties);
+    wine_vk_profile_begin(&timer);
     physicalDevice->instance->funcs.p_vkGetPhysicalDeviceProperties2KHR(physicalDevice->phys_dev, pProperties);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkGetPhysicalDeviceProperties2KHR]);
 #endif
 }
 
 static void WINAPI wine_vkGetPhysicalDeviceQueueFamilyProperties(VkPhysicalDevice physicalDevice, uint32_t *pQueueFamilyPropertyCount, VkQueueFamilyProperties *pQueueFamilyProperties)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %p, %p\n", physicalDevice, pQueueFamilyPropertyCount, pQueueFamilyProperties);
+    wine_vk_profile_begin(&timer);
     physicalDevice->instance->funcs.p_vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice->phys_dev, pQueueFamilyPropertyCount, pQueueFamilyProperties);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkGetPhysicalDeviceQueueFamilyProperties]);
 }
 
 static void WINAPI wine_vkGetPhysicalDeviceQueueFamilyProperties2KHR(VkPhysicalDevice physicalDevice, uint32_t *pQueueFamilyPropertyCount, VkQueueFamilyProperties2KHR *pQueueFamilyProperties)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %p, %p\n", physicalDevice, pQueueFamilyPropertyCount, pQueueFamilyProperties);
+    wine_vk_profile_begin(&timer);
     physicalDevice->instance->funcs.p_vkGetPhysicalDeviceQueueFamilyProperties2KHR(physicalDevice->phys_dev, pQueueFamilyPropertyCount, pQueueFamilyProperties);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkGetPhysicalDeviceQueueFamilyProperties2KHR]);
 }
 
 static void WINAPI wine_vkGetPhysicalDeviceSparseImageFormatProperties(VkPhysicalDevice physicalDevice, VkFormat format, VkImageType type, VkSampleCountFlagBits samples, VkImageUsageFlags usage, VkImageTiling tiling, uint32_t *pPropertyCount, VkSparseImageFormatProperties *pProperties)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %d, %d, %d, %#x, %d, %p, %p\n", physicalDevice, format, type, samples, usage, tiling, pPropertyCount, pProperties);
+    wine_vk_profile_begin(&timer);
     physicalDevice->instance->funcs.p_vkGetPhysicalDeviceSparseImageFormatProperties(physicalDevice->phys_dev, format, type, samples, usage, tiling, pPropertyCount, pProperties);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkGetPhysicalDeviceSparseImageFormatProperties]);
 }
 
 static void WINAPI wine_vkGetPhysicalDeviceSparseImageFormatProperties2KHR(VkPhysicalDevice physicalDevice, const VkPhysicalDeviceSparseImageFormatInfo2KHR *pFormatInfo, uint32_t *pPropertyCount, VkSparseImageFormatProperties2KHR *pProperties)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %p, %p, %p\n", physicalDevice, pFormatInfo, pPropertyCount, pProperties);
+    wine_vk_profile_begin(&timer);
     physicalDevice->instance->funcs.p_vkGetPhysicalDeviceSparseImageFormatProperties2KHR(physicalDevice->phys_dev, pFormatInfo, pPropertyCount, pProperties);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkGetPhysicalDeviceSparseImageFormatProperties2KHR]);
 }
 
 static VkResult WINAPI wine_vkGetPipelineCacheData(VkDevice device, VkPipelineCache pipelineCache, size_t *pDataSize, void *pData)
 {
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %p, %p\n", device, wine_dbgstr_longlong(pipelineCache), pDataSize, pData);
-    return device->funcs.p_vkGetPipelineCacheData(device->device, pipelineCache, pDataSize, pData);
+    wine_vk_profile_begin(&timer);
+    result = device->funcs.p_vkGetPipelineCacheData(device->device, pipelineCache, pDataSize, pData);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkGetPipelineCacheData]);
+    return result;
 }
 
 static VkResult WINAPI wine_vkGetQueryPoolResults(VkDevice device, VkQueryPool queryPool, uint32_t firstQuery, uint32_t queryCount, size_t dataSize, void *pData, VkDeviceSize stride, VkQueryResultFlags flags)
 {
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %u, %u, 0x%s, %p, 0x%s, %#x\n", device, wine_dbgstr_longlong(queryPool), firstQuery, queryCount, wine_dbgstr_longlong(dataSize), pData, wine_dbgstr_longlong(stride), flags);
-    return device->funcs.p_vkGetQueryPoolResults(device->device, queryPool, firstQuery, queryCount, dataSize, pData, stride, flags);
+    wine_vk_profile_begin(&timer);
+    wine_vk_device_flush_submits(device);
+    result = device->funcs.p_vkGetQueryPoolResults(device->device, queryPool, firstQuery, queryCount, dataSize, pData, stride, flags);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkGetQueryPoolResults]);
+    return result;
 }
 
 static void WINAPI wine_vkGetRenderAreaGranularity(VkDevice device, VkRenderPass renderPass, VkExtent2D *pGranularity)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %p\n", device, wine_dbgstr_longlong(renderPass), pGranularity);
+    wine_vk_profile_begin(&timer);
     device->funcs.p_vkGetRenderAreaGranularity(device->device, renderPass, pGranularity);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkGetRenderAreaGranularity]);
 }
 
 static VkResult WINAPI wine_vkInvalidateMappedMemoryRanges(VkDevice device, uint32_t memoryRangeCount, const VkMappedMemoryRange *pMemoryRanges)
 {
-#if defined(USE_STRUCT_CONVERSION)
     VkResult result;
-    VkMappedMemoryRange_host *pMemoryRanges_host;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %u, %p\n", device, memoryRangeCount, pMemoryRanges);
-
-    pMemoryRanges_host = convert_VkMappedMemoryRange_array_win_to_host(pMemoryRanges, memoryRangeCount);
-    result = device->funcs.p_vkInvalidateMappedMemoryRanges(device->device, memoryRangeCount, pMemoryRanges_host);
-
-    free_VkMappedMemoryRange_array(pMemoryRanges_host, memoryRangeCount);
+    wine_vk_profile_begin(&timer);
+    result = device->funcs.p_vkInvalidateMappedMemoryRanges(device->device, memoryRangeCount, pMemoryRanges);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkInvalidateMappedMemoryRanges]);
     return result;
-#else
-    TRACE("%p, %u, %p\n", device, memoryRangeCount, pMemoryRanges);
-    return device->funcs.p_vkInvalidateMappedMemoryRanges(device->device, memoryRangeCount, pMemoryRanges);
-#endif
 }
 
 static VkResult WINAPI wine_vkMapMemory(VkDevice device, VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize size, VkMemoryMapFlags flags, void **ppData)
 {
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, 0x%s, 0x%s, %#x, %p\n", device, wine_dbgstr_longlong(memory), wine_dbgstr_longlong(offset), wine_dbgstr_longlong(size), flags, ppData);
-    return device->funcs.p_vkMapMemory(device->device, memory, offset, size, flags, ppData);
+    wine_vk_profile_begin(&timer);
+    result = device->funcs.p_vkMapMemory(device->device, memory, offset, size, flags, ppData);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkMapMemory]);
+    return result;
 }
 
 static VkResult WINAPI wine_vkMergePipelineCaches(VkDevice device, VkPipelineCache dstCache, uint32_t srcCacheCount, const VkPipelineCache *pSrcCaches)
 {
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %u, %p\n", device, wine_dbgstr_longlong(dstCache), srcCacheCount, pSrcCaches);
-    return device->funcs.p_vkMergePipelineCaches(device->device, dstCache, srcCacheCount, pSrcCaches);
+    wine_vk_profile_begin(&timer);
+    result = device->funcs.p_vkMergePipelineCaches(device->device, dstCache, srcCacheCount, pSrcCaches);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkMergePipelineCaches]);
+    return result;
 }
 
 static VkResult WINAPI wine_vkQueueBindSparse(VkQueue queue, uint32_t bindInfoCount, const VkBindSparseInfo *pBindInfo, VkFence fence)
 {
 #if defined(USE_STRUCT_CONVERSION)
     VkResult result;
+    struct wine_vk_arena *arena;
+    struct wine_vk_profile_timer timer;
     VkBindSparseInfo_host *pBindInfo_host;
     TRACE("%p, %u, %p, 0x%s\n", queue, bindInfoCount, pBindInfo, wine_dbgstr_longlong(fence));
+    if (!(arena = wine_vk_get_thread_arena())) return VK_ERROR_OUT_OF_HOST_MEMORY;
+    wine_vk_profile_begin(&timer);
+    wine_vk_queue_flush_submits(queue);
 
-    pBindInfo_host = convert_VkBindSparseInfo_array_win_to_host(pBindInfo, bindInfoCount);
+    if (!(pBindInfo_host = convert_VkBindSparseInfo_array_win_to_host(pBindInfo, bindInfoCount, arena)) && pBindInfo)
+    {
+        result = VK_ERROR_OUT_OF_HOST_MEMORY;
+        goto done;
+    }
+    wine_vk_profile_host_begin(&timer);
     result = queue->device->funcs.p_vkQueueBindSparse(queue->queue, bindInfoCount, pBindInfo_host, fence);
+    wine_vk_profile_host_end(&timer);
 
-    free_VkBindSparseInfo_array(pBindInfo_host, bindInfoCount);
+done:
+    wine_vk_arena_reset(arena);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkQueueBindSparse]);
     return result;
 #else
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %u, %p, 0x%s\n", queue, bindInfoCount, pBindInfo, wine_dbgstr_longlong(fence));
-    return queue->device->funcs.p_vkQueueBindSparse(queue->queue, bindInfoCount, pBindInfo, fence);
+    wine_vk_profile_begin(&timer);
+    wine_vk_queue_flush_submits(queue);
+    result = queue->device->funcs.p_vkQueueBindSparse(queue->queue, bindInfoCount, pBindInfo, fence);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkQueueBindSparse]);
+    return result;
 #endif
 }
 
 static VkResult WINAPI wine_vkQueueWaitIdle(VkQueue queue)
 {
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p\n", queue);
-    return queue->device->funcs.p_vkQueueWaitIdle(queue->queue);
+    wine_vk_profile_begin(&timer);
+    wine_vk_queue_flush_submits(queue);
+    result = queue->device->funcs.p_vkQueueWaitIdle(queue->queue);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkQueueWaitIdle]);
+    return result;
 }
 
 static VkResult WINAPI wine_vkResetCommandBuffer(VkCommandBuffer commandBuffer, VkCommandBufferResetFlags flags)
 {
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %#x\n", commandBuffer, flags);
-    return commandBuffer->device->funcs.p_vkResetCommandBuffer(commandBuffer->command_buffer, flags);
-}
-
-static VkResult WINAPI wine_vkResetCommandPool(VkDevice device, VkCommandPool commandPool, VkCommandPoolResetFlags flags)
-{
-    TRACE("%p, 0x%s, %#x\n", device, wine_dbgstr_longlong(commandPool), flags);
-    return device->funcs.p_vkResetCommandPool(device->device, commandPool, flags);
+    wine_vk_profile_begin(&timer);
+#if defined(USE_STRUCT_CONVERSION)
+    wine_vk_arena_reset(&commandBuffer->arena);
+#endif
+    result = commandBuffer->device->funcs.p_vkResetCommandBuffer(commandBuffer->command_buffer, flags);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkResetCommandBuffer]);
+    return result;
 }
 
 static VkResult WINAPI wine_vkResetDescriptorPool(VkDevice device, VkDescriptorPool descriptorPool, VkDescriptorPoolResetFlags flags)
 {
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %#x\n", device, wine_dbgstr_longlong(descriptorPool), flags);
-    return device->funcs.p_vkResetDescriptorPool(device->device, descriptorPool, flags);
+    wine_vk_profile_begin(&timer);
+    result = device->funcs.p_vkResetDescriptorPool(device->device, descriptorPool, flags);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkResetDescriptorPool]);
+    return result;
 }
 
 static VkResult WINAPI wine_vkResetEvent(VkDevice device, VkEvent event)
 {
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s\n", device, wine_dbgstr_longlong(event));
-    return device->funcs.p_vkResetEvent(device->device, event);
+    wine_vk_profile_begin(&timer);
+    result = device->funcs.p_vkResetEvent(device->device, event);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkResetEvent]);
+    return result;
 }
 
 static VkResult WINAPI wine_vkResetFences(VkDevice device, uint32_t fenceCount, const VkFence *pFences)
 {
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %u, %p\n", device, fenceCount, pFences);
-    return device->funcs.p_vkResetFences(device->device, fenceCount, pFences);
+    wine_vk_profile_begin(&timer);
+    result = device->funcs.p_vkResetFences(device->device, fenceCount, pFences);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkResetFences]);
+    return result;
 }
 
 static VkResult WINAPI wine_vkSetEvent(VkDevice device, VkEvent event)
 {
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s\n", device, wine_dbgstr_longlong(event));
-    return device->funcs.p_vkSetEvent(device->device, event);
+    wine_vk_profile_begin(&timer);
+    result = device->funcs.p_vkSetEvent(device->device, event);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkSetEvent]);
+    return result;
 }
 
 static void WINAPI wine_vkSetHdrMetadataEXT(VkDevice device, uint32_t swapchainCount, const VkSwapchainKHR *pSwapchains, const VkHdrMetadataEXT *pMetadata)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %u, %p, %p\n", device, swapchainCount, pSwapchains, pMetadata);
+    wine_vk_profile_begin(&timer);
     device->funcs.p_vkSetHdrMetadataEXT(device->device, swapchainCount, pSwapchains, pMetadata);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkSetHdrMetadataEXT]);
 }
 
 static void WINAPI wine_vkTrimCommandPoolKHR(VkDevice device, VkCommandPool commandPool, VkCommandPoolTrimFlagsKHR flags)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, %#x\n", device, wine_dbgstr_longlong(commandPool), flags);
+    wine_vk_profile_begin(&timer);
     device->funcs.p_vkTrimCommandPoolKHR(device->device, commandPool, flags);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkTrimCommandPoolKHR]);
 }
 
 static void WINAPI wine_vkUnmapMemory(VkDevice device, VkDeviceMemory memory)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s\n", device, wine_dbgstr_longlong(memory));
+    wine_vk_profile_begin(&timer);
     device->funcs.p_vkUnmapMemory(device->device, memory);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkUnmapMemory]);
 }
 
 static void WINAPI wine_vkUpdateDescriptorSetWithTemplateKHR(VkDevice device, VkDescriptorSet descriptorSet, VkDescriptorUpdateTemplateKHR descriptorUpdateTemplate, const void *pData)
 {
+    struct wine_vk_profile_timer timer;
     TRACE("%p, 0x%s, 0x%s, %p\n", device, wine_dbgstr_longlong(descriptorSet), wine_dbgstr_longlong(descriptorUpdateTemplate), pData);
+    wine_vk_profile_begin(&timer);
     device->funcs.p_vkUpdateDescriptorSetWithTemplateKHR(device->device, descriptorSet, descriptorUpdateTemplate, pData);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkUpdateDescriptorSetWithTemplateKHR]);
 }
 
 static void WINAPI wine_vkUpdateDescriptorSets(VkDevice device, uint32_t descriptorWriteCount, const VkWriteDescriptorSet *pDescriptorWrites, uint32_t descriptorCopyCount, const VkCopyDescriptorSet *pDescriptorCopies)
 {
 #if defined(USE_STRUCT_CONVERSION)
+    struct wine_vk_arena *arena;
+    struct wine_vk_profile_timer timer;
     VkWriteDescriptorSet_host *pDescriptorWrites_host;
     VkCopyDescriptorSet_host *pDescriptorCopies_host;
     TRACE("%p, %u, %p, %u, %p\n", device, descriptorWriteCount, pDescriptorWrites, descriptorCopyCount, pDescriptorCopies);
-
-    pDescriptorWrites_host = convert_VkWriteDescriptorSet_array_win_to_host(pDescriptorWrites, descriptorWriteCount);
-    pDescriptorCopies_host = convert_VkCopyDescriptorSet_array_win_to_host(pDescriptorCopies, descriptorCopyCount);
+    if (!(arena = wine_vk_get_thread_arena())) return;
+    wine_vk_profile_begin(&timer);
+
+    if (!(pDescriptorWrites_host = convert_VkWriteDescriptorSet_array_win_to_host(pDescriptorWrites, descriptorWriteCount, arena)) && pDescriptorWrites)
+        goto done;
+    if (!(pDescriptorCopies_host = convert_VkCopyDescriptorSet_array_win_to_host(pDescriptorCopies, descriptorCopyCount, arena)) && pDescriptorCopies)
+        goto done;
+    wine_vk_profile_host_begin(&timer);
     device->funcs.p_vkUpdateDescriptorSets(device->device, descriptorWriteCount, pDescriptorWrites_host, descriptorCopyCount, pDescriptorCopies_host);
+    wine_vk_profile_host_end(&timer);
 
-    free_VkWriteDescriptorSet_array(pDescriptorWrites_host, descriptorWriteCount);
-    free_VkCopyDescriptorSet_array(pDescriptorCopies_host, descriptorCopyCount);
+done:
+    wine_vk_arena_reset(arena);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkUpdateDescriptorSets]);
 #else
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %u, %p, %u, %p\n", device, descriptorWriteCount, pDescriptorWrites, descriptorCopyCount, pDescriptorCopies);
+    wine_vk_profile_begin(&timer);
     device->funcs.p_vkUpdateDescriptorSets(device->device, descriptorWriteCount, pDescriptorWrites, descriptorCopyCount, pDescriptorCopies);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkUpdateDescriptorSets]);
 #endif
 }
 
 static VkResult WINAPI wine_vkWaitForFences(VkDevice device, uint32_t fenceCount, const VkFence *pFences, VkBool32 waitAll, uint64_t timeout)
 {
+    VkResult result;
+    struct wine_vk_profile_timer timer;
     TRACE("%p, %u, %p, %u, 0x%s\n", device, fenceCount, pFences, waitAll, wine_dbgstr_longlong(timeout));
-    return device->funcs.p_vkWaitForFences(device->device, fenceCount, pFences, waitAll, timeout);
+    wine_vk_profile_begin(&timer);
+    wine_vk_device_flush_submits(device);
+    result = device->funcs.p_vkWaitForFences(device->device, fenceCount, pFences, waitAll, timeout);
+    wine_vk_profile_end(&timer, &vk_profile_counters[WINE_VK_PROFILE_vkWaitForFences]);
+    return result;
 }
 
-static const struct vulkan_func vk_device_dispatch_table[] =
+static VkResult WINAPI wine_fast_vkAllocateDescriptorSets(VkDevice device, const VkDescriptorSetAllocateInfo *pAllocateInfo, VkDescriptorSet *pDescriptorSets)
 {
-    {"vkAcquireNextImageKHR", &wine_vkAcquireNextImageKHR},
-    {"vkAllocateCommandBuffers", &wine_vkAllocateCommandBuffers},
-    {"vkAllocateDescriptorSets", &wine_vkAllocateDescriptorSets},
-    {"vkAllocateMemory", &wine_vkAllocateMemory},
-    {"vkBeginCommandBuffer", &wine_vkBeginCommandBuffer},
-    {"vkBindBufferMemory", &wine_vkBindBufferMemory},
-    {"vkBindImageMemory", &wine_vkBindImageMemory},
-    {"vkCmdBeginQuery", &wine_vkCmdBeginQuery},
-    {"vkCmdBeginRenderPass", &wine_vkCmdBeginRenderPass},
+    return device->funcs.p_vkAllocateDescriptorSets(device->device, pAllocateInfo, pDescriptorSets);
+}
+
+static VkResult WINAPI wine_fast_vkBindBufferMemory(VkDevice device, VkBuffer buffer, VkDeviceMemory memory, VkDeviceSize memoryOffset)
+{
+    return device->funcs.p_vkBindBufferMemory(device->device, buffer, memory, memoryOffset);
+}
+
+static VkResult WINAPI wine_fast_vkBindImageMemory(VkDevice device, VkImage image, VkDeviceMemory memory, VkDeviceSize memoryOffset)
+{
+    return device->funcs.p_vkBindImageMemory(device->device, image, memory, memoryOffset);
+}
+
+static void WINAPI wine_fast_vkCmdBeginQuery(VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32_t query, VkQueryControlFlags flags)
+{
+    commandBuffer->device->funcs.p_vkCmdBeginQuery(commandBuffer->command_buffer, queryPool, query, flags);
+}
+
+static void WINAPI wine_fast_vkCmdBeginRenderPass(VkCommandBuffer commandBuffer, const VkRenderPassBeginInfo *pRenderPassBegin, VkSubpassContents contents)
+{
+    commandBuffer->device->funcs.p_vkCmdBeginRenderPass(commandBuffer->command_buffer, pRenderPassBegin, contents);
+}
+
+static void WINAPI wine_fast_vkCmdBindDescriptorSets(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout, uint32_t firstSet, uint32_t descriptorSetCount, const VkDescriptorSet *pDescriptorSets, uint32_t dynamicOffsetCount, const uint32_t *pDynamicOffsets)
+{
+    commandBuffer->device->funcs.p_vkCmdBindDescriptorSets(commandBuffer->command_buffer, pipelineBindPoint, layout, firstSet, descriptorSetCount, pDescriptorSets, dynamicOffsetCount, pDynamicOffsets);
+}
+
+static void WINAPI wine_fast_vkCmdBindIndexBuffer(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType)
+{
+    commandBuffer->device->funcs.p_vkCmdBindIndexBuffer(commandBuffer->command_buffer, buffer, offset, indexType);
+}
+
+static void WINAPI wine_fast_vkCmdBindPipeline(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipeline pipeline)
+{
+    commandBuffer->device->funcs.p_vkCmdBindPipeline(commandBuffer->command_buffer, pipelineBindPoint, pipeline);
+}
+
+static void WINAPI wine_fast_vkCmdBindVertexBuffers(VkCommandBuffer commandBuffer, uint32_t firstBinding, uint32_t bindingCount, const VkBuffer *pBuffers, const VkDeviceSize *pOffsets)
+{
+    commandBuffer->device->funcs.p_vkCmdBindVertexBuffers(commandBuffer->command_buffer, firstBinding, bindingCount, pBuffers, pOffsets);
+}
+
+static void WINAPI wine_fast_vkCmdBlitImage(VkCommandBuffer commandBuffer, VkImage srcImage, VkImageLayout srcImageLayout, VkImage dstImage, VkImageLayout dstImageLayout, uint32_t regionCount, const VkImageBlit *pRegions, VkFilter filter)
+{
+    commandBuffer->device->funcs.p_vkCmdBlitImage(commandBuffer->command_buffer, srcImage, srcImageLayout, dstImage, dstImageLayout, regionCount, pRegions, filter);
+}
+
+static void WINAPI wine_fast_vkCmdClearAttachments(VkCommandBuffer commandBuffer, uint32_t attachmentCount, const VkClearAttachment *pAttachments, uint32_t rectCount, const VkClearRect *pRects)
+{
+    commandBuffer->device->funcs.p_vkCmdClearAttachments(commandBuffer->command_buffer, attachmentCount, pAttachments, rectCount, pRects);
+}
+
+static void WINAPI wine_fast_vkCmdClearColorImage(VkCommandBuffer commandBuffer, VkImage image, VkImageLayout imageLayout, const VkClearColorValue *pColor, uint32_t rangeCount, const VkImageSubresourceRange *pRanges)
+{
+    commandBuffer->device->funcs.p_vkCmdClearColorImage(commandBuffer->command_buffer, image, imageLayout, pColor, rangeCount, pRanges);
+}
+
+static void WINAPI wine_fast_vkCmdClearDepthStencilImage(VkCommandBuffer commandBuffer, VkImage image, VkImageLayout imageLayout, const VkClearDepthStencilValue *pDepthStencil, uint32_t rangeCount, const VkImageSubresourceRange *pRanges)
+{
+    commandBuffer->device->funcs.p_vkCmdClearDepthStencilImage(commandBuffer->command_buffer, image, imageLayout, pDepthStencil, rangeCount, pRanges);
+}
+
+static void WINAPI wine_fast_vkCmdCopyBuffer(VkCommandBuffer commandBuffer, VkBuffer srcBuffer, VkBuffer dstBuffer, uint32_t regionCount, const VkBufferCopy *pRegions)
+{
+    commandBuffer->device->funcs.p_vkCmdCopyBuffer(commandBuffer->command_buffer, srcBuffer, dstBuffer, regionCount, pRegions);
+}
+
+static void WINAPI wine_fast_vkCmdCopyBufferToImage(VkCommandBuffer commandBuffer, VkBuffer srcBuffer, VkImage dstImage, VkImageLayout dstImageLayout, uint32_t regionCount, const VkBufferImageCopy *pRegions)
+{
+    commandBuffer->device->funcs.p_vkCmdCopyBufferToImage(commandBuffer->command_buffer, srcBuffer, dstImage, dstImageLayout, regionCount, pRegions);
+}
+
+static void WINAPI wine_fast_vkCmdCopyImage(VkCommandBuffer commandBuffer, VkImage srcImage, VkImageLayout srcImageLayout, VkImage dstImage, VkImageLayout dstImageLayout, uint32_t regionCount, const VkImageCopy *pRegions)
+{
+    commandBuffer->device->funcs.p_vkCmdCopyImage(commandBuffer->command_buffer, srcImage, srcImageLayout, dstImage, dstImageLayout, regionCount, pRegions);
+}
+
+static void WINAPI wine_fast_vkCmdCopyImageToBuffer(VkCommandBuffer commandBuffer, VkImage srcImage, VkImageLayout srcImageLayout, VkBuffer dstBuffer, uint32_t regionCount, const VkBufferImageCopy *pRegions)
+{
+    commandBuffer->device->funcs.p_vkCmdCopyImageToBuffer(commandBuffer->command_buffer, srcImage, srcImageLayout, dstBuffer, regionCount, pRegions);
+}
+
+static void WINAPI wine_fast_vkCmdCopyQueryPoolResults(VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32_t firstQuery, uint32_t queryCount, VkBuffer dstBuffer, VkDeviceSize dstOffset, VkDeviceSize stride, VkQueryResultFlags flags)
+{
+    commandBuffer->device->funcs.p_vkCmdCopyQueryPoolResults(commandBuffer->command_buffer, queryPool, firstQuery, queryCount, dstBuffer, dstOffset, stride, flags);
+}
+
+static void WINAPI wine_fast_vkCmdDispatch(VkCommandBuffer commandBuffer, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+{
+    commandBuffer->device->funcs.p_vkCmdDispatch(commandBuffer->command_buffer, groupCountX, groupCountY, groupCountZ);
+}
+
+static void WINAPI wine_fast_vkCmdDispatchIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset)
+{
+    commandBuffer->device->funcs.p_vkCmdDispatchIndirect(commandBuffer->command_buffer, buffer, offset);
+}
+
+static void WINAPI wine_fast_vkCmdDraw(VkCommandBuffer commandBuffer, uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance)
+{
+    commandBuffer->device->funcs.p_vkCmdDraw(commandBuffer->command_buffer, vertexCount, instanceCount, firstVertex, firstInstance);
+}
+
+static void WINAPI wine_fast_vkCmdDrawIndexed(VkCommandBuffer commandBuffer, uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance)
+{
+    commandBuffer->device->funcs.p_vkCmdDrawIndexed(commandBuffer->command_buffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+}
+
+static void WINAPI wine_fast_vkCmdDrawIndexedIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride)
+{
+    commandBuffer->device->funcs.p_vkCmdDrawIndexedIndirect(commandBuffer->command_buffer, buffer, offset, drawCount, stride);
+}
+
+static void WINAPI wine_fast_vkCmdDrawIndexedIndirectCountAMD(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkBuffer countBuffer, VkDeviceSize countBufferOffset, uint32_t maxDrawCount, uint32_t stride)
+{
+    commandBuffer->device->funcs.p_vkCmdDrawIndexedIndirectCountAMD(commandBuffer->command_buffer, buffer, offset, countBuffer, countBufferOffset, maxDrawCount, stride);
+}
+
+static void WINAPI wine_fast_vkCmdDrawIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride)
+{
+    commandBuffer->device->funcs.p_vkCmdDrawIndirect(commandBuffer->command_buffer, buffer, offset, drawCount, stride);
+}
+
+static void WINAPI wine_fast_vkCmdDrawIndirectCountAMD(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkBuffer countBuffer, VkDeviceSize countBufferOffset, uint32_t maxDrawCount, uint32_t stride)
+{
+    commandBuffer->device->funcs.p_vkCmdDrawIndirectCountAMD(commandBuffer->command_buffer, buffer, offset, countBuffer, countBufferOffset, maxDrawCount, stride);
+}
+
+static void WINAPI wine_fast_vkCmdEndQuery(VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32_t query)
+{
+    commandBuffer->device->funcs.p_vkCmdEndQuery(commandBuffer->command_buffer, queryPool, query);
+}
+
+static void WINAPI wine_fast_vkCmdEndRenderPass(VkCommandBuffer commandBuffer)
+{
+    commandBuffer->device->funcs.p_vkCmdEndRenderPass(commandBuffer->command_buffer);
+}
+
+static void WINAPI wine_fast_vkCmdFillBuffer(VkCommandBuffer commandBuffer, VkBuffer dstBuffer, VkDeviceSize dstOffset, VkDeviceSize size, uint32_t data)
+{
+    commandBuffer->device->funcs.p_vkCmdFillBuffer(commandBuffer->command_buffer, dstBuffer, dstOffset, size, data);
+}
+
+static void WINAPI wine_fast_vkCmdNextSubpass(VkCommandBuffer commandBuffer, VkSubpassContents contents)
+{
+    commandBuffer->device->funcs.p_vkCmdNextSubpass(commandBuffer->command_buffer, contents);
+}
+
+static void WINAPI wine_fast_vkCmdPushConstants(VkCommandBuffer commandBuffer, VkPipelineLayout layout, VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size, const void *pValues)
+{
+    commandBuffer->device->funcs.p_vkCmdPushConstants(commandBuffer->command_buffer, layout, stageFlags, offset, size, pValues);
+}
+
+static void WINAPI wine_fast_vkCmdPushDescriptorSetWithTemplateKHR(VkCommandBuffer commandBuffer, VkDescriptorUpdateTemplateKHR descriptorUpdateTemplate, VkPipelineLayout layout, uint32_t set, const void *pData)
+{
+    commandBuffer->device->funcs.p_vkCmdPushDescriptorSetWithTemplateKHR(commandBuffer->command_buffer, descriptorUpdateTemplate, layout, set, pData);
+}
+
+static void WINAPI wine_fast_vkCmdResetEvent(VkCommandBuffer commandBuffer, VkEvent event, VkPipelineStageFlags stageMask)
+{
+    commandBuffer->device->funcs.p_vkCmdResetEvent(commandBuffer->command_buffer, event, stageMask);
+}
+
+static void WINAPI wine_fast_vkCmdResetQueryPool(VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32_t firstQuery, uint32_t queryCount)
+{
+    commandBuffer->device->funcs.p_vkCmdResetQueryPool(commandBuffer->command_buffer, queryPool, firstQuery, queryCount);
+}
+
+static void WINAPI wine_fast_vkCmdResolveImage(VkCommandBuffer commandBuffer, VkImage srcImage, VkImageLayout srcImageLayout, VkImage dstImage, VkImageLayout dstImageLayout, uint32_t regionCount, const VkImageResolve *pRegions)
+{
+    commandBuffer->device->funcs.p_vkCmdResolveImage(commandBuffer->command_buffer, srcImage, srcImageLayout, dstImage, dstImageLayout, regionCount, pRegions);
+}
+
+static void WINAPI wine_fast_vkCmdSetBlendConstants(VkCommandBuffer commandBuffer, const float blendConstants[4])
+{
+    commandBuffer->device->funcs.p_vkCmdSetBlendConstants(commandBuffer->command_buffer, blendConstants);
+}
+
+static void WINAPI wine_fast_vkCmdSetDepthBias(VkCommandBuffer commandBuffer, float depthBiasConstantFactor, float depthBiasClamp, float depthBiasSlopeFactor)
+{
+    commandBuffer->device->funcs.p_vkCmdSetDepthBias(commandBuffer->command_buffer, depthBiasConstantFactor, depthBiasClamp, depthBiasSlopeFactor);
+}
+
+static void WINAPI wine_fast_vkCmdSetDepthBounds(VkCommandBuffer commandBuffer, float minDepthBounds, float maxDepthBounds)
+{
+    commandBuffer->device->funcs.p_vkCmdSetDepthBounds(commandBuffer->command_buffer, minDepthBounds, maxDepthBounds);
+}
+
+static void WINAPI wine_fast_vkCmdSetDiscardRectangleEXT(VkCommandBuffer commandBuffer, uint32_t firstDiscardRectangle, uint32_t discardRectangleCount, const VkRect2D *pDiscardRectangles)
+{
+    commandBuffer->device->funcs.p_vkCmdSetDiscardRectangleEXT(commandBuffer->command_buffer, firstDiscardRectangle, discardRectangleCount, pDiscardRectangles);
+}
+
+static void WINAPI wine_fast_vkCmdSetEvent(VkCommandBuffer commandBuffer, VkEvent event, VkPipelineStageFlags stageMask)
+{
+    commandBuffer->device->funcs.p_vkCmdSetEvent(commandBuffer->command_buffer, event, stageMask);
+}
+
+static void WINAPI wine_fast_vkCmdSetLineWidth(VkCommandBuffer commandBuffer, float lineWidth)
+{
+    commandBuffer->device->funcs.p_vkCmdSetLineWidth(commandBuffer->command_buffer, lineWidth);
+}
+
+static void WINAPI wine_fast_vkCmdSetScissor(VkCommandBuffer commandBuffer, uint32_t firstScissor, uint32_t scissorCount, const VkRect2D *pScissors)
+{
+    commandBuffer->device->funcs.p_vkCmdSetScissor(commandBuffer->command_buffer, firstScissor, scissorCount, pScissors);
+}
+
+static void WINAPI wine_fast_vkCmdSetStencilCompareMask(VkCommandBuffer commandBuffer, VkStencilFaceFlags faceMask, uint32_t compareMask)
+{
+    commandBuffer->device->funcs.p_vkCmdSetStencilCompareMask(commandBuffer->command_buffer, faceMask, compareMask);
+}
+
+static void WINAPI wine_fast_vkCmdSetStencilReference(VkCommandBuffer commandBuffer, VkStencilFaceFlags faceMask, uint32_t reference)
+{
+    commandBuffer->device->funcs.p_vkCmdSetStencilReference(commandBuffer->command_buffer, faceMask, reference);
+}
+
+static void WINAPI wine_fast_vkCmdSetStencilWriteMask(VkCommandBuffer commandBuffer, VkStencilFaceFlags faceMask, uint32_t writeMask)
+{
+    commandBuffer->device->funcs.p_vkCmdSetStencilWriteMask(commandBuffer->command_buffer, faceMask, writeMask);
+}
+
+static void WINAPI wine_fast_vkCmdSetViewport(VkCommandBuffer commandBuffer, uint32_t firstViewport, uint32_t viewportCount, const VkViewport *pViewports)
+{
+    commandBuffer->device->funcs.p_vkCmdSetViewport(commandBuffer->command_buffer, firstViewport, viewportCount, pViewports);
+}
+
+static void WINAPI wine_fast_vkCmdSetViewportWScalingNV(VkCommandBuffer commandBuffer, uint32_t firstViewport, uint32_t viewportCount, const VkViewportWScalingNV *pViewportWScalings)
+{
+    commandBuffer->device->funcs.p_vkCmdSetViewportWScalingNV(commandBuffer->command_buffer, firstViewport, viewportCount, pViewportWScalings);
+}
+
+static void WINAPI wine_fast_vkCmdUpdateBuffer(VkCommandBuffer commandBuffer, VkBuffer dstBuffer, VkDeviceSize dstOffset, VkDeviceSize dataSize, const void *pData)
+{
+    commandBuffer->device->funcs.p_vkCmdUpdateBuffer(commandBuffer->command_buffer, dstBuffer, dstOffset, dataSize, pData);
+}
+
+static void WINAPI wine_fast_vkCmdWriteTimestamp(VkCommandBuffer commandBuffer, VkPipelineStageFlagBits pipelineStage, VkQueryPool queryPool, uint32_t query)
+{
+    commandBuffer->device->funcs.p_vkCmdWriteTimestamp(commandBuffer->command_buffer, pipelineStage, queryPool, query);
+}
+
+static VkResult WINAPI wine_fast_vkCreateDescriptorPool(VkDevice device, const VkDescriptorPoolCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkDescriptorPool *pDescriptorPool)
+{
+    return device->funcs.p_vkCreateDescriptorPool(device->device, pCreateInfo, NULL, pDescriptorPool);
+}
+
+static VkResult WINAPI wine_fast_vkCreateDescriptorSetLayout(VkDevice device, const VkDescriptorSetLayoutCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkDescriptorSetLayout *pSetLayout)
+{
+    return device->funcs.p_vkCreateDescriptorSetLayout(device->device, pCreateInfo, NULL, pSetLayout);
+}
+
+static VkResult WINAPI wine_fast_vkCreateEvent(VkDevice device, const VkEventCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkEvent *pEvent)
+{
+    return device->funcs.p_vkCreateEvent(device->device, pCreateInfo, NULL, pEvent);
+}
+
+static VkResult WINAPI wine_fast_vkCreateFence(VkDevice device, const VkFenceCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkFence *pFence)
+{
+    return device->funcs.p_vkCreateFence(device->device, pCreateInfo, NULL, pFence);
+}
+
+static VkResult WINAPI wine_fast_vkCreateImage(VkDevice device, const VkImageCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkImage *pImage)
+{
+    return device->funcs.p_vkCreateImage(device->device, pCreateInfo, NULL, pImage);
+}
+
+static VkResult WINAPI wine_fast_vkCreatePipelineCache(VkDevice device, const VkPipelineCacheCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkPipelineCache *pPipelineCache)
+{
+    return device->funcs.p_vkCreatePipelineCache(device->device, pCreateInfo, NULL, pPipelineCache);
+}
+
+static VkResult WINAPI wine_fast_vkCreatePipelineLayout(VkDevice device, const VkPipelineLayoutCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkPipelineLayout *pPipelineLayout)
+{
+    return device->funcs.p_vkCreatePipelineLayout(device->device, pCreateInfo, NULL, pPipelineLayout);
+}
+
+static VkResult WINAPI wine_fast_vkCreateQueryPool(VkDevice device, const VkQueryPoolCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkQueryPool *pQueryPool)
+{
+    return device->funcs.p_vkCreateQueryPool(device->device, pCreateInfo, NULL, pQueryPool);
+}
+
+static VkResult WINAPI wine_fast_vkCreateRenderPass(VkDevice device, const VkRenderPassCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkRenderPass *pRenderPass)
+{
+    return device->funcs.p_vkCreateRenderPass(device->device, pCreateInfo, NULL, pRenderPass);
+}
+
+static VkResult WINAPI wine_fast_vkCreateSampler(VkDevice device, const VkSamplerCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkSampler *pSampler)
+{
+    return device->funcs.p_vkCreateSampler(device->device, pCreateInfo, NULL, pSampler);
+}
+
+static VkResult WINAPI wine_fast_vkCreateSemaphore(VkDevice device, const VkSemaphoreCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkSemaphore *pSemaphore)
+{
+    return device->funcs.p_vkCreateSemaphore(device->device, pCreateInfo, NULL, pSemaphore);
+}
+
+static VkResult WINAPI wine_fast_vkCreateShaderModule(VkDevice device, const VkShaderModuleCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkShaderModule *pShaderModule)
+{
+    return device->funcs.p_vkCreateShaderModule(device->device, pCreateInfo, NULL, pShaderModule);
+}
+
+static void WINAPI wine_fast_vkDestroyBuffer(VkDevice device, VkBuffer buffer, const VkAllocationCallbacks *pAllocator)
+{
+    device->funcs.p_vkDestroyBuffer(device->device, buffer, NULL);
+}
+
+static void WINAPI wine_fast_vkDestroyBufferView(VkDevice device, VkBufferView bufferView, const VkAllocationCallbacks *pAllocator)
+{
+    device->funcs.p_vkDestroyBufferView(device->device, bufferView, NULL);
+}
+
+static void WINAPI wine_fast_vkDestroyDescriptorPool(VkDevice device, VkDescriptorPool descriptorPool, const VkAllocationCallbacks *pAllocator)
+{
+    device->funcs.p_vkDestroyDescriptorPool(device->device, descriptorPool, NULL);
+}
+
+static void WINAPI wine_fast_vkDestroyDescriptorSetLayout(VkDevice device, VkDescriptorSetLayout descriptorSetLayout, const VkAllocationCallbacks *pAllocator)
+{
+    device->funcs.p_vkDestroyDescriptorSetLayout(device->device, descriptorSetLayout, NULL);
+}
+
+static void WINAPI wine_fast_vkDestroyDescriptorUpdateTemplateKHR(VkDevice device, VkDescriptorUpdateTemplateKHR descriptorUpdateTemplate, const VkAllocationCallbacks *pAllocator)
+{
+    device->funcs.p_vkDestroyDescriptorUpdateTemplateKHR(device->device, descriptorUpdateTemplate, NULL);
+}
+
+static void WINAPI wine_fast_vkDestroyEvent(VkDevice device, VkEvent event, const VkAllocationCallbacks *pAllocator)
+{
+    device->funcs.p_vkDestroyEvent(device->device, event, NULL);
+}
+
+static void WINAPI wine_fast_vkDestroyFence(VkDevice device, VkFence fence, const VkAllocationCallbacks *pAllocator)
+{
+    device->funcs.p_vkDestroyFence(device->device, fence, NULL);
+}
+
+static void WINAPI wine_fast_vkDestroyFramebuffer(VkDevice device, VkFramebuffer framebuffer, const VkAllocationCallbacks *pAllocator)
+{
+    device->funcs.p_vkDestroyFramebuffer(device->device, framebuffer, NULL);
+}
+
+static void WINAPI wine_fast_vkDestroyImage(VkDevice device, VkImage image, const VkAllocationCallbacks *pAllocator)
+{
+    device->funcs.p_vkDestroyImage(device->device, image, NULL);
+}
+
+static void WINAPI wine_fast_vkDestroyImageView(VkDevice device, VkImageView imageView, const VkAllocationCallbacks *pAllocator)
+{
+    device->funcs.p_vkDestroyImageView(device->device, imageView, NULL);
+}
+
+static void WINAPI wine_fast_vkDestroyPipeline(VkDevice device, VkPipeline pipeline, const VkAllocationCallbacks *pAllocator)
+{
+    device->funcs.p_vkDestroyPipeline(device->device, pipeline, NULL);
+}
+
+static void WINAPI wine_fast_vkDestroyPipelineCache(VkDevice device, VkPipelineCache pipelineCache, const VkAllocationCallbacks *pAllocator)
+{
+    device->funcs.p_vkDestroyPipelineCache(device->device, pipelineCache, NULL);
+}
+
+static void WINAPI wine_fast_vkDestroyPipelineLayout(VkDevice device, VkPipelineLayout pipelineLayout, const VkAllocationCallbacks *pAllocator)
+{
+    device->funcs.p_vkDestroyPipelineLayout(device->device, pipelineLayout, NULL);
+}
+
+static void WINAPI wine_fast_vkDestroyQueryPool(VkDevice device, VkQueryPool queryPool, const VkAllocationCallbacks *pAllocator)
+{
+    device->funcs.p_vkDestroyQueryPool(device->device, queryPool, NULL);
+}
+
+static void WINAPI wine_fast_vkDestroyRenderPass(VkDevice device, VkRenderPass renderPass, const VkAllocationCallbacks *pAllocator)
+{
+    device->funcs.p_vkDestroyRenderPass(device->device, renderPass, NULL);
+}
+
+static void WINAPI wine_fast_vkDestroySampler(VkDevice device, VkSampler sampler, const VkAllocationCallbacks *pAllocator)
+{
+    device->funcs.p_vkDestroySampler(device->device, sampler, NULL);
+}
+
+static void WINAPI wine_fast_vkDestroySemaphore(VkDevice device, VkSemaphore semaphore, const VkAllocationCallbacks *pAllocator)
+{
+    device->funcs.p_vkDestroySemaphore(device->device, semaphore, NULL);
+}
+
+static void WINAPI wine_fast_vkDestroyShaderModule(VkDevice device, VkShaderModule shaderModule, const VkAllocationCallbacks *pAllocator)
+{
+    device->funcs.p_vkDestroyShaderModule(device->device, shaderModule, NULL);
+}
+
+static VkResult WINAPI wine_fast_vkEndCommandBuffer(VkCommandBuffer commandBuffer)
+{
+    return commandBuffer->device->funcs.p_vkEndCommandBuffer(commandBuffer->command_buffer);
+}
+
+static VkResult WINAPI wine_fast_vkFlushMappedMemoryRanges(VkDevice device, uint32_t memoryRangeCount, const VkMappedMemoryRange *pMemoryRanges)
+{
+    return device->funcs.p_vkFlushMappedMemoryRanges(device->device, memoryRangeCount, pMemoryRanges);
+}
+
+static VkResult WINAPI wine_fast_vkFreeDescriptorSets(VkDevice device, VkDescriptorPool descriptorPool, uint32_t descriptorSetCount, const VkDescriptorSet *pDescriptorSets)
+{
+    return device->funcs.p_vkFreeDescriptorSets(device->device, descriptorPool, descriptorSetCount, pDescriptorSets);
+}
+
+static void WINAPI wine_fast_vkFreeMemory(VkDevice device, VkDeviceMemory memory, const VkAllocationCallbacks *pAllocator)
+{
+    device->funcs.p_vkFreeMemory(device->device, memory, NULL);
+}
+
+static void WINAPI wine_fast_vkGetDeviceMemoryCommitment(VkDevice device, VkDeviceMemory memory, VkDeviceSize *pCommittedMemoryInBytes)
+{
+    device->funcs.p_vkGetDeviceMemoryCommitment(device->device, memory, pCommittedMemoryInBytes);
+}
+
+static VkResult WINAPI wine_fast_vkGetFenceStatus(VkDevice device, VkFence fence)
+{
+    return device->funcs.p_vkGetFenceStatus(device->device, fence);
+}
+
+static void WINAPI wine_fast_vkGetImageSparseMemoryRequirements(VkDevice device, VkImage image, uint32_t *pSparseMemoryRequirementCount, VkSparseImageMemoryRequirements *pSparseMemoryRequirements)
+{
+    device->funcs.p_vkGetImageSparseMemoryRequirements(device->device, image, pSparseMemoryRequirementCount, pSparseMemoryRequirements);
+}
+
+static void WINAPI wine_fast_vkGetImageSubresourceLayout(VkDevice device, VkImage image, const VkImageSubresource *pSubresource, VkSubresourceLayout *pLayout)
+{
+    device->funcs.p_vkGetImageSubresourceLayout(device->device, image, pSubresource, pLayout);
+}
+
+static VkResult WINAPI wine_fast_vkGetPipelineCacheData(VkDevice device, VkPipelineCache pipelineCache, size_t *pDataSize, void *pData)
+{
+    return device->funcs.p_vkGetPipelineCacheData(device->device, pipelineCache, pDataSize, pData);
+}
+
+static void WINAPI wine_fast_vkGetRenderAreaGranularity(VkDevice device, VkRenderPass renderPass, VkExtent2D *pGranularity)
+{
+    device->funcs.p_vkGetRenderAreaGranularity(device->device, renderPass, pGranularity);
+}
+
+static VkResult WINAPI wine_fast_vkInvalidateMappedMemoryRanges(VkDevice device, uint32_t memoryRangeCount, const VkMappedMemoryRange *pMemoryRanges)
+{
+    return device->funcs.p_vkInvalidateMappedMemoryRanges(device->device, memoryRangeCount, pMemoryRanges);
+}
+
+static VkResult WINAPI wine_fast_vkMapMemory(VkDevice device, VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize size, VkMemoryMapFlags flags, void **ppData)
+{
+    return device->funcs.p_vkMapMemory(device->device, memory, offset, size, flags, ppData);
+}
+
+static VkResult WINAPI wine_fast_vkMergePipelineCaches(VkDevice device, VkPipelineCache dstCache, uint32_t srcCacheCount, const VkPipelineCache *pSrcCaches)
+{
+    return device->funcs.p_vkMergePipelineCaches(device->device, dstCache, srcCacheCount, pSrcCaches);
+}
+
+static VkResult WINAPI wine_fast_vkResetDescriptorPool(VkDevice device, VkDescriptorPool descriptorPool, VkDescriptorPoolResetFlags flags)
+{
+    return device->funcs.p_vkResetDescriptorPool(device->device, descriptorPool, flags);
+}
+
+static VkResult WINAPI wine_fast_vkResetEvent(VkDevice device, VkEvent event)
+{
+    return device->funcs.p_vkResetEvent(device->device, event);
+}
+
+static VkResult WINAPI wine_fast_vkResetFences(VkDevice device, uint32_t fenceCount, const VkFence *pFences)
+{
+    return device->funcs.p_vkResetFences(device->device, fenceCount, pFences);
+}
+
+static VkResult WINAPI wine_fast_vkSetEvent(VkDevice device, VkEvent event)
+{
+    return device->funcs.p_vkSetEvent(device->device, event);
+}
+
+static void WINAPI wine_fast_vkSetHdrMetadataEXT(VkDevice device, uint32_t swapchainCount, const VkSwapchainKHR *pSwapchains, const VkHdrMetadataEXT *pMetadata)
+{
+    device->funcs.p_vkSetHdrMetadataEXT(device->device, swapchainCount, pSwapchains, pMetadata);
+}
+
+static void WINAPI wine_fast_vkTrimCommandPoolKHR(VkDevice device, VkCommandPool commandPool, VkCommandPoolTrimFlagsKHR flags)
+{
+    device->funcs.p_vkTrimCommandPoolKHR(device->device, commandPool, flags);
+}
+
+static void WINAPI wine_fast_vkUnmapMemory(VkDevice device, VkDeviceMemory memory)
+{
+    device->funcs.p_vkUnmapMemory(device->device, memory);
+}
+
+static void WINAPI wine_fast_vkUpdateDescriptorSetWithTemplateKHR(VkDevice device, VkDescriptorSet descriptorSet, VkDescriptorUpdateTemplateKHR descriptorUpdateTemplate, const void *pData)
+{
+    device->funcs.p_vkUpdateDescriptorSetWithTemplateKHR(device->device, descriptorSet, descriptorUpdateTemplate, pData);
+}
+
+static const struct vulkan_func vk_device_dispatch_table[] =
+{
+    {"vkAcquireNextImageKHR", &wine_vkAcquireNextImageKHR},
+    {"vkAllocateCommandBuffers", &wine_vkAllocateCommandBuffers},
+    {"vkAllocateDescriptorSets", &wine_vkAllocateDescriptorSets},
+    {"vkAllocateMemory", &wine_vkAllocateMemory},
+    {"vkBeginCommandBuffer", &wine_vkBeginCommandBuffer},
+    {"vkBindBufferMemory", &wine_vkBindBufferMemory},
+    {"vkBindImageMemory", &wine_vkBindImageMemory},
+    {"vkCmdBeginQuery", &wine_vkCmdBeginQuery},
+    {"vkCmdBeginRenderPass", &wine_vkCmdBeginRenderPass},
     {"vkCmdBindDescriptorSets", &wine_vkCmdBindDescriptorSets},
     {"vkCmdBindIndexBuffer", &wine_vkCmdBindIndexBuffer},
     {"vkCmdBindPipeline", &wine_vkCmdBindPipeline},
@@ -2285,6 +3314,110 @@ static const struct vulkan_func vk_device_dispatch_table[] =
     {"vkWaitForFences", &wine_vkWaitForFences},
 };
 
+static const struct vulkan_func vk_device_fast_dispatch_table[] =
+{
+    {"vkAllocateDescriptorSets", &wine_fast_vkAllocateDescriptorSets},
+    {"vkBindBufferMemory", &wine_fast_vkBindBufferMemory},
+    {"vkBindImageMemory", &wine_fast_vkBindImageMemory},
+    {"vkCmdBeginQuery", &wine_fast_vkCmdBeginQuery},
+    {"vkCmdBeginRenderPass", &wine_fast_vkCmdBeginRenderPass},
+    {"vkCmdBindDescriptorSets", &wine_fast_vkCmdBindDescriptorSets},
+    {"vkCmdBindIndexBuffer", &wine_fast_vkCmdBindIndexBuffer},
+    {"vkCmdBindPipeline", &wine_fast_vkCmdBindPipeline},
+    {"vkCmdBindVertexBuffers", &wine_fast_vkCmdBindVertexBuffers},
+    {"vkCmdBlitImage", &wine_fast_vkCmdBlitImage},
+    {"vkCmdClearAttachments", &wine_fast_vkCmdClearAttachments},
+    {"vkCmdClearColorImage", &wine_fast_vkCmdClearColorImage},
+    {"vkCmdClearDepthStencilImage", &wine_fast_vkCmdClearDepthStencilImage},
+    {"vkCmdCopyBuffer", &wine_fast_vkCmdCopyBuffer},
+    {"vkCmdCopyBufferToImage", &wine_fast_vkCmdCopyBufferToImage},
+    {"vkCmdCopyImage", &wine_fast_vkCmdCopyImage},
+    {"vkCmdCopyImageToBuffer", &wine_fast_vkCmdCopyImageToBuffer},
+    {"vkCmdCopyQueryPoolResults", &wine_fast_vkCmdCopyQueryPoolResults},
+    {"vkCmdDispatch", &wine_fast_vkCmdDispatch},
+    {"vkCmdDispatchIndirect", &wine_fast_vkCmdDispatchIndirect},
+    {"vkCmdDraw", &wine_fast_vkCmdDraw},
+    {"vkCmdDrawIndexed", &wine_fast_vkCmdDrawIndexed},
+    {"vkCmdDrawIndexedIndirect", &wine_fast_vkCmdDrawIndexedIndirect},
+    {"vkCmdDrawIndexedIndirectCountAMD", &wine_fast_vkCmdDrawIndexedIndirectCountAMD},
+    {"vkCmdDrawIndirect", &wine_fast_vkCmdDrawIndirect},
+    {"vkCmdDrawIndirectCountAMD", &wine_fast_vkCmdDrawIndirectCountAMD},
+    {"vkCmdEndQuery", &wine_fast_vkCmdEndQuery},
+    {"vkCmdEndRenderPass", &wine_fast_vkCmdEndRenderPass},
+    {"vkCmdFillBuffer", &wine_fast_vkCmdFillBuffer},
+    {"vkCmdNextSubpass", &wine_fast_vkCmdNextSubpass},
+    {"vkCmdPushConstants", &wine_fast_vkCmdPushConstants},
+    {"vkCmdPushDescriptorSetWithTemplateKHR", &wine_fast_vkCmdPushDescriptorSetWithTemplateKHR},
+    {"vkCmdResetEvent", &wine_fast_vkCmdResetEvent},
+    {"vkCmdResetQueryPool", &wine_fast_vkCmdResetQueryPool},
+    {"vkCmdResolveImage", &wine_fast_vkCmdResolveImage},
+    {"vkCmdSetBlendConstants", &wine_fast_vkCmdSetBlendConstants},
+    {"vkCmdSetDepthBias", &wine_fast_vkCmdSetDepthBias},
+    {"vkCmdSetDepthBounds", &wine_fast_vkCmdSetDepthBounds},
+    {"vkCmdSetDiscardRectangleEXT", &wine_fast_vkCmdSetDiscardRectangleEXT},
+    {"vkCmdSetEvent", &wine_fast_vkCmdSetEvent},
+    {"vkCmdSetLineWidth", &wine_fast_vkCmdSetLineWidth},
+    {"vkCmdSetScissor", &wine_fast_vkCmdSetScissor},
+    {"vkCmdSetStencilCompareMask", &wine_fast_vkCmdSetStencilCompareMask},
+    {"vkCmdSetStencilReference", &wine_fast_vkCmdSetStencilReference},
+    {"vkCmdSetStencilWriteMask", &wine_fast_vkCmdSetStencilWriteMask},
+    {"vkCmdSetViewport", &wine_fast_vkCmdSetViewport},
+    {"vkCmdSetViewportWScalingNV", &wine_fast_vkCmdSetViewportWScalingNV},
+    {"vkCmdUpdateBuffer", &wine_fast_vkCmdUpdateBuffer},
+    {"vkCmdWriteTimestamp", &wine_fast_vkCmdWriteTimestamp},
+    {"vkCreateDescriptorPool", &wine_fast_vkCreateDescriptorPool},
+    {"vkCreateDescriptorSetLayout", &wine_fast_vkCreateDescriptorSetLayout},
+    {"vkCreateEvent", &wine_fast_vkCreateEvent},
+    {"vkCreateFence", &wine_fast_vkCreateFence},
+    {"vkCreateImage", &wine_fast_vkCreateImage},
+    {"vkCreatePipelineCache", &wine_fast_vkCreatePipelineCache},
+    {"vkCreatePipelineLayout", &wine_fast_vkCreatePipelineLayout},
+    {"vkCreateQueryPool", &wine_fast_vkCreateQueryPool},
+    {"vkCreateRenderPass", &wine_fast_vkCreateRenderPass},
+    {"vkCreateSampler", &wine_fast_vkCreateSampler},
+    {"vkCreateSemaphore", &wine_fast_vkCreateSemaphore},
+    {"vkCreateShaderModule", &wine_fast_vkCreateShaderModule},
+    {"vkDestroyBuffer", &wine_fast_vkDestroyBuffer},
+    {"vkDestroyBufferView", &wine_fast_vkDestroyBufferView},
+    {"vkDestroyDescriptorPool", &wine_fast_vkDestroyDescriptorPool},
+    {"vkDestroyDescriptorSetLayout", &wine_fast_vkDestroyDescriptorSetLayout},
+    {"vkDestroyDescriptorUpdateTemplateKHR", &wine_fast_vkDestroyDescriptorUpdateTemplateKHR},
+    {"vkDestroyEvent", &wine_fast_vkDestroyEvent},
+    {"vkDestroyFence", &wine_fast_vkDestroyFence},
+    {"vkDestroyFramebuffer", &wine_fast_vkDestroyFramebuffer},
+    {"vkDestroyImage", &wine_fast_vkDestroyImage},
+    {"vkDestroyImageView", &wine_fast_vkDestroyImageView},
+    {"vkDestroyPipeline", &wine_fast_vkDestroyPipeline},
+    {"vkDestroyPipelineCache", &wine_fast_vkDestroyPipelineCache},
+    {"vkDestroyPipelineLayout", &wine_fast_vkDestroyPipelineLayout},
+    {"vkDestroyQueryPool", &wine_fast_vkDestroyQueryPool},
+    {"vkDestroyRenderPass", &wine_fast_vkDestroyRenderPass},
+    {"vkDestroySampler", &wine_fast_vkDestroySampler},
+    {"vkDestroySemaphore", &wine_fast_vkDestroySemaphore},
+    {"vkDestroyShaderModule", &wine_fast_vkDestroyShaderModule},
+    {"vkEndCommandBuffer", &wine_fast_vkEndCommandBuffer},
+    {"vkFlushMappedMemoryRanges", &wine_fast_vkFlushMappedMemoryRanges},
+    {"vkFreeDescriptorSets", &wine_fast_vkFreeDescriptorSets},
+    {"vkFreeMemory", &wine_fast_vkFreeMemory},
+    {"vkGetDeviceMemoryCommitment", &wine_fast_vkGetDeviceMemoryCommitment},
+    {"vkGetFenceStatus", &wine_fast_vkGetFenceStatus},
+    {"vkGetImageSparseMemoryRequirements", &wine_fast_vkGetImageSparseMemoryRequirements},
+    {"vkGetImageSubresourceLayout", &wine_fast_vkGetImageSubresourceLayout},
+    {"vkGetPipelineCacheData", &wine_fast_vkGetPipelineCacheData},
+    {"vkGetRenderAreaGranularity", &wine_fast_vkGetRenderAreaGranularity},
+    {"vkInvalidateMappedMemoryRanges", &wine_fast_vkInvalidateMappedMemoryRanges},
+    {"vkMapMemory", &wine_fast_vkMapMemory},
+    {"vkMergePipelineCaches", &wine_fast_vkMergePipelineCaches},
+    {"vkResetDescriptorPool", &wine_fast_vkResetDescriptorPool},
+    {"vkResetEvent", &wine_fast_vkResetEvent},
+    {"vkResetFences", &wine_fast_vkResetFences},
+    {"vkSetEvent", &wine_fast_vkSetEvent},
+    {"vkSetHdrMetadataEXT", &wine_fast_vkSetHdrMetadataEXT},
+    {"vkTrimCommandPoolKHR", &wine_fast_vkTrimCommandPoolKHR},
+    {"vkUnmapMemory", &wine_fast_vkUnmapMemory},
+    {"vkUpdateDescriptorSetWithTemplateKHR", &wine_fast_vkUpdateDescriptorSetWithTemplateKHR},
+};
+
 static const struct vulkan_func vk_instance_dispatch_table[] =
 {
     {"vkCreateDevice", &wine_vkCreateDevice},
@@ -2329,6 +3462,20 @@ void *wine_vk_get_device_proc_addr(const char *name)
     return NULL;
 }
 
+void *wine_vk_get_device_fast_proc_addr(const char *name)
+{
+    unsigned int i;
+    for (i = 0; i < ARRAY_SIZE(vk_device_fast_dispatch_table); i++)
+    {
+        if (strcmp(vk_device_fast_dispatch_table[i].name, name) == 0)
+        {
+            TRACE("Found pName=%s in device fast table\n", name);
+            return vk_device_fast_dispatch_table[i].func;
+        }
+    }
+    return NULL;
+}
+
 void *wine_vk_get_instance_proc_addr(const char *name)
 {
     unsigned int i;
@@ -2386,7 +3533,7 @@ static const char *vk_instance_extensions[] =
 
 BOOL wine_vk_device_extension_supported(const char *name)
 {
-    int i;
+    unsigned int i;
     for (i = 0; i < ARRAY_SIZE(vk_device_extensions); i++)
     {
         if (strcmp(vk_device_extensions[i], name) == 0)
@@ -2397,7 +3544,7 @@ BOOL wine_vk_device_extension_supported(const char *name)
 
 BOOL wine_vk_instance_extension_supported(const char *name)
 {
-    int i;
+    unsigned int i;
     for (i = 0; i < ARRAY_SIZE(vk_instance_extensions); i++)
     {
         if (strcmp(vk_instance_extensions[i], name) == 0)
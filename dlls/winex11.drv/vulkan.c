@@ -40,6 +40,7 @@
 #ifdef SONAME_LIBVULKAN
 
 WINE_DEFAULT_DEBUG_CHANNEL(vulkan);
+WINE_DECLARE_DEBUG_CHANNEL(fps);
 
 typedef VkFlags VkXlibSurfaceCreateFlagsKHR;
 #define VK_STRUCTURE_TYPE_XLIB_SURFACE_CREATE_INFO_KHR 1000004000
@@ -59,6 +60,51 @@ struct wine_vk_surface
 /* Macro to help conversion from VkSurfaceKHR (uint64_t) to a surface pointer. */
 #define SURFACE_FROM_HANDLE(surface) ((struct wine_vk_surface *)(uintptr_t)surface)
 
+#define WINE_VK_MAX_FRAMES_IN_FLIGHT 16
+
+/* Present scheduling state, only tracked when frame pacing or fps tracing is enabled.
+ * Swapchain handles stay native, the state is found through the native handle.
+ * Presents submit a fence to the queue and acquires wait for the fence submitted
+ * 'max_frames' presents earlier, which bounds how far the application can get
+ * ahead of the GPU regardless of the host driver's queue depth.
+ */
+struct wine_vk_swapchain
+{
+    struct list entry;
+    VkDevice device;
+    VkSwapchainKHR swapchain; /* native swapchain */
+
+    VkResult (*p_vkCreateFence)(VkDevice, const VkFenceCreateInfo *, const VkAllocationCallbacks *, VkFence *);
+    void (*p_vkDestroyFence)(VkDevice, VkFence, const VkAllocationCallbacks *);
+    VkResult (*p_vkQueueSubmit)(VkQueue, uint32_t, const VkSubmitInfo *, VkFence);
+    VkResult (*p_vkResetFences)(VkDevice, uint32_t, const VkFence *);
+    VkResult (*p_vkWaitForFences)(VkDevice, uint32_t, const VkFence *, VkBool32, uint64_t);
+
+    unsigned int max_frames;
+    unsigned int present_count;
+    VkFence fences[WINE_VK_MAX_FRAMES_IN_FLIGHT];
+    BOOL fence_pending[WINE_VK_MAX_FRAMES_IN_FLIGHT];
+
+    /* Present-to-present statistics, in performance counter ticks. */
+    LONGLONG last_present;
+    LONGLONG stats_start;
+    unsigned int interval_count;
+    LONGLONG interval_sum;
+    LONGLONG interval_min;
+    LONGLONG interval_max;
+};
+
+static struct list vk_swapchain_list = LIST_INIT(vk_swapchain_list);
+
+static CRITICAL_SECTION vulkan_section;
+static CRITICAL_SECTION_DEBUG critsect_debug =
+{
+    0, 0, &vulkan_section,
+    { &critsect_debug.ProcessLocksList, &critsect_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": vulkan_section") }
+};
+static CRITICAL_SECTION vulkan_section = { &critsect_debug, -1, 0, 0, 0, 0 };
+
 typedef struct VkXlibSurfaceCreateInfoKHR {
     VkStructureType                sType;
     const void*                    pNext;
@@ -248,12 +294,206 @@ static VkResult wine_vk_instance_convert_create_info(const VkInstanceCreateInfo
     return VK_SUCCESS;
 }
 
+static struct wine_vk_swapchain *wine_vk_find_swapchain(VkSwapchainKHR swapchain)
+{
+    struct wine_vk_swapchain *vk_swapchain;
+
+    if (list_empty(&vk_swapchain_list))
+        return NULL;
+
+    EnterCriticalSection(&vulkan_section);
+    LIST_FOR_EACH_ENTRY(vk_swapchain, &vk_swapchain_list, struct wine_vk_swapchain, entry)
+    {
+        if (vk_swapchain->swapchain == swapchain)
+        {
+            LeaveCriticalSection(&vulkan_section);
+            return vk_swapchain;
+        }
+    }
+    LeaveCriticalSection(&vulkan_section);
+
+    return NULL;
+}
+
+static void wine_vk_swapchain_create(VkDevice device, VkSwapchainKHR swapchain)
+{
+    VkFenceCreateInfo fence_info;
+    struct wine_vk_swapchain *vk_swapchain;
+    unsigned int i;
+
+    if (!vulkan_max_frames_in_flight && !TRACE_ON(fps))
+        return;
+
+    if (!(vk_swapchain = heap_alloc_zero(sizeof(*vk_swapchain))))
+    {
+        ERR("Failed to allocate present scheduling state.\n");
+        return;
+    }
+    vk_swapchain->device = device;
+    vk_swapchain->swapchain = swapchain;
+
+    vk_swapchain->max_frames = min(max(vulkan_max_frames_in_flight, 0), WINE_VK_MAX_FRAMES_IN_FLIGHT);
+    if (vk_swapchain->max_frames != vulkan_max_frames_in_flight)
+        WARN("Clamping maximum frames in flight %d to %u.\n", vulkan_max_frames_in_flight, vk_swapchain->max_frames);
+
+    if (vk_swapchain->max_frames)
+    {
+#define LOAD_FUNCPTR(f) if (!(vk_swapchain->p_##f = pvkGetDeviceProcAddr(device, #f))) goto fail;
+        LOAD_FUNCPTR(vkCreateFence)
+        LOAD_FUNCPTR(vkDestroyFence)
+        LOAD_FUNCPTR(vkQueueSubmit)
+        LOAD_FUNCPTR(vkResetFences)
+        LOAD_FUNCPTR(vkWaitForFences)
+#undef LOAD_FUNCPTR
+
+        fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        fence_info.pNext = NULL;
+        fence_info.flags = 0;
+        for (i = 0; i < vk_swapchain->max_frames; i++)
+        {
+            if (vk_swapchain->p_vkCreateFence(device, &fence_info, NULL, &vk_swapchain->fences[i]) != VK_SUCCESS)
+                goto fail;
+        }
+    }
+
+    TRACE("Scheduling presents for swapchain 0x%s, max frames in flight %u.\n",
+            wine_dbgstr_longlong(swapchain), vk_swapchain->max_frames);
+
+    EnterCriticalSection(&vulkan_section);
+    list_add_tail(&vk_swapchain_list, &vk_swapchain->entry);
+    LeaveCriticalSection(&vulkan_section);
+    return;
+
+fail:
+    ERR("Failed to set up present scheduling for swapchain 0x%s.\n", wine_dbgstr_longlong(swapchain));
+    for (i = 0; i < vk_swapchain->max_frames; i++)
+    {
+        if (vk_swapchain->fences[i])
+            vk_swapchain->p_vkDestroyFence(device, vk_swapchain->fences[i], NULL);
+    }
+    heap_free(vk_swapchain);
+}
+
+static void wine_vk_swapchain_destroy(VkSwapchainKHR swapchain)
+{
+    struct wine_vk_swapchain *vk_swapchain;
+    unsigned int i;
+
+    if (!(vk_swapchain = wine_vk_find_swapchain(swapchain)))
+        return;
+
+    EnterCriticalSection(&vulkan_section);
+    list_remove(&vk_swapchain->entry);
+    LeaveCriticalSection(&vulkan_section);
+
+    for (i = 0; i < vk_swapchain->max_frames; i++)
+    {
+        if (vk_swapchain->fence_pending[i])
+            vk_swapchain->p_vkWaitForFences(vk_swapchain->device, 1, &vk_swapchain->fences[i], VK_TRUE, ~(uint64_t)0);
+        vk_swapchain->p_vkDestroyFence(vk_swapchain->device, vk_swapchain->fences[i], NULL);
+    }
+    heap_free(vk_swapchain);
+}
+
+/* Waits until the fence for the next present may be reused, i.e. until
+ * no more than max_frames - 1 presented frames are still being rendered. */
+static VkResult wine_vk_swapchain_wait(struct wine_vk_swapchain *vk_swapchain, uint64_t timeout)
+{
+    unsigned int slot = vk_swapchain->present_count % vk_swapchain->max_frames;
+    VkResult res;
+
+    if (!vk_swapchain->fence_pending[slot])
+        return VK_SUCCESS;
+
+    res = vk_swapchain->p_vkWaitForFences(vk_swapchain->device, 1, &vk_swapchain->fences[slot], VK_TRUE, timeout);
+    if (res != VK_SUCCESS)
+        return res;
+
+    vk_swapchain->fence_pending[slot] = FALSE;
+    return vk_swapchain->p_vkResetFences(vk_swapchain->device, 1, &vk_swapchain->fences[slot]);
+}
+
+static void wine_vk_swapchain_update_stats(struct wine_vk_swapchain *vk_swapchain)
+{
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER counter;
+    LONGLONG interval;
+
+    if (!freq.QuadPart)
+        QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&counter);
+
+    if (!vk_swapchain->last_present)
+    {
+        vk_swapchain->last_present = vk_swapchain->stats_start = counter.QuadPart;
+        return;
+    }
+
+    interval = counter.QuadPart - vk_swapchain->last_present;
+    vk_swapchain->last_present = counter.QuadPart;
+    if (!vk_swapchain->interval_count++)
+        vk_swapchain->interval_min = vk_swapchain->interval_max = interval;
+    vk_swapchain->interval_sum += interval;
+    vk_swapchain->interval_min = min(vk_swapchain->interval_min, interval);
+    vk_swapchain->interval_max = max(vk_swapchain->interval_max, interval);
+
+    /* every 1.5 seconds */
+    if ((counter.QuadPart - vk_swapchain->stats_start) * 2 > freq.QuadPart * 3)
+    {
+        double ms = 1000.0 / freq.QuadPart;
+
+        TRACE_(fps)("swapchain 0x%s @ approx %.2ffps, present interval avg %.3f ms, min %.3f ms, max %.3f ms\n",
+                wine_dbgstr_longlong(vk_swapchain->swapchain),
+                vk_swapchain->interval_count * (double)freq.QuadPart / vk_swapchain->interval_sum,
+                vk_swapchain->interval_sum * ms / vk_swapchain->interval_count,
+                vk_swapchain->interval_min * ms, vk_swapchain->interval_max * ms);
+        vk_swapchain->stats_start = counter.QuadPart;
+        vk_swapchain->interval_count = 0;
+        vk_swapchain->interval_sum = 0;
+    }
+}
+
+static void wine_vk_swapchain_present(struct wine_vk_swapchain *vk_swapchain, VkQueue queue)
+{
+    unsigned int slot;
+
+    if (TRACE_ON(fps))
+        wine_vk_swapchain_update_stats(vk_swapchain);
+
+    if (!vk_swapchain->max_frames)
+        return;
+
+    /* Normally already waited for in vkAcquireNextImageKHR. */
+    if (wine_vk_swapchain_wait(vk_swapchain, ~(uint64_t)0) != VK_SUCCESS)
+        return;
+
+    /* Signaled once all work submitted to the queue so far completes. */
+    slot = vk_swapchain->present_count % vk_swapchain->max_frames;
+    if (vk_swapchain->p_vkQueueSubmit(queue, 0, NULL, vk_swapchain->fences[slot]) == VK_SUCCESS)
+        vk_swapchain->fence_pending[slot] = TRUE;
+    else
+        WARN("Failed to submit frame fence.\n");
+    vk_swapchain->present_count++;
+}
+
 static VkResult X11DRV_vkAcquireNextImageKHR(VkDevice device, VkSwapchainKHR swapchain, uint64_t timeout,
         VkSemaphore semaphore, VkFence fence, uint32_t *pImageIndex)
 {
+    struct wine_vk_swapchain *vk_swapchain;
+    VkResult res;
+
     TRACE("%p, 0x%s, 0x%s, 0x%s, 0x%s, %p\n", device, wine_dbgstr_longlong(swapchain), wine_dbgstr_longlong(timeout),
             wine_dbgstr_longlong(semaphore), wine_dbgstr_longlong(fence), pImageIndex);
 
+    if ((vk_swapchain = wine_vk_find_swapchain(swapchain)) && vk_swapchain->max_frames)
+    {
+        res = wine_vk_swapchain_wait(vk_swapchain, timeout);
+        if (res == VK_TIMEOUT && !timeout)
+            return VK_NOT_READY;
+        if (res != VK_SUCCESS)
+            return res;
+    }
+
     return pvkAcquireNextImageKHR(device, swapchain, timeout, semaphore, fence, pImageIndex);
 }
 
@@ -289,6 +529,8 @@ static VkResult X11DRV_vkCreateSwapchainKHR(VkDevice device, const VkSwapchainCr
         const VkAllocationCallbacks *pAllocator, VkSwapchainKHR *pSwapchain)
 {
     VkSwapchainCreateInfoKHR create_info;
+    VkResult res;
+
     TRACE("%p %p %p %p\n", device, pCreateInfo, pAllocator, pSwapchain);
 
     if (pAllocator)
@@ -297,7 +539,11 @@ static VkResult X11DRV_vkCreateSwapchainKHR(VkDevice device, const VkSwapchainCr
     create_info = *pCreateInfo;
     create_info.surface = SURFACE_FROM_HANDLE(pCreateInfo->surface)->surface;
 
-    return pvkCreateSwapchainKHR(device, &create_info, NULL /* pAllocator */, pSwapchain);
+    res = pvkCreateSwapchainKHR(device, &create_info, NULL /* pAllocator */, pSwapchain);
+    if (res == VK_SUCCESS)
+        wine_vk_swapchain_create(device, *pSwapchain);
+
+    return res;
 }
 
 static VkResult X11DRV_vkCreateWin32SurfaceKHR(VkInstance instance, const VkWin32SurfaceCreateInfoKHR *pCreateInfo,
@@ -376,6 +622,7 @@ static void X11DRV_vkDestroySwapchainKHR(VkDevice device, VkSwapchainKHR swapcha
     if (pAllocator)
         FIXME("Support for allocation callbacks not implemented yet\n");
 
+    wine_vk_swapchain_destroy(swapchain);
     pvkDestroySwapchainKHR(device, swapchain, pAllocator);
 }
 
@@ -500,7 +747,17 @@ static VkResult X11DRV_vkGetSwapchainImagesKHR(VkDevice device, VkSwapchainKHR s
 
 static VkResult X11DRV_vkQueuePresentKHR(VkQueue queue, const VkPresentInfoKHR *pPresentInfo)
 {
+    struct wine_vk_swapchain *vk_swapchain;
+    uint32_t i;
+
     TRACE("%p, %p\n", queue, pPresentInfo);
+
+    for (i = 0; i < pPresentInfo->swapchainCount; i++)
+    {
+        if ((vk_swapchain = wine_vk_find_swapchain(pPresentInfo->pSwapchains[i])))
+            wine_vk_swapchain_present(vk_swapchain, queue);
+    }
+
     return pvkQueuePresentKHR(queue, pPresentInfo);
 }
 
@@ -81,6 +81,7 @@ BOOL client_side_graphics = TRUE;
 BOOL client_side_with_render = TRUE;
 BOOL shape_layered_windows = TRUE;
 int copy_default_colors = 128;
+int vulkan_max_frames_in_flight = 0;
 int alloc_system_colors = 256;
 DWORD thread_data_tls_index = TLS_OUT_OF_INDEXES;
 int xrender_error_base = 0;
@@ -415,6 +416,9 @@ static void setup_options(void)
 
     get_config_key( hkey, appkey, "InputStyle", input_style, sizeof(input_style) );
 
+    if (!get_config_key( hkey, appkey, "VulkanMaxFramesInFlight", buffer, sizeof(buffer) ))
+        vulkan_max_frames_in_flight = atoi(buffer);
+
     if (appkey) RegCloseKey( appkey );
     if (hkey) RegCloseKey( hkey );
 }
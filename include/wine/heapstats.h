@@ -0,0 +1,44 @@
+/*
+ * Wine heap statistics, returned by RtlQueryHeapInformation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#ifndef __WINE_WINE_HEAPSTATS_H
+#define __WINE_WINE_HEAPSTATS_H
+
+#include <windef.h>
+
+#define HeapWineStatistics       ((HEAP_INFORMATION_CLASS)0x100)
+#define HEAP_STATISTICS_CLASSES  16  /* block size classes, powers of two from 16 bytes */
+
+typedef struct _HEAP_WINE_STATISTICS {
+    SIZE_T  ReservedSize;        /* address space of the sub-heaps and large blocks */
+    SIZE_T  CommittedSize;
+    SIZE_T  UsedSize;            /* blocks allocated by the application, including large ones */
+    SIZE_T  CachedSize;          /* blocks cached by the low fragmentation front end */
+    SIZE_T  FreeSize;            /* free blocks, including uncommitted space */
+    SIZE_T  LargeSize;
+    ULONG   UsedBlocks;
+    ULONG   FreeBlocks;
+    ULONG   LargeBlocks;         /* blocks allocated directly as virtual memory */
+    ULONG   LockContention;      /* waits for the heap lock */
+    ULONG   FrontEndContention;  /* busy front end locks, the back end was used instead */
+    ULONG64 Reallocations;
+    ULONG64 Allocations[HEAP_STATISTICS_CLASSES];
+    ULONG64 Frees[HEAP_STATISTICS_CLASSES];
+} HEAP_WINE_STATISTICS, *PHEAP_WINE_STATISTICS;
+
+#endif  /* __WINE_WINE_HEAPSTATS_H */
@@ -50,6 +50,50 @@ struct request_max_size
     int pad[16];
 };
 
+
+
+#define FAST_SYNC_SERVER       0x80000000
+#define FAST_SYNC_STATE_MASK   0x7fffffff
+#define FAST_SYNC_EVENT_SIGNALED 0x00000001
+#define FAST_SYNC_EVENT_CLAIMED  0x00000002
+#define FAST_SYNC_EVENT_PULSE    0x00000004
+#define FAST_SYNC_EVENT_PULSES   0x7ffffffc
+#define FAST_SYNC_REGION_SIZE  0x40000
+#define FAST_SYNC_MAX_OBJECTS  (FAST_SYNC_REGION_SIZE / sizeof(int))
+
+enum fast_sync_type
+{
+    FAST_SYNC_NONE,
+    FAST_SYNC_MANUAL_EVENT,
+    FAST_SYNC_AUTO_EVENT,
+    FAST_SYNC_SEMAPHORE
+};
+
+
+
+#define KEY_SEQ_REGION_SIZE    0x40000
+
+
+
+struct shared_input
+{
+    unsigned int   seq;
+    unsigned int   id;
+    int            cursor_x;
+    int            cursor_y;
+    unsigned int   cursor_change;
+    user_handle_t  foreground;
+    user_handle_t  focus;
+    user_handle_t  active;
+    int            input_slot;
+    unsigned int   input_id;
+    int            __pad[6];
+    unsigned char  keystate[256];
+};
+
+#define SHARED_INPUT_MAX_SLOTS   8192
+#define SHARED_INPUT_REGION_SIZE (SHARED_INPUT_MAX_SLOTS * sizeof(struct shared_input))
+
 #define FIRST_USER_HANDLE 0x0020
 #define LAST_USER_HANDLE  0xffef
 
@@ -199,6 +243,18 @@ typedef __int64 timeout_t;
 #define TIMEOUT_INFINITE (((timeout_t)0x7fffffff) << 32 | 0xffffffff)
 
 
+struct request_stats
+{
+    int            req;
+    process_id_t   pid;
+    unsigned int   count;
+    unsigned int   max_time;
+    timeout_t      total_time;
+    mem_size_t     reply_size;
+    char           name[32];
+};
+
+
 typedef struct
 {
     unsigned int debug_flags;
@@ -873,6 +929,22 @@ struct terminate_thread_reply
 
 
 
+
+struct get_request_stats_request
+{
+    struct request_header __header;
+    process_id_t pid;
+};
+struct get_request_stats_reply
+{
+    struct reply_header __header;
+    data_size_t  total;
+    /* VARARG(stats,request_stats); */
+    char __pad_12[4];
+};
+
+
+
 struct get_process_info_request
 {
     struct request_header __header;
@@ -1214,7 +1286,9 @@ struct create_event_reply
 {
     struct reply_header __header;
     obj_handle_t handle;
-    char __pad_12[4];
+    int          fast_type;
+    unsigned int fast_index;
+    unsigned int fast_access;
 };
 
 
@@ -1256,7 +1330,9 @@ struct open_event_reply
 {
     struct reply_header __header;
     obj_handle_t handle;
-    char __pad_12[4];
+    int          fast_type;
+    unsigned int fast_index;
+    unsigned int fast_access;
 };
 
 
@@ -1368,7 +1444,11 @@ struct create_semaphore_reply
 {
     struct reply_header __header;
     obj_handle_t handle;
-    char __pad_12[4];
+    int          fast_type;
+    unsigned int fast_index;
+    unsigned int fast_access;
+    unsigned int fast_max;
+    char __pad_28[4];
 };
 
 
@@ -1400,6 +1480,36 @@ struct query_semaphore_reply
 };
 
 
+struct get_fast_sync_region_request
+{
+    struct request_header __header;
+    char __pad_12[4];
+};
+struct get_fast_sync_region_reply
+{
+    struct reply_header __header;
+    unsigned int size;
+    char __pad_12[4];
+};
+
+
+
+struct get_fast_sync_request
+{
+    struct request_header __header;
+    obj_handle_t handle;
+};
+struct get_fast_sync_reply
+{
+    struct reply_header __header;
+    int          type;
+    unsigned int index;
+    unsigned int max;
+    unsigned int access;
+};
+
+
+
 struct open_semaphore_request
 {
     struct request_header __header;
@@ -1412,7 +1522,11 @@ struct open_semaphore_reply
 {
     struct reply_header __header;
     obj_handle_t handle;
-    char __pad_12[4];
+    int          fast_type;
+    unsigned int fast_index;
+    unsigned int fast_access;
+    unsigned int fast_max;
+    char __pad_28[4];
 };
 
 
@@ -2641,11 +2755,27 @@ struct get_key_value_reply
     struct reply_header __header;
     int          type;
     data_size_t  total;
+    int          seq_index;
+    unsigned int seq;
     /* VARARG(data,bytes); */
 };
 
 
 
+struct get_key_seq_region_request
+{
+    struct request_header __header;
+    char __pad_12[4];
+};
+struct get_key_seq_region_reply
+{
+    struct reply_header __header;
+    unsigned int size;
+    char __pad_12[4];
+};
+
+
+
 struct enum_key_value_request
 {
     struct request_header __header;
@@ -4219,6 +4349,36 @@ struct get_last_input_time_reply
 
 
 
+struct get_shared_input_region_request
+{
+    struct request_header __header;
+    char __pad_12[4];
+};
+struct get_shared_input_region_reply
+{
+    struct reply_header __header;
+    obj_handle_t handle;
+    data_size_t  size;
+};
+
+
+
+struct get_shared_input_request
+{
+    struct request_header __header;
+    char __pad_12[4];
+};
+struct get_shared_input_reply
+{
+    struct reply_header __header;
+    int          desktop_slot;
+    unsigned int desktop_id;
+    int          queue_slot;
+    unsigned int queue_id;
+};
+
+
+
 struct get_key_state_request
 {
     struct request_header __header;
@@ -5628,6 +5788,7 @@ enum request
     REQ_init_thread,
     REQ_terminate_process,
     REQ_terminate_thread,
+    REQ_get_request_stats,
     REQ_get_process_info,
     REQ_get_process_vm_counters,
     REQ_set_process_info,
@@ -5660,6 +5821,8 @@ enum request
     REQ_create_semaphore,
     REQ_release_semaphore,
     REQ_query_semaphore,
+    REQ_get_fast_sync_region,
+    REQ_get_fast_sync,
     REQ_open_semaphore,
     REQ_create_file,
     REQ_open_file_object,
@@ -5730,6 +5893,7 @@ enum request
     REQ_enum_key,
     REQ_set_key_value,
     REQ_get_key_value,
+    REQ_get_key_seq_region,
     REQ_enum_key_value,
     REQ_delete_key_value,
     REQ_load_registry,
@@ -5824,6 +5988,8 @@ enum request
     REQ_attach_thread_input,
     REQ_get_thread_input,
     REQ_get_last_input_time,
+    REQ_get_shared_input_region,
+    REQ_get_shared_input,
     REQ_get_key_state,
     REQ_set_key_state,
     REQ_set_foreground_window,
@@ -5924,6 +6090,7 @@ union generic_request
     struct init_thread_request init_thread_request;
     struct terminate_process_request terminate_process_request;
     struct terminate_thread_request terminate_thread_request;
+    struct get_request_stats_request get_request_stats_request;
     struct get_process_info_request get_process_info_request;
     struct get_process_vm_counters_request get_process_vm_counters_request;
     struct set_process_info_request set_process_info_request;
@@ -5956,6 +6123,8 @@ union generic_request
     struct create_semaphore_request create_semaphore_request;
     struct release_semaphore_request release_semaphore_request;
     struct query_semaphore_request query_semaphore_request;
+    struct get_fast_sync_region_request get_fast_sync_region_request;
+    struct get_fast_sync_request get_fast_sync_request;
     struct open_semaphore_request open_semaphore_request;
     struct create_file_request create_file_request;
     struct open_file_object_request open_file_object_request;
@@ -6026,6 +6195,7 @@ union generic_request
     struct enum_key_request enum_key_request;
     struct set_key_value_request set_key_value_request;
     struct get_key_value_request get_key_value_request;
+    struct get_key_seq_region_request get_key_seq_region_request;
     struct enum_key_value_request enum_key_value_request;
     struct delete_key_value_request delete_key_value_request;
     struct load_registry_request load_registry_request;
@@ -6120,6 +6290,8 @@ union generic_request
     struct attach_thread_input_request attach_thread_input_request;
     struct get_thread_input_request get_thread_input_request;
     struct get_last_input_time_request get_last_input_time_request;
+    struct get_shared_input_region_request get_shared_input_region_request;
+    struct get_shared_input_request get_shared_input_request;
     struct get_key_state_request get_key_state_request;
     struct set_key_state_request set_key_state_request;
     struct set_foreground_window_request set_foreground_window_request;
@@ -6218,6 +6390,7 @@ union generic_reply
     struct init_thread_reply init_thread_reply;
     struct terminate_process_reply terminate_process_reply;
     struct terminate_thread_reply terminate_thread_reply;
+    struct get_request_stats_reply get_request_stats_reply;
     struct get_process_info_reply get_process_info_reply;
     struct get_process_vm_counters_reply get_process_vm_counters_reply;
     struct set_process_info_reply set_process_info_reply;
@@ -6250,6 +6423,8 @@ union generic_reply
     struct create_semaphore_reply create_semaphore_reply;
     struct release_semaphore_reply release_semaphore_reply;
     struct query_semaphore_reply query_semaphore_reply;
+    struct get_fast_sync_region_reply get_fast_sync_region_reply;
+    struct get_fast_sync_reply get_fast_sync_reply;
     struct open_semaphore_reply open_semaphore_reply;
     struct create_file_reply create_file_reply;
     struct open_file_object_reply open_file_object_reply;
@@ -6320,6 +6495,7 @@ union generic_reply
     struct enum_key_reply enum_key_reply;
     struct set_key_value_reply set_key_value_reply;
     struct get_key_value_reply get_key_value_reply;
+    struct get_key_seq_region_reply get_key_seq_region_reply;
     struct enum_key_value_reply enum_key_value_reply;
     struct delete_key_value_reply delete_key_value_reply;
     struct load_registry_reply load_registry_reply;
@@ -6414,6 +6590,8 @@ union generic_reply
     struct attach_thread_input_reply attach_thread_input_reply;
     struct get_thread_input_reply get_thread_input_reply;
     struct get_last_input_time_reply get_last_input_time_reply;
+    struct get_shared_input_region_reply get_shared_input_region_reply;
+    struct get_shared_input_reply get_shared_input_reply;
     struct get_key_state_reply get_key_state_reply;
     struct set_key_state_reply set_key_state_reply;
     struct set_foreground_window_reply set_foreground_window_reply;
@@ -6501,6 +6679,6 @@ union generic_reply
     struct terminate_job_reply terminate_job_reply;
 };
 
-#define SERVER_PROTOCOL_VERSION 548
+#define SERVER_PROTOCOL_VERSION 556
 
 #endif /* __WINE_WINE_SERVER_PROTOCOL_H */
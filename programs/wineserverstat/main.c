@@ -0,0 +1,121 @@
+/*
+ * Dump the wineserver request statistics
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ntstatus.h"
+#define WIN32_NO_STATUS
+#include "windef.h"
+#include "winbase.h"
+#include "winternl.h"
+#include "wine/server.h"
+
+static struct request_stats *get_request_stats( DWORD pid, unsigned int *count )
+{
+    data_size_t size = 256 * sizeof(struct request_stats);
+    struct request_stats *stats;
+    NTSTATUS status;
+
+    for (;;)
+    {
+        if (!(stats = HeapAlloc( GetProcessHeap(), 0, size ))) return NULL;
+        SERVER_START_REQ( get_request_stats )
+        {
+            req->pid = pid;
+            wine_server_set_reply( req, stats, size );
+            status = wine_server_call( req );
+            size = reply->total;
+        }
+        SERVER_END_REQ;
+        if (status != STATUS_BUFFER_TOO_SMALL) break;
+        HeapFree( GetProcessHeap(), 0, stats );
+    }
+
+    if (status)
+    {
+        fprintf( stderr, "wineserverstat: failed to get the statistics, status %08x\n", status );
+        HeapFree( GetProcessHeap(), 0, stats );
+        return NULL;
+    }
+    *count = size / sizeof(*stats);
+    return stats;
+}
+
+/* busiest first */
+static int compare_stats( const void *a, const void *b )
+{
+    const struct request_stats *stats1 = a, *stats2 = b;
+
+    if (stats1->total_time != stats2->total_time) return stats1->total_time < stats2->total_time ? 1 : -1;
+    if (stats1->count != stats2->count) return stats1->count < stats2->count ? 1 : -1;
+    return 0;
+}
+
+static void print_stats( const struct request_stats *stats, const char *name )
+{
+    printf( "%-32s %10u %12.3f %10.2f %10.2f %12.1f\n", name, stats->count,
+            stats->total_time / 1000000.0, stats->total_time / 1000.0 / max( stats->count, 1 ),
+            stats->max_time / 1000.0, stats->reply_size / 1024.0 );
+}
+
+static void print_header( const char *name )
+{
+    printf( "%-32s %10s %12s %10s %10s %12s\n", name, "count", "total ms", "avg us", "max us", "reply KiB" );
+}
+
+int main( int argc, char *argv[] )
+{
+    struct request_stats *stats;
+    unsigned int i, count;
+    DWORD pid = 0;
+    char name[32];
+
+    if (argc > 2 || (argc == 2 && (!strcmp( argv[1], "-h" ) || !strcmp( argv[1], "--help" ))))
+    {
+        printf( "Usage: wineserverstat [pid]\n\n"
+                "Dumps the requests handled by the wineserver, for all processes\n"
+                "or only for the given process, busiest first.\n" );
+        return argc > 2;
+    }
+    if (argc == 2) pid = strtoul( argv[1], NULL, 0 );
+
+    if (!(stats = get_request_stats( pid, &count ))) return 1;
+    qsort( stats, count, sizeof(*stats), compare_stats );
+
+    print_header( "request" );
+    for (i = 0; i < count; i++)
+        if (stats[i].req != -1) print_stats( &stats[i], stats[i].name );
+
+    if (!pid)
+    {
+        printf( "\n" );
+        print_header( "process" );
+        for (i = 0; i < count; i++)
+        {
+            if (stats[i].req != -1) continue;
+            sprintf( name, "%04x", stats[i].pid );
+            print_stats( &stats[i], name );
+        }
+    }
+
+    HeapFree( GetProcessHeap(), 0, stats );
+    return 0;
+}
@@ -0,0 +1,260 @@
+/*
+ * Server-side fast synchronization objects
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+/*
+ * Events and semaphores keep their state in a word of a shared memory
+ * region mapped by every client, so that signaling and waiting on them
+ * doesn't need a server round trip. Clients only touch a word with atomic
+ * operations, and only while the FAST_SYNC_SERVER bit isn't set. The
+ * server sets that bit as soon as a thread waits on the object in the
+ * server, and clears it again once nobody is waiting there anymore, so
+ * that while it is set the server state is authoritative.
+ */
+
+#include "config.h"
+#include "wine/port.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+#endif
+#ifdef HAVE_SYS_SYSCALL_H
+# include <sys/syscall.h>
+#endif
+
+#include "ntstatus.h"
+#define WIN32_NO_STATUS
+#include "windef.h"
+#include "winternl.h"
+
+#include "handle.h"
+#include "request.h"
+#include "thread.h"
+
+#if defined(__linux__) && defined(HAVE_SYS_MMAN_H) && defined(__NR_futex) && defined(__NR_memfd_create)
+#define USE_FAST_SYNC
+#endif
+
+#ifdef USE_FAST_SYNC
+
+static int fast_sync_enabled = -1;
+static int fast_sync_fd = -1;
+static int *fast_sync_region;
+static unsigned int *fast_sync_next;       /* free list links */
+static unsigned int fast_sync_free = ~0u;  /* head of the free list */
+static unsigned int fast_sync_used;        /* number of words ever allocated */
+
+/* create the shared region, fast synchronization is enabled through WINEFASTSYNC */
+static int init_fast_sync(void)
+{
+    const char *env;
+    void *ptr;
+    int fd;
+
+    if (fast_sync_enabled != -1) return fast_sync_enabled;
+    fast_sync_enabled = 0;
+
+    if (!(env = getenv( "WINEFASTSYNC" )) || !atoi( env )) return 0;
+
+    if ((fd = syscall( __NR_memfd_create, "wine-fast-sync", 0 )) == -1) return 0;
+    if (ftruncate( fd, FAST_SYNC_REGION_SIZE ) == -1 ||
+        (ptr = mmap( NULL, FAST_SYNC_REGION_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 )) == MAP_FAILED)
+    {
+        close( fd );
+        return 0;
+    }
+    if (!(fast_sync_next = mem_alloc( FAST_SYNC_MAX_OBJECTS * sizeof(*fast_sync_next) )))
+    {
+        munmap( ptr, FAST_SYNC_REGION_SIZE );
+        close( fd );
+        return 0;
+    }
+    fast_sync_fd = fd;
+    fast_sync_region = ptr;
+    fast_sync_enabled = 1;
+    return 1;
+}
+
+static inline void wake_fast_sync( int *word )
+{
+    syscall( __NR_futex, word, 1 /* FUTEX_WAKE */, INT_MAX, NULL, 0, 0 );
+}
+
+#endif  /* USE_FAST_SYNC */
+
+/* allocate the shared state of an object, returns -1 if fast synchronization isn't available */
+int alloc_fast_sync( unsigned int state )
+{
+#ifdef USE_FAST_SYNC
+    unsigned int index;
+
+    if (!init_fast_sync()) return -1;
+
+    if (fast_sync_free != ~0u)
+    {
+        index = fast_sync_free;
+        fast_sync_free = fast_sync_next[index];
+    }
+    else if (fast_sync_used < FAST_SYNC_MAX_OBJECTS) index = fast_sync_used++;
+    else return -1;
+
+    fast_sync_region[index] = state & FAST_SYNC_STATE_MASK;
+    return index;
+#else
+    return -1;
+#endif
+}
+
+void free_fast_sync( int index )
+{
+#ifdef USE_FAST_SYNC
+    if (index == -1) return;
+    fast_sync_region[index] = FAST_SYNC_SERVER;  /* make clients with stale handles go to the server */
+    wake_fast_sync( &fast_sync_region[index] );
+    fast_sync_next[index] = fast_sync_free;
+    fast_sync_free = index;
+#endif
+}
+
+unsigned int get_fast_sync_state( int index )
+{
+#ifdef USE_FAST_SYNC
+    return *(volatile int *)&fast_sync_region[index] & FAST_SYNC_STATE_MASK;
+#else
+    return 0;
+#endif
+}
+
+/* atomically replace the state if it is still 'old', clients may be updating it concurrently */
+int cmpxchg_fast_sync_state( int index, unsigned int old, unsigned int state )
+{
+#ifdef USE_FAST_SYNC
+    int *word = &fast_sync_region[index];
+    int owner = *(volatile int *)word & FAST_SYNC_SERVER;
+
+    if (!__sync_bool_compare_and_swap( word, owner | old, owner | state )) return 0;
+    if (state != old) wake_fast_sync( word );
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+void set_fast_sync_state( int index, unsigned int state )
+{
+    unsigned int old;
+
+    do old = get_fast_sync_state( index );
+    while (!cmpxchg_fast_sync_state( index, old, state ));
+}
+
+/* events keep their signaled state in the low bit of the word, along with a pulse count */
+void set_fast_sync_event( int index, int signaled )
+{
+    unsigned int old;
+
+    do old = get_fast_sync_state( index );
+    while (!cmpxchg_fast_sync_state( index, old, signaled ? old | FAST_SYNC_EVENT_SIGNALED
+                                                           : old & ~FAST_SYNC_EVENT_SIGNALED ));
+}
+
+/* Threads sleeping on the word of an event would wake up to find it reset again after */
+/* a pulse, so pulses bump the pulse count instead, and waiters compare it to the one */
+/* they started with. Only one of them claims the pulse of an auto-reset event. */
+/* Returns 0 if the server owns the state, the pulse has to wake server waiters then. */
+int pulse_fast_sync_event( int index )
+{
+#ifdef USE_FAST_SYNC
+    int *word = &fast_sync_region[index];
+    unsigned int old;
+
+    do
+    {
+        old = *(volatile int *)word;
+        if (old & FAST_SYNC_SERVER) return 0;
+    }
+    while (!__sync_bool_compare_and_swap( word, old, (old + FAST_SYNC_EVENT_PULSE) & FAST_SYNC_EVENT_PULSES ));
+    wake_fast_sync( word );
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+/* take over the state while threads are waiting on the object in the server */
+void set_fast_sync_owner( int index, int server )
+{
+#ifdef USE_FAST_SYNC
+    int *word = &fast_sync_region[index];
+
+    if (server) __sync_fetch_and_or( word, FAST_SYNC_SERVER );
+    else __sync_fetch_and_and( word, FAST_SYNC_STATE_MASK );
+    /* threads sleeping on the word have to go through the server from now on */
+    wake_fast_sync( word );
+#endif
+}
+
+/* Get the shared memory region of fast synchronization objects */
+DECL_HANDLER(get_fast_sync_region)
+{
+#ifdef USE_FAST_SYNC
+    if (init_fast_sync())
+    {
+        reply->size = FAST_SYNC_REGION_SIZE;
+        send_client_fd( current->process, fast_sync_fd, 0 );
+        return;
+    }
+#endif
+    set_error( STATUS_NOT_IMPLEMENTED );
+}
+
+/* get the fast synchronization state of the object behind a handle, it is also */
+/* returned along with new handles to save clients a get_fast_sync request */
+int get_handle_fast_sync( struct process *process, obj_handle_t handle, unsigned int *index,
+                          unsigned int *max, unsigned int *access )
+{
+    struct object *obj;
+    unsigned int sem_max = 0;
+    int type, idx = -1;
+
+    if (!(obj = get_handle_obj( process, handle, 0, NULL ))) return FAST_SYNC_NONE;
+
+    type = get_event_fast_sync( obj, &idx );
+    if (type == FAST_SYNC_NONE) type = get_semaphore_fast_sync( obj, &idx, &sem_max );
+    release_object( obj );
+
+    if (idx == -1) return FAST_SYNC_NONE;
+    *index = idx;
+    if (max) *max = sem_max;
+    *access = get_handle_access( process, handle );
+    return type;
+}
+
+/* Get the fast synchronization state of an object */
+DECL_HANDLER(get_fast_sync)
+{
+    reply->type = get_handle_fast_sync( current->process, req->handle, &reply->index,
+                                        &reply->max, &reply->access );
+}
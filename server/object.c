@@ -43,12 +43,22 @@
 #include "security.h"
 
 
+/* Namespaces grow once they hold more than NAMESPACE_MAX_LOAD names per bucket.
+ * The names are then moved to the new table a few buckets at a time on each
+ * addition or removal, and lookups check both tables until the move is done. */
 struct namespace
 {
     unsigned int        hash_size;       /* size of hash table */
-    struct list         names[1];        /* array of hash entry lists */
+    unsigned int        count;           /* number of names */
+    struct list        *names;           /* array of hash entry lists */
+    struct list        *old_names;       /* previous array while resizing, or NULL */
+    unsigned int        old_hash_size;   /* size of the previous array */
+    unsigned int        old_pos;         /* first bucket of the previous array not moved yet */
 };
 
+#define NAMESPACE_MAX_LOAD     2
+#define NAMESPACE_REHASH_STEP  8  /* buckets moved at each addition or removal */
+
 
 #ifdef DEBUG_OBJECTS
 static struct list object_list = LIST_INIT(object_list);
@@ -127,19 +137,62 @@ void *memdup( const void *data, size_t len )
 
 /*****************************************************************/
 
-static int get_name_hash( const struct namespace *namespace, const WCHAR *name, data_size_t len )
+static unsigned int get_name_hash( const WCHAR *name, data_size_t len )
 {
-    WCHAR hash = 0;
+    unsigned int hash = 0x811c9dc5;
     len /= sizeof(WCHAR);
-    while (len--) hash ^= tolowerW(*name++);
-    return hash % namespace->hash_size;
+    while (len--) hash = (hash ^ tolowerW(*name++)) * 0x01000193;
+    return hash;
+}
+
+/* move some buckets of the previous hash table to the current one */
+static void namespace_rehash( struct namespace *namespace, unsigned int count )
+{
+    struct object_name *ptr;
+    struct list *entry;
+
+    while (namespace->old_names && count--)
+    {
+        while ((entry = list_head( &namespace->old_names[namespace->old_pos] )))
+        {
+            ptr = LIST_ENTRY( entry, struct object_name, entry );
+            list_remove( &ptr->entry );
+            list_add_head( &namespace->names[get_name_hash( ptr->name, ptr->len ) % namespace->hash_size],
+                           &ptr->entry );
+        }
+        if (++namespace->old_pos < namespace->old_hash_size) continue;
+        free( namespace->old_names );
+        namespace->old_names = NULL;
+    }
+}
+
+/* grow the hash table, the names are moved over by later calls to namespace_rehash */
+static void namespace_grow( struct namespace *namespace )
+{
+    unsigned int i, hash_size = namespace->hash_size * 2 + 1;
+    struct list *names;
+
+    namespace_rehash( namespace, namespace->old_hash_size );  /* finish the previous resize */
+    if (!(names = malloc( hash_size * sizeof(*names) ))) return;  /* keep the current size */
+    for (i = 0; i < hash_size; i++) list_init( &names[i] );
+
+    namespace->old_names     = namespace->names;
+    namespace->old_hash_size = namespace->hash_size;
+    namespace->old_pos       = 0;
+    namespace->names         = names;
+    namespace->hash_size     = hash_size;
 }
 
 void namespace_add( struct namespace *namespace, struct object_name *ptr )
 {
-    int hash = get_name_hash( namespace, ptr->name, ptr->len );
+    unsigned int hash = get_name_hash( ptr->name, ptr->len );
+
+    if (++namespace->count > namespace->hash_size * NAMESPACE_MAX_LOAD && !namespace->old_names)
+        namespace_grow( namespace );
+    namespace_rehash( namespace, NAMESPACE_REHASH_STEP );
 
-    list_add_head( &namespace->names[hash], &ptr->entry );
+    list_add_head( &namespace->names[hash % namespace->hash_size], &ptr->entry );
+    ptr->namespace = namespace;
 }
 
 /* allocate a name for an object */
@@ -151,6 +204,7 @@ static struct object_name *alloc_name( const struct unicode_str *name )
     {
         ptr->len = name->len;
         ptr->parent = NULL;
+        ptr->namespace = NULL;
         memcpy( ptr->name, name->str, name->len );
     }
     return ptr;
@@ -432,15 +486,11 @@ void release_object( void *ptr )
 }
 
 /* find an object by its name; the refcount is incremented */
-struct object *find_object( const struct namespace *namespace, const struct unicode_str *name,
-                            unsigned int attributes )
+static struct object *find_object_in_list( const struct list *list, const struct unicode_str *name,
+                                           unsigned int attributes )
 {
-    const struct list *list;
     struct list *p;
 
-    if (!name || !name->len) return NULL;
-
-    list = &namespace->names[ get_name_hash( namespace, name->str, name->len ) ];
     LIST_FOR_EACH( p, list )
     {
         const struct object_name *ptr = LIST_ENTRY( p, struct object_name, entry );
@@ -459,6 +509,22 @@ struct object *find_object( const struct namespace *namespace, const struct unic
     return NULL;
 }
 
+struct object *find_object( const struct namespace *namespace, const struct unicode_str *name,
+                            unsigned int attributes )
+{
+    struct object *obj;
+    unsigned int hash;
+
+    if (!name || !name->len) return NULL;
+
+    hash = get_name_hash( name->str, name->len );
+    if ((obj = find_object_in_list( &namespace->names[hash % namespace->hash_size], name, attributes )))
+        return obj;
+    if (namespace->old_names && hash % namespace->old_hash_size >= namespace->old_pos)
+        return find_object_in_list( &namespace->old_names[hash % namespace->old_hash_size], name, attributes );
+    return NULL;
+}
+
 /* find an object by its index; the refcount is incremented */
 struct object *find_object_index( const struct namespace *namespace, unsigned int index )
 {
@@ -473,6 +539,14 @@ struct object *find_object_index( const struct namespace *namespace, unsigned in
             if (!index--) return grab_object( ptr->obj );
         }
     }
+    for (i = namespace->old_names ? namespace->old_pos : 0; i < namespace->old_hash_size; i++)
+    {
+        const struct object_name *ptr;
+        LIST_FOR_EACH_ENTRY( ptr, &namespace->old_names[i], const struct object_name, entry )
+        {
+            if (!index--) return grab_object( ptr->obj );
+        }
+    }
     set_error( STATUS_NO_MORE_ENTRIES );
     return NULL;
 }
@@ -483,15 +557,30 @@ struct namespace *create_namespace( unsigned int hash_size )
     struct namespace *namespace;
     unsigned int i;
 
-    namespace = mem_alloc( sizeof(*namespace) + (hash_size - 1) * sizeof(namespace->names[0]) );
-    if (namespace)
+    if (!(namespace = mem_alloc( sizeof(*namespace) ))) return NULL;
+    if (!(namespace->names = mem_alloc( hash_size * sizeof(*namespace->names) )))
     {
-        namespace->hash_size      = hash_size;
-        for (i = 0; i < hash_size; i++) list_init( &namespace->names[i] );
+        free( namespace );
+        return NULL;
     }
+    namespace->hash_size      = hash_size;
+    namespace->count          = 0;
+    namespace->old_names      = NULL;
+    namespace->old_hash_size  = 0;
+    namespace->old_pos        = 0;
+    for (i = 0; i < hash_size; i++) list_init( &namespace->names[i] );
     return namespace;
 }
 
+/* free a namespace, it must not contain any names */
+void free_namespace( struct namespace *namespace )
+{
+    if (!namespace) return;
+    free( namespace->names );
+    free( namespace->old_names );
+    free( namespace );
+}
+
 /* functions for unimplemented/default object operations */
 
 struct object_type *no_get_type( struct object *obj )
@@ -683,6 +772,11 @@ int no_link_name( struct object *obj, struct object_name *name, struct object *p
 void default_unlink_name( struct object *obj, struct object_name *name )
 {
     list_remove( &name->entry );
+    if (name->namespace)
+    {
+        name->namespace->count--;
+        namespace_rehash( name->namespace, NAMESPACE_REHASH_STEP );
+    }
 }
 
 struct object *no_open_file( struct object *obj, unsigned int access, unsigned int sharing,
@@ -113,6 +113,7 @@ struct object_name
     struct list         entry;           /* entry in the hash list */
     struct object      *obj;             /* object owning this name */
     struct object      *parent;          /* parent object */
+    struct namespace   *namespace;       /* namespace containing the name, if any */
     data_size_t         len;             /* name length in bytes */
     WCHAR               name[1];
 };
@@ -141,6 +142,7 @@ extern void *open_named_object( struct object *parent, const struct object_ops *
 extern void unlink_named_object( struct object *obj );
 extern void make_object_static( struct object *obj );
 extern struct namespace *create_namespace( unsigned int hash_size );
+extern void free_namespace( struct namespace *namespace );
 /* grab/release_object can take any pointer, but you better make sure */
 /* that the thing pointed to starts with a struct object... */
 extern struct object *grab_object( void *obj );
@@ -185,6 +187,24 @@ extern struct keyed_event *get_keyed_event_obj( struct process *process, obj_han
 extern void pulse_event( struct event *event );
 extern void set_event( struct event *event );
 extern void reset_event( struct event *event );
+extern int get_event_fast_sync( struct object *obj, int *index );
+
+/* semaphore functions */
+
+extern int get_semaphore_fast_sync( struct object *obj, int *index, unsigned int *max );
+
+/* fast synchronization functions */
+
+extern int alloc_fast_sync( unsigned int state );
+extern void free_fast_sync( int index );
+extern unsigned int get_fast_sync_state( int index );
+extern int cmpxchg_fast_sync_state( int index, unsigned int old, unsigned int state );
+extern void set_fast_sync_state( int index, unsigned int state );
+extern void set_fast_sync_event( int index, int signaled );
+extern int pulse_fast_sync_event( int index );
+extern void set_fast_sync_owner( int index, int server );
+extern int get_handle_fast_sync( struct process *process, obj_handle_t handle, unsigned int *index,
+                                 unsigned int *max, unsigned int *access );
 
 /* mutex functions */
 
@@ -531,6 +531,7 @@ struct thread *create_process( int fd, struct thread *parent_thread, int inherit
     process->desktop         = 0;
     process->token           = NULL;
     process->trace_data      = 0;
+    process->req_counters    = NULL;
     process->rawinput_mouse  = NULL;
     process->rawinput_kbd    = NULL;
     list_init( &process->thread_list );
@@ -641,6 +642,7 @@ static void process_destroy( struct object *obj )
     if (process->id) free_ptid( process->id );
     if (process->token) release_object( process->token );
     free( process->dir_cache );
+    free( process->req_counters );
 }
 
 /* dump a process on stdout for debugging purposes */
@@ -1352,6 +1354,75 @@ DECL_HANDLER(terminate_process)
     release_object( process );
 }
 
+static void fill_request_stats( struct request_stats *stats, int req, process_id_t pid,
+                                const struct request_counter *counter )
+{
+    stats->req        = req;
+    stats->pid        = pid;
+    stats->count      = counter->count;
+    stats->max_time   = counter->max_time;
+    stats->total_time = counter->total_time;
+    stats->reply_size = counter->reply_size;
+    memset( stats->name, 0, sizeof(stats->name) );
+    if (req != -1)
+    {
+        const char *name = get_req_name( req );
+        memcpy( stats->name, name, min( strlen(name), sizeof(stats->name) - 1 ));
+    }
+}
+
+/* retrieve the request statistics */
+DECL_HANDLER(get_request_stats)
+{
+    const struct request_counter *counters = request_counters;
+    struct request_stats *stats;
+    struct process *process;
+    unsigned int i, count = 0;
+
+    if (req->pid)
+    {
+        if (!(process = get_process_from_id( req->pid ))) return;
+        counters = process->req_counters;
+        release_object( process );
+        if (!counters) return;
+    }
+
+    for (i = 0; i < REQ_NB_REQUESTS; i++) if (counters[i].count) count++;
+    if (!req->pid)
+        LIST_FOR_EACH_ENTRY( process, &process_list, struct process, entry )
+            if (process->req_counters) count++;
+
+    reply->total = count * sizeof(*stats);
+    if (reply->total > get_reply_max_size())
+    {
+        set_error( STATUS_BUFFER_TOO_SMALL );
+        return;
+    }
+    if (!(stats = set_reply_data_size( reply->total ))) return;
+
+    for (i = 0; i < REQ_NB_REQUESTS; i++)
+        if (counters[i].count) fill_request_stats( stats++, i, req->pid, &counters[i] );
+
+    if (!req->pid)
+    {
+        LIST_FOR_EACH_ENTRY( process, &process_list, struct process, entry )
+        {
+            struct request_counter total;
+
+            if (!process->req_counters) continue;
+            memset( &total, 0, sizeof(total) );
+            for (i = 0; i < REQ_NB_REQUESTS; i++)
+            {
+                total.count      += process->req_counters[i].count;
+                total.total_time += process->req_counters[i].total_time;
+                total.reply_size += process->req_counters[i].reply_size;
+                total.max_time    = max( total.max_time, process->req_counters[i].max_time );
+            }
+            fill_request_stats( stats++, -1, process->id, &total );
+        }
+    }
+}
+
 /* fetch information about a process */
 DECL_HANDLER(get_process_info)
 {
@@ -95,6 +95,7 @@ struct process
     struct list          rawinput_devices;/* list of registered rawinput devices */
     const struct rawinput_device *rawinput_mouse; /* rawinput mouse device, if any */
     const struct rawinput_device *rawinput_kbd;   /* rawinput keyboard device, if any */
+    struct request_counter *req_counters; /* statistics by request type, allocated on first use */
 };
 
 struct process_snapshot
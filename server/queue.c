@@ -25,9 +25,17 @@
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #ifdef HAVE_POLL_H
 # include <poll.h>
 #endif
+#ifdef HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+#endif
+#ifdef HAVE_SYS_SYSCALL_H
+# include <sys/syscall.h>
+#endif
+#include <unistd.h>
 
 #include "ntstatus.h"
 #define WIN32_NO_STATUS
@@ -84,8 +92,25 @@ struct message
     unsigned int           data_size; /* size of message data */
     unsigned int           unique_id; /* unique id for nested hw message waits */
     struct message_result *result;    /* result in sender queue */
+    struct posted_group   *group;     /* group of a posted message */
+    struct list            group_entry; /* entry in the group list */
+    unsigned int           seq;       /* posting order of a posted message */
 };
 
+/* posted messages with the same window and message code, in posting order; this
+ * lets filtered retrieval look at the oldest message of each group instead of
+ * walking the whole posted message list */
+struct posted_group
+{
+    struct list            entry;     /* entry in the queue list of groups */
+    struct list            hash_entry; /* entry in the queue hash table */
+    user_handle_t          win;       /* window handle */
+    unsigned int           msg;       /* message code */
+    struct list            msgs;      /* messages of the group */
+};
+
+#define POSTED_HASH_SIZE 64
+
 struct timer
 {
     struct list     entry;     /* entry in timer list */
@@ -113,7 +138,9 @@ struct thread_input
     user_handle_t          cursor;        /* current cursor */
     int                    cursor_count;  /* cursor show count */
     struct list            msg_list;      /* list of hardware messages */
-    unsigned char          keystate[256]; /* state of each key */
+    struct shared_input   *shared;        /* state shared with the clients */
+    int                    shared_slot;   /* slot of the shared state, or -1 */
+    unsigned char         *keystate;      /* state of each key, in the shared state */
 };
 
 struct msg_queue
@@ -130,6 +157,9 @@ struct msg_queue
     int                    exit_code;       /* exit code of pending quit message */
     int                    cursor_count;    /* per-queue cursor show count */
     struct list            msg_list[NB_MSG_KINDS];  /* lists of messages */
+    struct list            posted_groups;   /* groups of posted messages */
+    struct list            posted_hash[POSTED_HASH_SIZE]; /* hash table of the posted message groups */
+    unsigned int           posted_seq;      /* sequence number of the next posted message */
     struct list            send_result;     /* stack of sent messages waiting for result */
     struct list            callback_result; /* list of callback messages waiting for result */
     struct message_result *recv_result;     /* stack of received messages waiting for result */
@@ -140,6 +170,8 @@ struct msg_queue
     struct thread_input   *input;           /* thread input descriptor */
     struct hook_table     *hooks;           /* hook table */
     timeout_t              last_get_msg;    /* time of last get message call */
+    struct shared_input   *shared;          /* state shared with the clients */
+    int                    shared_slot;     /* slot of the shared state, or -1 */
 };
 
 struct hotkey
@@ -152,6 +184,18 @@ struct hotkey
     unsigned int        flags;        /* key modifiers */
 };
 
+#if defined(__linux__) && defined(HAVE_SYS_MMAN_H) && defined(__NR_memfd_create)
+#define USE_SHARED_INPUT_REGION
+#endif
+
+/* state of desktops, thread inputs and queues published to the clients, one slot per object */
+static int shared_input_fd = -1;
+static struct shared_input *shared_input_region;
+static int *shared_input_next;          /* free list links */
+static int shared_input_free = -1;      /* head of the free list */
+static int shared_input_used;           /* number of slots ever allocated */
+static unsigned int shared_input_id;    /* id of the last allocated slot */
+
 static void msg_queue_dump( struct object *obj, int verbose );
 static int msg_queue_add_queue( struct object *obj, struct wait_queue_entry *entry );
 static void msg_queue_remove_queue( struct object *obj, struct wait_queue_entry *entry );
@@ -241,13 +285,157 @@ static void set_caret_window( struct thread_input *input, user_handle_t win )
     input->caret_state       = 0;
 }
 
+/* create the shared input region */
+static int init_shared_input_region(void)
+{
+#ifdef USE_SHARED_INPUT_REGION
+    static int failed;
+    void *ptr;
+    int fd;
+
+    if (shared_input_region) return 1;
+    if (failed) return 0;
+    failed = 1;
+
+    if ((fd = syscall( __NR_memfd_create, "wine-shared-input", 0 )) == -1) return 0;
+    if (ftruncate( fd, SHARED_INPUT_REGION_SIZE ) == -1 ||
+        (ptr = mmap( NULL, SHARED_INPUT_REGION_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 )) == MAP_FAILED)
+    {
+        close( fd );
+        return 0;
+    }
+    if (!(shared_input_next = mem_alloc( SHARED_INPUT_MAX_SLOTS * sizeof(*shared_input_next) )))
+    {
+        munmap( ptr, SHARED_INPUT_REGION_SIZE );
+        close( fd );
+        return 0;
+    }
+    shared_input_fd = fd;
+    shared_input_region = ptr;
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+/* start updating a shared state, readers retry until the matching end_shared_update */
+static inline void begin_shared_update( struct shared_input *shared )
+{
+    shared->seq++;
+    __sync_synchronize();
+}
+
+static inline void end_shared_update( struct shared_input *shared )
+{
+    __sync_synchronize();
+    shared->seq++;
+}
+
+/* allocate the shared state of an object, in private memory if the region is not available */
+struct shared_input *alloc_shared_input( int *slot )
+{
+    struct shared_input *shared;
+
+    *slot = -1;
+    if (init_shared_input_region())
+    {
+        if (shared_input_free != -1)
+        {
+            *slot = shared_input_free;
+            shared_input_free = shared_input_next[*slot];
+        }
+        else if (shared_input_used < SHARED_INPUT_MAX_SLOTS) *slot = shared_input_used++;
+    }
+    if (*slot == -1)
+    {
+        if ((shared = mem_alloc( sizeof(*shared) ))) memset( shared, 0, sizeof(*shared) );
+        return shared;
+    }
+
+    shared = &shared_input_region[*slot];
+    begin_shared_update( shared );
+    if (!++shared_input_id) shared_input_id++;
+    shared->id = shared_input_id;
+    memset( &shared->cursor_x, 0, sizeof(*shared) - offsetof( struct shared_input, cursor_x ));
+    end_shared_update( shared );
+    return shared;
+}
+
+void free_shared_input( struct shared_input *shared, int slot )
+{
+    if (slot == -1)
+    {
+        free( shared );
+        return;
+    }
+    /* make clients holding the old id go to the server */
+    begin_shared_update( shared );
+    shared->id = 0;
+    end_shared_update( shared );
+    shared_input_next[slot] = shared_input_free;
+    shared_input_free = slot;
+}
+
+/* publish the cursor position of a desktop */
+static void update_shared_cursor( struct desktop *desktop )
+{
+    struct shared_input *shared = desktop->shared;
+
+    begin_shared_update( shared );
+    shared->cursor_x      = desktop->cursor.x;
+    shared->cursor_y      = desktop->cursor.y;
+    shared->cursor_change = desktop->cursor.last_change;
+    end_shared_update( shared );
+}
+
+/* publish the foreground window of a desktop */
+static void update_shared_foreground( struct desktop *desktop )
+{
+    struct shared_input *shared = desktop->shared;
+
+    begin_shared_update( shared );
+    shared->foreground = desktop->foreground_input ? desktop->foreground_input->active : 0;
+    end_shared_update( shared );
+}
+
+/* publish the focus and active windows of a thread input */
+static void update_shared_input( struct thread_input *input )
+{
+    struct shared_input *shared = input->shared;
+
+    begin_shared_update( shared );
+    shared->focus  = input->focus;
+    shared->active = input->active;
+    end_shared_update( shared );
+    if (input->desktop && input->desktop->foreground_input == input)
+        update_shared_foreground( input->desktop );
+}
+
+/* publish the thread input of a queue */
+static void update_shared_queue( struct msg_queue *queue )
+{
+    struct shared_input *shared = queue->shared;
+
+    begin_shared_update( shared );
+    shared->input_slot = queue->input->shared_slot;
+    shared->input_id   = queue->input->shared->id;
+    end_shared_update( shared );
+}
+
 /* create a thread input object */
 static struct thread_input *create_thread_input( struct thread *thread )
 {
     struct thread_input *input;
+    struct shared_input *shared;
+    int slot;
+
+    if (!(shared = alloc_shared_input( &slot ))) return NULL;
 
     if ((input = alloc_object( &thread_input_ops )))
     {
+        input->shared       = shared;
+        input->shared_slot  = slot;
+        input->keystate     = shared->keystate;
         input->focus        = 0;
         input->capture      = 0;
         input->active       = 0;
@@ -257,7 +445,6 @@ static struct thread_input *create_thread_input( struct thread *thread )
         input->cursor_count = 0;
         list_init( &input->msg_list );
         set_caret_window( input, 0 );
-        memset( input->keystate, 0, sizeof(input->keystate) );
 
         if (!(input->desktop = get_thread_desktop( thread, 0 /* FIXME: access rights */ )))
         {
@@ -265,6 +452,7 @@ static struct thread_input *create_thread_input( struct thread *thread )
             return NULL;
         }
     }
+    else free_shared_input( shared, slot );
     return input;
 }
 
@@ -272,8 +460,9 @@ static struct thread_input *create_thread_input( struct thread *thread )
 static struct msg_queue *create_msg_queue( struct thread *thread, struct thread_input *input )
 {
     struct thread_input *new_input = NULL;
+    struct shared_input *shared;
     struct msg_queue *queue;
-    int i;
+    int i, slot;
 
     if (!input)
     {
@@ -281,8 +470,16 @@ static struct msg_queue *create_msg_queue( struct thread *thread, struct thread_
         input = new_input;
     }
 
+    if (!(shared = alloc_shared_input( &slot )))
+    {
+        if (new_input) release_object( new_input );
+        return NULL;
+    }
+
     if ((queue = alloc_object( &msg_queue_ops )))
     {
+        queue->shared          = shared;
+        queue->shared_slot     = slot;
         queue->fd              = NULL;
         queue->wake_bits       = 0;
         queue->wake_mask       = 0;
@@ -303,9 +500,14 @@ static struct msg_queue *create_msg_queue( struct thread *thread, struct thread_
         list_init( &queue->pending_timers );
         list_init( &queue->expired_timers );
         for (i = 0; i < NB_MSG_KINDS; i++) list_init( &queue->msg_list[i] );
+        list_init( &queue->posted_groups );
+        for (i = 0; i < POSTED_HASH_SIZE; i++) list_init( &queue->posted_hash[i] );
+        queue->posted_seq      = 0;
+        update_shared_queue( queue );
 
         thread->queue = queue;
     }
+    else free_shared_input( shared, slot );
     if (new_input) release_object( new_input );
     return queue;
 }
@@ -336,6 +538,7 @@ static int assign_thread_input( struct thread *thread, struct thread_input *new_
     }
     queue->input = (struct thread_input *)grab_object( new_input );
     new_input->cursor_count += queue->cursor_count;
+    update_shared_queue( queue );
     return 1;
 }
 
@@ -411,6 +614,7 @@ static void set_foreground_input( struct desktop *desktop, struct thread_input *
     if (desktop->foreground_input == input) return;
     set_clip_rectangle( desktop, NULL, 1 );
     desktop->foreground_input = input;
+    update_shared_foreground( desktop );
 }
 
 /* get the hook table for a given thread */
@@ -615,6 +819,43 @@ static void free_message( struct message *msg )
     free( msg );
 }
 
+/* add a message at the end of the posted message list */
+/* on failure the message is left untouched, the caller has to free it */
+static int add_posted_message( struct msg_queue *queue, struct message *msg )
+{
+    struct list *bucket = &queue->posted_hash[(msg->win ^ (msg->msg * 0x9e3779b1)) % POSTED_HASH_SIZE];
+    struct posted_group *group;
+
+    LIST_FOR_EACH_ENTRY( group, bucket, struct posted_group, hash_entry )
+        if (group->win == msg->win && group->msg == msg->msg) goto found;
+
+    if (!(group = mem_alloc( sizeof(*group) ))) return 0;
+    group->win = msg->win;
+    group->msg = msg->msg;
+    list_init( &group->msgs );
+    list_add_tail( &queue->posted_groups, &group->entry );
+    list_add_head( bucket, &group->hash_entry );
+
+found:
+    msg->group = group;
+    msg->seq   = queue->posted_seq++;
+    list_add_tail( &group->msgs, &msg->group_entry );
+    list_add_tail( &queue->msg_list[POST_MESSAGE], &msg->entry );
+    return 1;
+}
+
+/* remove a posted message from its group */
+static void remove_posted_group_entry( struct message *msg )
+{
+    struct posted_group *group = msg->group;
+
+    list_remove( &msg->group_entry );
+    if (!list_empty( &group->msgs )) return;
+    list_remove( &group->entry );
+    list_remove( &group->hash_entry );
+    free( group );
+}
+
 /* remove (and free) a message from a message list */
 static void remove_queue_message( struct msg_queue *queue, struct message *msg,
                                   enum message_kind kind )
@@ -626,6 +867,7 @@ static void remove_queue_message( struct msg_queue *queue, struct message *msg,
         if (list_empty( &queue->msg_list[kind] )) clear_queue_bits( queue, QS_SENDMESSAGE );
         break;
     case POST_MESSAGE:
+        remove_posted_group_entry( msg );
         if (list_empty( &queue->msg_list[kind] ) && !queue->quit_message)
             clear_queue_bits( queue, QS_POSTMESSAGE|QS_ALLPOSTMESSAGE );
         if (msg->msg == WM_HOTKEY && --queue->hotkey_count == 0)
@@ -783,16 +1025,27 @@ static int get_posted_message( struct msg_queue *queue, user_handle_t win,
                                unsigned int first, unsigned int last, unsigned int flags,
                                struct get_message_reply *reply )
 {
-    struct message *msg;
+    struct posted_group *group;
+    struct message *msg, *oldest;
+    struct list *ptr;
+
+    if (!(ptr = list_head( &queue->msg_list[POST_MESSAGE] ))) return 0;
+
+    /* the oldest message is the usual match */
+    msg = LIST_ENTRY( ptr, struct message, entry );
+    if (match_window( win, msg->win ) && check_msg_filter( msg->msg, first, last )) goto found;
 
-    /* check against the filters */
-    LIST_FOR_EACH_ENTRY( msg, &queue->msg_list[POST_MESSAGE], struct message, entry )
+    /* check the oldest message of each group against the filters */
+    msg = NULL;
+    LIST_FOR_EACH_ENTRY( group, &queue->posted_groups, struct posted_group, entry )
     {
-        if (!match_window( win, msg->win )) continue;
-        if (!check_msg_filter( msg->msg, first, last )) continue;
-        goto found; /* found one */
+        if (!check_msg_filter( group->msg, first, last )) continue;
+        oldest = LIST_ENTRY( list_head( &group->msgs ), struct message, group_entry );
+        if (msg && (int)(oldest->seq - msg->seq) > 0) continue;
+        if (!match_window( win, group->win )) continue;
+        msg = oldest;
     }
-    return 0;
+    if (!msg) return 0;
 
     /* return it to the app */
 found:
@@ -968,6 +1221,11 @@ static void msg_queue_destroy( struct object *obj )
 
     cleanup_results( queue );
     for (i = 0; i < NB_MSG_KINDS; i++) empty_msg_list( &queue->msg_list[i] );
+    while ((ptr = list_head( &queue->posted_groups )))
+    {
+        list_remove( ptr );
+        free( LIST_ENTRY( ptr, struct posted_group, entry ));
+    }
 
     LIST_FOR_EACH_ENTRY_SAFE( hotkey, hotkey2, &queue->input->desktop->hotkeys, struct hotkey, entry )
     {
@@ -995,6 +1253,7 @@ static void msg_queue_destroy( struct object *obj )
     release_object( queue->input );
     if (queue->hooks) release_object( queue->hooks );
     if (queue->fd) release_object( queue->fd );
+    free_shared_input( queue->shared, queue->shared_slot );
 }
 
 static void msg_queue_poll_event( struct fd *fd, int event )
@@ -1024,6 +1283,7 @@ static void thread_input_destroy( struct object *obj )
         if (input->desktop->foreground_input == input) set_foreground_input( input->desktop, NULL );
         release_object( input->desktop );
     }
+    free_shared_input( input->shared, input->shared_slot );
 }
 
 /* fix the thread input data when a window is destroyed */
@@ -1037,6 +1297,7 @@ static inline void thread_input_cleanup_window( struct msg_queue *queue, user_ha
     if (window == input->menu_owner) input->menu_owner = 0;
     if (window == input->move_size) input->move_size = 0;
     if (window == input->caret) set_caret_window( input, 0 );
+    update_shared_input( input );
 }
 
 /* check if the specified window can be set in the input data of a given queue */
@@ -1088,10 +1349,16 @@ int attach_thread_input( struct thread *thread_from, struct thread *thread_to )
     {
         if (!input->focus) input->focus = thread_from->queue->input->focus;
         if (!input->active) input->active = thread_from->queue->input->active;
+        update_shared_input( input );
     }
 
     ret = assign_thread_input( thread_from, input );
-    if (ret) memset( input->keystate, 0, sizeof(input->keystate) );
+    if (ret)
+    {
+        begin_shared_update( input->shared );
+        memset( input->keystate, 0, 256 );
+        end_shared_update( input->shared );
+    }
     release_object( input );
     return ret;
 }
@@ -1122,6 +1389,8 @@ void detach_thread_input( struct thread *thread_from )
             }
             release_object( thread );
         }
+        update_shared_input( old_input );
+        update_shared_input( input );
         assign_thread_input( thread_from, input );
         release_object( input );
     }
@@ -1262,12 +1531,14 @@ static void set_input_key_state( unsigned char *keystate, unsigned char key, int
 }
 
 /* update the input key state for a keyboard message */
-static void update_input_key_state( struct desktop *desktop, unsigned char *keystate,
+static void update_input_key_state( struct desktop *desktop, struct shared_input *shared,
                                     const struct message *msg )
 {
+    unsigned char *keystate = shared->keystate;
     unsigned char key;
     int down = 0;
 
+    begin_shared_update( shared );
     switch (msg->msg)
     {
     case WM_LBUTTONDOWN:
@@ -1323,6 +1594,15 @@ static void update_input_key_state( struct desktop *desktop, unsigned char *keys
         }
         break;
     }
+    end_shared_update( shared );
+}
+
+/* replace the key state of a desktop or thread input */
+static void set_shared_key_state( struct shared_input *shared, const void *keystate, data_size_t size )
+{
+    begin_shared_update( shared );
+    memcpy( shared->keystate, keystate, size );
+    end_shared_update( shared );
 }
 
 /* release the hardware message currently being processed by the given thread */
@@ -1355,7 +1635,7 @@ static void release_hardware_message( struct msg_queue *queue, unsigned int hw_i
         }
         if (clr_bit) clear_queue_bits( queue, clr_bit );
 
-        update_input_key_state( input->desktop, input->keystate, msg );
+        update_input_key_state( input->desktop, input->shared, msg );
         list_remove( &msg->entry );
         free_message( msg );
     }
@@ -1392,7 +1672,11 @@ found:
     msg->data      = NULL;
     msg->data_size = 0;
 
-    list_add_tail( &hotkey->queue->msg_list[POST_MESSAGE], &msg->entry );
+    if (!add_posted_message( hotkey->queue, msg ))
+    {
+        free_message( msg );
+        return 1;
+    }
     set_queue_bits( hotkey->queue, QS_POSTMESSAGE|QS_ALLPOSTMESSAGE|QS_HOTKEY );
     hotkey->queue->hotkey_count++;
     return 1;
@@ -1474,7 +1758,7 @@ static void queue_hardware_message( struct desktop *desktop, struct message *msg
     struct thread_input *input;
     unsigned int msg_code;
 
-    update_input_key_state( desktop, desktop->keystate, msg );
+    update_input_key_state( desktop, desktop->shared, msg );
     last_input_time = get_tick_count();
     if (msg->msg != WM_MOUSEMOVE) always_queue = 1;
 
@@ -1495,6 +1779,7 @@ static void queue_hardware_message( struct desktop *desktop, struct message *msg
             desktop->cursor.x = x;
             desktop->cursor.y = y;
             desktop->cursor.last_change = get_tick_count();
+            update_shared_cursor( desktop );
         }
         if (desktop->keystate[VK_LBUTTON] & 0x80)  msg->wparam |= MK_LBUTTON;
         if (desktop->keystate[VK_MBUTTON] & 0x80)  msg->wparam |= MK_MBUTTON;
@@ -1517,7 +1802,7 @@ static void queue_hardware_message( struct desktop *desktop, struct message *msg
     win = find_hardware_message_window( desktop, input, msg, &msg_code, &thread );
     if (!win || !thread)
     {
-        if (input) update_input_key_state( input->desktop, input->keystate, msg );
+        if (input) update_input_key_state( input->desktop, input->shared, msg );
         free_message( msg );
         return;
     }
@@ -1611,6 +1896,7 @@ static int queue_mouse_message( struct desktop *desktop, user_handle_t win, cons
     };
 
     desktop->cursor.last_change = get_tick_count();
+    update_shared_cursor( desktop );
     flags = input->mouse.flags;
     time  = input->mouse.time;
     if (!time) time = desktop->cursor.last_change;
@@ -1959,7 +2245,7 @@ static int get_hardware_message( struct thread *thread, unsigned int hw_id, user
         if (!win || !win_thread)
         {
             /* no window at all, remove it */
-            update_input_key_state( input->desktop, input->keystate, msg );
+            update_input_key_state( input->desktop, input->shared, msg );
             list_remove( &msg->entry );
             free_message( msg );
             continue;
@@ -1975,7 +2261,7 @@ static int get_hardware_message( struct thread *thread, unsigned int hw_id, user
             else
             {
                 /* for another thread input, drop it */
-                update_input_key_state( input->desktop, input->keystate, msg );
+                update_input_key_state( input->desktop, input->shared, msg );
                 list_remove( &msg->entry );
                 free_message( msg );
             }
@@ -2101,12 +2387,15 @@ void post_message( user_handle_t win, unsigned int message, lparam_t wparam, lpa
 
         get_message_defaults( thread->queue, &msg->x, &msg->y, &msg->time );
 
-        list_add_tail( &thread->queue->msg_list[POST_MESSAGE], &msg->entry );
-        set_queue_bits( thread->queue, QS_POSTMESSAGE|QS_ALLPOSTMESSAGE );
-        if (message == WM_HOTKEY)
+        if (!add_posted_message( thread->queue, msg )) free_message( msg );
+        else
         {
-            set_queue_bits( thread->queue, QS_HOTKEY );
-            thread->queue->hotkey_count++;
+            set_queue_bits( thread->queue, QS_POSTMESSAGE|QS_ALLPOSTMESSAGE );
+            if (message == WM_HOTKEY)
+            {
+                set_queue_bits( thread->queue, QS_HOTKEY );
+                thread->queue->hotkey_count++;
+            }
         }
     }
     release_object( thread );
@@ -2342,7 +2631,12 @@ DECL_HANDLER(send_message)
             set_queue_bits( recv_queue, QS_SENDMESSAGE );
             break;
         case MSG_POSTED:
-            list_add_tail( &recv_queue->msg_list[POST_MESSAGE], &msg->entry );
+            if (!add_posted_message( recv_queue, msg ))
+            {
+                free_message( msg );
+                set_error( STATUS_NO_MEMORY );
+                break;
+            }
             set_queue_bits( recv_queue, QS_POSTMESSAGE|QS_ALLPOSTMESSAGE );
             if (msg->msg == WM_HOTKEY)
             {
@@ -2881,7 +3175,9 @@ DECL_HANDLER(get_key_state)
         if (req->key >= 0)
         {
             reply->state = desktop->keystate[req->key & 0xff];
+            begin_shared_update( desktop->shared );
             desktop->keystate[req->key & 0xff] &= ~0x40;
+            end_shared_update( desktop->shared );
         }
         set_reply_data( desktop->keystate, size );
         release_object( desktop );
@@ -2912,6 +3208,49 @@ DECL_HANDLER(get_key_state)
 }
 
 
+/* get a handle to a file holding the shared input region */
+DECL_HANDLER(get_shared_input_region)
+{
+    struct file *file;
+    int fd;
+
+    if (!init_shared_input_region())
+    {
+        set_error( STATUS_NOT_IMPLEMENTED );
+        return;
+    }
+    if ((fd = dup( shared_input_fd )) == -1)
+    {
+        file_set_error();
+        return;
+    }
+    if ((file = create_file_for_fd( fd, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE )))
+    {
+        reply->handle = alloc_handle( current->process, file, GENERIC_READ, 0 );
+        reply->size   = SHARED_INPUT_REGION_SIZE;
+        release_object( file );
+    }
+}
+
+
+/* get the shared input slots of the current thread */
+DECL_HANDLER(get_shared_input)
+{
+    struct desktop *desktop;
+
+    if (!(desktop = get_thread_desktop( current, 0 ))) return;
+    reply->desktop_slot = desktop->shared_slot;
+    reply->desktop_id   = desktop->shared->id;
+    reply->queue_slot   = -1;
+    if (current->queue)
+    {
+        reply->queue_slot = current->queue->shared_slot;
+        reply->queue_id   = current->queue->shared->id;
+    }
+    release_object( desktop );
+}
+
+
 /* set queue keyboard state for a given thread */
 DECL_HANDLER(set_key_state)
 {
@@ -2922,16 +3261,16 @@ DECL_HANDLER(set_key_state)
     if (!req->tid)  /* set global async key state */
     {
         if (!(desktop = get_thread_desktop( current, 0 ))) return;
-        memcpy( desktop->keystate, get_req_data(), size );
+        set_shared_key_state( desktop->shared, get_req_data(), size );
         release_object( desktop );
     }
     else
     {
         if (!(thread = get_thread_from_id( req->tid ))) return;
-        if (thread->queue) memcpy( thread->queue->input->keystate, get_req_data(), size );
+        if (thread->queue) set_shared_key_state( thread->queue->input->shared, get_req_data(), size );
         if (req->async && (desktop = get_thread_desktop( thread, 0 )))
         {
-            memcpy( desktop->keystate, get_req_data(), size );
+            set_shared_key_state( desktop->shared, get_req_data(), size );
             release_object( desktop );
         }
         release_object( thread );
@@ -2975,6 +3314,7 @@ DECL_HANDLER(set_focus_window)
     {
         reply->previous = queue->input->focus;
         queue->input->focus = get_user_full_handle( req->handle );
+        update_shared_input( queue->input );
     }
 }
 
@@ -2991,6 +3331,7 @@ DECL_HANDLER(set_active_window)
         {
             reply->previous = queue->input->active;
             queue->input->active = get_user_full_handle( req->handle );
+            update_shared_input( queue->input );
         }
         else set_error( STATUS_INVALID_HANDLE );
     }
@@ -35,6 +35,12 @@
 #include <string.h>
 #include <stdlib.h>
 #include <sys/stat.h>
+#ifdef HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+#endif
+#ifdef HAVE_SYS_SYSCALL_H
+# include <sys/syscall.h>
+#endif
 #include <unistd.h>
 
 #include "ntstatus.h"
@@ -78,6 +84,10 @@ struct key
     unsigned int      flags;       /* flags */
     timeout_t         modif;       /* last modification time */
     struct list       notify_list; /* list of notifications */
+    int               seq_index;   /* index of the change sequence number, or -1 */
+    const struct snapshot_key *hive; /* snapshot data for the subkeys and values not loaded yet */
+    struct name_index *subkey_index; /* hash index of the subkeys array, for large keys */
+    struct name_index *value_index;  /* hash index of the values array, for large keys */
 };
 
 /* key flags */
@@ -101,6 +111,28 @@ struct key_value
 #define MIN_SUBKEYS  8   /* min. number of allocated subkeys per key */
 #define MIN_VALUES   8   /* min. number of allocated values per key */
 
+#define MIN_INDEXED  64  /* min. number of subkeys or values for a key to get a hash index */
+#define REBUILD_LOOKUPS 8  /* a stale index is rebuilt after count / REBUILD_LOOKUPS lookups */
+
+/* Case-insensitive hash index of the subkeys or values of a key. It maps the
+ * name hashes to the positions in the sorted arrays, which stay authoritative
+ * for enumeration. Collisions are resolved by linear probing. Inserts and
+ * deletes only mark the index as stale, it is rebuilt lazily. */
+struct name_index_entry
+{
+    unsigned int hash;
+    int          pos;   /* position in the array, -1 if the entry is free */
+};
+
+struct name_index
+{
+    unsigned int            size;  /* number of entries, a power of 2 */
+    unsigned int            count; /* number of used entries */
+    int                     valid; /* whether the positions are up to date */
+    unsigned int            lookups; /* lookups done since the index went stale */
+    struct name_index_entry entries[1];
+};
+
 #define MAX_NAME_LEN  256    /* max. length of a key name */
 #define MAX_VALUE_LEN 16383  /* max. length of a value name */
 
@@ -118,18 +150,88 @@ static const WCHAR symlink_value[] = {'S','y','m','b','o','l','i','c','L','i','n
 static const struct unicode_str symlink_str = { symlink_value, sizeof(symlink_value) };
 
 static void set_periodic_save_timer(void);
-static struct key_value *find_value( const struct key *key, const struct unicode_str *name, int *index );
+static void materialize_key( struct key *key );
+static struct key_value *find_value( struct key *key, const struct unicode_str *name, int *index );
+
+#if defined(__linux__) && defined(HAVE_SYS_MMAN_H) && defined(__NR_memfd_create)
+#define USE_KEY_SEQ_REGION
+#endif
+
+#define KEY_SEQ_MAX_INDEX (KEY_SEQ_REGION_SIZE / sizeof(unsigned int))
+
+/* change sequence numbers shared with the clients, allocated when a client first reads a value */
+static int key_seq_fd = -1;
+static unsigned int *key_seq_region;
+static int *key_seq_next;               /* free list links */
+static int key_seq_free = -1;           /* head of the free list */
+static int key_seq_used;                /* number of indices ever allocated */
 
 /* information about where to save a registry branch */
 struct save_branch_info
 {
     struct key  *key;
     const char  *path;
+    char        *journal_path;  /* path of the change journal */
+    FILE        *journal;       /* changes made since the last full save */
+    struct key  *journal_last;  /* key of the last journal record */
+    int          compact;       /* changes the journal can't describe were made */
+    off_t        file_size;     /* size of the file at the last full save */
+    char        *snapshot_path; /* path of the binary snapshot, if enabled */
+    const char  *snapshot;      /* snapshot mapped at startup */
+    size_t       snapshot_size;
 };
 
 #define MAX_SAVE_BRANCH_INFO 3
 static int save_branch_count;
 static struct save_branch_info save_branch_info[MAX_SAVE_BRANCH_INFO];
+static int replaying_journal;  /* set while loading a change journal */
+
+/* the journal is compacted into the branch file once it grows larger than both */
+#define JOURNAL_MIN_COMPACT_SIZE (1024 * 1024)
+
+/* Binary snapshot of a branch, written next to the text file when WINEREGSNAPSHOT is set.
+ * It is mapped at startup instead of parsing the text file, and the subkeys and values of
+ * a key are only created from it when the key is first accessed. Offsets are relative to
+ * the start of the snapshot, keys are 8-byte aligned and subkeys and values are sorted
+ * like the in-memory arrays. Keys keep their KEY_WOW64 flag, so that Wow64 redirection
+ * works before their subkeys are created. */
+#define SNAPSHOT_MAGIC   0x48474552  /* "REGH" */
+#define SNAPSHOT_VERSION 2
+
+struct snapshot_header
+{
+    unsigned int   magic;
+    unsigned int   version;
+    unsigned int   size;         /* total size of the snapshot */
+    unsigned int   root;         /* offset of the branch key */
+    unsigned int   prefix_type;
+    unsigned int   __pad;
+    file_pos_t     file_inode;   /* text file the snapshot was written from */
+    file_pos_t     file_size;
+    timeout_t      file_mtime;
+};
+
+struct snapshot_key
+{
+    timeout_t      modif;
+    unsigned int   flags;        /* KEY_SYMLINK and KEY_WOW64 */
+    unsigned short namelen;
+    unsigned short classlen;
+    unsigned int   subkey_count;
+    unsigned int   subkeys;      /* offset of the array of subkey offsets */
+    unsigned int   value_count;
+    unsigned int   values;       /* offset of the array of values */
+    WCHAR          name[1];      /* name followed by class */
+};
+
+struct snapshot_value
+{
+    unsigned int   type;
+    unsigned int   namelen;
+    unsigned int   name;         /* offset of the name */
+    data_size_t    len;
+    unsigned int   data;         /* offset of the data */
+};
 
 
 /* information about a file being loaded */
@@ -188,6 +290,14 @@ static inline int is_wow6432node( const WCHAR *name, unsigned int len )
  * - key names use escapes too in order to support Unicode
  * - the modification time optionally follows the key name
  * - REG_EXPAND_SZ and REG_MULTI_SZ are saved as strings instead of hex
+ *
+ * Between full saves, changes are appended to a journal file next to the
+ * branch file. It uses the same format, consecutive changes to a key being
+ * grouped under one key header, with two extra key options: #delete to
+ * delete the key and its subkeys, and #delete_value= followed by a value
+ * name to delete a value. The journal is replayed on top of the branch file
+ * on startup, without following symlinks since records name the link keys
+ * themselves.
  */
 
 /* dump the full path of a key */
@@ -255,27 +365,34 @@ static void dump_value( const struct key_value *value, FILE *f )
     fputc( '\n', f );
 }
 
+/* dump a key name and its options to a text file */
+static void dump_key( const struct key *key, const struct key *base, FILE *f )
+{
+    fprintf( f, "\n[" );
+    if (key != base) dump_path( key, base, f );
+    fprintf( f, "] %u\n", (unsigned int)((key->modif - ticks_1601_to_1970) / TICKS_PER_SEC) );
+    fprintf( f, "#time=%x%08x\n", (unsigned int)(key->modif >> 32), (unsigned int)key->modif );
+    if (key->class)
+    {
+        fprintf( f, "#class=\"" );
+        dump_strW( key->class, key->classlen / sizeof(WCHAR), f, "\"\"" );
+        fprintf( f, "\"\n" );
+    }
+    if (key->flags & KEY_SYMLINK) fputs( "#link\n", f );
+}
+
 /* save a registry and all its subkeys to a text file */
-static void save_subkeys( const struct key *key, const struct key *base, FILE *f )
+static void save_subkeys( struct key *key, const struct key *base, FILE *f )
 {
     int i;
 
     if (key->flags & KEY_VOLATILE) return;
+    materialize_key( key );
     /* save key if it has either some values or no subkeys, or needs special options */
     /* keys with no values but subkeys are saved implicitly by saving the subkeys */
     if ((key->last_value >= 0) || (key->last_subkey == -1) || key->class || (key->flags & KEY_SYMLINK))
     {
-        fprintf( f, "\n[" );
-        if (key != base) dump_path( key, base, f );
-        fprintf( f, "] %u\n", (unsigned int)((key->modif - ticks_1601_to_1970) / TICKS_PER_SEC) );
-        fprintf( f, "#time=%x%08x\n", (unsigned int)(key->modif >> 32), (unsigned int)key->modif );
-        if (key->class)
-        {
-            fprintf( f, "#class=\"" );
-            dump_strW( key->class, key->classlen / sizeof(WCHAR), f, "\"\"" );
-            fprintf( f, "\"\n" );
-        }
-        if (key->flags & KEY_SYMLINK) fputs( "#link\n", f );
+        dump_key( key, base, f );
         for (i = 0; i <= key->last_value; i++) dump_value( &key->values[i], f );
     }
     for (i = 0; i <= key->last_subkey; i++) save_subkeys( key->subkeys[i], base, f );
@@ -403,6 +520,59 @@ static int key_close_handle( struct object *obj, struct process *process, obj_ha
     return 1;  /* ok to close */
 }
 
+/* create the shared region of the change sequence numbers */
+static int init_key_seq_region(void)
+{
+#ifdef USE_KEY_SEQ_REGION
+    static int failed;
+    void *ptr;
+    int fd;
+
+    if (key_seq_region) return 1;
+    if (failed) return 0;
+    failed = 1;
+
+    if ((fd = syscall( __NR_memfd_create, "wine-key-seq", 0 )) == -1) return 0;
+    if (ftruncate( fd, KEY_SEQ_REGION_SIZE ) == -1 ||
+        (ptr = mmap( NULL, KEY_SEQ_REGION_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 )) == MAP_FAILED)
+    {
+        close( fd );
+        return 0;
+    }
+    if (!(key_seq_next = mem_alloc( KEY_SEQ_MAX_INDEX * sizeof(*key_seq_next) )))
+    {
+        munmap( ptr, KEY_SEQ_REGION_SIZE );
+        close( fd );
+        return 0;
+    }
+    key_seq_fd = fd;
+    key_seq_region = ptr;
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+/* get the index of the change sequence number of a key, allocating it if needed */
+static int get_key_seq_index( struct key *key )
+{
+    if (key->seq_index != -1 || !init_key_seq_region()) return key->seq_index;
+
+    if (key_seq_free != -1)
+    {
+        key->seq_index = key_seq_free;
+        key_seq_free = key_seq_next[key_seq_free];
+    }
+    else if (key_seq_used < KEY_SEQ_MAX_INDEX) key->seq_index = key_seq_used++;
+    return key->seq_index;
+}
+
+/* invalidate the values that clients have cached for a key */
+static inline void bump_key_seq( struct key *key )
+{
+    if (key->seq_index != -1) key_seq_region[key->seq_index]++;
+}
+
 static void key_destroy( struct object *obj )
 {
     int i;
@@ -410,6 +580,13 @@ static void key_destroy( struct object *obj )
     struct key *key = (struct key *)obj;
     assert( obj->ops == &key_ops );
 
+    if (key->seq_index != -1)
+    {
+        bump_key_seq( key );
+        key_seq_next[key->seq_index] = key_seq_free;
+        key_seq_free = key->seq_index;
+    }
+
     free( key->name );
     free( key->class );
     for (i = 0; i <= key->last_value; i++)
@@ -418,12 +595,14 @@ static void key_destroy( struct object *obj )
         free( key->values[i].data );
     }
     free( key->values );
+    free( key->value_index );
     for (i = 0; i <= key->last_subkey; i++)
     {
         key->subkeys[i]->parent = NULL;
         release_object( key->subkeys[i] );
     }
     free( key->subkeys );
+    free( key->subkey_index );
     /* unconditionally notify everything waiting on this key */
     while ((ptr = list_head( &key->notify_list )))
     {
@@ -473,6 +652,75 @@ static struct unicode_str *get_path_token( const struct unicode_str *path, struc
     return token;
 }
 
+/* hash a key or value name, case-insensitively */
+static unsigned int hash_name( const WCHAR *name, data_size_t len )
+{
+    unsigned int i, hash = 0x811c9dc5;
+
+    for (i = 0; i < len / sizeof(WCHAR); i++) hash = (hash ^ tolowerW( name[i] )) * 0x01000193;
+    return hash;
+}
+
+static struct name_index *alloc_name_index( unsigned int count )
+{
+    struct name_index *index;
+    unsigned int size = 16;
+
+    while (size < 2 * count) size *= 2;
+    if (!(index = malloc( FIELD_OFFSET( struct name_index, entries[size] ) ))) return NULL;
+    index->size    = size;
+    index->count   = 0;
+    index->valid   = 0;
+    index->lookups = 0;
+    return index;
+}
+
+static void name_index_insert( struct name_index *index, unsigned int hash, int pos )
+{
+    unsigned int i, mask = index->size - 1;
+
+    for (i = hash & mask; index->entries[i].pos != -1; i = (i + 1) & mask) ;
+    index->entries[i].hash = hash;
+    index->entries[i].pos  = pos;
+    index->count++;
+}
+
+/* the positions changed, the index has to be rebuilt before it can be used again */
+static void name_index_invalidate( struct name_index *index )
+{
+    if (!index) return;
+    index->valid   = 0;
+    index->lookups = 0;
+}
+
+/* get an index that the caller fills if it isn't valid, or NULL to do a binary search instead;
+ * a stale index is only rebuilt once enough lookups happened since the last change, so that
+ * series of inserts or deletes don't rebuild it every time */
+static struct name_index *get_name_index( struct name_index **index_ptr, unsigned int count )
+{
+    struct name_index *index = *index_ptr;
+    unsigned int i;
+
+    if (index)
+    {
+        if (index->valid) return index;
+        if (++index->lookups < count / REBUILD_LOOKUPS) return NULL;
+        if (index->size < 2 * count)
+        {
+            free( index );
+            index = NULL;
+        }
+    }
+    if (!index && !(index = alloc_name_index( count )))
+    {
+        *index_ptr = NULL;
+        return NULL;
+    }
+    for (i = 0; i < index->size; i++) index->entries[i].pos = -1;
+    index->count = 0;
+    return *index_ptr = index;
+}
+
 /* allocate a key object */
 static struct key *alloc_key( const struct unicode_str *name, timeout_t modif )
 {
@@ -492,6 +740,10 @@ static struct key *alloc_key( const struct unicode_str *name, timeout_t modif )
         key->values      = NULL;
         key->modif       = modif;
         key->parent      = NULL;
+        key->seq_index   = -1;
+        key->hive        = NULL;
+        key->subkey_index = NULL;
+        key->value_index = NULL;
         list_init( &key->notify_list );
         if (name->len && !(key->name = memdup( name->str, name->len )))
         {
@@ -524,6 +776,85 @@ static void make_clean( struct key *key )
     for (i = 0; i <= key->last_subkey; i++) make_clean( key->subkeys[i] );
 }
 
+/* find the saved branch containing a key */
+static struct save_branch_info *get_key_branch( const struct key *key )
+{
+    int i;
+
+    for ( ; key; key = key->parent)
+    {
+        if (key->flags & KEY_VOLATILE) return NULL;
+        for (i = 0; i < save_branch_count; i++)
+            if (save_branch_info[i].key == key) return &save_branch_info[i];
+    }
+    return NULL;
+}
+
+/* forget the key of the last journal record, the next change needs a new key header */
+static void journal_end_record( struct save_branch_info *info )
+{
+    if (info->journal_last) release_object( info->journal_last );
+    info->journal_last = NULL;
+}
+
+/* start a journal record for a modified key, return the journal to write the change to */
+static FILE *journal_key( struct key *key )
+{
+    struct save_branch_info *info;
+
+    if (replaying_journal || !(info = get_key_branch( key ))) return NULL;
+    if (!info->journal || info->compact) return NULL;
+    if (key == info->journal_last)  /* continue the current record */
+    {
+        fprintf( info->journal, "#time=%x%08x\n", (unsigned int)(key->modif >> 32), (unsigned int)key->modif );
+        return info->journal;
+    }
+    journal_end_record( info );
+    dump_key( key, info->key, info->journal );
+    /* hold a reference so that a new key can't reuse the address */
+    info->journal_last = (struct key *)grab_object( key );
+    return info->journal;
+}
+
+/* record the deletion of a key and its subkeys in the journal */
+static void journal_delete_key( const struct key *key )
+{
+    struct save_branch_info *info;
+
+    if (replaying_journal || !(info = get_key_branch( key ))) return;
+    if (key == info->key) info->compact = 1;  /* can't be replayed relative to itself */
+    else if (info->journal && !info->compact)
+    {
+        journal_end_record( info );
+        dump_key( key, info->key, info->journal );
+        fputs( "#delete\n", info->journal );
+    }
+}
+
+/* record the deletion of a value in the journal */
+static void journal_delete_value( struct key *key, const struct unicode_str *name )
+{
+    FILE *f;
+
+    if (!(f = journal_key( key ))) return;
+    fputs( "#delete_value=", f );
+    if (name->len)
+    {
+        fputc( '\"', f );
+        dump_strW( name->str, name->len / sizeof(WCHAR), f, "\"\"" );
+        fputs( "\"\n", f );
+    }
+    else fputs( "@\n", f );
+}
+
+/* the journal of the branch can't describe a change, the next save will rewrite the file */
+static void journal_invalidate( const struct key *key )
+{
+    struct save_branch_info *info;
+
+    if (!replaying_journal && (info = get_key_branch( key ))) info->compact = 1;
+}
+
 /* go through all the notifications and send them if necessary */
 static void check_notify( struct key *key, unsigned int change, int not_subtree )
 {
@@ -544,6 +875,7 @@ static void touch_key( struct key *key, unsigned int change )
 
     key->modif = current_time;
     make_dirty( key );
+    bump_key_seq( key );
 
     /* do notifications */
     check_notify( key, change, 1 );
@@ -599,6 +931,7 @@ static struct key *alloc_subkey( struct key *parent, const struct unicode_str *n
         for (i = ++parent->last_subkey; i > index; i--)
             parent->subkeys[i] = parent->subkeys[i-1];
         parent->subkeys[index] = key;
+        name_index_invalidate( parent->subkey_index );
         if (is_wow6432node( key->name, key->namelen ) && !is_wow6432node( parent->name, parent->namelen ))
             parent->flags |= KEY_WOW64;
     }
@@ -615,9 +948,11 @@ static void free_subkey( struct key *parent, int index )
     assert( index <= parent->last_subkey );
 
     key = parent->subkeys[index];
+    name_index_invalidate( parent->subkey_index );
     for (i = index; i < parent->last_subkey; i++) parent->subkeys[i] = parent->subkeys[i + 1];
     parent->last_subkey--;
     key->flags |= KEY_DELETED;
+    bump_key_seq( key );
     key->parent = NULL;
     if (is_wow6432node( key->name, key->namelen )) parent->flags &= ~KEY_WOW64;
     release_object( key );
@@ -635,12 +970,47 @@ static void free_subkey( struct key *parent, int index )
     }
 }
 
+/* find a subkey through the hash index, building it if needed; return its position or -1 */
+static int lookup_subkey_index( struct key *key, const struct unicode_str *name )
+{
+    struct name_index *index;
+    unsigned int i, mask, hash;
+    int pos;
+
+    if (!(index = get_name_index( &key->subkey_index, key->last_subkey + 1 ))) return -1;
+    if (!index->valid)
+    {
+        for (pos = 0; pos <= key->last_subkey; pos++)
+            name_index_insert( index, hash_name( key->subkeys[pos]->name, key->subkeys[pos]->namelen ), pos );
+        index->valid = 1;
+    }
+
+    hash = hash_name( name->str, name->len );
+    mask = index->size - 1;
+    for (i = hash & mask; (pos = index->entries[i].pos) != -1; i = (i + 1) & mask)
+    {
+        const struct key *subkey = key->subkeys[pos];
+
+        if (index->entries[i].hash == hash && subkey->namelen == name->len &&
+            !memicmpW( subkey->name, name->str, name->len / sizeof(WCHAR) ))
+            return pos;
+    }
+    return -1;
+}
+
 /* find the named child of a given key and return its index */
-static struct key *find_subkey( const struct key *key, const struct unicode_str *name, int *index )
+static struct key *find_subkey( struct key *key, const struct unicode_str *name, int *index )
 {
     int i, min, max, res;
     data_size_t len;
 
+    materialize_key( key );
+    if (key->last_subkey + 1 >= MIN_INDEXED && (i = lookup_subkey_index( key, name )) != -1)
+    {
+        *index = i;
+        return key->subkeys[i];
+    }
+    /* binary search, also used to get the insertion point of a new subkey */
     min = 0;
     max = key->last_subkey;
     while (min <= max)
@@ -828,6 +1198,7 @@ static struct key *create_key( struct key *key, const struct unicode_str *name,
         free(key->class);
         if (!(key->class = memdup( class->str, key->classlen ))) key->classlen = 0;
     }
+    journal_key( key );
     touch_key( key->parent, REG_NOTIFY_CHANGE_NAME );
     grab_object( key );
     return key;
@@ -847,7 +1218,8 @@ static struct key *create_key_recursive( struct key *key, const struct unicode_s
         struct key *subkey;
         if (!(subkey = find_subkey( key, &token, &index ))) break;
         key = subkey;
-        if (!(key = follow_symlink( key, 0 )))
+        /* journal records name the keys themselves, like OBJ_OPENLINK */
+        if (!replaying_journal && !(key = follow_symlink( key, 0 )))
         {
             set_error( STATUS_OBJECT_NAME_NOT_FOUND );
             return NULL;
@@ -877,7 +1249,7 @@ static struct key *create_key_recursive( struct key *key, const struct unicode_s
 }
 
 /* query information about a key or a subkey */
-static void enum_key( const struct key *key, int index, int info_class,
+static void enum_key( struct key *key, int index, int info_class,
                       struct enum_key_reply *reply )
 {
     static const WCHAR backslash[] = { '\\' };
@@ -888,6 +1260,7 @@ static void enum_key( const struct key *key, int index, int info_class,
     const struct key *k;
     char *data;
 
+    materialize_key( key );
     if (index != -1)  /* -1 means use the specified key directly */
     {
         if ((index < 0) || (index > key->last_subkey))
@@ -896,6 +1269,7 @@ static void enum_key( const struct key *key, int index, int info_class,
             return;
         }
         key = key->subkeys[index];
+        materialize_key( key );
     }
 
     namelen = key->namelen;
@@ -985,6 +1359,7 @@ static void enum_key( const struct key *key, int index, int info_class,
 /* delete a key and its values */
 static int delete_key( struct key *key, int recurse )
 {
+    struct unicode_str name;
     int index;
     struct key *parent = key->parent;
 
@@ -996,13 +1371,15 @@ static int delete_key( struct key *key, int recurse )
     }
     assert( parent );
 
+    materialize_key( key );
     while (recurse && (key->last_subkey>=0))
         if (0 > delete_key(key->subkeys[key->last_subkey], 1))
             return -1;
 
-    for (index = 0; index <= parent->last_subkey; index++)
-        if (parent->subkeys[index] == key) break;
-    assert( index <= parent->last_subkey );
+    name.str = key->name;
+    name.len = key->namelen;
+    find_subkey( parent, &name, &index );
+    assert( index <= parent->last_subkey && parent->subkeys[index] == key );
 
     /* we can only delete a key that has no subkeys */
     if (key->last_subkey >= 0)
@@ -1012,6 +1389,7 @@ static int delete_key( struct key *key, int recurse )
     }
 
     if (debug_level > 1) dump_operation( key, NULL, "Delete" );
+    journal_delete_key( key );
     free_subkey( parent, index );
     touch_key( parent, REG_NOTIFY_CHANGE_NAME );
     return 0;
@@ -1042,12 +1420,137 @@ static int grow_values( struct key *key )
     return 1;
 }
 
+/* get a part of the snapshot a key was loaded from, checking that it is in bounds */
+static const void *get_snapshot_data( const struct snapshot_key *hive, unsigned int offset, file_pos_t size )
+{
+    int i;
+
+    for (i = 0; i < MAX_SAVE_BRANCH_INFO; i++)  /* the branch may not be registered yet */
+    {
+        const char *base = save_branch_info[i].snapshot;
+        size_t snapshot_size = save_branch_info[i].snapshot_size;
+
+        if ((const char *)hive < base || (const char *)hive >= base + snapshot_size) continue;
+        if (offset > snapshot_size || size > snapshot_size - offset) return NULL;
+        return base + offset;
+    }
+    return NULL;
+}
+
+static const struct snapshot_key *get_snapshot_key( const struct snapshot_key *hive, unsigned int offset )
+{
+    const struct snapshot_key *key;
+
+    if (offset % 8) return NULL;
+    if (!(key = get_snapshot_data( hive, offset, FIELD_OFFSET( struct snapshot_key, name ) ))) return NULL;
+    return get_snapshot_data( hive, offset, FIELD_OFFSET( struct snapshot_key, name ) +
+                              key->namelen + key->classlen );
+}
+
+/* create the subkeys and values of a key loaded from a snapshot */
+static void materialize_key( struct key *key )
+{
+    const struct snapshot_key *hive = key->hive, *child;
+    const struct snapshot_value *values;
+    const unsigned int *subkeys;
+    struct unicode_str name;
+    struct key_value *value;
+    struct key *subkey;
+    unsigned int i;
+
+    if (!hive) return;
+    key->hive = NULL;
+
+    if (!(subkeys = get_snapshot_data( hive, hive->subkeys, (file_pos_t)hive->subkey_count * sizeof(*subkeys) )) ||
+        !(values = get_snapshot_data( hive, hive->values, (file_pos_t)hive->value_count * sizeof(*values) )))
+        goto error;
+
+    while (key->nb_subkeys < hive->subkey_count) if (!grow_subkeys( key )) return;
+    for (i = 0; i < hive->subkey_count; i++)
+    {
+        if (!(child = get_snapshot_key( hive, subkeys[i] ))) goto error;
+        name.str = child->name;
+        name.len = child->namelen;
+        if (!(subkey = alloc_key( &name, child->modif ))) return;
+        subkey->parent = key;
+        subkey->flags  = child->flags & (KEY_SYMLINK | KEY_WOW64);
+        subkey->hive   = child;
+        if (child->classlen &&
+            (subkey->class = memdup( child->name + child->namelen / sizeof(WCHAR), child->classlen )))
+            subkey->classlen = child->classlen;
+        key->subkeys[++key->last_subkey] = subkey;
+        if (is_wow6432node( subkey->name, subkey->namelen ) && !is_wow6432node( key->name, key->namelen ))
+            key->flags |= KEY_WOW64;
+    }
+
+    while (key->nb_values < hive->value_count) if (!grow_values( key )) return;
+    for (i = 0; i < hive->value_count; i++)
+    {
+        const void *name_data = get_snapshot_data( hive, values[i].name, values[i].namelen );
+        const void *data = get_snapshot_data( hive, values[i].data, values[i].len );
+
+        if (!name_data || !data) goto error;
+        value = &key->values[key->last_value + 1];
+        value->name    = NULL;
+        value->namelen = 0;
+        value->type    = values[i].type;
+        value->len     = 0;
+        value->data    = NULL;
+        if (values[i].namelen && !(value->name = memdup( name_data, values[i].namelen ))) return;
+        value->namelen = values[i].namelen;
+        key->last_value++;
+        if (values[i].len && !(value->data = memdup( data, values[i].len ))) return;
+        value->len = values[i].len;
+    }
+    return;
+
+ error:
+    fprintf( stderr, "wineserver: corrupted registry snapshot for key " );
+    dump_path( key, NULL, stderr );
+    fprintf( stderr, "\n" );
+}
+
+/* find a value through the hash index, building it if needed; return its position or -1 */
+static int lookup_value_index( struct key *key, const struct unicode_str *name )
+{
+    struct name_index *index;
+    unsigned int i, mask, hash;
+    int pos;
+
+    if (!(index = get_name_index( &key->value_index, key->last_value + 1 ))) return -1;
+    if (!index->valid)
+    {
+        for (pos = 0; pos <= key->last_value; pos++)
+            name_index_insert( index, hash_name( key->values[pos].name, key->values[pos].namelen ), pos );
+        index->valid = 1;
+    }
+
+    hash = hash_name( name->str, name->len );
+    mask = index->size - 1;
+    for (i = hash & mask; (pos = index->entries[i].pos) != -1; i = (i + 1) & mask)
+    {
+        const struct key_value *value = &key->values[pos];
+
+        if (index->entries[i].hash == hash && value->namelen == name->len &&
+            !memicmpW( value->name, name->str, name->len / sizeof(WCHAR) ))
+            return pos;
+    }
+    return -1;
+}
+
 /* find the named value of a given key and return its index in the array */
-static struct key_value *find_value( const struct key *key, const struct unicode_str *name, int *index )
+static struct key_value *find_value( struct key *key, const struct unicode_str *name, int *index )
 {
     int i, min, max, res;
     data_size_t len;
 
+    materialize_key( key );
+    if (key->last_value + 1 >= MIN_INDEXED && (i = lookup_value_index( key, name )) != -1)
+    {
+        *index = i;
+        return &key->values[i];
+    }
+    /* binary search, also used to get the insertion point of a new value */
     min = 0;
     max = key->last_value;
     while (min <= max)
@@ -1086,6 +1589,7 @@ static struct key_value *insert_value( struct key *key, const struct unicode_str
     }
     if (name->len && !(new_name = memdup( name->str, name->len ))) return NULL;
     for (i = ++key->last_value; i > index; i--) key->values[i] = key->values[i - 1];
+    name_index_invalidate( key->value_index );
     value = &key->values[index];
     value->name    = new_name;
     value->namelen = name->len;
@@ -1101,6 +1605,7 @@ static void set_value( struct key *key, const struct unicode_str *name,
     struct key_value *value;
     void *ptr = NULL;
     int index;
+    FILE *f;
 
     if ((value = find_value( key, name, &index )))
     {
@@ -1139,6 +1644,7 @@ static void set_value( struct key *key, const struct unicode_str *name,
     value->len   = len;
     value->data  = ptr;
     touch_key( key, REG_NOTIFY_CHANGE_LAST_SET );
+    if ((f = journal_key( key ))) dump_value( value, f );
     if (debug_level > 1) dump_operation( key, value, "Set" );
 }
 
@@ -1167,6 +1673,7 @@ static void enum_value( struct key *key, int i, int info_class, struct enum_key_
 {
     struct key_value *value;
 
+    materialize_key( key );
     if (i < 0 || i > key->last_value) set_error( STATUS_NO_MORE_ENTRIES );
     else
     {
@@ -1225,11 +1732,13 @@ static void delete_value( struct key *key, const struct unicode_str *name )
         return;
     }
     if (debug_level > 1) dump_operation( key, value, "Delete" );
+    name_index_invalidate( key->value_index );
     free( value->name );
     free( value->data );
     for (i = index; i < key->last_value; i++) key->values[i] = key->values[i + 1];
     key->last_value--;
     touch_key( key, REG_NOTIFY_CHANGE_LAST_SET );
+    journal_delete_value( key, name );
 
     /* try to shrink the array */
     nb_values = key->nb_values;
@@ -1451,7 +1960,8 @@ static int load_key_option( struct key *key, const char *buffer, struct file_loa
             else if (*p >= 'a' && *p <= 'f') modif = (modif << 4) | (*p - 'a' + 10);
             else break;
         }
-        update_key_time( key, modif );
+        if (replaying_journal) key->modif = modif;
+        else update_key_time( key, modif );
     }
     if (!strncmp( buffer, "#class=", 7 ))
     {
@@ -1465,6 +1975,24 @@ static int load_key_option( struct key *key, const char *buffer, struct file_loa
         key->classlen = len;
     }
     if (!strncmp( buffer, "#link", 5 )) key->flags |= KEY_SYMLINK;
+    if (!strncmp( buffer, "#delete_value=", 14 ))
+    {
+        struct unicode_str name;
+        int index;
+
+        p = buffer + 14;
+        if (!get_file_tmp_space( info, strlen(p) * sizeof(WCHAR) )) return 0;
+        name.str = info->tmp;
+        name.len = 0;
+        if (*p == '"')
+        {
+            len = info->tmplen;
+            if (parse_strW( info->tmp, &len, p + 1, '\"' ) == -1) return 0;
+            name.len = len - sizeof(WCHAR);  /* terminating null */
+        }
+        else if (*p != '@') return 0;
+        if (find_value( key, &name, &index )) delete_value( key, &name );
+    }
     /* ignore unknown options */
     return 1;
 }
@@ -1583,6 +2111,7 @@ static int load_value( struct key *key, const char *buffer, struct file_load_inf
     value->data = newptr;
     value->len  = len;
     value->type = type;
+    bump_key_seq( key );
     return 1;
 
  error:
@@ -1671,7 +2200,13 @@ static void load_keys( struct key *key, const char *filename, FILE *f, int prefi
             else file_read_error( "Value without key", &info );
             break;
         case '#':   /* option */
-            if (subkey) load_key_option( subkey, p, &info );
+            if (subkey && !strcmp( p, "#delete" ))
+            {
+                if (subkey != key) delete_key( subkey, 1 );
+                release_object( subkey );
+                subkey = NULL;
+            }
+            else if (subkey) load_key_option( subkey, p, &info );
             else if (!load_global_option( p, &info )) goto done;
             break;
         case ';':   /* comment */
@@ -1714,12 +2249,242 @@ static void load_registry( struct key *key, obj_handle_t handle )
     }
 }
 
+/* start a new empty journal for a branch */
+static void reset_journal( struct save_branch_info *info )
+{
+    struct stat st;
+
+    journal_end_record( info );
+    if (info->journal) fclose( info->journal );
+    if ((info->journal = fopen( info->journal_path, "w" )))
+        fprintf( info->journal, "WINE REGISTRY Version 2\n" );
+    info->compact = 0;
+    info->file_size = stat( info->path, &st ) ? 0 : st.st_size;
+}
+
+/* replay the journal left by the previous session and open it for appending */
+static void init_journal( struct save_branch_info *info )
+{
+    struct stat st;
+    FILE *f;
+
+    if (!(info->journal_path = malloc( strlen( info->path ) + sizeof(".journal") ))) return;
+    sprintf( info->journal_path, "%s.journal", info->path );
+
+    if ((f = fopen( info->journal_path, "r" )))
+    {
+        replaying_journal = 1;
+        load_keys( info->key, info->journal_path, f, 0 );
+        replaying_journal = 0;
+        clear_error();
+        /* the branch file doesn't contain the replayed changes yet */
+        if (ftell( f ) > sizeof("WINE REGISTRY Version 2")) make_dirty( info->key );
+        fclose( f );
+    }
+
+    if (!(info->journal = fopen( info->journal_path, "a" ))) return;
+    fseek( info->journal, 0, SEEK_END );
+    if (!ftell( info->journal )) fprintf( info->journal, "WINE REGISTRY Version 2\n" );
+    info->file_size = stat( info->path, &st ) ? 0 : st.st_size;
+}
+
+/* buffer used to build a snapshot */
+struct snapshot_buffer
+{
+    char        *data;
+    unsigned int size;
+    unsigned int pos;
+    int          error;
+};
+
+/* allocate 8-byte aligned space in the snapshot, return its offset */
+static unsigned int snapshot_alloc( struct snapshot_buffer *buf, unsigned int size )
+{
+    unsigned int pos = buf->pos, new_size;
+    char *data;
+
+    if (buf->error) return 0;
+    if (size > 0x7fffffff - pos - 8)
+    {
+        buf->error = 1;
+        return 0;
+    }
+    if (pos + size > buf->size)
+    {
+        new_size = max( buf->size * 2, (pos + size + 8) & ~7 );
+        if (!(data = realloc( buf->data, new_size )))
+        {
+            buf->error = 1;
+            return 0;
+        }
+        buf->data = data;
+        buf->size = new_size;
+    }
+    memset( buf->data + pos, 0, size );
+    buf->pos = (pos + size + 7) & ~7;
+    return pos;
+}
+
+/* add a key and its subkeys to a snapshot, return its offset */
+static unsigned int snapshot_write_key( struct snapshot_buffer *buf, struct key *key )
+{
+    struct snapshot_key *hive;
+    struct snapshot_value *value;
+    unsigned int offset, subkeys, values, name, data, child, count = 0;
+    int i;
+
+    materialize_key( key );
+    for (i = 0; i <= key->last_subkey; i++)
+        if (!(key->subkeys[i]->flags & KEY_VOLATILE)) count++;
+
+    offset  = snapshot_alloc( buf, FIELD_OFFSET( struct snapshot_key, name ) + key->namelen + key->classlen );
+    subkeys = snapshot_alloc( buf, count * sizeof(unsigned int) );
+    values  = snapshot_alloc( buf, (key->last_value + 1) * sizeof(struct snapshot_value) );
+    if (buf->error) return 0;
+
+    hive = (struct snapshot_key *)(buf->data + offset);
+    hive->modif        = key->modif;
+    hive->flags        = key->flags & (KEY_SYMLINK | KEY_WOW64);
+    hive->namelen      = key->namelen;
+    hive->classlen     = key->classlen;
+    hive->subkey_count = count;
+    hive->subkeys      = subkeys;
+    hive->value_count  = key->last_value + 1;
+    hive->values       = values;
+    memcpy( hive->name, key->name, key->namelen );
+    if (key->class) memcpy( hive->name + key->namelen / sizeof(WCHAR), key->class, key->classlen );
+
+    for (i = 0; i <= key->last_value; i++)
+    {
+        name = snapshot_alloc( buf, key->values[i].namelen );
+        data = snapshot_alloc( buf, key->values[i].len );
+        if (buf->error) return 0;
+        value = (struct snapshot_value *)(buf->data + values) + i;
+        value->type    = key->values[i].type;
+        value->namelen = key->values[i].namelen;
+        value->name    = name;
+        value->len     = key->values[i].len;
+        value->data    = data;
+        memcpy( buf->data + name, key->values[i].name, key->values[i].namelen );
+        memcpy( buf->data + data, key->values[i].data, key->values[i].len );
+    }
+
+    for (i = 0, count = 0; i <= key->last_subkey; i++)
+    {
+        if (key->subkeys[i]->flags & KEY_VOLATILE) continue;
+        child = snapshot_write_key( buf, key->subkeys[i] );
+        if (buf->error) return 0;
+        ((unsigned int *)(buf->data + subkeys))[count++] = child;
+    }
+    return offset;
+}
+
+/* write the snapshot of a branch after its text file has been saved */
+static void save_snapshot( struct save_branch_info *info )
+{
+    struct snapshot_header *header;
+    struct snapshot_buffer buf;
+    unsigned int root;
+    struct stat st;
+    char *tmp;
+    ssize_t ret;
+    int fd;
+
+    if (!info->snapshot_path || stat( info->path, &st )) return;
+
+    buf.size  = 65536;
+    buf.pos   = 0;
+    buf.error = 0;
+    if (!(buf.data = malloc( buf.size ))) return;
+    snapshot_alloc( &buf, sizeof(*header) );
+    root = snapshot_write_key( &buf, info->key );
+    if (buf.error) goto done;
+
+    header = (struct snapshot_header *)buf.data;
+    header->magic       = SNAPSHOT_MAGIC;
+    header->version     = SNAPSHOT_VERSION;
+    header->size        = buf.pos;
+    header->root        = root;
+    header->prefix_type = prefix_type;
+    header->file_inode  = st.st_ino;
+    header->file_size   = st.st_size;
+    header->file_mtime  = st.st_mtime;
+
+    if (!(tmp = malloc( strlen( info->snapshot_path ) + sizeof(".tmp") ))) goto done;
+    sprintf( tmp, "%s.tmp", info->snapshot_path );
+    if ((fd = open( tmp, O_CREAT | O_TRUNC | O_WRONLY, 0666 )) != -1)
+    {
+        for (buf.size = 0; buf.size < buf.pos; buf.size += ret)
+            if ((ret = write( fd, buf.data + buf.size, buf.pos - buf.size )) <= 0) break;
+        if (close( fd ) || buf.size < buf.pos || rename( tmp, info->snapshot_path )) unlink( tmp );
+    }
+    free( tmp );
+
+done:
+    free( buf.data );
+}
+
+/* map the snapshot of a branch if it is enabled and up to date with the text file */
+static int load_snapshot( struct save_branch_info *info, const char *filename, struct key *key )
+{
+    const struct snapshot_header *header;
+    const char *env;
+    struct stat st, snapshot_st;
+    void *ptr;
+    int fd;
+
+    if (!(env = getenv( "WINEREGSNAPSHOT" )) || !atoi( env )) return 0;
+    if (!(info->snapshot_path = malloc( strlen( filename ) + sizeof(".snapshot") ))) return 0;
+    sprintf( info->snapshot_path, "%s.snapshot", filename );
+
+    if (key->last_subkey != -1 || key->last_value != -1) return 0;
+    if (stat( filename, &st )) return 0;
+    if ((fd = open( info->snapshot_path, O_RDONLY )) == -1) return 0;
+    if (fstat( fd, &snapshot_st ) || snapshot_st.st_size < sizeof(*header) ||
+        snapshot_st.st_size > 0x7fffffff ||
+        (ptr = mmap( NULL, snapshot_st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 )) == MAP_FAILED)
+    {
+        close( fd );
+        return 0;
+    }
+    close( fd );
+
+    header = ptr;
+    if (header->magic != SNAPSHOT_MAGIC || header->version != SNAPSHOT_VERSION ||
+        header->size != snapshot_st.st_size || header->file_inode != st.st_ino ||
+        header->file_size != st.st_size || header->file_mtime != st.st_mtime ||
+        (prefix_type != PREFIX_UNKNOWN && header->prefix_type != prefix_type))
+    {
+        munmap( ptr, snapshot_st.st_size );
+        return 0;
+    }
+
+    info->snapshot = ptr;
+    info->snapshot_size = snapshot_st.st_size;
+    if (!(key->hive = get_snapshot_key( (const struct snapshot_key *)info->snapshot, header->root )))
+    {
+        munmap( ptr, snapshot_st.st_size );
+        info->snapshot = NULL;
+        info->snapshot_size = 0;
+        return 0;
+    }
+    key->flags |= key->hive->flags & KEY_WOW64;
+    prefix_type = header->prefix_type;
+    if (debug_level > 1) fprintf( stderr, "%s: loaded from %s\n", filename, info->snapshot_path );
+    return 1;
+}
+
 /* load one of the initial registry files */
 static int load_init_registry_from_file( const char *filename, struct key *key )
 {
+    struct save_branch_info *info;
+    int loaded = 0, snapshot;
     FILE *f;
 
-    if ((f = fopen( filename, "r" )))
+    assert( save_branch_count < MAX_SAVE_BRANCH_INFO );
+    info = &save_branch_info[save_branch_count];
+
+    if (!(snapshot = load_snapshot( info, filename, key )) && (f = fopen( filename, "r" )))
     {
         load_keys( key, filename, f, 0 );
         fclose( f );
@@ -1728,14 +2493,16 @@ static int load_init_registry_from_file( const char *filename, struct key *key )
             fprintf( stderr, "%s is not a valid registry file\n", filename );
             return 1;
         }
+        loaded = 1;
     }
 
-    assert( save_branch_count < MAX_SAVE_BRANCH_INFO );
-
-    save_branch_info[save_branch_count].path = filename;
-    save_branch_info[save_branch_count++].key = (struct key *)grab_object( key );
+    info->path = filename;
+    info->key = (struct key *)grab_object( key );
+    save_branch_count++;
     make_object_static( &key->obj );
-    return (f != NULL);
+    if (loaded) save_snapshot( info );
+    init_journal( info );
+    return loaded || snapshot;
 }
 
 static WCHAR *format_user_registry_path( const SID *sid, struct unicode_str *path )
@@ -1990,6 +2757,28 @@ done:
     return ret;
 }
 
+/* write the changes of a branch to disk, only rewriting the file when compacting the journal */
+static int flush_branch( struct save_branch_info *info, int compact )
+{
+    int dirty = (info->key->flags & KEY_DIRTY) != 0;
+
+    if (info->journal && !info->compact && !compact &&
+        ftell( info->journal ) <= max( info->file_size, JOURNAL_MIN_COMPACT_SIZE ))
+    {
+        if (!fflush( info->journal ) && !ferror( info->journal )) return 1;
+        info->compact = 1;  /* the journal may be incomplete */
+    }
+
+    if (!save_branch( info->key, info->path ))
+    {
+        if (info->journal) fflush( info->journal );
+        return 0;
+    }
+    if (dirty) save_snapshot( info );
+    if (info->journal_path) reset_journal( info );
+    return 1;
+}
+
 /* periodic saving of the registry */
 static void periodic_save( void *arg )
 {
@@ -1998,7 +2787,7 @@ static void periodic_save( void *arg )
     if (fchdir( config_dir_fd ) == -1) return;
     save_timeout_user = NULL;
     for (i = 0; i < save_branch_count; i++)
-        save_branch( save_branch_info[i].key, save_branch_info[i].path );
+        flush_branch( &save_branch_info[i], 0 );
     if (fchdir( server_dir_fd ) == -1) fatal_error( "chdir to server dir: %s\n", strerror( errno ));
     set_periodic_save_timer();
 }
@@ -2018,7 +2807,7 @@ void flush_registry(void)
     if (fchdir( config_dir_fd ) == -1) return;
     for (i = 0; i < save_branch_count; i++)
     {
-        if (!save_branch( save_branch_info[i].key, save_branch_info[i].path ))
+        if (!flush_branch( &save_branch_info[i], 1 ))
         {
             fprintf( stderr, "wineserver: could not save registry branch to %s",
                      save_branch_info[i].path );
@@ -2110,9 +2899,12 @@ DECL_HANDLER(delete_key)
 DECL_HANDLER(flush_key)
 {
     struct key *key = get_hkey_obj( req->hkey, 0 );
+    struct save_branch_info *info;
+
     if (key)
     {
-        /* we don't need to do anything here with the current implementation */
+        /* the changes are saved periodically, only make sure the journal is written out */
+        if ((info = get_key_branch( key )) && info->journal) fflush( info->journal );
         release_object( key );
     }
 }
@@ -2161,13 +2953,28 @@ DECL_HANDLER(get_key_value)
     struct unicode_str name = get_req_unicode_str();
 
     reply->total = 0;
+    reply->seq_index = -1;
     if ((key = get_hkey_obj( req->hkey, KEY_QUERY_VALUE )))
     {
+        if ((reply->seq_index = get_key_seq_index( key )) != -1)
+            reply->seq = key_seq_region[reply->seq_index];
         get_value( key, &name, &reply->type, &reply->total );
         release_object( key );
     }
 }
 
+/* get the shared memory region of the key change sequence numbers */
+DECL_HANDLER(get_key_seq_region)
+{
+    if (!init_key_seq_region())
+    {
+        set_error( STATUS_NOT_IMPLEMENTED );
+        return;
+    }
+    reply->size = KEY_SEQ_REGION_SIZE;
+    send_client_fd( current->process, key_seq_fd, 0 );
+}
+
 /* enumerate the value of a registry key */
 DECL_HANDLER(enum_key_value)
 {
@@ -2222,6 +3029,7 @@ DECL_HANDLER(load_registry)
         if ((key = create_key( parent, &name, NULL, 0, KEY_WOW64_64KEY, 0, sd, &dummy )))
         {
             load_registry( key, req->file );
+            journal_invalidate( key );
             release_object( key );
         }
         release_object( parent );
@@ -128,6 +128,7 @@ unsigned int global_error = 0;  /* global error code for when no thread is curre
 timeout_t server_start_time = 0;  /* server startup time */
 int server_dir_fd = -1;    /* file descriptor for the server dir */
 int config_dir_fd = -1;    /* file descriptor for the config dir */
+struct request_counter request_counters[REQ_NB_REQUESTS];  /* statistics by request type */
 
 static struct master_socket *master_socket;  /* the master socket object */
 static struct timeout_user *master_timeout;
@@ -286,11 +287,49 @@ static void send_reply( union generic_reply *reply )
         fatal_protocol_error( current, "reply write: %s\n", strerror( errno ));
 }
 
+/* monotonic time in nanoseconds, for the request statistics */
+static inline timeout_t get_request_time(void)
+{
+#ifdef __APPLE__
+    static mach_timebase_info_data_t timebase;
+
+    if (!timebase.denom) mach_timebase_info( &timebase );
+    return mach_absolute_time() * timebase.numer / timebase.denom;
+#elif defined(HAVE_CLOCK_GETTIME)
+    struct timespec ts;
+
+    if (!clock_gettime( CLOCK_MONOTONIC, &ts )) return (timeout_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+    return current_time * 100;
+}
+
+/* account a handled request to the global and per-process statistics */
+static void update_request_counters( struct process *process, enum request req,
+                                     timeout_t time, data_size_t reply_size )
+{
+    struct request_counter *counters[2];
+    unsigned int i;
+
+    if (!process->req_counters)
+        process->req_counters = calloc( REQ_NB_REQUESTS, sizeof(*process->req_counters) );
+
+    counters[0] = &request_counters[req];
+    counters[1] = process->req_counters ? &process->req_counters[req] : NULL;
+    for (i = 0; i < 2 && counters[i]; i++)
+    {
+        counters[i]->count++;
+        counters[i]->total_time += time;
+        counters[i]->reply_size += sizeof(struct reply_header) + reply_size;
+        if (time > counters[i]->max_time) counters[i]->max_time = min( time, ~0u );
+    }
+}
+
 /* call a request handler */
 static void call_req_handler( struct thread *thread )
 {
     union generic_reply reply;
     enum request req = thread->req.request_header.req;
+    timeout_t start = 0;
 
     current = thread;
     current->reply_size = 0;
@@ -300,12 +339,18 @@ static void call_req_handler( struct thread *thread )
     if (debug_level) trace_request();
 
     if (req < REQ_NB_REQUESTS)
+    {
+        start = get_request_time();
         req_handlers[req]( &current->req, &reply );
+    }
     else
         set_error( STATUS_NOT_IMPLEMENTED );
 
     if (current)
     {
+        if (req < REQ_NB_REQUESTS)
+            update_request_counters( current->process, req, get_request_time() - start,
+                                     current->reply_size );
         if (current->reply_fd)
         {
             reply.reply_header.error = current->error;
@@ -64,6 +64,18 @@ extern int server_dir_fd, config_dir_fd;
 
 extern void trace_request(void);
 extern void trace_reply( enum request req, const union generic_reply *reply );
+extern const char *get_req_name( enum request req );
+
+/* statistics about the handled requests, times in nanoseconds */
+struct request_counter
+{
+    unsigned int count;        /* number of handled requests */
+    unsigned int max_time;     /* longest handler time */
+    timeout_t    total_time;   /* cumulative handler time */
+    mem_size_t   reply_size;   /* cumulative size of the replies */
+};
+
+extern struct request_counter request_counters[REQ_NB_REQUESTS];
 
 /* get the request vararg data */
 static inline const void *get_req_data(void)
@@ -120,6 +132,7 @@ DECL_HANDLER(init_process_done);
 DECL_HANDLER(init_thread);
 DECL_HANDLER(terminate_process);
 DECL_HANDLER(terminate_thread);
+DECL_HANDLER(get_request_stats);
 DECL_HANDLER(get_process_info);
 DECL_HANDLER(get_process_vm_counters);
 DECL_HANDLER(set_process_info);
@@ -152,6 +165,8 @@ DECL_HANDLER(query_mutex);
 DECL_HANDLER(create_semaphore);
 DECL_HANDLER(release_semaphore);
 DECL_HANDLER(query_semaphore);
+DECL_HANDLER(get_fast_sync_region);
+DECL_HANDLER(get_fast_sync);
 DECL_HANDLER(open_semaphore);
 DECL_HANDLER(create_file);
 DECL_HANDLER(open_file_object);
@@ -222,6 +237,7 @@ DECL_HANDLER(flush_key);
 DECL_HANDLER(enum_key);
 DECL_HANDLER(set_key_value);
 DECL_HANDLER(get_key_value);
+DECL_HANDLER(get_key_seq_region);
 DECL_HANDLER(enum_key_value);
 DECL_HANDLER(delete_key_value);
 DECL_HANDLER(load_registry);
@@ -316,6 +332,8 @@ DECL_HANDLER(unregister_hotkey);
 DECL_HANDLER(attach_thread_input);
 DECL_HANDLER(get_thread_input);
 DECL_HANDLER(get_last_input_time);
+DECL_HANDLER(get_shared_input_region);
+DECL_HANDLER(get_shared_input);
 DECL_HANDLER(get_key_state);
 DECL_HANDLER(set_key_state);
 DECL_HANDLER(set_foreground_window);
@@ -415,6 +433,7 @@ static const req_handler req_handlers[REQ_NB_REQUESTS] =
     (req_handler)req_init_thread,
     (req_handler)req_terminate_process,
     (req_handler)req_terminate_thread,
+    (req_handler)req_get_request_stats,
     (req_handler)req_get_process_info,
     (req_handler)req_get_process_vm_counters,
     (req_handler)req_set_process_info,
@@ -447,6 +466,8 @@ static const req_handler req_handlers[REQ_NB_REQUESTS] =
     (req_handler)req_create_semaphore,
     (req_handler)req_release_semaphore,
     (req_handler)req_query_semaphore,
+    (req_handler)req_get_fast_sync_region,
+    (req_handler)req_get_fast_sync,
     (req_handler)req_open_semaphore,
     (req_handler)req_create_file,
     (req_handler)req_open_file_object,
@@ -517,6 +538,7 @@ static const req_handler req_handlers[REQ_NB_REQUESTS] =
     (req_handler)req_enum_key,
     (req_handler)req_set_key_value,
     (req_handler)req_get_key_value,
+    (req_handler)req_get_key_seq_region,
     (req_handler)req_enum_key_value,
     (req_handler)req_delete_key_value,
     (req_handler)req_load_registry,
@@ -611,6 +633,8 @@ static const req_handler req_handlers[REQ_NB_REQUESTS] =
     (req_handler)req_attach_thread_input,
     (req_handler)req_get_thread_input,
     (req_handler)req_get_last_input_time,
+    (req_handler)req_get_shared_input_region,
+    (req_handler)req_get_shared_input,
     (req_handler)req_get_key_state,
     (req_handler)req_set_key_state,
     (req_handler)req_set_foreground_window,
@@ -797,6 +821,10 @@ C_ASSERT( sizeof(struct terminate_thread_request) == 24 );
 C_ASSERT( FIELD_OFFSET(struct terminate_thread_reply, self) == 8 );
 C_ASSERT( FIELD_OFFSET(struct terminate_thread_reply, last) == 12 );
 C_ASSERT( sizeof(struct terminate_thread_reply) == 16 );
+C_ASSERT( FIELD_OFFSET(struct get_request_stats_request, pid) == 12 );
+C_ASSERT( sizeof(struct get_request_stats_request) == 16 );
+C_ASSERT( FIELD_OFFSET(struct get_request_stats_reply, total) == 8 );
+C_ASSERT( sizeof(struct get_request_stats_reply) == 16 );
 C_ASSERT( FIELD_OFFSET(struct get_process_info_request, handle) == 12 );
 C_ASSERT( sizeof(struct get_process_info_request) == 16 );
 C_ASSERT( FIELD_OFFSET(struct get_process_info_reply, pid) == 8 );
@@ -925,7 +953,10 @@ C_ASSERT( FIELD_OFFSET(struct create_event_request, manual_reset) == 16 );
 C_ASSERT( FIELD_OFFSET(struct create_event_request, initial_state) == 20 );
 C_ASSERT( sizeof(struct create_event_request) == 24 );
 C_ASSERT( FIELD_OFFSET(struct create_event_reply, handle) == 8 );
-C_ASSERT( sizeof(struct create_event_reply) == 16 );
+C_ASSERT( FIELD_OFFSET(struct create_event_reply, fast_type) == 12 );
+C_ASSERT( FIELD_OFFSET(struct create_event_reply, fast_index) == 16 );
+C_ASSERT( FIELD_OFFSET(struct create_event_reply, fast_access) == 20 );
+C_ASSERT( sizeof(struct create_event_reply) == 24 );
 C_ASSERT( FIELD_OFFSET(struct event_op_request, handle) == 12 );
 C_ASSERT( FIELD_OFFSET(struct event_op_request, op) == 16 );
 C_ASSERT( sizeof(struct event_op_request) == 24 );
@@ -939,7 +970,10 @@ C_ASSERT( FIELD_OFFSET(struct open_event_request, attributes) == 16 );
 C_ASSERT( FIELD_OFFSET(struct open_event_request, rootdir) == 20 );
 C_ASSERT( sizeof(struct open_event_request) == 24 );
 C_ASSERT( FIELD_OFFSET(struct open_event_reply, handle) == 8 );
-C_ASSERT( sizeof(struct open_event_reply) == 16 );
+C_ASSERT( FIELD_OFFSET(struct open_event_reply, fast_type) == 12 );
+C_ASSERT( FIELD_OFFSET(struct open_event_reply, fast_index) == 16 );
+C_ASSERT( FIELD_OFFSET(struct open_event_reply, fast_access) == 20 );
+C_ASSERT( sizeof(struct open_event_reply) == 24 );
 C_ASSERT( FIELD_OFFSET(struct create_keyed_event_request, access) == 12 );
 C_ASSERT( sizeof(struct create_keyed_event_request) == 16 );
 C_ASSERT( FIELD_OFFSET(struct create_keyed_event_reply, handle) == 8 );
@@ -976,7 +1010,11 @@ C_ASSERT( FIELD_OFFSET(struct create_semaphore_request, initial) == 16 );
 C_ASSERT( FIELD_OFFSET(struct create_semaphore_request, max) == 20 );
 C_ASSERT( sizeof(struct create_semaphore_request) == 24 );
 C_ASSERT( FIELD_OFFSET(struct create_semaphore_reply, handle) == 8 );
-C_ASSERT( sizeof(struct create_semaphore_reply) == 16 );
+C_ASSERT( FIELD_OFFSET(struct create_semaphore_reply, fast_type) == 12 );
+C_ASSERT( FIELD_OFFSET(struct create_semaphore_reply, fast_index) == 16 );
+C_ASSERT( FIELD_OFFSET(struct create_semaphore_reply, fast_access) == 20 );
+C_ASSERT( FIELD_OFFSET(struct create_semaphore_reply, fast_max) == 24 );
+C_ASSERT( sizeof(struct create_semaphore_reply) == 32 );
 C_ASSERT( FIELD_OFFSET(struct release_semaphore_request, handle) == 12 );
 C_ASSERT( FIELD_OFFSET(struct release_semaphore_request, count) == 16 );
 C_ASSERT( sizeof(struct release_semaphore_request) == 24 );
@@ -987,12 +1025,26 @@ C_ASSERT( sizeof(struct query_semaphore_request) == 16 );
 C_ASSERT( FIELD_OFFSET(struct query_semaphore_reply, current) == 8 );
 C_ASSERT( FIELD_OFFSET(struct query_semaphore_reply, max) == 12 );
 C_ASSERT( sizeof(struct query_semaphore_reply) == 16 );
+C_ASSERT( sizeof(struct get_fast_sync_region_request) == 16 );
+C_ASSERT( FIELD_OFFSET(struct get_fast_sync_region_reply, size) == 8 );
+C_ASSERT( sizeof(struct get_fast_sync_region_reply) == 16 );
+C_ASSERT( FIELD_OFFSET(struct get_fast_sync_request, handle) == 12 );
+C_ASSERT( sizeof(struct get_fast_sync_request) == 16 );
+C_ASSERT( FIELD_OFFSET(struct get_fast_sync_reply, type) == 8 );
+C_ASSERT( FIELD_OFFSET(struct get_fast_sync_reply, index) == 12 );
+C_ASSERT( FIELD_OFFSET(struct get_fast_sync_reply, max) == 16 );
+C_ASSERT( FIELD_OFFSET(struct get_fast_sync_reply, access) == 20 );
+C_ASSERT( sizeof(struct get_fast_sync_reply) == 24 );
 C_ASSERT( FIELD_OFFSET(struct open_semaphore_request, access) == 12 );
 C_ASSERT( FIELD_OFFSET(struct open_semaphore_request, attributes) == 16 );
 C_ASSERT( FIELD_OFFSET(struct open_semaphore_request, rootdir) == 20 );
 C_ASSERT( sizeof(struct open_semaphore_request) == 24 );
 C_ASSERT( FIELD_OFFSET(struct open_semaphore_reply, handle) == 8 );
-C_ASSERT( sizeof(struct open_semaphore_reply) == 16 );
+C_ASSERT( FIELD_OFFSET(struct open_semaphore_reply, fast_type) == 12 );
+C_ASSERT( FIELD_OFFSET(struct open_semaphore_reply, fast_index) == 16 );
+C_ASSERT( FIELD_OFFSET(struct open_semaphore_reply, fast_access) == 20 );
+C_ASSERT( FIELD_OFFSET(struct open_semaphore_reply, fast_max) == 24 );
+C_ASSERT( sizeof(struct open_semaphore_reply) == 32 );
 C_ASSERT( FIELD_OFFSET(struct create_file_request, access) == 12 );
 C_ASSERT( FIELD_OFFSET(struct create_file_request, sharing) == 16 );
 C_ASSERT( FIELD_OFFSET(struct create_file_request, create) == 20 );
@@ -1403,7 +1455,12 @@ C_ASSERT( FIELD_OFFSET(struct get_key_value_request, hkey) == 12 );
 C_ASSERT( sizeof(struct get_key_value_request) == 16 );
 C_ASSERT( FIELD_OFFSET(struct get_key_value_reply, type) == 8 );
 C_ASSERT( FIELD_OFFSET(struct get_key_value_reply, total) == 12 );
-C_ASSERT( sizeof(struct get_key_value_reply) == 16 );
+C_ASSERT( FIELD_OFFSET(struct get_key_value_reply, seq_index) == 16 );
+C_ASSERT( FIELD_OFFSET(struct get_key_value_reply, seq) == 20 );
+C_ASSERT( sizeof(struct get_key_value_reply) == 24 );
+C_ASSERT( sizeof(struct get_key_seq_region_request) == 16 );
+C_ASSERT( FIELD_OFFSET(struct get_key_seq_region_reply, size) == 8 );
+C_ASSERT( sizeof(struct get_key_seq_region_reply) == 16 );
 C_ASSERT( FIELD_OFFSET(struct enum_key_value_request, hkey) == 12 );
 C_ASSERT( FIELD_OFFSET(struct enum_key_value_request, index) == 16 );
 C_ASSERT( FIELD_OFFSET(struct enum_key_value_request, info_class) == 20 );
@@ -1925,6 +1982,16 @@ C_ASSERT( sizeof(struct get_thread_input_reply) == 64 );
 C_ASSERT( sizeof(struct get_last_input_time_request) == 16 );
 C_ASSERT( FIELD_OFFSET(struct get_last_input_time_reply, time) == 8 );
 C_ASSERT( sizeof(struct get_last_input_time_reply) == 16 );
+C_ASSERT( sizeof(struct get_shared_input_region_request) == 16 );
+C_ASSERT( FIELD_OFFSET(struct get_shared_input_region_reply, handle) == 8 );
+C_ASSERT( FIELD_OFFSET(struct get_shared_input_region_reply, size) == 12 );
+C_ASSERT( sizeof(struct get_shared_input_region_reply) == 16 );
+C_ASSERT( sizeof(struct get_shared_input_request) == 16 );
+C_ASSERT( FIELD_OFFSET(struct get_shared_input_reply, desktop_slot) == 8 );
+C_ASSERT( FIELD_OFFSET(struct get_shared_input_reply, desktop_id) == 12 );
+C_ASSERT( FIELD_OFFSET(struct get_shared_input_reply, queue_slot) == 16 );
+C_ASSERT( FIELD_OFFSET(struct get_shared_input_reply, queue_id) == 20 );
+C_ASSERT( sizeof(struct get_shared_input_reply) == 24 );
 C_ASSERT( FIELD_OFFSET(struct get_key_state_request, tid) == 12 );
 C_ASSERT( FIELD_OFFSET(struct get_key_state_request, key) == 16 );
 C_ASSERT( sizeof(struct get_key_state_request) == 24 );
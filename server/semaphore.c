@@ -41,22 +41,26 @@ struct semaphore
     struct object  obj;    /* object header */
     unsigned int   count;  /* current count */
     unsigned int   max;    /* maximum possible count */
+    int            fast;   /* index of the fast synchronization state, or -1 */
 };
 
 static void semaphore_dump( struct object *obj, int verbose );
 static struct object_type *semaphore_get_type( struct object *obj );
+static int semaphore_add_queue( struct object *obj, struct wait_queue_entry *entry );
+static void semaphore_remove_queue( struct object *obj, struct wait_queue_entry *entry );
 static int semaphore_signaled( struct object *obj, struct wait_queue_entry *entry );
 static void semaphore_satisfied( struct object *obj, struct wait_queue_entry *entry );
 static unsigned int semaphore_map_access( struct object *obj, unsigned int access );
 static int semaphore_signal( struct object *obj, unsigned int access );
+static void semaphore_destroy( struct object *obj );
 
 static const struct object_ops semaphore_ops =
 {
     sizeof(struct semaphore),      /* size */
     semaphore_dump,                /* dump */
     semaphore_get_type,            /* get_type */
-    add_queue,                     /* add_queue */
-    remove_queue,                  /* remove_queue */
+    semaphore_add_queue,           /* add_queue */
+    semaphore_remove_queue,        /* remove_queue */
     semaphore_signaled,            /* signaled */
     semaphore_satisfied,           /* satisfied */
     semaphore_signal,              /* signal */
@@ -69,7 +73,7 @@ static const struct object_ops semaphore_ops =
     default_unlink_name,           /* unlink_name */
     no_open_file,                  /* open_file */
     no_close_handle,               /* close_handle */
-    no_destroy                     /* destroy */
+    semaphore_destroy              /* destroy */
 };
 
 
@@ -91,20 +95,40 @@ static struct semaphore *create_semaphore( struct object *root, const struct uni
             /* initialize it if it didn't already exist */
             sem->count = initial;
             sem->max   = max;
+            sem->fast  = max <= FAST_SYNC_STATE_MASK ? alloc_fast_sync( initial ) : -1;
         }
     }
     return sem;
 }
 
+static inline unsigned int get_semaphore_count( struct semaphore *sem )
+{
+    if (sem->fast != -1) return get_fast_sync_state( sem->fast );
+    return sem->count;
+}
+
 static int release_semaphore( struct semaphore *sem, unsigned int count,
                               unsigned int *prev )
 {
-    if (prev) *prev = sem->count;
-    if (sem->count + count < sem->count || sem->count + count > sem->max)
+    unsigned int current = get_semaphore_count( sem );
+
+    if (sem->fast != -1)
+    {
+        /* clients may acquire it concurrently as long as nobody waits in the server */
+        while (current + count >= current && current + count <= sem->max &&
+               !cmpxchg_fast_sync_state( sem->fast, current, current + count ))
+            current = get_semaphore_count( sem );
+    }
+    if (prev) *prev = current;
+    if (current + count < current || current + count > sem->max)
     {
         set_error( STATUS_SEMAPHORE_LIMIT_EXCEEDED );
         return 0;
     }
+    else if (sem->fast != -1)
+    {
+        if (!current) wake_up( &sem->obj, count );
+    }
     else if (sem->count)
     {
         /* there cannot be any thread to wake up if the count is != 0 */
@@ -118,11 +142,21 @@ static int release_semaphore( struct semaphore *sem, unsigned int count,
     return 1;
 }
 
+int get_semaphore_fast_sync( struct object *obj, int *index, unsigned int *max )
+{
+    struct semaphore *sem = (struct semaphore *)obj;
+
+    if (obj->ops != &semaphore_ops) return FAST_SYNC_NONE;
+    *index = sem->fast;
+    *max = sem->max;
+    return FAST_SYNC_SEMAPHORE;
+}
+
 static void semaphore_dump( struct object *obj, int verbose )
 {
     struct semaphore *sem = (struct semaphore *)obj;
     assert( obj->ops == &semaphore_ops );
-    fprintf( stderr, "Semaphore count=%d max=%d\n", sem->count, sem->max );
+    fprintf( stderr, "Semaphore count=%d max=%d fast=%d\n", get_semaphore_count( sem ), sem->max, sem->fast );
 }
 
 static struct object_type *semaphore_get_type( struct object *obj )
@@ -132,19 +166,48 @@ static struct object_type *semaphore_get_type( struct object *obj )
     return get_object_type( &str );
 }
 
+static int semaphore_add_queue( struct object *obj, struct wait_queue_entry *entry )
+{
+    struct semaphore *sem = (struct semaphore *)obj;
+    assert( obj->ops == &semaphore_ops );
+    /* clients must not change the count behind the back of server waiters */
+    if (sem->fast != -1 && list_empty( &obj->wait_queue )) set_fast_sync_owner( sem->fast, 1 );
+    return add_queue( obj, entry );
+}
+
+static void semaphore_remove_queue( struct object *obj, struct wait_queue_entry *entry )
+{
+    struct semaphore *sem = (struct semaphore *)obj;
+    assert( obj->ops == &semaphore_ops );
+    remove_queue( obj, entry );
+    if (sem->fast != -1 && list_empty( &obj->wait_queue )) set_fast_sync_owner( sem->fast, 0 );
+}
+
 static int semaphore_signaled( struct object *obj, struct wait_queue_entry *entry )
 {
     struct semaphore *sem = (struct semaphore *)obj;
     assert( obj->ops == &semaphore_ops );
-    return (sem->count > 0);
+    return (get_semaphore_count( sem ) > 0);
 }
 
 static void semaphore_satisfied( struct object *obj, struct wait_queue_entry *entry )
 {
     struct semaphore *sem = (struct semaphore *)obj;
     assert( obj->ops == &semaphore_ops );
-    assert( sem->count );
-    sem->count--;
+    if (sem->fast != -1)
+    {
+        unsigned int count;
+
+        /* clients can write to the shared state, so it may have dropped to zero */
+        /* behind our back; the wait is satisfied anyway then, without taking a count */
+        do count = get_semaphore_count( sem );
+        while (count && !cmpxchg_fast_sync_state( sem->fast, count, count - 1 ));
+    }
+    else
+    {
+        assert( sem->count );
+        sem->count--;
+    }
 }
 
 static unsigned int semaphore_map_access( struct object *obj, unsigned int access )
@@ -169,6 +232,13 @@ static int semaphore_signal( struct object *obj, unsigned int access )
     return release_semaphore( sem, 1, NULL );
 }
 
+static void semaphore_destroy( struct object *obj )
+{
+    struct semaphore *sem = (struct semaphore *)obj;
+    assert( obj->ops == &semaphore_ops );
+    free_fast_sync( sem->fast );
+}
+
 /* create a semaphore */
 DECL_HANDLER(create_semaphore)
 {
@@ -189,6 +259,9 @@ DECL_HANDLER(create_semaphore)
                                                           req->access, objattr->attributes );
         release_object( sem );
     }
+    if (reply->handle)
+        reply->fast_type = get_handle_fast_sync( current->process, reply->handle, &reply->fast_index,
+                                                 &reply->fast_max, &reply->fast_access );
 
     if (root) release_object( root );
 }
@@ -200,6 +273,9 @@ DECL_HANDLER(open_semaphore)
 
     reply->handle = open_object( current->process, req->rootdir, req->access,
                                  &semaphore_ops, &name, req->attributes );
+    if (reply->handle)
+        reply->fast_type = get_handle_fast_sync( current->process, reply->handle, &reply->fast_index,
+                                                 &reply->fast_max, &reply->fast_access );
 }
 
 /* release a semaphore */
@@ -223,7 +299,7 @@ DECL_HANDLER(query_semaphore)
     if ((sem = (struct semaphore *)get_handle_obj( current->process, req->handle,
                                                    SEMAPHORE_QUERY_STATE, &semaphore_ops )))
     {
-        reply->current = sem->count;
+        reply->current = get_semaphore_count( sem );
         reply->max = sem->max;
         release_object( sem );
     }
@@ -894,6 +894,26 @@ static void dump_varargs_properties( const char *prefix, data_size_t size )
     remove_data( size );
 }
 
+static void dump_varargs_request_stats( const char *prefix, data_size_t size )
+{
+    const struct request_stats *stats = cur_data;
+    data_size_t len = size / sizeof(*stats);
+
+    fprintf( stderr, "%s{", prefix );
+    while (len > 0)
+    {
+        fprintf( stderr, "{req=%d,pid=%04x,count=%u,max_time=%u", stats->req, stats->pid,
+                 stats->count, stats->max_time );
+        dump_uint64( ",total_time=", (const unsigned __int64 *)&stats->total_time );
+        dump_uint64( ",reply_size=", &stats->reply_size );
+        fputc( '}', stderr );
+        stats++;
+        if (--len) fputc( ',', stderr );
+    }
+    fputc( '}', stderr );
+    remove_data( size );
+}
+
 static void dump_varargs_LUID_AND_ATTRIBUTES( const char *prefix, data_size_t size )
 {
     const LUID_AND_ATTRIBUTES *lat = cur_data;
@@ -1345,6 +1365,17 @@ static void dump_terminate_thread_reply( const struct terminate_thread_reply *re
     fprintf( stderr, ", last=%d", req->last );
 }
 
+static void dump_get_request_stats_request( const struct get_request_stats_request *req )
+{
+    fprintf( stderr, " pid=%04x", req->pid );
+}
+
+static void dump_get_request_stats_reply( const struct get_request_stats_reply *req )
+{
+    fprintf( stderr, " total=%u", req->total );
+    dump_varargs_request_stats( ", stats=", cur_size );
+}
+
 static void dump_get_process_info_request( const struct get_process_info_request *req )
 {
     fprintf( stderr, " handle=%04x", req->handle );
@@ -1582,6 +1613,9 @@ static void dump_create_event_request( const struct create_event_request *req )
 static void dump_create_event_reply( const struct create_event_reply *req )
 {
     fprintf( stderr, " handle=%04x", req->handle );
+    fprintf( stderr, ", fast_type=%d", req->fast_type );
+    fprintf( stderr, ", fast_index=%08x", req->fast_index );
+    fprintf( stderr, ", fast_access=%08x", req->fast_access );
 }
 
 static void dump_event_op_request( const struct event_op_request *req )
@@ -1612,6 +1646,9 @@ static void dump_open_event_request( const struct open_event_request *req )
 static void dump_open_event_reply( const struct open_event_reply *req )
 {
     fprintf( stderr, " handle=%04x", req->handle );
+    fprintf( stderr, ", fast_type=%d", req->fast_type );
+    fprintf( stderr, ", fast_index=%08x", req->fast_index );
+    fprintf( stderr, ", fast_access=%08x", req->fast_access );
 }
 
 static void dump_create_keyed_event_request( const struct create_keyed_event_request *req )
@@ -1696,6 +1733,10 @@ static void dump_create_semaphore_request( const struct create_semaphore_request
 static void dump_create_semaphore_reply( const struct create_semaphore_reply *req )
 {
     fprintf( stderr, " handle=%04x", req->handle );
+    fprintf( stderr, ", fast_type=%d", req->fast_type );
+    fprintf( stderr, ", fast_index=%08x", req->fast_index );
+    fprintf( stderr, ", fast_access=%08x", req->fast_access );
+    fprintf( stderr, ", fast_max=%08x", req->fast_max );
 }
 
 static void dump_release_semaphore_request( const struct release_semaphore_request *req )
@@ -1720,6 +1761,28 @@ static void dump_query_semaphore_reply( const struct query_semaphore_reply *req
     fprintf( stderr, ", max=%08x", req->max );
 }
 
+static void dump_get_fast_sync_region_request( const struct get_fast_sync_region_request *req )
+{
+}
+
+static void dump_get_fast_sync_region_reply( const struct get_fast_sync_region_reply *req )
+{
+    fprintf( stderr, " size=%08x", req->size );
+}
+
+static void dump_get_fast_sync_request( const struct get_fast_sync_request *req )
+{
+    fprintf( stderr, " handle=%04x", req->handle );
+}
+
+static void dump_get_fast_sync_reply( const struct get_fast_sync_reply *req )
+{
+    fprintf( stderr, " type=%d", req->type );
+    fprintf( stderr, ", index=%08x", req->index );
+    fprintf( stderr, ", max=%08x", req->max );
+    fprintf( stderr, ", access=%08x", req->access );
+}
+
 static void dump_open_semaphore_request( const struct open_semaphore_request *req )
 {
     fprintf( stderr, " access=%08x", req->access );
@@ -1731,6 +1794,10 @@ static void dump_open_semaphore_request( const struct open_semaphore_request *re
 static void dump_open_semaphore_reply( const struct open_semaphore_reply *req )
 {
     fprintf( stderr, " handle=%04x", req->handle );
+    fprintf( stderr, ", fast_type=%d", req->fast_type );
+    fprintf( stderr, ", fast_index=%08x", req->fast_index );
+    fprintf( stderr, ", fast_access=%08x", req->fast_access );
+    fprintf( stderr, ", fast_max=%08x", req->fast_max );
 }
 
 static void dump_create_file_request( const struct create_file_request *req )
@@ -2522,9 +2589,20 @@ static void dump_get_key_value_reply( const struct get_key_value_reply *req )
 {
     fprintf( stderr, " type=%d", req->type );
     fprintf( stderr, ", total=%u", req->total );
+    fprintf( stderr, ", seq_index=%d", req->seq_index );
+    fprintf( stderr, ", seq=%08x", req->seq );
     dump_varargs_bytes( ", data=", cur_size );
 }
 
+static void dump_get_key_seq_region_request( const struct get_key_seq_region_request *req )
+{
+}
+
+static void dump_get_key_seq_region_reply( const struct get_key_seq_region_reply *req )
+{
+    fprintf( stderr, " size=%08x", req->size );
+}
+
 static void dump_enum_key_value_request( const struct enum_key_value_request *req )
 {
     fprintf( stderr, " hkey=%04x", req->hkey );
@@ -3568,6 +3646,28 @@ static void dump_get_last_input_time_reply( const struct get_last_input_time_rep
     fprintf( stderr, " time=%08x", req->time );
 }
 
+static void dump_get_shared_input_region_request( const struct get_shared_input_region_request *req )
+{
+}
+
+static void dump_get_shared_input_region_reply( const struct get_shared_input_region_reply *req )
+{
+    fprintf( stderr, " handle=%04x", req->handle );
+    fprintf( stderr, ", size=%u", req->size );
+}
+
+static void dump_get_shared_input_request( const struct get_shared_input_request *req )
+{
+}
+
+static void dump_get_shared_input_reply( const struct get_shared_input_reply *req )
+{
+    fprintf( stderr, " desktop_slot=%d", req->desktop_slot );
+    fprintf( stderr, ", desktop_id=%08x", req->desktop_id );
+    fprintf( stderr, ", queue_slot=%d", req->queue_slot );
+    fprintf( stderr, ", queue_id=%08x", req->queue_id );
+}
+
 static void dump_get_key_state_request( const struct get_key_state_request *req )
 {
     fprintf( stderr, " tid=%04x", req->tid );
@@ -4529,6 +4629,7 @@ static const dump_func req_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_init_thread_request,
     (dump_func)dump_terminate_process_request,
     (dump_func)dump_terminate_thread_request,
+    (dump_func)dump_get_request_stats_request,
     (dump_func)dump_get_process_info_request,
     (dump_func)dump_get_process_vm_counters_request,
     (dump_func)dump_set_process_info_request,
@@ -4561,6 +4662,8 @@ static const dump_func req_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_create_semaphore_request,
     (dump_func)dump_release_semaphore_request,
     (dump_func)dump_query_semaphore_request,
+    (dump_func)dump_get_fast_sync_region_request,
+    (dump_func)dump_get_fast_sync_request,
     (dump_func)dump_open_semaphore_request,
     (dump_func)dump_create_file_request,
     (dump_func)dump_open_file_object_request,
@@ -4631,6 +4734,7 @@ static const dump_func req_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_enum_key_request,
     (dump_func)dump_set_key_value_request,
     (dump_func)dump_get_key_value_request,
+    (dump_func)dump_get_key_seq_region_request,
     (dump_func)dump_enum_key_value_request,
     (dump_func)dump_delete_key_value_request,
     (dump_func)dump_load_registry_request,
@@ -4725,6 +4829,8 @@ static const dump_func req_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_attach_thread_input_request,
     (dump_func)dump_get_thread_input_request,
     (dump_func)dump_get_last_input_time_request,
+    (dump_func)dump_get_shared_input_region_request,
+    (dump_func)dump_get_shared_input_request,
     (dump_func)dump_get_key_state_request,
     (dump_func)dump_set_key_state_request,
     (dump_func)dump_set_foreground_window_request,
@@ -4821,6 +4927,7 @@ static const dump_func reply_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_init_thread_reply,
     (dump_func)dump_terminate_process_reply,
     (dump_func)dump_terminate_thread_reply,
+    (dump_func)dump_get_request_stats_reply,
     (dump_func)dump_get_process_info_reply,
     (dump_func)dump_get_process_vm_counters_reply,
     NULL,
@@ -4853,6 +4960,8 @@ static const dump_func reply_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_create_semaphore_reply,
     (dump_func)dump_release_semaphore_reply,
     (dump_func)dump_query_semaphore_reply,
+    (dump_func)dump_get_fast_sync_region_reply,
+    (dump_func)dump_get_fast_sync_reply,
     (dump_func)dump_open_semaphore_reply,
     (dump_func)dump_create_file_reply,
     (dump_func)dump_open_file_object_reply,
@@ -4923,6 +5032,7 @@ static const dump_func reply_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_enum_key_reply,
     NULL,
     (dump_func)dump_get_key_value_reply,
+    (dump_func)dump_get_key_seq_region_reply,
     (dump_func)dump_enum_key_value_reply,
     NULL,
     NULL,
@@ -5017,6 +5127,8 @@ static const dump_func reply_dumpers[REQ_NB_REQUESTS] = {
     NULL,
     (dump_func)dump_get_thread_input_reply,
     (dump_func)dump_get_last_input_time_reply,
+    (dump_func)dump_get_shared_input_region_reply,
+    (dump_func)dump_get_shared_input_reply,
     (dump_func)dump_get_key_state_reply,
     NULL,
     (dump_func)dump_set_foreground_window_reply,
@@ -5113,6 +5225,7 @@ static const char * const req_names[REQ_NB_REQUESTS] = {
     "init_thread",
     "terminate_process",
     "terminate_thread",
+    "get_request_stats",
     "get_process_info",
     "get_process_vm_counters",
     "set_process_info",
@@ -5145,6 +5258,8 @@ static const char * const req_names[REQ_NB_REQUESTS] = {
     "create_semaphore",
     "release_semaphore",
     "query_semaphore",
+    "get_fast_sync_region",
+    "get_fast_sync",
     "open_semaphore",
     "create_file",
     "open_file_object",
@@ -5215,6 +5330,7 @@ static const char * const req_names[REQ_NB_REQUESTS] = {
     "enum_key",
     "set_key_value",
     "get_key_value",
+    "get_key_seq_region",
     "enum_key_value",
     "delete_key_value",
     "load_registry",
@@ -5309,6 +5425,8 @@ static const char * const req_names[REQ_NB_REQUESTS] = {
     "attach_thread_input",
     "get_thread_input",
     "get_last_input_time",
+    "get_shared_input_region",
+    "get_shared_input",
     "get_key_state",
     "set_key_state",
     "set_foreground_window",
@@ -5537,6 +5655,11 @@ static const char *get_status_name( unsigned int status )
     return buffer;
 }
 
+const char *get_req_name( enum request req )
+{
+    return req < REQ_NB_REQUESTS ? req_names[req] : "?";
+}
+
 void trace_request(void)
 {
     enum request req = current->req.request_header.req;
@@ -76,7 +76,9 @@ struct desktop
     struct thread_input *foreground_input; /* thread input of foreground thread */
     unsigned int         users;            /* processes and threads using this desktop */
     struct global_cursor cursor;           /* global cursor information */
-    unsigned char        keystate[256];    /* asynchronous key state */
+    struct shared_input *shared;           /* state shared with the clients */
+    int                  shared_slot;      /* slot of the shared state, or -1 */
+    unsigned char       *keystate;         /* asynchronous key state, in the shared state */
 };
 
 /* user handles functions */
@@ -103,6 +105,8 @@ extern struct thread *get_first_global_hook( int id );
 /* queue functions */
 
 extern void free_msg_queue( struct thread *thread );
+extern struct shared_input *alloc_shared_input( int *slot );
+extern void free_shared_input( struct shared_input *shared, int slot );
 extern struct hook_table *get_queue_hooks( struct thread *thread );
 extern void set_queue_hooks( struct thread *thread, struct hook_table *hooks );
 extern void inc_queue_paint_count( struct thread *thread, int incr );
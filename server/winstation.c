@@ -180,7 +180,7 @@ static void winstation_destroy( struct object *obj )
     list_remove( &winstation->entry );
     if (winstation->clipboard) release_object( winstation->clipboard );
     if (winstation->atom_table) release_object( winstation->atom_table );
-    free( winstation->desktop_names );
+    free_namespace( winstation->desktop_names );
 }
 
 static unsigned int winstation_map_access( struct object *obj, unsigned int access )
@@ -227,9 +227,14 @@ static struct desktop *create_desktop( const struct unicode_str *name, unsigned
             desktop->foreground_input = NULL;
             desktop->users = 0;
             memset( &desktop->cursor, 0, sizeof(desktop->cursor) );
-            memset( desktop->keystate, 0, sizeof(desktop->keystate) );
             list_add_tail( &winstation->desktops, &desktop->entry );
             list_init( &desktop->hotkeys );
+            if (!(desktop->shared = alloc_shared_input( &desktop->shared_slot )))
+            {
+                release_object( desktop );
+                return NULL;
+            }
+            desktop->keystate = desktop->shared->keystate;
         }
         else clear_error();
     }
@@ -291,6 +296,7 @@ static void desktop_destroy( struct object *obj )
     if (desktop->close_timeout) remove_timeout_user( desktop->close_timeout );
     list_remove( &desktop->entry );
     release_object( desktop->winstation );
+    if (desktop->shared) free_shared_input( desktop->shared, desktop->shared_slot );
 }
 
 static unsigned int desktop_map_access( struct object *obj, unsigned int access )